@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/// \file
+/// Compares text protocol queries with binary prepared statement queries
+
+#include "Common.h"
+#include "Database/DatabaseEnv.h"
+
+#include <ace/Get_Opt.h>
+#include <ace/OS_NS_time.h>
+
+DatabaseType WorldDatabase;
+DatabaseType CharacterDatabase;
+DatabaseType LoginDatabase;
+
+enum BenchMode
+{
+    BENCH_TEXT,                                             // Database::Query, mysql_store_result
+    BENCH_BINARY,                                           // SqlStatement::Query, stored typed columns
+    BENCH_STREAM,                                           // SqlStatement::StreamQuery
+    MAX_BENCH_MODE
+};
+
+static char const* ModeNames[MAX_BENCH_MODE] = { "text", "binary", "stream" };
+
+struct BenchQuery
+{
+    char const* name;
+    char const* sql;                                        // '?' is the character guid
+};
+
+// startup loaders, as in ObjectMgr::LoadCreatures and ObjectMgr::LoadGameObjects
+static BenchQuery const LoaderQueries[] =
+{
+    { "creatures", "SELECT creature.guid, creature.id, map, modelid, equipment_id, position_x, position_y, position_z, orientation, "
+                   "spawntimesecs, spawndist, currentwaypoint, curhealth, curmana, DeathState, MovementType, spawnMask, phaseMask, event, "
+                   "pool_creature.pool_entry, pool_creature_template.pool_entry FROM creature "
+                   "LEFT OUTER JOIN game_event_creature ON creature.guid = game_event_creature.guid "
+                   "LEFT OUTER JOIN pool_creature ON creature.guid = pool_creature.guid "
+                   "LEFT OUTER JOIN pool_creature_template ON creature.id = pool_creature_template.id" },
+    { "gameobjects", "SELECT gameobject.guid, gameobject.id, map, position_x, position_y, position_z, orientation, "
+                     "rotation0, rotation1, rotation2, rotation3, spawntimesecs, animprogress, state, spawnMask, phaseMask, event, "
+                     "pool_gameobject.pool_entry, pool_gameobject_template.pool_entry FROM gameobject "
+                     "LEFT OUTER JOIN game_event_gameobject ON gameobject.guid = game_event_gameobject.guid "
+                     "LEFT OUTER JOIN pool_gameobject ON gameobject.guid = pool_gameobject.guid "
+                     "LEFT OUTER JOIN pool_gameobject_template ON gameobject.id = pool_gameobject_template.id" },
+};
+
+// biggest queries of LoginQueryHolder
+static BenchQuery const LoginQueries[] =
+{
+    { "auras",        "SELECT caster_guid,item_guid,spell,stackcount,remaincharges,basepoints0,basepoints1,basepoints2,periodictime0,periodictime1,periodictime2,maxduration,remaintime,effIndexMask FROM character_aura WHERE guid = ?" },
+    { "spells",       "SELECT spell,active,disabled FROM character_spell WHERE guid = ?" },
+    { "queststatus",  "SELECT quest,status,rewarded,explored,timer,mobcount1,mobcount2,mobcount3,mobcount4,itemcount1,itemcount2,itemcount3,itemcount4,itemcount5,itemcount6 FROM character_queststatus WHERE guid = ?" },
+    { "reputation",   "SELECT faction,standing,flags FROM character_reputation WHERE guid = ?" },
+    { "inventory",    "SELECT data,text,bag,slot,item,item_template FROM character_inventory JOIN item_instance ON character_inventory.item = item_instance.guid WHERE character_inventory.guid = ? ORDER BY bag,slot" },
+    { "actions",      "SELECT spec,button,action,type FROM character_action WHERE guid = ? ORDER BY button" },
+    { "achievements", "SELECT achievement, date FROM character_achievement WHERE guid = ?" },
+    { "criteria",     "SELECT criteria, counter, date FROM character_achievement_progress WHERE guid = ?" },
+    { "skills",       "SELECT skill, value, max FROM character_skills WHERE guid = ?" },
+    { "talents",      "SELECT talent_id, current_rank, spec FROM character_talent WHERE guid = ?" },
+    { "mails",        "SELECT id,messageType,sender,receiver,subject,body,expire_time,deliver_time,money,cod,checked,stationery,mailTemplateId,has_items FROM mail WHERE receiver = ? ORDER BY id DESC" },
+};
+
+#define LOADER_QUERIES  (sizeof(LoaderQueries) / sizeof(LoaderQueries[0]))
+#define LOGIN_QUERIES   (sizeof(LoginQueries) / sizeof(LoginQueries[0]))
+
+static SqlStatementID LoaderStatements[LOADER_QUERIES];
+static SqlStatementID LoginStatements[LOGIN_QUERIES];
+
+struct BenchOptions
+{
+    BenchOptions() : runs(3), logins(200), guid(0) {}
+
+    std::string worldInfo;
+    std::string characterInfo;
+    uint32 runs;
+    uint32 logins;                                          // per run
+    uint32 guid;
+};
+
+struct BenchResult
+{
+    BenchResult() : rows(0), fields(0), checksum(0.0) {}
+
+    uint64 rows;
+    uint64 fields;
+    double checksum;                                        // same for all modes if they read the same values
+};
+
+static double GetMSTime(ACE_hrtime_t start)
+{
+    return double(ACE_OS::gethrtime() - start) / 1000000.0;
+}
+
+// every field is read once by the getter of its type, like the loaders do
+static void ConsumeResult(QueryResult* result, BenchResult& bench)
+{
+    if (!result)
+        return;
+
+    do
+    {
+        Field* fields = result->Fetch();
+        for (uint32 i = 0; i < result->GetFieldCount(); ++i)
+        {
+            switch (fields[i].GetType())
+            {
+                case Field::DB_TYPE_INTEGER:
+                case Field::DB_TYPE_BOOL:
+                    bench.checksum += fields[i].GetUInt32();
+                    break;
+                case Field::DB_TYPE_FLOAT:
+                    bench.checksum += fields[i].GetFloat();
+                    break;
+                default:
+                    if (char const* str = fields[i].GetString())
+                        bench.checksum += strlen(str);
+                    break;
+            }
+        }
+
+        ++bench.rows;
+        bench.fields += result->GetFieldCount();
+    }
+    while (result->NextRow());
+
+    delete result;
+}
+
+static QueryResult* RunQuery(Database& db, SqlStatementID& id, char const* sql, BenchMode mode, uint32 guid, bool withGuid)
+{
+    if (mode == BENCH_TEXT)
+    {
+        std::string text(sql);
+        if (withGuid)
+        {
+            std::ostringstream ss;
+            ss << "'" << guid << "'";
+            text.replace(text.find('?'), 1, ss.str());
+        }
+
+        return db.Query(text.c_str());
+    }
+
+    SqlStatement stmt = db.CreateStatement(id, sql);
+    if (withGuid)
+        stmt.addUInt32(guid);
+
+    return mode == BENCH_STREAM ? stmt.StreamQuery() : stmt.Query();
+}
+
+static void PrintResult(char const* workload, BenchMode mode, double ms, BenchResult const& bench, double perUnit, char const* unit)
+{
+    printf("%-12s %-7s %10.1f %10llu %12llu %12.3f %-10s %16.1f\n", workload, ModeNames[mode], ms,
+           (unsigned long long)bench.rows, (unsigned long long)bench.fields, perUnit, unit, bench.checksum);
+}
+
+static void BenchLoaders(BenchOptions const& options)
+{
+    for (uint32 q = 0; q < LOADER_QUERIES; ++q)
+    {
+        for (uint32 run = 0; run < options.runs; ++run)
+        {
+            for (uint32 mode = 0; mode < MAX_BENCH_MODE; ++mode)
+            {
+                BenchResult bench;
+                ACE_hrtime_t start = ACE_OS::gethrtime();
+
+                ConsumeResult(RunQuery(WorldDatabase, LoaderStatements[q], LoaderQueries[q].sql, BenchMode(mode), 0, false), bench);
+
+                double ms = GetMSTime(start);
+                PrintResult(LoaderQueries[q].name, BenchMode(mode), ms, bench, bench.rows ? ms * 1000.0 / bench.rows : 0.0, "us/row");
+            }
+        }
+    }
+}
+
+static void BenchLogins(BenchOptions const& options)
+{
+    // login reads all rows at once, streaming makes no sense there
+    for (uint32 run = 0; run < options.runs; ++run)
+    {
+        for (uint32 mode = 0; mode < BENCH_STREAM; ++mode)
+        {
+            BenchResult bench;
+            ACE_hrtime_t start = ACE_OS::gethrtime();
+
+            for (uint32 login = 0; login < options.logins; ++login)
+                for (uint32 q = 0; q < LOGIN_QUERIES; ++q)
+                    ConsumeResult(RunQuery(CharacterDatabase, LoginStatements[q], LoginQueries[q].sql, BenchMode(mode), options.guid, true), bench);
+
+            double ms = GetMSTime(start);
+            PrintResult("login", BenchMode(mode), ms, bench, ms / options.logins, "ms/login");
+        }
+    }
+}
+
+static void usage(char const* prog)
+{
+    printf("Usage: %s [-w world db] [-c character db] [-g character guid] [-r runs] [-l logins per run]\n"
+           "       databases as in mangosd.conf: \"host;port;user;password;database\"\n", prog);
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+
+    ACE_Get_Opt cmd_opts(argc, argv, "w:c:g:r:l:");
+
+    int option;
+    while ((option = cmd_opts()) != EOF)
+    {
+        switch (option)
+        {
+            case 'w': options.worldInfo = cmd_opts.opt_arg(); break;
+            case 'c': options.characterInfo = cmd_opts.opt_arg(); break;
+            case 'g': options.guid = uint32(atoi(cmd_opts.opt_arg())); break;
+            case 'r': options.runs = uint32(atoi(cmd_opts.opt_arg())); break;
+            case 'l': options.logins = uint32(atoi(cmd_opts.opt_arg())); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if ((options.worldInfo.empty() && options.characterInfo.empty()) || !options.runs || !options.logins)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    printf("%-12s %-7s %10s %10s %12s %12s %-10s %16s\n", "workload", "mode", "ms", "rows", "fields", "", "", "checksum");
+
+    if (!options.worldInfo.empty())
+    {
+        if (!WorldDatabase.Initialize(options.worldInfo.c_str()))
+        {
+            printf("Can't connect to world database\n");
+            return 1;
+        }
+
+        BenchLoaders(options);
+    }
+
+    if (!options.characterInfo.empty())
+    {
+        if (!CharacterDatabase.Initialize(options.characterInfo.c_str()))
+        {
+            printf("Can't connect to character database\n");
+            return 1;
+        }
+
+        // character with most items if none given
+        if (!options.guid)
+        {
+            if (QueryResult* result = CharacterDatabase.Query("SELECT guid FROM character_inventory GROUP BY guid ORDER BY COUNT(*) DESC LIMIT 1"))
+            {
+                options.guid = result->Fetch()[0].GetUInt32();
+                delete result;
+            }
+        }
+
+        printf("character guid %u, %u logins per run\n", options.guid, options.logins);
+        BenchLogins(options);
+    }
+
+    return 0;
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LOADTEST_CLIENTCRYPT_H
+#define LOADTEST_CLIENTCRYPT_H
+
+#include "Common.h"
+#include "Auth/SARC4.h"
+
+class BigNumber;
+
+/// Client side of AuthCrypt: the keys of both directions are swapped
+class ClientCrypt
+{
+    public:
+        ClientCrypt();
+
+        void Init(BigNumber* K);
+        void DecryptRecv(uint8* data, size_t len);
+        void EncryptSend(uint8* data, size_t len);
+
+        bool IsInitialized() const { return m_initialized; }
+
+    private:
+        SARC4 m_serverDecrypt;
+        SARC4 m_clientEncrypt;
+        bool m_initialized;
+};
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LOADTEST_CLIENTPACKET_H
+#define LOADTEST_CLIENTPACKET_H
+
+#include "Common.h"
+#include "Utilities/ByteConverter.h"
+
+#include <vector>
+
+/**
+ * Minimal world packet builder and reader of the load test client.
+ *
+ * Little endian layout as ByteBuffer of the server. Reads past the end
+ * don't throw, they set the failed state and return zeros instead.
+ */
+class ClientPacket
+{
+    public:
+        explicit ClientPacket(uint16 opcode, size_t reserve = 32) : m_opcode(opcode), m_rpos(0), m_failed(false)
+        {
+            m_data.reserve(reserve);
+        }
+
+        ClientPacket(uint16 opcode, uint8 const* data, size_t size) : m_opcode(opcode), m_data(data, data + size), m_rpos(0), m_failed(false) {}
+
+        uint16 GetOpcode() const { return m_opcode; }
+        size_t size() const { return m_data.size(); }
+        uint8 const* contents() const { return m_data.empty() ? NULL : &m_data[0]; }
+
+        template<class T> ClientPacket& Append(T value)
+        {
+            EndianConvert(value);
+            uint8 const* bytes = (uint8 const*)&value;
+            m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+            return *this;
+        }
+
+        ClientPacket& operator<<(uint8 value) { return Append(value); }
+        ClientPacket& operator<<(uint16 value) { return Append(value); }
+        ClientPacket& operator<<(uint32 value) { return Append(value); }
+        ClientPacket& operator<<(uint64 value) { return Append(value); }
+        ClientPacket& operator<<(float value) { return Append(value); }
+
+        ClientPacket& operator<<(std::string const& value)
+        {
+            m_data.insert(m_data.end(), value.begin(), value.end());
+            m_data.push_back(0);
+            return *this;
+        }
+
+        void AppendBytes(uint8 const* data, size_t size) { m_data.insert(m_data.end(), data, data + size); }
+
+        void AppendPackGUID(uint64 guid)
+        {
+            size_t maskPos = m_data.size();
+            m_data.push_back(0);
+
+            for (uint8 i = 0; i < 8; ++i)
+            {
+                if (uint8 byte = uint8(guid >> (i * 8)))
+                {
+                    m_data[maskPos] |= uint8(1 << i);
+                    m_data.push_back(byte);
+                }
+            }
+        }
+
+        template<class T> T Read()
+        {
+            T value = T();
+            if (m_rpos + sizeof(T) > m_data.size())
+            {
+                m_failed = true;
+                m_rpos = m_data.size();
+                return value;
+            }
+
+            memcpy(&value, &m_data[m_rpos], sizeof(T));
+            EndianConvert(value);
+            m_rpos += sizeof(T);
+            return value;
+        }
+
+        uint64 ReadPackGUID()
+        {
+            uint8 mask = Read<uint8>();
+            uint64 guid = 0;
+            for (uint8 i = 0; i < 8; ++i)
+                if (mask & (1 << i))
+                    guid |= uint64(Read<uint8>()) << (i * 8);
+            return guid;
+        }
+
+        void ReadSkip(size_t size)
+        {
+            if (m_rpos + size > m_data.size())
+            {
+                m_failed = true;
+                m_rpos = m_data.size();
+            }
+            else
+                m_rpos += size;
+        }
+
+        bool IsFailed() const { return m_failed; }
+
+    private:
+        uint16 m_opcode;
+        std::vector<uint8> m_data;
+        size_t m_rpos;
+        bool m_failed;
+};
+
+#endif
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "LoadDriver.h"
+
+#include <ace/Reactor.h>
+
+char const* ScenarioNames[MAX_SCENARIO] = { "logon", "login", "city", "raid", "crowd" };
+
+LoadDriver::LoadDriver(LoadOptions const& options) : m_options(options), m_startTime(0),
+    m_started(0), m_active(0), m_loggingIn(0), m_starting(false), m_stopping(false)
+{
+    if (!m_options.accounts)
+        m_options.accounts = m_options.sessions;
+}
+
+bool LoadDriver::Start()
+{
+    if (m_address.set(m_options.port, m_options.host.c_str()) == -1)
+    {
+        printf("Can't resolve %s\n", m_options.host.c_str());
+        return false;
+    }
+
+    if (m_options.scenario != SCENARIO_LOGON && m_worldAddress.set(m_options.worldPort, m_options.worldHost.c_str()) == -1)
+    {
+        printf("Can't resolve %s\n", m_options.worldHost.c_str());
+        return false;
+    }
+
+    if (m_connector.open(ACE_Reactor::instance(), ACE_NONBLOCK) == -1 ||
+        m_worldConnector.open(ACE_Reactor::instance(), ACE_NONBLOCK) == -1)
+    {
+        printf("Can't open connector\n");
+        return false;
+    }
+
+    reactor(ACE_Reactor::instance());
+    reactor()->schedule_timer(this, NULL, ACE_Time_Value(1), ACE_Time_Value(1));
+
+    printf("Scenario %s: %u sessions to %s:%u, %u concurrent logins, %u accounts\n", ScenarioNames[m_options.scenario],
+        m_options.sessions, m_options.host.c_str(), m_options.port, m_options.concurrent, m_options.accounts);
+
+    m_startTime = ACE_OS::gethrtime();
+    m_stats.Start();
+    StartSessions();
+    return true;
+}
+
+void LoadDriver::StartSessions()
+{
+    // a connect failing at once closes its session, which calls back here
+    if (m_starting || m_stopping)
+        return;
+
+    m_starting = true;
+
+    while (m_loggingIn < m_options.concurrent && m_started < m_options.sessions)
+    {
+        uint32 accountIndex = m_options.firstAccount + m_started % m_options.accounts;
+
+        LoginSession* session = new LoginSession;
+        session->Setup(this, accountIndex, GetAccountName(accountIndex), m_options.build);
+
+        ++m_started;
+        ++m_active;
+        ++m_loggingIn;
+
+        // result is reported by the session itself, also for failed connects
+        m_connector.connect(session, m_address, ACE_Synch_Options::asynch);
+    }
+
+    m_starting = false;
+}
+
+void LoadDriver::OnLogonDone(uint32 accountIndex, std::string const& account, BigNumber const& K, ACE_hrtime_t startTime)
+{
+    if (m_stopping)
+    {
+        OnLoginFinished();
+        OnSessionClosed();
+        return;
+    }
+
+    // the logon session slot is taken over by the world client
+    WorldClient* client = new WorldClient;
+    client->Setup(this, accountIndex, account, K, startTime);
+
+    m_worldConnector.connect(client, m_worldAddress, ACE_Synch_Options::asynch);
+}
+
+void LoadDriver::OnLoginFinished()
+{
+    --m_loggingIn;
+    StartSessions();
+}
+
+void LoadDriver::OnSessionClosed()
+{
+    --m_active;
+}
+
+void LoadDriver::Stop()
+{
+    if (m_stopping)
+        return;
+
+    printf("Run time is over, stopping %u clients\n", uint32(m_clients.size()));
+    m_stopping = true;
+
+    // closed clients unregister themselves
+    std::set<WorldClient*> clients = m_clients;
+    for (std::set<WorldClient*>::const_iterator itr = clients.begin(); itr != clients.end(); ++itr)
+        (*itr)->Stop();
+}
+
+std::string LoadDriver::GetAccountName(uint32 index) const
+{
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%05u", index);
+    return m_options.prefix + buf;
+}
+
+int LoadDriver::handle_timeout(ACE_Time_Value const& /*current_time*/, void const* /*act*/)
+{
+    m_stats.PrintProgress();
+
+    if (m_options.scenario >= SCENARIO_CITY &&
+        ACE_OS::gethrtime() - m_startTime >= ACE_hrtime_t(m_options.duration) * 1000000000)
+        Stop();
+
+    return 0;
+}
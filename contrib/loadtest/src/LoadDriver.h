@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LOADTEST_LOADDRIVER_H
+#define LOADTEST_LOADDRIVER_H
+
+#include "Common.h"
+#include "LoadStats.h"
+#include "LoginSession.h"
+#include "WorldClient.h"
+
+#include <ace/Connector.h>
+#include <ace/SOCK_Connector.h>
+#include <ace/INET_Addr.h>
+
+#include <set>
+
+enum LoadScenario
+{
+    SCENARIO_LOGON,                                         // realmd logon and realm list only
+    SCENARIO_LOGIN_STORM,                                   // logon and world login, disconnect when in world
+    SCENARIO_CITY,                                          // clients stay in world, walk around and chat
+    SCENARIO_RAID,                                          // clients stay in world, move and cast spells
+    SCENARIO_CROWD,                                         // clients stay in world spread around the start point and walk
+    MAX_SCENARIO
+};
+
+// names used on the command line
+extern char const* ScenarioNames[MAX_SCENARIO];
+
+struct LoadOptions
+{
+    LoadOptions() : scenario(SCENARIO_LOGON), host("127.0.0.1"), port(3724), worldHost("127.0.0.1"), worldPort(8085),
+        sessions(1000), concurrent(100), accounts(0), firstAccount(0), prefix("LOADTEST"), build(12340), duration(60) {}
+
+    LoadScenario scenario;
+    std::string host;
+    uint16 port;
+    std::string worldHost;
+    uint16 worldPort;
+    uint32 sessions;                                        // total sessions (clients)
+    uint32 concurrent;                                      // logins in progress at once
+    uint32 accounts;                                        // different accounts, 0 - one per session
+    uint32 firstAccount;
+    std::string prefix;
+    uint16 build;
+    uint32 duration;                                        // seconds in world for city, raid and crowd scenarios
+};
+
+/**
+ * Keeps the configured number of logins in flight until all clients are started,
+ * stops the clients staying in world at end of the run and prints progress once
+ * per second.
+ */
+class LoadDriver : public ACE_Event_Handler
+{
+    public:
+        explicit LoadDriver(LoadOptions const& options);
+
+        bool Start();
+        bool IsDone() const { return (m_started == m_options.sessions || m_stopping) && m_active == 0; }
+        bool IsStopping() const { return m_stopping; }
+
+        LoadOptions const& GetOptions() const { return m_options; }
+        LoadStats& GetStats() { return m_stats; }
+
+        // realmd logon of a world scenario client is done, continue with the world server
+        void OnLogonDone(uint32 accountIndex, std::string const& account, BigNumber const& K, ACE_hrtime_t startTime);
+        // client is in world or failed before, next logins can be started
+        void OnLoginFinished();
+        // session or world client closed
+        void OnSessionClosed();
+
+        void RegisterClient(WorldClient* client) { m_clients.insert(client); }
+        void UnregisterClient(WorldClient* client) { m_clients.erase(client); }
+
+        // progress timer
+        int handle_timeout(ACE_Time_Value const& current_time, void const* act = 0);
+
+    private:
+        typedef ACE_Connector<LoginSession, ACE_SOCK_CONNECTOR> LogonConnector;
+        typedef ACE_Connector<WorldClient, ACE_SOCK_CONNECTOR> WorldConnector;
+
+        void StartSessions();
+        void Stop();
+        std::string GetAccountName(uint32 index) const;
+
+        LoadOptions m_options;
+        ACE_INET_Addr m_address;
+        ACE_INET_Addr m_worldAddress;
+        LogonConnector m_connector;
+        WorldConnector m_worldConnector;
+        LoadStats m_stats;
+        ACE_hrtime_t m_startTime;
+
+        uint32 m_started;
+        uint32 m_active;                                    // sessions and world clients
+        uint32 m_loggingIn;
+        bool m_starting;                                    // guards against recursion of failed connects
+        bool m_stopping;
+
+        std::set<WorldClient*> m_clients;
+};
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "LoadStats.h"
+
+#include <algorithm>
+
+static char const* LatencySeriesNames[MAX_LATENCY_SERIES] =
+{
+    "logon",
+    "world login",
+    "ping",
+    "world tick",
+    "spell cast"
+};
+
+LoadStats::LoadStats() : m_start(0), m_lastReport(0), m_failed(0),
+    m_clients(0), m_bytesSent(0), m_bytesReceived(0), m_packetsReceived(0), m_movementBytes(0), m_movementPackets(0), m_movementBundles(0)
+{
+    memset(m_lastCount, 0, sizeof(m_lastCount));
+}
+
+void LoadStats::Start()
+{
+    m_start = m_lastReport = ACE_OS::gethrtime();
+}
+
+void LoadStats::AddSample(LatencySeries series, uint32 latency)
+{
+    m_samples[series].push_back(latency);
+}
+
+void LoadStats::AddFailure(std::string const& reason)
+{
+    ++m_failed;
+    ++m_failures[reason];
+}
+
+void LoadStats::AddTraffic(uint64 sent, uint64 received, uint32 packets)
+{
+    ++m_clients;
+    m_bytesSent += sent;
+    m_bytesReceived += received;
+    m_packetsReceived += packets;
+}
+
+void LoadStats::AddMovementTraffic(uint64 received, uint32 packets, uint32 bundles)
+{
+    m_movementBytes += received;
+    m_movementPackets += packets;
+    m_movementBundles += bundles;
+}
+
+void LoadStats::PrintProgress()
+{
+    ACE_hrtime_t now = ACE_OS::gethrtime();
+    double interval = Seconds(now - m_lastReport);
+    if (interval <= 0.0)
+        return;
+
+    uint32 logons = m_samples[LATENCY_LOGON].size();
+    uint32 logins = m_samples[LATENCY_WORLD_LOGIN].size();
+
+    printf("%8.1fs  logons %7u (%7.1f/s)  world logins %7u (%7.1f/s)  failed %6u\n", Seconds(now - m_start),
+        logons, (logons - m_lastCount[LATENCY_LOGON]) / interval,
+        logins, (logins - m_lastCount[LATENCY_WORLD_LOGIN]) / interval, m_failed);
+    fflush(stdout);
+
+    m_lastReport = now;
+    for (int i = 0; i < MAX_LATENCY_SERIES; ++i)
+        m_lastCount[i] = m_samples[i].size();
+}
+
+void LoadStats::PrintSummary() const
+{
+    double total = Seconds(ACE_OS::gethrtime() - m_start);
+
+    printf("\n");
+    printf("Run time %.2f s, %u logons, %u world logins, %u failures\n", total,
+        uint32(m_samples[LATENCY_LOGON].size()), uint32(m_samples[LATENCY_WORLD_LOGIN].size()), m_failed);
+    if (total > 0.0)
+        printf("Logons per second: %.1f, world logins per second: %.1f\n",
+            m_samples[LATENCY_LOGON].size() / total, m_samples[LATENCY_WORLD_LOGIN].size() / total);
+
+    printf("\nLatency (ms)          count      p50      p90      p99      max\n");
+    for (int i = 0; i < MAX_LATENCY_SERIES; ++i)
+    {
+        if (m_samples[i].empty())
+            continue;
+
+        std::vector<uint32> sorted = m_samples[i];
+        std::sort(sorted.begin(), sorted.end());
+
+        printf("  %-16s %9u %8.1f %8.1f %8.1f %8.1f\n", LatencySeriesNames[i], uint32(sorted.size()),
+            sorted[sorted.size() * 50 / 100] / 1000.0, sorted[sorted.size() * 90 / 100] / 1000.0,
+            sorted[sorted.size() * 99 / 100] / 1000.0, sorted.back() / 1000.0);
+    }
+
+    if (m_clients)
+    {
+        printf("\nWorld traffic per client: %.1f KB sent, %.1f KB received, %.0f packets received\n",
+            m_bytesSent / 1024.0 / m_clients, m_bytesReceived / 1024.0 / m_clients, double(m_packetsReceived) / m_clients);
+        if (total > 0.0)
+            printf("World traffic total: %.1f KB/s sent, %.1f KB/s received\n", m_bytesSent / 1024.0 / total, m_bytesReceived / 1024.0 / total);
+        if (m_movementPackets)
+            printf("Movement of others per client: %.1f KB received in %.0f packets (%.0f bundled moves packets)\n",
+                m_movementBytes / 1024.0 / m_clients, double(m_movementPackets) / m_clients, double(m_movementBundles) / m_clients);
+    }
+
+    for (std::map<std::string, uint32>::const_iterator itr = m_failures.begin(); itr != m_failures.end(); ++itr)
+        printf("Failed at %s: %u\n", itr->first.c_str(), itr->second);
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LOADTEST_LOADSTATS_H
+#define LOADTEST_LOADSTATS_H
+
+#include "Common.h"
+
+#include <ace/OS_NS_time.h>
+
+#include <vector>
+
+enum LatencySeries
+{
+    LATENCY_LOGON,                                          // connect to realmd .. realm list received
+    LATENCY_WORLD_LOGIN,                                    // connect to realmd .. SMSG_LOGIN_VERIFY_WORLD
+    LATENCY_PING,                                           // CMSG_PING .. SMSG_PONG, network thread only
+    LATENCY_WORLD_TICK,                                     // CMSG_QUERY_TIME .. response, waits for World::UpdateSessions
+    LATENCY_SPELL,                                          // CMSG_CAST_SPELL .. SMSG_SPELL_GO or failure, waits for Map::Update
+    MAX_LATENCY_SERIES
+};
+
+/**
+ * Results of the sessions of a load test run.
+ *
+ * Everything runs in the reactor thread, so no locking is needed.
+ */
+class LoadStats
+{
+    public:
+        LoadStats();
+
+        void Start();
+
+        // latency in microseconds
+        void AddSample(LatencySeries series, uint32 latency);
+        void AddFailure(std::string const& reason);
+        void AddTraffic(uint64 sent, uint64 received, uint32 packets);
+        void AddMovementTraffic(uint64 received, uint32 packets, uint32 bundles);
+
+        uint32 GetCount(LatencySeries series) const { return m_samples[series].size(); }
+
+        // one line with rates since the previous call
+        void PrintProgress();
+        void PrintSummary() const;
+
+    private:
+        static double Seconds(ACE_hrtime_t time) { return double(time) / 1000000000.0; }
+
+        ACE_hrtime_t m_start;
+        ACE_hrtime_t m_lastReport;
+        uint32 m_failed;
+        uint32 m_lastCount[MAX_LATENCY_SERIES];
+
+        std::vector<uint32> m_samples[MAX_LATENCY_SERIES];
+        std::map<std::string, uint32> m_failures;           // count by reason
+
+        uint32 m_clients;                                   // closed world connections
+        uint64 m_bytesSent;
+        uint64 m_bytesReceived;
+        uint64 m_packetsReceived;
+        uint64 m_movementBytes;                             // movement of other players, part of the received traffic
+        uint64 m_movementPackets;
+        uint64 m_movementBundles;                           // SMSG_MULTIPLE_MOVES and SMSG_COMPRESSED_MOVES among them
+};
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/// \file
+/// Headless load generator for realmd and the world server
+
+#include "Common.h"
+#include "LoadDriver.h"
+
+#include <ace/Get_Opt.h>
+#include <ace/Reactor.h>
+#include <ace/Dev_Poll_Reactor.h>
+#include <ace/ACE.h>
+
+static void usage(char const* prog)
+{
+    printf("Usage: %s [-s logon|login|city|raid|crowd] [-h host] [-p port] [-w world host] [-W world port]\n"
+           "       [-n sessions] [-c concurrent] [-t seconds in world] [-a accounts]\n"
+           "       [-f first account number] [-P account prefix] [-b client build]\n", prog);
+}
+
+int main(int argc, char** argv)
+{
+    LoadOptions options;
+
+    ACE_Get_Opt cmd_opts(argc, argv, "s:h:p:w:W:n:c:t:a:f:P:b:");
+
+    int option;
+    while ((option = cmd_opts()) != EOF)
+    {
+        switch (option)
+        {
+            case 's':
+            {
+                int scenario = 0;
+                while (scenario < MAX_SCENARIO && strcmp(ScenarioNames[scenario], cmd_opts.opt_arg()) != 0)
+                    ++scenario;
+
+                if (scenario == MAX_SCENARIO)
+                {
+                    usage(argv[0]);
+                    return 1;
+                }
+
+                options.scenario = LoadScenario(scenario);
+                break;
+            }
+            case 'h': options.host = cmd_opts.opt_arg(); break;
+            case 'p': options.port = uint16(atoi(cmd_opts.opt_arg())); break;
+            case 'w': options.worldHost = cmd_opts.opt_arg(); break;
+            case 'W': options.worldPort = uint16(atoi(cmd_opts.opt_arg())); break;
+            case 'n': options.sessions = uint32(atoi(cmd_opts.opt_arg())); break;
+            case 'c': options.concurrent = uint32(atoi(cmd_opts.opt_arg())); break;
+            case 't': options.duration = uint32(atoi(cmd_opts.opt_arg())); break;
+            case 'a': options.accounts = uint32(atoi(cmd_opts.opt_arg())); break;
+            case 'f': options.firstAccount = uint32(atoi(cmd_opts.opt_arg())); break;
+            case 'P': options.prefix = cmd_opts.opt_arg(); break;
+            case 'b': options.build = uint16(atoi(cmd_opts.opt_arg())); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (!options.sessions || !options.concurrent)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+#if defined (ACE_HAS_EVENT_POLL) || defined (ACE_HAS_DEV_POLL)
+    // select() based reactor is limited to FD_SETSIZE sockets
+    ACE_Reactor::instance(new ACE_Reactor(new ACE_Dev_Poll_Reactor(ACE::max_handles(), 1), 1), true);
+#endif
+
+    LoadDriver driver(options);
+    if (!driver.Start())
+        return 1;
+
+    while (!driver.IsDone())
+    {
+        ACE_Time_Value interval(0, 100000);
+        if (ACE_Reactor::instance()->run_reactor_event_loop(interval) == -1)
+            break;
+    }
+
+    ACE_Reactor::instance()->cancel_timer(&driver);
+    driver.GetStats().PrintSummary();
+    return 0;
+}
@@ -0,0 +1,365 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "LoginSession.h"
+#include "LoadDriver.h"
+#include "Auth/Sha1.h"
+#include "AuthCodes.h"
+
+#include <ace/Reactor.h>
+
+// GCC have alternative #pragma pack(N) syntax and old gcc version not support pack(push,N), also any gcc version not support it at some paltform
+#if defined( __GNUC__ )
+#pragma pack(1)
+#else
+#pragma pack(push,1)
+#endif
+
+// same layouts as in realmd AuthSocket.cpp
+struct LogonChallenge_C
+{
+    uint8   cmd;
+    uint8   error;
+    uint16  size;
+    uint8   gamename[4];
+    uint8   version1;
+    uint8   version2;
+    uint8   version3;
+    uint16  build;
+    uint8   platform[4];
+    uint8   os[4];
+    uint8   country[4];
+    uint32  timezone_bias;
+    uint32  ip;
+    uint8   I_len;
+};
+
+struct LogonProof_C
+{
+    uint8   cmd;
+    uint8   A[32];
+    uint8   M1[20];
+    uint8   crc_hash[20];
+    uint8   number_of_keys;
+    uint8   securityFlags;
+};
+
+// GCC have alternative #pragma pack() syntax and old gcc version not support pack(pop), also any gcc version not support it at some paltform
+#if defined( __GNUC__ )
+#pragma pack()
+#else
+#pragma pack(pop)
+#endif
+
+// sizes of the server answer to a correct CMD_AUTH_LOGON_PROOF
+#define LOGON_PROOF_S_SIZE              32
+#define LOGON_PROOF_S_SIZE_BUILD_6005   26
+
+LoginSession::LoginSession() : m_driver(NULL), m_accountIndex(0), m_build(0), m_state(STATE_CONNECTING), m_startTime(0), m_inputSize(0)
+{
+    memset(m_M2, 0, sizeof(m_M2));
+}
+
+void LoginSession::Setup(LoadDriver* driver, uint32 accountIndex, std::string const& account, uint16 build)
+{
+    m_driver = driver;
+    m_accountIndex = accountIndex;
+    m_account = account;
+    m_build = build;
+    m_startTime = ACE_OS::gethrtime();
+    m_failure = "logon connect";
+}
+
+int LoginSession::open(void* arg)
+{
+    if (Base::open(arg) == -1)
+        return -1;
+
+    ///- Send the logon challenge
+    std::vector<uint8> buf(sizeof(LogonChallenge_C) + m_account.size());
+    LogonChallenge_C* ch = (LogonChallenge_C*)&buf[0];
+
+    ch->cmd = CMD_AUTH_LOGON_CHALLENGE;
+    ch->error = 3;
+    ch->size = uint16(buf.size() - 4);
+    memcpy(ch->gamename, "WoW", 4);
+    ch->version1 = 0;
+    ch->version2 = 0;
+    ch->version3 = 0;
+    ch->build = m_build;
+    memcpy(ch->platform, "68x", 4);
+    memcpy(ch->os, "niW", 4);
+    memcpy(ch->country, "SUne", 4);
+    ch->timezone_bias = 0;
+    ch->ip = 0x0100007F;
+    ch->I_len = uint8(m_account.size());
+    memcpy(&buf[sizeof(LogonChallenge_C)], m_account.c_str(), m_account.size());
+
+    m_state = STATE_CHALLENGE;
+    m_failure.clear();
+
+    return SendData(&buf[0], buf.size()) ? 0 : -1;
+}
+
+int LoginSession::handle_input(ACE_HANDLE)
+{
+    if (m_input.size() < m_inputSize + 4096)
+        m_input.resize(m_inputSize + 4096);
+
+    ssize_t n = peer().recv(&m_input[m_inputSize], m_input.size() - m_inputSize);
+    if (n <= 0)
+    {
+        if (n == -1 && errno == EWOULDBLOCK)
+            return 0;
+
+        return Fail("logon (connection closed)");
+    }
+
+    m_inputSize += n;
+
+    bool open;
+    switch (m_state)
+    {
+        case STATE_CHALLENGE:  open = HandleChallenge(); break;
+        case STATE_PROOF:      open = HandleProof();     break;
+        case STATE_REALMLIST:  open = HandleRealmList(); break;
+        default:               open = false;             break;
+    }
+
+    return open ? 0 : -1;
+}
+
+int LoginSession::handle_close(ACE_HANDLE h, ACE_Reactor_Mask mask)
+{
+    // also called by the connector for failed connects
+    if (LoadDriver* driver = m_driver)
+    {
+        m_driver = NULL;
+
+        if (m_state == STATE_DONE)
+        {
+            driver->GetStats().AddSample(LATENCY_LOGON, uint32((ACE_OS::gethrtime() - m_startTime) / 1000));
+
+            if (driver->GetOptions().scenario != SCENARIO_LOGON)
+            {
+                driver->OnLogonDone(m_accountIndex, m_account, m_K, m_startTime);
+                return Base::handle_close(h, mask);
+            }
+        }
+        else
+            driver->GetStats().AddFailure(m_failure.empty() ? "logon (unexpected data)" : m_failure);
+
+        driver->OnLoginFinished();
+        driver->OnSessionClosed();
+    }
+
+    return Base::handle_close(h, mask);
+}
+
+bool LoginSession::SendData(void const* data, size_t size)
+{
+    if (peer().send_n(data, size) != ssize_t(size))
+        return Fail("logon send");
+
+    return true;
+}
+
+bool LoginSession::Fail(char const* reason)
+{
+    if (m_failure.empty())
+        m_failure = reason;
+
+    return false;
+}
+
+bool LoginSession::HandleChallenge()
+{
+    if (m_inputSize < 3)
+        return true;
+
+    if (m_input[0] != CMD_AUTH_LOGON_CHALLENGE)
+        return Fail("logon challenge");
+
+    if (m_input[2] != WOW_SUCCESS)
+        return Fail("logon challenge (account refused)");
+
+    ///- B, g, N, s, unk3 and security flags
+    size_t pos = 3 + 32;
+    if (m_inputSize < pos + 1)
+        return true;
+    size_t gPos = pos + 1;
+    pos = gPos + m_input[pos];
+    if (m_inputSize < pos + 1)
+        return true;
+    size_t NPos = pos + 1;
+    pos = NPos + m_input[pos];
+    size_t sPos = pos;
+    pos += 32 + 16 + 1;
+    if (m_inputSize < pos)
+        return true;
+
+    BigNumber B, g, N, s;
+    B.SetBinary(&m_input[3], 32);
+    g.SetBinary(&m_input[gPos], NPos - 1 - gPos);
+    N.SetBinary(&m_input[NPos], sPos - NPos);
+    s.SetBinary(&m_input[sPos], 32);
+
+    m_inputSize = 0;
+
+    ///- Client side of SRP6
+    BigNumber a;
+    a.SetRand(19 * 8);
+    BigNumber A = g.ModExp(a, N);
+
+    std::string password = m_account;
+
+    Sha1Hash sha;
+    sha.UpdateData(m_account);
+    sha.UpdateData(":");
+    sha.UpdateData(password);
+    sha.Finalize();
+    uint8 passwordHash[SHA_DIGEST_LENGTH];
+    memcpy(passwordHash, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&s, NULL);
+    sha.UpdateData(passwordHash, SHA_DIGEST_LENGTH);
+    sha.Finalize();
+    BigNumber x;
+    x.SetBinary(sha.GetDigest(), sha.GetLength());
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&A, &B, NULL);
+    sha.Finalize();
+    BigNumber u;
+    u.SetBinary(sha.GetDigest(), 20);
+
+    // S = (B - 3 * g^x) ^ (a + u * x), kept non negative in the subtraction
+    BigNumber v = g.ModExp(x, N);
+    BigNumber kv = (v * 3) % N;
+    BigNumber base = ((B + N) - kv) % N;
+    BigNumber S = base.ModExp(a + u * x, N);
+
+    ///- Session key, interleaved hashes of S (same as the server)
+    uint8 t[32];
+    uint8 t1[16];
+    uint8 vK[40];
+    memcpy(t, S.AsByteArray(32), 32);
+    for (int i = 0; i < 16; ++i)
+        t1[i] = t[i * 2];
+    sha.Initialize();
+    sha.UpdateData(t1, 16);
+    sha.Finalize();
+    for (int i = 0; i < 20; ++i)
+        vK[i * 2] = sha.GetDigest()[i];
+    for (int i = 0; i < 16; ++i)
+        t1[i] = t[i * 2 + 1];
+    sha.Initialize();
+    sha.UpdateData(t1, 16);
+    sha.Finalize();
+    for (int i = 0; i < 20; ++i)
+        vK[i * 2 + 1] = sha.GetDigest()[i];
+    m_K.SetBinary(vK, 40);
+
+    ///- M1 = H(H(N) xor H(g), H(I), s, A, B, K)
+    uint8 hash[20];
+    sha.Initialize();
+    sha.UpdateBigNumbers(&N, NULL);
+    sha.Finalize();
+    memcpy(hash, sha.GetDigest(), 20);
+    sha.Initialize();
+    sha.UpdateBigNumbers(&g, NULL);
+    sha.Finalize();
+    for (int i = 0; i < 20; ++i)
+        hash[i] ^= sha.GetDigest()[i];
+    BigNumber t3;
+    t3.SetBinary(hash, 20);
+
+    sha.Initialize();
+    sha.UpdateData(m_account);
+    sha.Finalize();
+    uint8 t4[SHA_DIGEST_LENGTH];
+    memcpy(t4, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&t3, NULL);
+    sha.UpdateData(t4, SHA_DIGEST_LENGTH);
+    sha.UpdateBigNumbers(&s, &A, &B, &m_K, NULL);
+    sha.Finalize();
+
+    LogonProof_C proof;
+    memset(&proof, 0, sizeof(proof));
+    proof.cmd = CMD_AUTH_LOGON_PROOF;
+    memcpy(proof.A, A.AsByteArray(32), 32);
+    memcpy(proof.M1, sha.GetDigest(), 20);
+
+    ///- Expected server proof M2 = H(A, M1, K)
+    BigNumber M;
+    M.SetBinary(sha.GetDigest(), 20);
+    sha.Initialize();
+    sha.UpdateBigNumbers(&A, &M, &m_K, NULL);
+    sha.Finalize();
+    memcpy(m_M2, sha.GetDigest(), 20);
+
+    m_state = STATE_PROOF;
+    return SendData(&proof, sizeof(proof));
+}
+
+bool LoginSession::HandleProof()
+{
+    if (m_inputSize < 2)
+        return true;
+
+    // unknown client build is answered by failed challenge
+    if (m_input[0] != CMD_AUTH_LOGON_PROOF)
+        return Fail("logon proof (client build not accepted)");
+
+    if (m_input[1] != WOW_SUCCESS)
+        return Fail("logon proof (wrong password)");
+
+    size_t size = m_build > 6005 ? LOGON_PROOF_S_SIZE : LOGON_PROOF_S_SIZE_BUILD_6005;
+    if (m_inputSize < size)
+        return true;
+
+    if (memcmp(&m_input[2], m_M2, 20))
+        return Fail("logon proof (server proof mismatch)");
+
+    m_inputSize = 0;
+
+    ///- Request the realm list
+    uint8 request[5] = { CMD_REALM_LIST, 0, 0, 0, 0 };
+
+    m_state = STATE_REALMLIST;
+    return SendData(request, sizeof(request));
+}
+
+bool LoginSession::HandleRealmList()
+{
+    if (m_inputSize < 3)
+        return true;
+
+    if (m_input[0] != CMD_REALM_LIST)
+        return Fail("realm list");
+
+    size_t size = 3 + (m_input[1] | (m_input[2] << 8));
+    if (m_inputSize < size)
+        return true;
+
+    m_state = STATE_DONE;
+    return false;
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LOADTEST_LOGINSESSION_H
+#define LOADTEST_LOGINSESSION_H
+
+#include "Common.h"
+#include "Auth/BigNumber.h"
+
+#include <ace/Svc_Handler.h>
+#include <ace/SOCK_Stream.h>
+#include <ace/OS_NS_time.h>
+
+#include <vector>
+
+class LoadDriver;
+
+/**
+ * One client logon to realmd: SRP6 challenge and proof, then realm list request.
+ *
+ * The password of every account is its name. The session ends (and reports to
+ * the driver) when the realm list is received or at first error. In world
+ * scenarios the session key is handed to the driver for the world login.
+ */
+class LoginSession : public ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH>
+{
+        typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> Base;
+
+    public:
+        LoginSession();
+
+        void Setup(LoadDriver* driver, uint32 accountIndex, std::string const& account, uint16 build);
+
+        // connection established
+        int open(void* arg);
+
+        int handle_input(ACE_HANDLE = ACE_INVALID_HANDLE);
+        int handle_close(ACE_HANDLE = ACE_INVALID_HANDLE, ACE_Reactor_Mask = ACE_Event_Handler::ALL_EVENTS_MASK);
+
+    private:
+        enum State
+        {
+            STATE_CONNECTING,
+            STATE_CHALLENGE,
+            STATE_PROOF,
+            STATE_REALMLIST,
+            STATE_DONE
+        };
+
+        // return false if the session must be closed, else wait for more data
+        bool HandleChallenge();
+        bool HandleProof();
+        bool HandleRealmList();
+
+        bool SendData(void const* data, size_t size);
+        bool Fail(char const* reason);
+
+        LoadDriver* m_driver;
+        uint32 m_accountIndex;
+        std::string m_account;
+        uint16 m_build;
+        State m_state;
+        ACE_hrtime_t m_startTime;
+        std::string m_failure;
+
+        std::vector<uint8> m_input;
+        size_t m_inputSize;                                 // received bytes in m_input
+
+        BigNumber m_K;
+        uint8 m_M2[20];                                     // expected server proof
+};
+
+#endif
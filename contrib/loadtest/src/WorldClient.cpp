@@ -0,0 +1,583 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "WorldClient.h"
+#include "LoadDriver.h"
+#include "Auth/Sha1.h"
+
+#include <ace/Reactor.h>
+#include <ace/OS_NS_sys_time.h>
+
+#include <math.h>
+
+// world protocol values of the supported client build (game/Opcodes.h, game/SharedDefines.h)
+enum WorldOpcodes
+{
+    CMSG_CHAR_CREATE                = 0x036,
+    CMSG_CHAR_ENUM                  = 0x037,
+    SMSG_CHAR_CREATE                = 0x03A,
+    SMSG_CHAR_ENUM                  = 0x03B,
+    CMSG_PLAYER_LOGIN               = 0x03D,
+    CMSG_MESSAGECHAT                = 0x095,
+    MSG_MOVE_START_FORWARD          = 0x0B5,
+    MSG_MOVE_STOP                   = 0x0B7,
+    MSG_MOVE_HEARTBEAT              = 0x0EE,                // last of the relayed movement opcodes starting at MSG_MOVE_START_FORWARD
+    CMSG_CAST_SPELL                 = 0x12E,
+    SMSG_CAST_FAILED                = 0x130,
+    SMSG_SPELL_GO                   = 0x132,
+    CMSG_QUERY_TIME                 = 0x1CE,
+    SMSG_QUERY_TIME_RESPONSE        = 0x1CF,
+    CMSG_PING                       = 0x1DC,
+    SMSG_PONG                       = 0x1DD,
+    SMSG_AUTH_CHALLENGE             = 0x1EC,
+    CMSG_AUTH_SESSION               = 0x1ED,
+    SMSG_AUTH_RESPONSE              = 0x1EE,
+    SMSG_LOGIN_VERIFY_WORLD         = 0x236,
+    SMSG_COMPRESSED_MOVES           = 0x2FB,
+    SMSG_TIME_SYNC_REQ              = 0x390,
+    CMSG_TIME_SYNC_RESP             = 0x391,
+    SMSG_MULTIPLE_MOVES             = 0x51E
+};
+
+#define AUTH_OK                     0x0C
+#define AUTH_WAIT_QUEUE             0x1B
+#define CHAR_CREATE_SUCCESS         0x2F
+
+#define CHAT_MSG_SAY                0x01
+#define LANG_COMMON                 7
+#define MOVEFLAG_FORWARD            0x00000001
+
+// new characters are human mages, self cast Frost Armor is known at level 1
+#define CHARACTER_RACE              1
+#define CHARACTER_CLASS             8
+#define RAID_SPELL_ID               168
+
+#define ACTION_INTERVAL             500                     // ms between scripted actions
+#define RUN_SPEED                   7.0f
+#define MAX_HOME_DISTANCE           15.0f
+#define CROWD_RADIUS                50.0f                   // spread of home positions in the crowd scenario, covers all relay distance tiers
+
+WorldClient::WorldClient() : m_driver(NULL), m_accountIndex(0), m_logonStart(0), m_state(STATE_CONNECTING), m_loginFinished(false),
+    m_inputSize(0), m_headerDecrypted(0), m_bytesSent(0), m_bytesReceived(0), m_packetsReceived(0),
+    m_movementBytes(0), m_movementPackets(0), m_movementBundles(0),
+    m_guid(0), m_mapId(0), m_homeX(0.0f), m_homeY(0.0f), m_x(0.0f), m_y(0.0f), m_z(0.0f), m_o(0.0f),
+    m_moving(false), m_moveTicks(1), m_ticks(0), m_pingSent(0), m_pingSeq(0), m_queryTimeSent(0), m_castSent(0), m_castCount(0)
+{
+}
+
+void WorldClient::Setup(LoadDriver* driver, uint32 accountIndex, std::string const& account, BigNumber const& K, ACE_hrtime_t logonStart)
+{
+    m_driver = driver;
+    m_accountIndex = accountIndex;
+    m_account = account;
+    m_K = K;
+    m_logonStart = logonStart;
+    m_failure = "world connect";
+}
+
+int WorldClient::open(void* arg)
+{
+    if (Base::open(arg) == -1)
+        return -1;
+
+    // connected after end of the run
+    if (m_driver->IsStopping())
+        return Fail("world login (run stopped)") ? 0 : -1;
+
+    m_driver->RegisterClient(this);
+    m_state = STATE_AUTH_CHALLENGE;
+    m_failure.clear();
+    return 0;
+}
+
+void WorldClient::Stop()
+{
+    if (m_state != STATE_IN_WORLD)
+        Fail("world login (run stopped)");
+
+    reactor()->remove_handler(this, ACE_Event_Handler::ALL_EVENTS_MASK);
+}
+
+int WorldClient::handle_input(ACE_HANDLE)
+{
+    if (m_input.size() < m_inputSize + 16384)
+        m_input.resize(m_inputSize + 16384);
+
+    ssize_t n = peer().recv(&m_input[m_inputSize], m_input.size() - m_inputSize);
+    if (n <= 0)
+    {
+        if (n == -1 && errno == EWOULDBLOCK)
+            return 0;
+
+        return Fail("world (connection closed)") ? 0 : -1;
+    }
+
+    m_inputSize += n;
+    m_bytesReceived += n;
+
+    ///- Split received data to packets, headers are encrypted after authentication
+    size_t pos = 0;
+    bool open = true;
+    while (open && m_inputSize - pos >= 4)
+    {
+        uint8* header = &m_input[pos];
+
+        if (m_headerDecrypted < 4)
+        {
+            m_crypt.DecryptRecv(header + m_headerDecrypted, 4 - m_headerDecrypted);
+            m_headerDecrypted = 4;
+        }
+
+        // size of large packets takes 3 bytes
+        bool large = (header[0] & 0x80) != 0;
+        size_t headerSize = large ? 5 : 4;
+        if (m_inputSize - pos < headerSize)
+            break;
+
+        if (large && m_headerDecrypted < 5)
+        {
+            m_crypt.DecryptRecv(header + 4, 1);
+            m_headerDecrypted = 5;
+        }
+
+        size_t size = large ? (size_t(header[0] & 0x7F) << 16) | (header[1] << 8) | header[2] : (header[0] << 8) | header[1];
+        uint16 opcode = header[headerSize - 2] | (header[headerSize - 1] << 8);
+
+        if (size < 2)
+        {
+            open = Fail("world (bad packet header)");
+            break;
+        }
+
+        if (m_inputSize - pos < headerSize + size - 2)
+            break;
+
+        ClientPacket packet(opcode, header + headerSize, size - 2);
+        pos += headerSize + size - 2;
+        m_headerDecrypted = 0;
+        ++m_packetsReceived;
+
+        open = HandlePacket(packet);
+    }
+
+    if (pos)
+    {
+        memmove(&m_input[0], &m_input[pos], m_inputSize - pos);
+        m_inputSize -= pos;
+    }
+
+    return open ? 0 : -1;
+}
+
+int WorldClient::handle_close(ACE_HANDLE h, ACE_Reactor_Mask mask)
+{
+    // also called by the connector for failed connects
+    if (LoadDriver* driver = m_driver)
+    {
+        m_driver = NULL;
+
+        LoadStats& stats = driver->GetStats();
+
+        if (!m_failure.empty() || m_state != STATE_IN_WORLD)
+            stats.AddFailure(m_failure.empty() ? "world (unexpected data)" : m_failure);
+
+        if (m_state != STATE_CONNECTING)
+        {
+            stats.AddTraffic(m_bytesSent, m_bytesReceived, m_packetsReceived);
+            stats.AddMovementTraffic(m_movementBytes, m_movementPackets, m_movementBundles);
+        }
+
+        if (!m_loginFinished)
+            driver->OnLoginFinished();
+
+        driver->UnregisterClient(this);
+        driver->OnSessionClosed();
+    }
+
+    return Base::handle_close(h, mask);
+}
+
+bool WorldClient::HandlePacket(ClientPacket& packet)
+{
+    switch (packet.GetOpcode())
+    {
+        case SMSG_AUTH_CHALLENGE:
+            return m_state == STATE_AUTH_CHALLENGE ? HandleAuthChallenge(packet) : Fail("world (unexpected auth challenge)");
+        case SMSG_AUTH_RESPONSE:
+            return m_state == STATE_AUTH_RESPONSE ? HandleAuthResponse(packet) : true;
+        case SMSG_CHAR_ENUM:
+            return m_state == STATE_CHAR_ENUM ? HandleCharEnum(packet) : true;
+        case SMSG_CHAR_CREATE:
+            return m_state == STATE_CHAR_CREATE ? HandleCharCreate(packet) : true;
+        case SMSG_LOGIN_VERIFY_WORLD:
+            return m_state == STATE_LOGIN ? HandleLoginVerifyWorld(packet) : true;
+        case SMSG_TIME_SYNC_REQ:
+        {
+            ClientPacket answer(CMSG_TIME_SYNC_RESP, 8);
+            answer << packet.Read<uint32>();
+            answer << GetClientTime();
+            return SendPacket(answer);
+        }
+        case SMSG_PONG:
+            if (m_pingSent && packet.Read<uint32>() == m_pingSeq)
+            {
+                m_driver->GetStats().AddSample(LATENCY_PING, ElapsedUs(m_pingSent));
+                m_pingSent = 0;
+            }
+            return true;
+        case SMSG_QUERY_TIME_RESPONSE:
+            if (m_queryTimeSent)
+            {
+                m_driver->GetStats().AddSample(LATENCY_WORLD_TICK, ElapsedUs(m_queryTimeSent));
+                m_queryTimeSent = 0;
+            }
+            return true;
+        case SMSG_SPELL_GO:
+            return HandleSpellResult(packet, true);
+        case SMSG_CAST_FAILED:
+            return HandleSpellResult(packet, false);
+        case SMSG_COMPRESSED_MOVES:
+        case SMSG_MULTIPLE_MOVES:
+            ++m_movementBundles;
+            ++m_movementPackets;
+            m_movementBytes += 4 + packet.size();
+            return true;
+        default:
+            if (packet.GetOpcode() >= MSG_MOVE_START_FORWARD && packet.GetOpcode() <= MSG_MOVE_HEARTBEAT)
+            {
+                ++m_movementPackets;
+                m_movementBytes += 4 + packet.size();
+            }
+
+            // everything else (object updates, chat) only counts as traffic
+            return true;
+    }
+}
+
+bool WorldClient::HandleAuthChallenge(ClientPacket& packet)
+{
+    packet.ReadSkip(4);
+    uint32 serverSeed = packet.Read<uint32>();
+    if (packet.IsFailed())
+        return Fail("world auth challenge");
+
+    uint32 clientSeed = uint32(rand());
+    uint32 t = 0;
+
+    Sha1Hash sha;
+    sha.UpdateData(m_account);
+    sha.UpdateData((uint8*)&t, 4);
+    sha.UpdateData((uint8*)&clientSeed, 4);
+    sha.UpdateData((uint8*)&serverSeed, 4);
+    sha.UpdateBigNumbers(&m_K, NULL);
+    sha.Finalize();
+
+    ClientPacket auth(CMSG_AUTH_SESSION, 80);
+    auth << uint32(m_driver->GetOptions().build);
+    auth << uint32(0);
+    auth << m_account;
+    auth << uint32(0);
+    auth << clientSeed;
+    auth << uint32(0) << uint32(0) << uint32(0);
+    auth << uint64(0);
+    auth.AppendBytes(sha.GetDigest(), 20);
+    auth << uint32(0);                                      // no addon info
+
+    if (!SendPacket(auth))
+        return false;
+
+    // server encrypts everything after the auth session
+    m_crypt.Init(&m_K);
+    m_state = STATE_AUTH_RESPONSE;
+    return true;
+}
+
+bool WorldClient::HandleAuthResponse(ClientPacket& packet)
+{
+    uint8 code = packet.Read<uint8>();
+
+    // queued clients get another response when they can enter
+    if (code == AUTH_WAIT_QUEUE)
+        return true;
+
+    if (code != AUTH_OK)
+        return Fail("world auth session");
+
+    m_state = STATE_CHAR_ENUM;
+    return SendPacket(ClientPacket(CMSG_CHAR_ENUM, 0));
+}
+
+bool WorldClient::HandleCharEnum(ClientPacket& packet)
+{
+    uint8 count = packet.Read<uint8>();
+
+    if (!count)
+    {
+        ClientPacket create(CMSG_CHAR_CREATE, 24);
+        create << GetCharacterName();
+        create << uint8(CHARACTER_RACE) << uint8(CHARACTER_CLASS);
+        create << uint8(0) << uint8(0) << uint8(0);         // gender, skin, face
+        create << uint8(0) << uint8(0) << uint8(0);         // hair style, hair color, facial hair
+        create << uint8(0);                                 // outfit
+
+        m_state = STATE_CHAR_CREATE;
+        return SendPacket(create);
+    }
+
+    m_guid = packet.Read<uint64>();
+    if (packet.IsFailed())
+        return Fail("world char enum");
+
+    ClientPacket login(CMSG_PLAYER_LOGIN, 8);
+    login << m_guid;
+
+    m_state = STATE_LOGIN;
+    return SendPacket(login);
+}
+
+bool WorldClient::HandleCharCreate(ClientPacket& packet)
+{
+    if (packet.Read<uint8>() != CHAR_CREATE_SUCCESS)
+        return Fail("world char create");
+
+    m_state = STATE_CHAR_ENUM;
+    return SendPacket(ClientPacket(CMSG_CHAR_ENUM, 0));
+}
+
+bool WorldClient::HandleLoginVerifyWorld(ClientPacket& packet)
+{
+    m_mapId = packet.Read<uint32>();
+    m_x = m_homeX = packet.Read<float>();
+    m_y = m_homeY = packet.Read<float>();
+    m_z = packet.Read<float>();
+    m_o = packet.Read<float>();
+
+    // clients walk to their own spot first, the height of the start point is kept
+    if (m_driver->GetOptions().scenario == SCENARIO_CROWD)
+    {
+        float angle = (rand() % 628) / 100.0f;
+        float radius = CROWD_RADIUS * (rand() % 1000) / 1000.0f;
+        m_homeX += cos(angle) * radius;
+        m_homeY += sin(angle) * radius;
+    }
+
+    m_state = STATE_IN_WORLD;
+    m_loginFinished = true;
+
+    m_driver->GetStats().AddSample(LATENCY_WORLD_LOGIN, ElapsedUs(m_logonStart));
+    m_driver->OnLoginFinished();
+
+    if (m_driver->GetOptions().scenario == SCENARIO_LOGIN_STORM)
+        return false;
+
+    // spread actions of clients entering at same time
+    ACE_Time_Value interval(0, ACTION_INTERVAL * 1000);
+    ACE_Time_Value delay(0, (rand() % ACTION_INTERVAL) * 1000);
+    reactor()->schedule_timer(this, NULL, delay, interval);
+    return true;
+}
+
+bool WorldClient::HandleSpellResult(ClientPacket& packet, bool go)
+{
+    if (!m_castSent)
+        return true;
+
+    if (go)
+    {
+        packet.ReadPackGUID();                              // cast item or caster
+        if (packet.ReadPackGUID() != m_guid)
+            return true;
+    }
+
+    if (packet.Read<uint8>() != m_castCount)
+        return true;
+
+    m_driver->GetStats().AddSample(LATENCY_SPELL, ElapsedUs(m_castSent));
+    m_castSent = 0;
+    return true;
+}
+
+int WorldClient::handle_timeout(ACE_Time_Value const& /*current_time*/, void const* /*act*/)
+{
+    if (m_state == STATE_IN_WORLD && m_driver)
+        DoActions();
+
+    return 0;
+}
+
+void WorldClient::DoActions()
+{
+    ++m_ticks;
+    uint32 slot = m_ticks + m_accountIndex;
+
+    DoMovement();
+
+    // every 5 seconds
+    if (slot % 10 == 0)
+    {
+        ClientPacket ping(CMSG_PING, 8);
+        ping << ++m_pingSeq;
+        ping << uint32(0);
+        m_pingSent = ACE_OS::gethrtime();
+        SendPacket(ping);
+    }
+
+    // every 2 seconds
+    if (slot % 4 == 1 && !m_queryTimeSent)
+    {
+        m_queryTimeSent = ACE_OS::gethrtime();
+        SendPacket(ClientPacket(CMSG_QUERY_TIME, 0));
+    }
+
+    switch (m_driver->GetOptions().scenario)
+    {
+        case SCENARIO_CITY:
+            if (slot % 20 == 3)                             // every 10 seconds
+                SendChat();
+            break;
+        case SCENARIO_RAID:
+            if (slot % 4 == 3)                              // every 2 seconds, above global cooldown
+                SendCastSpell();
+            if (slot % 60 == 5)
+                SendChat();
+            break;
+        default:
+            break;
+    }
+}
+
+void WorldClient::DoMovement()
+{
+    if (--m_moveTicks)
+    {
+        if (!m_moving)
+            return;
+
+        float distance = RUN_SPEED * ACTION_INTERVAL / 1000.0f;
+        m_x += cos(m_o) * distance;
+        m_y += sin(m_o) * distance;
+        SendMovement(MSG_MOVE_HEARTBEAT);
+        return;
+    }
+
+    m_moveTicks = 2 + rand() % 4;
+
+    if (m_moving)
+    {
+        m_moving = false;
+        SendMovement(MSG_MOVE_STOP);
+        return;
+    }
+
+    // new direction, back to start position if too far
+    float dx = m_homeX - m_x;
+    float dy = m_homeY - m_y;
+    if (dx * dx + dy * dy > MAX_HOME_DISTANCE * MAX_HOME_DISTANCE)
+        m_o = atan2(dy, dx);
+    else
+        m_o = (rand() % 628) / 100.0f;
+
+    if (m_o < 0.0f)
+        m_o += 2 * M_PI_F;
+
+    m_moving = true;
+    SendMovement(MSG_MOVE_START_FORWARD);
+}
+
+void WorldClient::SendMovement(uint16 opcode)
+{
+    ClientPacket move(opcode, 40);
+    move.AppendPackGUID(m_guid);
+    move << uint32(m_moving ? MOVEFLAG_FORWARD : 0);
+    move << uint16(0);                                      // moveFlags2
+    move << GetClientTime();
+    move << m_x << m_y << m_z << m_o;
+    move << uint32(0);                                      // fall time
+    SendPacket(move);
+}
+
+void WorldClient::SendChat()
+{
+    ClientPacket chat(CMSG_MESSAGECHAT, 48);
+    chat << uint32(CHAT_MSG_SAY);
+    chat << uint32(LANG_COMMON);
+    chat << std::string("load test message from ") + GetCharacterName();
+    SendPacket(chat);
+}
+
+void WorldClient::SendCastSpell()
+{
+    // answer to the previous cast is lost, don't account it
+    ClientPacket cast(CMSG_CAST_SPELL, 10);
+    cast << ++m_castCount;
+    cast << uint32(RAID_SPELL_ID);
+    cast << uint8(0);                                       // cast flags
+    cast << uint32(0);                                      // target mask: self
+    m_castSent = ACE_OS::gethrtime();
+    SendPacket(cast);
+}
+
+bool WorldClient::SendPacket(ClientPacket const& packet)
+{
+    std::vector<uint8> buf(6 + packet.size());
+
+    // big endian size of opcode and payload, then 4 bytes opcode
+    uint16 size = uint16(packet.size() + 4);
+    buf[0] = uint8(size >> 8);
+    buf[1] = uint8(size);
+    buf[2] = uint8(packet.GetOpcode());
+    buf[3] = uint8(packet.GetOpcode() >> 8);
+    buf[4] = 0;
+    buf[5] = 0;
+    m_crypt.EncryptSend(&buf[0], 6);
+
+    if (packet.size())
+        memcpy(&buf[6], packet.contents(), packet.size());
+
+    if (peer().send_n(&buf[0], buf.size()) != ssize_t(buf.size()))
+        return Fail("world send");
+
+    m_bytesSent += buf.size();
+    return true;
+}
+
+bool WorldClient::Fail(char const* reason)
+{
+    if (m_failure.empty())
+        m_failure = reason;
+
+    return false;
+}
+
+uint32 WorldClient::GetClientTime() const
+{
+    return uint32(ACE_OS::gettimeofday().msec());
+}
+
+std::string WorldClient::GetCharacterName() const
+{
+    // letters only, no same letter thrice in a row: one syllable per decimal digit
+    static char const* syllables[10] = { "ka", "ri", "mo", "te", "lu", "sa", "ne", "vo", "di", "pe" };
+
+    std::string name = "Lo";
+    uint32 index = m_accountIndex;
+    for (int i = 0; i < 5; ++i, index /= 10)
+        name += syllables[index % 10];
+
+    return name;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LOADTEST_WORLDCLIENT_H
+#define LOADTEST_WORLDCLIENT_H
+
+#include "Common.h"
+#include "Auth/BigNumber.h"
+#include "ClientCrypt.h"
+#include "ClientPacket.h"
+
+#include <ace/Svc_Handler.h>
+#include <ace/SOCK_Stream.h>
+#include <ace/OS_NS_time.h>
+
+#include <vector>
+
+class LoadDriver;
+
+/**
+ * Scripted world server client.
+ *
+ * Authenticates with the session key of the realmd logon, creates a character
+ * at first use of the account, enters the world and, depending on the scenario,
+ * leaves at once or walks around, chats and casts spells until stopped.
+ */
+class WorldClient : public ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH>
+{
+        typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> Base;
+
+    public:
+        WorldClient();
+
+        void Setup(LoadDriver* driver, uint32 accountIndex, std::string const& account, BigNumber const& K, ACE_hrtime_t logonStart);
+
+        // end of the run, closes the connection
+        void Stop();
+
+        // connection established
+        int open(void* arg);
+
+        int handle_input(ACE_HANDLE = ACE_INVALID_HANDLE);
+        int handle_timeout(ACE_Time_Value const& current_time, void const* act = 0);
+        int handle_close(ACE_HANDLE = ACE_INVALID_HANDLE, ACE_Reactor_Mask = ACE_Event_Handler::ALL_EVENTS_MASK);
+
+    private:
+        enum State
+        {
+            STATE_CONNECTING,
+            STATE_AUTH_CHALLENGE,
+            STATE_AUTH_RESPONSE,
+            STATE_CHAR_ENUM,
+            STATE_CHAR_CREATE,
+            STATE_LOGIN,
+            STATE_IN_WORLD
+        };
+
+        // return false if the connection must be closed
+        bool HandlePacket(ClientPacket& packet);
+        bool HandleAuthChallenge(ClientPacket& packet);
+        bool HandleAuthResponse(ClientPacket& packet);
+        bool HandleCharEnum(ClientPacket& packet);
+        bool HandleCharCreate(ClientPacket& packet);
+        bool HandleLoginVerifyWorld(ClientPacket& packet);
+        bool HandleSpellResult(ClientPacket& packet, bool go);
+
+        // scripted actions, called every ACTION_INTERVAL in world
+        void DoActions();
+        void DoMovement();
+        void SendMovement(uint16 opcode);
+        void SendChat();
+        void SendCastSpell();
+
+        bool SendPacket(ClientPacket const& packet);
+        bool Fail(char const* reason);
+
+        uint32 GetClientTime() const;
+        uint32 ElapsedUs(ACE_hrtime_t since) const { return uint32((ACE_OS::gethrtime() - since) / 1000); }
+        std::string GetCharacterName() const;
+
+        LoadDriver* m_driver;
+        uint32 m_accountIndex;
+        std::string m_account;
+        BigNumber m_K;
+        ACE_hrtime_t m_logonStart;
+        State m_state;
+        bool m_loginFinished;                               // driver knows the login is over
+        std::string m_failure;
+
+        ClientCrypt m_crypt;
+        std::vector<uint8> m_input;
+        size_t m_inputSize;                                 // received bytes in m_input
+        size_t m_headerDecrypted;                           // bytes of the next header already decrypted
+
+        uint64 m_bytesSent;
+        uint64 m_bytesReceived;
+        uint32 m_packetsReceived;
+        uint64 m_movementBytes;
+        uint32 m_movementPackets;
+        uint32 m_movementBundles;
+
+        // character state
+        uint64 m_guid;
+        uint32 m_mapId;
+        float m_homeX, m_homeY;
+        float m_x, m_y, m_z, m_o;
+        bool m_moving;
+        uint32 m_moveTicks;                                 // ticks left in current move or pause
+        uint32 m_ticks;
+
+        // pending requests for latency
+        ACE_hrtime_t m_pingSent;
+        uint32 m_pingSeq;
+        ACE_hrtime_t m_queryTimeSent;
+        ACE_hrtime_t m_castSent;
+        uint8 m_castCount;
+};
+
+#endif
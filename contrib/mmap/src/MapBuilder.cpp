@@ -25,13 +25,84 @@
 #include "DetourNavMeshBuilder.h"
 #include "DetourCommon.h"
 
+#include <ace/Guard_T.h>
+#include <ace/Thread_Manager.h>
+#include <ace/OS_NS_sys_time.h>
+
 using namespace VMAP;
 
 namespace MMAP
 {
+    typedef ACE_Guard<ACE_Thread_Mutex> Guard;
+
+    struct TileTask
+    {
+        TileTask(uint32 _tileX, uint32 _tileY, uint64 _hash) : tileX(_tileX), tileY(_tileY), hash(_hash) {}
+
+        uint32 tileX;
+        uint32 tileY;
+        uint64 hash;                                        // 0 if not calculated yet
+    };
+
+    // state of one map build, shared by the worker threads
+    struct MapBuildJob
+    {
+        MapBuildJob(MapBuilder* _builder, uint32 _mapID) :
+            builder(_builder), mapID(_mapID), navMesh(NULL), next(0), built(0), empty(0), hashFile(NULL) {}
+
+        MapBuilder* builder;
+        uint32 mapID;
+        dtNavMesh* navMesh;
+        vector<TileTask> tasks;
+
+        ACE_Thread_Mutex lock;                              // guards all below
+        size_t next;
+        uint32 built;
+        uint32 empty;
+        FILE* hashFile;
+    };
+
+    // FNV-1a, good enough to detect changed input files
+    static const uint64 HASH_OFFSET_BASIS = (uint64(0xcbf29ce4) << 32) | 0x84222325;
+    static const uint64 HASH_PRIME        = (uint64(0x00000100) << 32) | 0x000001b3;
+
+    static void hashBytes(uint64& hash, void const* data, size_t size)
+    {
+        unsigned char const* bytes = (unsigned char const*)data;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= HASH_PRIME;
+        }
+    }
+
+    static void hashFile(uint64& hash, char const* fileName)
+    {
+        FILE* file = fopen(fileName, "rb");
+
+        // missing file is an input state too
+        uint8 exists = file ? 1 : 0;
+        hashBytes(hash, &exists, sizeof(exists));
+        if (!file)
+            return;
+
+        char buffer[64 * 1024];
+        size_t count;
+        while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+            hashBytes(hash, buffer, count);
+
+        fclose(file);
+    }
+
+    static uint32 elapsedMs(ACE_Time_Value const& since)
+    {
+        return uint32((ACE_OS::gettimeofday() - since).msec());
+    }
+
     MapBuilder::MapBuilder(float maxWalkableAngle, bool skipLiquid,
                            bool skipContinents, bool skipJunkMaps, bool skipBattlegrounds,
-                           bool debugOutput, bool bigBaseUnit, const char* offMeshFilePath) :
+                           bool debugOutput, bool bigBaseUnit, const char* offMeshFilePath,
+                           int threads, bool incremental) :
                            m_terrainBuilder(NULL),
                            m_debugOutput        (debugOutput),
                            m_skipContinents     (skipContinents),
@@ -40,7 +111,9 @@ namespace MMAP
                            m_maxWalkableAngle   (maxWalkableAngle),
                            m_bigBaseUnit        (bigBaseUnit),
                            m_rcContext          (NULL),
-                           m_offMeshFilePath    (offMeshFilePath)
+                           m_offMeshFilePath    (offMeshFilePath),
+                           m_threads            (threads > 0 ? threads : 1),
+                           m_incremental        (incremental)
     {
         m_terrainBuilder = new TerrainBuilder(skipLiquid);
 
@@ -142,12 +215,16 @@ namespace MMAP
     /**************************************************************************/
     void MapBuilder::buildAllMaps()
     {
+        ACE_Time_Value startTime = ACE_OS::gettimeofday();
+
         for (TileList::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it)
         {
             uint32 mapID = (*it).first;
             if (!shouldSkipMap(mapID))
                 buildMap(mapID);
         }
+
+        printf("All maps done in %.1f s.\n", elapsedMs(startTime) / 1000.0f);
     }
 
     /**************************************************************************/
@@ -210,6 +287,8 @@ namespace MMAP
     {
         printf("Building map %03u:\n", mapID);
 
+        ACE_Time_Value startTime = ACE_OS::gettimeofday();
+
         set<uint32>* tiles = getTileList(mapID);
 
         // make sure we process maps which don't have tiles
@@ -237,8 +316,15 @@ namespace MMAP
             return;
         }
 
-        // now start building mmtiles for each tile
-        printf("We have %u tiles.                          \n", (unsigned int)tiles->size());
+        TileHashMap hashes;
+        loadTileHashes(mapID, hashes);
+
+        MapBuildJob job(this, mapID);
+        job.navMesh = navMesh;
+
+        // select tiles to build: missing or broken output resumes an interrupted run,
+        // in incremental mode also tiles with changed input data
+        uint32 skipped = 0;
         for (set<uint32>::iterator it = tiles->begin(); it != tiles->end(); ++it)
         {
             uint32 tileX, tileY;
@@ -246,19 +332,209 @@ namespace MMAP
             // unpack tile coords
             StaticMapTree::unpackTileID((*it), tileX, tileY);
 
-            if (shouldSkipTile(mapID, tileX, tileY))
+            uint64 hash = 0;
+            if (m_incremental)
+            {
+                hash = getTileInputHash(mapID, tileX, tileY, navMesh);
+
+                TileHashMap::const_iterator stored = hashes.find(StaticMapTree::packTileID(tileX, tileY));
+                if (stored != hashes.end() && stored->second.hash == hash &&
+                        (!stored->second.built || shouldSkipTile(mapID, tileX, tileY)))
+                {
+                    ++skipped;
+                    continue;
+                }
+            }
+            else if (shouldSkipTile(mapID, tileX, tileY))
+            {
+                ++skipped;
                 continue;
+            }
+
+            job.tasks.push_back(TileTask(tileX, tileY, hash));
+        }
+
+        // now start building mmtiles for each tile
+        printf("We have %u tiles, %u up to date, %u to build.\n", (unsigned int)tiles->size(), skipped, (unsigned int)job.tasks.size());
+
+        if (!job.tasks.empty())
+        {
+            job.hashFile = openTileHashes(mapID, hashes);
+
+            int threads = m_threads < int(job.tasks.size()) ? m_threads : int(job.tasks.size());
+            int group = -1;
+            if (threads > 1)
+            {
+                group = ACE_Thread_Manager::instance()->spawn_n(threads, (ACE_THR_FUNC)&MapBuilder::tileWorker, &job);
+                if (group == -1)
+                    printf("Failed to start %d worker threads, building in one thread.\n", threads);
+            }
+
+            if (group != -1)
+                ACE_Thread_Manager::instance()->wait_grp(group);
+            else
+                processTiles(job);
 
-            buildTile(mapID, tileX, tileY, navMesh);
+            if (job.hashFile)
+                fclose(job.hashFile);
         }
 
         dtFreeNavMesh(navMesh);
 
-        printf("Complete!                               \n\n");
+        uint32 buildTime = elapsedMs(startTime);
+        uint32 processed = job.built + job.empty;
+        printf("Map %03u complete: %u tiles built, %u without navmesh data, %u skipped in %.1f s (%u ms per tile, %d threads)\n\n",
+               mapID, job.built, job.empty, skipped, buildTime / 1000.0f, processed ? buildTime / processed : 0, m_threads);
+    }
+
+    /**************************************************************************/
+    ACE_THR_FUNC_RETURN MapBuilder::tileWorker(void* arg)
+    {
+        MapBuildJob* job = (MapBuildJob*)arg;
+        job->builder->processTiles(*job);
+        return 0;
+    }
+
+    /**************************************************************************/
+    void MapBuilder::processTiles(MapBuildJob& job)
+    {
+        for (;;)
+        {
+            TileTask* task;
+            {
+                Guard guard(job.lock);
+                if (job.next >= job.tasks.size())
+                    return;
+
+                task = &job.tasks[job.next++];
+            }
+
+            bool built = buildTile(job.mapID, task->tileX, task->tileY, job.navMesh);
+
+            // hash is taken after the build, the same data is in the page cache now
+            if (!task->hash)
+                task->hash = getTileInputHash(job.mapID, task->tileX, task->tileY, job.navMesh);
+
+            Guard guard(job.lock);
+            if (built)
+                ++job.built;
+            else
+                ++job.empty;
+
+            // tile is done, record it so an interrupted run can be resumed
+            if (job.hashFile)
+            {
+                fprintf(job.hashFile, "%u %u %08x%08x %u\n", task->tileX, task->tileY,
+                        uint32(task->hash >> 32), uint32(task->hash), built ? 1 : 0);
+                fflush(job.hashFile);
+            }
+
+            uint32 done = job.built + job.empty;
+            printf("[Map %03u] %u/%u tiles (%.1f%%)                \n", job.mapID, done, (unsigned int)job.tasks.size(),
+                   done * 100.0f / job.tasks.size());
+        }
+    }
+
+    /**************************************************************************/
+    uint64 MapBuilder::getTileInputHash(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh)
+    {
+        uint64 hash = HASH_OFFSET_BASIS;
+
+        // build settings and navmesh params (tile coords are relative to the navmesh origin)
+        uint32 version = MMAP_VERSION;
+        bool usesLiquids = m_terrainBuilder->usesLiquids();
+        hashBytes(hash, &version, sizeof(version));
+        hashBytes(hash, &m_maxWalkableAngle, sizeof(m_maxWalkableAngle));
+        hashBytes(hash, &m_bigBaseUnit, sizeof(m_bigBaseUnit));
+        hashBytes(hash, &usesLiquids, sizeof(usesLiquids));
+        hashBytes(hash, navMesh->getParams(), sizeof(dtNavMeshParams));
+
+        // heightmap of the tile and its borders, see TerrainBuilder::loadMap
+        char fileName[64];
+        int const neighbours[5][2] = { {0, 0}, {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+        for (int i = 0; i < 5; ++i)
+        {
+            sprintf(fileName, "maps/%03u%02u%02u.map", mapID, tileY + neighbours[i][1], tileX + neighbours[i][0]);
+            hashFile(hash, fileName);
+        }
+
+        // model data, see TerrainBuilder::loadVMap
+        sprintf(fileName, "vmaps/%03u.vmtree", mapID);
+        hashFile(hash, fileName);
+        hashFile(hash, ("vmaps/" + StaticMapTree::getTileFileName(mapID, tileY, tileX)).c_str());
+
+        // offmesh connections of the tile, see TerrainBuilder::loadOffMeshConnections
+        if (m_offMeshFilePath)
+        {
+            if (FILE* fp = fopen(m_offMeshFilePath, "rb"))
+            {
+                char buf[512];
+                while (fgets(buf, sizeof(buf), fp))
+                {
+                    int mid, tx, ty;
+                    if (3 == sscanf(buf, "%d %d,%d", &mid, &tx, &ty) && uint32(mid) == mapID && uint32(tx) == tileX && uint32(ty) == tileY)
+                        hashBytes(hash, buf, strlen(buf));
+                }
+                fclose(fp);
+            }
+        }
+
+        // 0 is reserved for "not calculated"
+        return hash ? hash : 1;
     }
 
     /**************************************************************************/
-    void MapBuilder::buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh)
+    void MapBuilder::loadTileHashes(uint32 mapID, TileHashMap& hashes)
+    {
+        char fileName[32];
+        sprintf(fileName, "mmaps/%03u.mmhash", mapID);
+
+        FILE* file = fopen(fileName, "rb");
+        if (!file)
+            return;
+
+        // later records of a tile override earlier ones
+        char buf[128];
+        while (fgets(buf, sizeof(buf), file))
+        {
+            uint32 tileX, tileY, hashHi, hashLo, built;
+            if (5 == sscanf(buf, "%u %u %8x%8x %u", &tileX, &tileY, &hashHi, &hashLo, &built))
+                hashes[StaticMapTree::packTileID(tileX, tileY)] = TileHash((uint64(hashHi) << 32) | hashLo, built != 0);
+        }
+
+        fclose(file);
+    }
+
+    /**************************************************************************/
+    FILE* MapBuilder::openTileHashes(uint32 mapID, TileHashMap const& hashes)
+    {
+        char fileName[32];
+        sprintf(fileName, "mmaps/%03u.mmhash", mapID);
+
+        // rewrite compacted, new records are appended while tiles are built
+        FILE* file = fopen(fileName, "wb");
+        if (!file)
+        {
+            char message[1024];
+            sprintf(message, "Failed to open %s for writing!\n", fileName);
+            perror(message);
+            return NULL;
+        }
+
+        for (TileHashMap::const_iterator itr = hashes.begin(); itr != hashes.end(); ++itr)
+        {
+            uint32 tileX, tileY;
+            StaticMapTree::unpackTileID(itr->first, tileX, tileY);
+            fprintf(file, "%u %u %08x%08x %u\n", tileX, tileY,
+                    uint32(itr->second.hash >> 32), uint32(itr->second.hash), itr->second.built ? 1 : 0);
+        }
+
+        fflush(file);
+        return file;
+    }
+
+    /**************************************************************************/
+    bool MapBuilder::buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh)
     {
         printf("Building map %03u, tile [%02u,%02u]\n", mapID, tileX, tileY);
 
@@ -272,7 +548,7 @@ namespace MMAP
 
         // if there is no data, give up now
         if (!meshData.solidVerts.size() && !meshData.liquidVerts.size())
-            return;
+            return false;
 
         // remove unused vertices
         TerrainBuilder::cleanVertices(meshData.solidVerts, meshData.solidTris);
@@ -284,7 +560,7 @@ namespace MMAP
         allVerts.append(meshData.solidVerts);
 
         if (!allVerts.size())
-            return;
+            return false;
 
         // get bounds of current tile
         float bmin[3], bmax[3];
@@ -293,7 +569,7 @@ namespace MMAP
         m_terrainBuilder->loadOffMeshConnections(mapID, tileX, tileY, meshData, m_offMeshFilePath);
 
         // build navmesh tile
-        buildMoveMapTile(mapID, tileX, tileY, meshData, bmin, bmax, navMesh);
+        return buildMoveMapTile(mapID, tileX, tileY, meshData, bmin, bmax, navMesh);
     }
 
     /**************************************************************************/
@@ -373,7 +649,7 @@ namespace MMAP
     }
 
     /**************************************************************************/
-    void MapBuilder::buildMoveMapTile(uint32 mapID, uint32 tileX, uint32 tileY,
+    bool MapBuilder::buildMoveMapTile(uint32 mapID, uint32 tileX, uint32 tileY,
                                       MeshData &meshData, float bmin[3], float bmax[3],
                                       dtNavMesh* navMesh)
     {
@@ -398,12 +674,13 @@ namespace MMAP
         // these are WORLD UNIT based metrics
         // this are basic unit dimentions
         // value have to divide GRID_SIZE(533.33333f) ( aka: 0.5333, 0.2666, 0.3333, 0.1333, etc )
-        const static float BASE_UNIT_DIM = m_bigBaseUnit ? 0.533333f : 0.266666f;
+        // (not static, tiles are built by several threads)
+        const float BASE_UNIT_DIM = m_bigBaseUnit ? 0.533333f : 0.266666f;
 
         // All are in UNIT metrics!
-        const static int VERTEX_PER_MAP = int(GRID_SIZE/BASE_UNIT_DIM + 0.5f);
-        const static int VERTEX_PER_TILE = m_bigBaseUnit ? 40 : 80; // must divide VERTEX_PER_MAP
-        const static int TILES_PER_MAP = VERTEX_PER_MAP/VERTEX_PER_TILE;
+        const int VERTEX_PER_MAP = int(GRID_SIZE/BASE_UNIT_DIM + 0.5f);
+        const int VERTEX_PER_TILE = m_bigBaseUnit ? 40 : 80; // must divide VERTEX_PER_MAP
+        const int TILES_PER_MAP = VERTEX_PER_MAP/VERTEX_PER_TILE;
 
         rcConfig config;
         memset(&config, 0, sizeof(rcConfig));
@@ -545,14 +822,14 @@ namespace MMAP
         if (!pmmerge)
         {
             printf("%s alloc pmmerge FIALED!          \r", tileString);
-            return;
+            return false;
         }
 
         rcPolyMeshDetail** dmmerge = new rcPolyMeshDetail*[TILES_PER_MAP * TILES_PER_MAP];
         if (!dmmerge)
         {
             printf("%s alloc dmmerge FIALED!          \r", tileString);
-            return;
+            return false;
         }
 
         int nmerge = 0;
@@ -574,7 +851,7 @@ namespace MMAP
         if (!iv.polyMesh)
         {
             printf("%s alloc iv.polyMesh FIALED!          \r", tileString);
-            return;
+            return false;
         }
         rcMergePolyMeshes(m_rcContext, pmmerge, nmerge, *iv.polyMesh);
 
@@ -582,7 +859,7 @@ namespace MMAP
         if (!iv.polyMeshDetail)
         {
             printf("%s alloc m_dmesh FIALED!          \r", tileString);
-            return;
+            return false;
         }
         rcMergePolyMeshDetails(m_rcContext, dmmerge, nmerge, *iv.polyMeshDetail);
 
@@ -643,6 +920,7 @@ namespace MMAP
         // will hold final navmesh
         unsigned char* navData = NULL;
         int navDataSize = 0;
+        bool written = false;
 
         do
         {
@@ -689,27 +967,35 @@ namespace MMAP
                 continue;
             }
 
-            dtTileRef tileRef = 0;
             printf("%s Adding tile to navmesh...                \r", tileString);
-            // DT_TILE_FREE_DATA tells detour to unallocate memory when the tile
-            // is removed via removeTile()
-            dtStatus dtResult = navMesh->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, &tileRef);
-            if (!tileRef || dtResult != DT_SUCCESS)
             {
-                printf("%s Failed adding tile to navmesh!           \n", tileString);
-                continue;
+                // validate the tile data, the navmesh is shared by all worker threads
+                // data stays owned by us, so it is still valid for file output after removeTile
+                Guard guard(m_navMeshLock);
+
+                dtTileRef tileRef = 0;
+                dtStatus dtResult = navMesh->addTile(navData, navDataSize, 0, 0, &tileRef);
+                if (!tileRef || dtResult != DT_SUCCESS)
+                {
+                    printf("%s Failed adding tile to navmesh!           \n", tileString);
+                    continue;
+                }
+
+                navMesh->removeTile(tileRef, NULL, NULL);
             }
 
-            // file output
+            // file output, written under temporary name and renamed when complete,
+            // so an interrupted run never leaves a truncated tile behind
             char fileName[255];
+            char tmpFileName[255];
             sprintf(fileName, "mmaps/%03u%02i%02i.mmtile", mapID, tileY, tileX);
-            FILE* file = fopen(fileName, "wb");
+            sprintf(tmpFileName, "%s.tmp", fileName);
+            FILE* file = fopen(tmpFileName, "wb");
             if (!file)
             {
                 char message[1024];
-                sprintf(message, "Failed to open %s for writing!\n", fileName);
+                sprintf(message, "Failed to open %s for writing!\n", tmpFileName);
                 perror(message);
-                navMesh->removeTile(tileRef, NULL, NULL);
                 continue;
             }
 
@@ -719,17 +1005,28 @@ namespace MMAP
             MmapTileHeader header;
             header.usesLiquids = m_terrainBuilder->usesLiquids();
             header.size = uint32(navDataSize);
-            fwrite(&header, sizeof(MmapTileHeader), 1, file);
+            bool success = fwrite(&header, sizeof(MmapTileHeader), 1, file) == 1;
 
             // write data
-            fwrite(navData, sizeof(unsigned char), navDataSize, file);
-            fclose(file);
+            success = success && fwrite(navData, sizeof(unsigned char), navDataSize, file) == size_t(navDataSize);
+            success = (fclose(file) == 0) && success;
+
+            remove(fileName);
+            if (!success || rename(tmpFileName, fileName) != 0)
+            {
+                char message[1024];
+                sprintf(message, "Failed to write %s!\n", fileName);
+                perror(message);
+                remove(tmpFileName);
+                continue;
+            }
 
-            // now that tile is written to disk, we can unload it
-            navMesh->removeTile(tileRef, NULL, NULL);
+            written = true;
         }
         while (0);
 
+        dtFree(navData);
+
         if (m_debugOutput)
         {
             // restore padding so that the debug visualization is correct
@@ -743,6 +1040,8 @@ namespace MMAP
             iv.generateObjFile(mapID, tileX, tileY, meshData);
             iv.writeIV(mapID, tileX, tileY);
         }
+
+        return written;
     }
 
     /**************************************************************************/
@@ -867,9 +1166,19 @@ namespace MMAP
             return false;
 
         MmapTileHeader header;
-        fread(&header, sizeof(MmapTileHeader), 1, file);
+        bool complete = fread(&header, sizeof(MmapTileHeader), 1, file) == 1;
+
+        // tile from an interrupted run (written by older versions in place)
+        if (complete)
+        {
+            fseek(file, 0, SEEK_END);
+            complete = ftell(file) == long(sizeof(MmapTileHeader) + header.size);
+        }
         fclose(file);
 
+        if (!complete)
+            return false;
+
         if (header.mmapMagic != MMAP_MAGIC || header.dtVersion != DT_NAVMESH_VERSION)
             return false;
 
@@ -32,6 +32,8 @@
 #include "Recast.h"
 #include "DetourNavMesh.h"
 
+#include <ace/Thread_Mutex.h>
+
 using namespace std;
 using namespace VMAP;
 // G3D namespace typedefs conflicts with ACE typedefs
@@ -39,6 +41,19 @@ using namespace VMAP;
 namespace MMAP
 {
     typedef map<uint32,set<uint32>*> TileList;
+
+    // input data hash of a built tile, used by incremental builds
+    struct TileHash
+    {
+        TileHash() : hash(0), built(false) {}
+        TileHash(uint64 _hash, bool _built) : hash(_hash), built(_built) {}
+
+        uint64 hash;
+        bool built;                                         // false if the tile produced no navmesh data
+    };
+    typedef map<uint32,TileHash> TileHashMap;
+
+    struct MapBuildJob;
     struct Tile
     {
         Tile() : chf(NULL), solid(NULL), cset(NULL), pmesh(NULL), dmesh(NULL) {}
@@ -67,7 +82,9 @@ namespace MMAP
                        bool skipBattlegrounds   = false,
                        bool debugOutput         = false,
                        bool bigBaseUnit         = false,
-                       const char* offMeshFilePath = NULL);
+                       const char* offMeshFilePath = NULL,
+                       int threads              = 1,
+                       bool incremental         = false);
 
             ~MapBuilder();
 
@@ -87,10 +104,20 @@ namespace MMAP
 
             void buildNavMesh(uint32 mapID, dtNavMesh* &navMesh);
 
-            void buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh);
+            // returns true if the tile file was written
+            bool buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh);
+
+            // tile queue processing, run by every worker thread of a map build
+            void processTiles(MapBuildJob& job);
+            static ACE_THR_FUNC_RETURN tileWorker(void* arg);
+
+            // incremental build support
+            uint64 getTileInputHash(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh);
+            void loadTileHashes(uint32 mapID, TileHashMap& hashes);
+            FILE* openTileHashes(uint32 mapID, TileHashMap const& hashes);
 
             // move map building
-            void buildMoveMapTile(uint32 mapID,
+            bool buildMoveMapTile(uint32 mapID,
                                   uint32 tileX,
                                   uint32 tileY,
                                   MeshData &meshData,
@@ -120,6 +147,12 @@ namespace MMAP
             float m_maxWalkableAngle;
             bool m_bigBaseUnit;
 
+            int m_threads;
+            bool m_incremental;
+
+            // detour navmesh is not thread safe, tiles are added only for validation
+            ACE_Thread_Mutex m_navMeshLock;
+
             // build performance - not really used for now
             rcContext* m_rcContext;
     };
@@ -830,7 +830,7 @@ namespace MMAP
                                     &p0[0], &p0[1], &p0[2], &p1[0], &p1[1], &p1[2], &size))
                 continue;
 
-            if(mapID == mid, tileX == tx, tileY == ty)
+            if (mapID == uint32(mid) && tileX == uint32(tx) && tileY == uint32(ty))
             {
                 meshData.offMeshConnections.append(p0[1]);
                 meshData.offMeshConnections.append(p0[2]);
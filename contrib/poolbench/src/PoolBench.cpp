@@ -0,0 +1,365 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/// \file
+/// Compares the packet and SQL operation pool with the global allocator
+
+#include "Common.h"
+#include "MemoryPool.h"
+
+#include <ace/Get_Opt.h>
+#include <ace/Guard_T.h>
+#include <ace/OS_NS_time.h>
+#include <ace/Thread_Manager.h>
+#include <ace/Thread_Mutex.h>
+
+#include <deque>
+
+typedef ACE_Guard<ACE_Thread_Mutex> BenchGuard;
+
+enum BenchAllocator
+{
+    BENCH_GLOBAL,                                           // std::vector and new[], so malloc, TBB or FastMM as linked
+    BENCH_POOL,                                             // MemoryPool, as used by ByteBuffer and SqlOperation
+    MAX_BENCH_ALLOCATOR
+};
+
+static char const* AllocatorNames[MAX_BENCH_ALLOCATOR] = { "global", "pool" };
+
+// blocks of one thread kept alive before freeing, like packets waiting in a session queue
+#define BENCH_WINDOW    64
+
+struct BenchOptions
+{
+    BenchOptions() : threads(4), operations(1000000) {}
+
+    uint32 threads;
+    uint32 operations;                                      // per thread
+};
+
+// xorshift, rand() takes a lock in some C libraries
+class BenchRandom
+{
+    public:
+        explicit BenchRandom(uint32 seed) : m_state(seed * 2654435761u + 1) {}
+
+        uint32 Next()
+        {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 17;
+            m_state ^= m_state << 5;
+            return m_state;
+        }
+
+        // packet sizes: mostly small, some update packets, few big ones
+        size_t PacketSize()
+        {
+            uint32 roll = Next() % 100;
+            if (roll < 70)
+                return 4 + Next() % 200;
+            if (roll < 95)
+                return 200 + Next() % 1300;
+            return 1500 + Next() % 8000;
+        }
+
+    private:
+        uint32 m_state;
+};
+
+// packet written field by field like ByteBuffer::append does
+template<class Storage>
+class BenchPacket
+{
+    public:
+        BenchPacket() : m_wpos(0) { m_storage.reserve(200); }
+
+        void Fill(size_t size, uint32 value)
+        {
+            for (size_t i = 0; i < size; i += sizeof(value))
+            {
+                if (m_storage.size() < m_wpos + sizeof(value))
+                    m_storage.resize(m_wpos + sizeof(value));
+                memcpy(&m_storage[m_wpos], &value, sizeof(value));
+                m_wpos += sizeof(value);
+            }
+        }
+
+    private:
+        Storage m_storage;
+        size_t m_wpos;
+};
+
+// storage of ByteBuffer before the pool
+typedef BenchPacket<std::vector<uint8> > GlobalBuffer;
+
+// WorldPacket now
+class PoolBuffer : public BenchPacket<MemoryPoolBuffer>, public MemoryPoolObject
+{
+};
+
+class BenchRun
+{
+    public:
+        BenchRun(BenchOptions const& options, BenchAllocator allocator) : m_options(options), m_allocator(allocator), m_nextSeed(0), m_ended(0) {}
+
+        // returns wall time in ms
+        double Run(ACE_THR_FUNC function)
+        {
+            ACE_hrtime_t start = ACE_OS::gethrtime();
+
+            int group = ACE_Thread_Manager::instance()->spawn_n(m_options.threads, function, this);
+            if (group == -1)
+            {
+                printf("Can't start %u threads\n", m_options.threads);
+                return 0.0;
+            }
+            ACE_Thread_Manager::instance()->wait_grp(group);
+
+            return double(ACE_OS::gethrtime() - start) / 1000000.0;
+        }
+
+        // every thread writes packets and frees them after a while itself
+        static ACE_THR_FUNC_RETURN LocalPackets(void* arg)
+        {
+            BenchRun* run = (BenchRun*)arg;
+            if (run->m_allocator == BENCH_POOL)
+                run->LocalPackets<PoolBuffer>();
+            else
+                run->LocalPackets<GlobalBuffer>();
+            return 0;
+        }
+
+        // odd threads write packets, even threads free them (network thread to world thread)
+        static ACE_THR_FUNC_RETURN HandoffPackets(void* arg)
+        {
+            BenchRun* run = (BenchRun*)arg;
+            if (run->m_allocator == BENCH_POOL)
+                run->HandoffPackets<PoolBuffer>();
+            else
+                run->HandoffPackets<GlobalBuffer>();
+            return 0;
+        }
+
+        // odd threads copy SQL strings, even threads free them (world thread to SQL delay thread)
+        static ACE_THR_FUNC_RETURN HandoffStrings(void* arg)
+        {
+            BenchRun* run = (BenchRun*)arg;
+            run->HandoffStrings();
+            return 0;
+        }
+
+    private:
+        uint32 NextSeed()
+        {
+            BenchGuard guard(m_lock);
+            return ++m_nextSeed;
+        }
+
+        template<class Buffer>
+        void LocalPackets()
+        {
+            BenchRandom random(NextSeed());
+            Buffer* window[BENCH_WINDOW] = { NULL };
+
+            for (uint32 i = 0; i < m_options.operations; ++i)
+            {
+                Buffer*& slot = window[i % BENCH_WINDOW];
+                delete slot;
+
+                slot = new Buffer();
+                slot->Fill(random.PacketSize(), i);
+            }
+
+            for (uint32 i = 0; i < BENCH_WINDOW; ++i)
+                delete window[i];
+        }
+
+        template<class Buffer>
+        void HandoffPackets()
+        {
+            uint32 seed = NextSeed();
+            BenchRandom random(seed);
+
+            if (seed % 2)
+            {
+                for (uint32 i = 0; i < m_options.operations; ++i)
+                {
+                    Buffer* buffer = new Buffer();
+                    buffer->Fill(random.PacketSize(), i);
+                    Push(buffer);
+                }
+                Push(NULL);
+            }
+            else
+            {
+                while (void* buffer = Pop())
+                    delete (Buffer*)buffer;
+            }
+        }
+
+        void HandoffStrings()
+        {
+            uint32 seed = NextSeed();
+            BenchRandom random(seed);
+
+            if (seed % 2)
+            {
+                char sql[512];
+                for (uint32 i = 0; i < m_options.operations; ++i)
+                {
+                    size_t length = 40 + random.Next() % 400;
+                    memset(sql, 'x', length);
+                    sql[length] = '\0';
+
+                    Push(m_allocator == BENCH_POOL ? MemoryPool::CopyString(sql) : mangos_strdup(sql));
+                }
+                Push(NULL);
+            }
+            else
+            {
+                while (char* sql = (char*)Pop())
+                {
+                    if (m_allocator == BENCH_POOL)
+                        MemoryPool::FreeString(sql);
+                    else
+                        delete[] sql;
+                }
+            }
+        }
+
+        // NULL ends the stream of one producer; consumers stop when all producers ended
+        void Push(void* item)
+        {
+            BenchGuard guard(m_lock);
+            m_queue.push_back(item);
+        }
+
+        void* Pop()
+        {
+            for (;;)
+            {
+                {
+                    BenchGuard guard(m_lock);
+                    while (!m_queue.empty())
+                    {
+                        void* item = m_queue.front();
+                        m_queue.pop_front();
+                        if (item)
+                            return item;
+
+                        ++m_ended;
+                    }
+
+                    if (m_ended >= (m_options.threads + 1) / 2)
+                    {
+                        // wake up the other consumers
+                        m_queue.push_back(NULL);
+                        --m_ended;
+                        return NULL;
+                    }
+                }
+
+                ACE_OS::thr_yield();
+            }
+        }
+
+        BenchOptions const& m_options;
+        BenchAllocator m_allocator;
+
+        ACE_Thread_Mutex m_lock;                            // guards all below
+        uint32 m_nextSeed;
+        std::deque<void*> m_queue;
+        uint32 m_ended;
+};
+
+struct BenchWorkload
+{
+    char const* name;
+    ACE_THR_FUNC function;
+    bool handoff;                                           // needs at least one producer and one consumer
+};
+
+static BenchWorkload const Workloads[] =
+{
+    { "local packets",   (ACE_THR_FUNC)&BenchRun::LocalPackets,   false },
+    { "handoff packets", (ACE_THR_FUNC)&BenchRun::HandoffPackets, true  },
+    { "handoff strings", (ACE_THR_FUNC)&BenchRun::HandoffStrings, true  },
+};
+
+static void usage(char const* prog)
+{
+    printf("Usage: %s [-t threads] [-n operations per thread]\n", prog);
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+
+    ACE_Get_Opt cmd_opts(argc, argv, "t:n:");
+
+    int option;
+    while ((option = cmd_opts()) != EOF)
+    {
+        switch (option)
+        {
+            case 't': options.threads = uint32(atoi(cmd_opts.opt_arg())); break;
+            case 'n': options.operations = uint32(atoi(cmd_opts.opt_arg())); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (!options.threads || !options.operations)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    printf("%u threads, %u operations per thread\n\n", options.threads, options.operations);
+    printf("%-16s %-8s %10s %12s\n", "workload", "alloc", "ms", "ns/op");
+
+    for (uint32 i = 0; i < sizeof(Workloads) / sizeof(Workloads[0]); ++i)
+    {
+        BenchWorkload const& workload = Workloads[i];
+        if (workload.handoff && options.threads < 2)
+            continue;
+
+        // producers only count in handoff workloads
+        uint32 producers = workload.handoff ? (options.threads + 1) / 2 : options.threads;
+
+        for (uint32 allocator = 0; allocator < MAX_BENCH_ALLOCATOR; ++allocator)
+        {
+            BenchRun run(options, BenchAllocator(allocator));
+            double ms = run.Run(workload.function);
+
+            printf("%-16s %-8s %10.1f %12.1f\n", workload.name, AllocatorNames[allocator], ms,
+                   ms * 1000000.0 / (double(producers) * options.operations));
+        }
+    }
+
+    MemoryPool::ClassStatistics stats[MEMORY_POOL_CLASSES];
+    MemoryPool::GetStatistics(stats);
+
+    printf("\n%-8s %12s %8s\n", "size", "allocations", "slabs");
+    for (uint32 i = 0; i < MEMORY_POOL_CLASSES; ++i)
+        printf("%-8u %12ld %8ld\n", uint32(stats[i].blockSize), stats[i].allocations, stats[i].slabs);
+    printf("oversize allocations: %ld\n", MemoryPool::GetOversizeAllocations());
+
+    return 0;
+}
@@ -18,15 +18,16 @@
 
 #include <string>
 #include <iostream>
+#include <cstdlib>
 
 #include "TileAssembler.h"
 
 //=======================================================
 int main(int argc, char* argv[])
 {
-    if(argc != 3)
+    if(argc != 3 && argc != 4)
     {
-        std::cout << "usage: " << argv[0] << " <raw data dir> <vmap dest dir>" << std::endl;
+        std::cout << "usage: " << argv[0] << " <raw data dir> <vmap dest dir> [threads]" << std::endl;
         return 1;
     }
 
@@ -37,6 +38,9 @@ int main(int argc, char* argv[])
 
     VMAP::TileAssembler* ta = new VMAP::TileAssembler(src, dest);
 
+    if(argc == 4)
+        ta->setThreads(atoi(argv[3]));
+
     if(!ta->convertWorld2())
     {
         std::cout << "exit with errors" << std::endl;
@@ -33,12 +33,12 @@ class GridInfo
     public:
 
         GridInfo()
-            : i_timer(0), i_unloadActiveLockCount(0), i_unloadExplicitLock(false)
+            : i_timer(0), i_unloadGeneration(0), i_unloadActiveLockCount(0), i_unloadExplicitLock(false), i_unloadQueued(false)
         {
         }
 
         GridInfo(time_t expiry, bool unload = true )
-            : i_timer(expiry), i_unloadActiveLockCount(0), i_unloadExplicitLock(!unload)
+            : i_timer(expiry), i_unloadGeneration(0), i_unloadActiveLockCount(0), i_unloadExplicitLock(!unload), i_unloadQueued(false)
         {
         }
 
@@ -53,6 +53,13 @@ class GridInfo
         void incUnloadActiveLock() { ++i_unloadActiveLockCount; }
         void decUnloadActiveLock() { if (i_unloadActiveLockCount) --i_unloadActiveLockCount; }
 
+        bool isUnloadQueued() const { return i_unloadQueued; }
+        void setUnloadQueued(bool on) { i_unloadQueued = on; }
+
+        // queue entries of older generations are stale, a new one starts when the grid is reactivated or idles again
+        uint32 getUnloadGeneration() const { return i_unloadGeneration; }
+        void newUnloadGeneration() { ++i_unloadGeneration; i_unloadQueued = false; }
+
         void setTimer(const TimeTracker& pTimer) { i_timer = pTimer; }
         void ResetTimeTracker(time_t interval) { i_timer.Reset(interval); }
         void UpdateTimeTracker(time_t diff) { i_timer.Update(diff); }
@@ -60,8 +67,10 @@ class GridInfo
     private:
 
         TimeTracker i_timer;
+        uint32 i_unloadGeneration;
         uint16 i_unloadActiveLockCount : 16;                    // lock from active object spawn points (prevent clone loading)
         bool i_unloadExplicitLock      : 1;                     // explicit manual lock or config setting
+        bool i_unloadQueued            : 1;                     // expired, waiting in the grid unload queue of the map
 };
 
 typedef enum
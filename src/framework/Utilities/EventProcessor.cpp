@@ -18,29 +18,202 @@
 
 #include "EventProcessor.h"
 
-EventProcessor::EventProcessor()
+// EventLinkList
+
+uint32 EventLinkList::size() const
 {
-    m_time = 0;
-    m_aborting = false;
+    uint32 result = 0;
+    for (EventLink const* link = m_head.m_next; link != &m_head; link = link->m_next)
+        ++result;
+    return result;
 }
 
-EventProcessor::~EventProcessor()
+void EventLinkList::splice(EventLinkList& other)
 {
-    KillAllEvents(true);
+    if (other.empty())
+        return;
+
+    EventLink* first = other.m_head.m_next;
+    EventLink* last = other.m_head.m_prev;
+
+    first->m_prev = m_head.m_prev;
+    m_head.m_prev->m_next = first;
+    last->m_next = &m_head;
+    m_head.m_prev = last;
+
+    other.m_head.m_prev = other.m_head.m_next = &other.m_head;
 }
 
-void EventProcessor::Update(uint32 p_time)
+void EventLinkList::clear()
 {
-    // update time
-    m_time += p_time;
+    while (!empty())
+        m_head.m_next->Unlink();
+}
+
+// EventTimerWheel
 
-    // main event loop
-    EventList::iterator i;
-    while (((i = m_events.begin()) != m_events.end()) && i->first <= m_time)
+EventTimerWheel::EventTimerWheel() : m_time(0), m_scheduled(0)
+{
+}
+
+EventTimerWheel::~EventTimerWheel()
+{
+    // events are owned and deleted by the processors, the slot lists only unlink them
+}
+
+void EventTimerWheel::Place(BasicEvent* Event, uint64 now)
+{
+    uint64 expires = Event->m_execTime < now ? now : Event->m_execTime;
+    uint64 delta = expires - now;
+
+    for (uint32 level = 0; level < WHEEL_LEVELS; ++level)
+    {
+        if (delta < (uint64(1) << ((level + 1) * WHEEL_BITS)))
+        {
+            m_slots[level][(expires >> (level * WHEEL_BITS)) & WHEEL_MASK].push_back(&Event->m_timerLink);
+            return;
+        }
+    }
+
+    m_overflow.push_back(&Event->m_timerLink);
+}
+
+void EventTimerWheel::Unplan(BasicEvent* Event)
+{
+    // a link out of the wheel (pending queue or parked list) is not counted
+    if (Event->m_planned)
     {
-        // get and remove event from queue
-        BasicEvent* Event = i->second;
-        m_events.erase(i);
+        Event->m_planned = false;
+        --m_scheduled;
+    }
+
+    Event->m_timerLink.Unlink();
+}
+
+void EventTimerWheel::Cascade(uint32 level, uint64 tick)
+{
+    EventLinkList cascaded;
+
+    if (level == WHEEL_LEVELS)
+        cascaded.splice(m_overflow);
+    else
+    {
+        uint32 index = uint32(tick >> (level * WHEEL_BITS)) & WHEEL_MASK;
+
+        // coarser level wraps at same tick, let it fill this level first
+        if (index == 0)
+            Cascade(level + 1, tick);
+
+        cascaded.splice(m_slots[level][index]);
+    }
+
+    while (BasicEvent* Event = cascaded.front())
+        Place(Event, tick);
+}
+
+void EventTimerWheel::Schedule(BasicEvent* Event)
+{
+    Guard guard(m_lock);
+
+    // re-added event may still be planned for its old time
+    Unplan(Event);
+
+    // the current tick is already processed, so the nearest possible is the next one
+    Place(Event, m_time + 1);
+    Event->m_planned = true;
+    ++m_scheduled;
+}
+
+void EventTimerWheel::ScheduleEvents(EventLinkList& owned)
+{
+    Guard guard(m_lock);
+
+    for (EventLink* link = owned.first(); !owned.isEnd(link); link = EventLinkList::next(link))
+    {
+        BasicEvent* Event = link->GetEvent();
+        if (Event->to_Abort)
+            continue;
+
+        Unplan(Event);
+        Place(Event, m_time + 1);
+        Event->m_planned = true;
+        ++m_scheduled;
+    }
+}
+
+void EventTimerWheel::Cancel(BasicEvent* Event)
+{
+    Guard guard(m_lock);
+    Unplan(Event);
+}
+
+void EventTimerWheel::CancelEvents(EventLinkList& owned)
+{
+    Guard guard(m_lock);
+
+    for (EventLink* link = owned.first(); !owned.isEnd(link); link = EventLinkList::next(link))
+        Unplan(link->GetEvent());
+}
+
+void EventTimerWheel::Resume(EventLinkList& parked)
+{
+    Guard guard(m_lock);
+
+    while (BasicEvent* Event = parked.front())
+    {
+        Place(Event, m_time + 1);
+        Event->m_planned = true;
+        ++m_scheduled;
+    }
+}
+
+void EventTimerWheel::Update(uint32 p_time)
+{
+    {
+        Guard guard(m_lock);
+
+        uint64 newTime = m_time + p_time;
+
+        // collect due events of all passed ticks, empty wheel just moves the time
+        while (m_time < newTime && m_scheduled > 0)
+        {
+            uint64 tick = m_time + 1;
+            uint32 index = uint32(tick) & WHEEL_MASK;
+
+            if (index == 0)
+                Cascade(1, tick);
+
+            m_due.splice(m_slots[0][index]);
+            m_time = tick;
+        }
+
+        m_time = newTime;
+    }
+
+    // main event loop, events can be cancelled by other processors while we execute
+    for (;;)
+    {
+        BasicEvent* Event;
+        {
+            Guard guard(m_lock);
+
+            Event = m_due.front();
+            if (!Event)
+                break;
+
+            Unplan(Event);
+
+            // owner is not updated now, the event stays with it until the owner resumes its events
+            if (!Event->to_Abort && Event->m_owner && !Event->m_owner->CanExecuteEvents())
+            {
+                Event->m_owner->m_parked.push_back(&Event->m_timerLink);
+                continue;
+            }
+        }
+
+        // the event is ours now: KillAllEvents of the owner called from Execute must not delete it,
+        // an event re-added by AddEvent is linked to its owner again
+        Event->m_ownerLink.Unlink();
 
         if (!Event->to_Abort)
         {
@@ -58,43 +231,93 @@ void EventProcessor::Update(uint32 p_time)
     }
 }
 
+// EventProcessor
+
+EventProcessor::EventProcessor() : m_time(0), m_wheel(NULL), m_aborting(false)
+{
+}
+
+EventProcessor::~EventProcessor()
+{
+    KillAllEvents(true);
+}
+
 void EventProcessor::KillAllEvents(bool force)
 {
     // prevent event insertions
     m_aborting = true;
 
-    // first, abort all existing events
-    for (EventList::iterator i = m_events.begin(); i != m_events.end();)
+    if (m_events.empty())
+        return;
+
+    // first, stop planned executions, so the wheel doesn't touch events we delete
+    if (m_wheel)
+        m_wheel->CancelEvents(m_events);
+
+    uint64 now = GetTime();
+
+    for (EventLink* link = m_events.first(); !m_events.isEnd(link);)
     {
-        EventList::iterator i_old = i;
-        ++i;
+        BasicEvent* Event = link->GetEvent();
+        link = EventLinkList::next(link);
 
-        i_old->second->to_Abort = true;
-        i_old->second->Abort(m_time);
-        if (force || i_old->second->IsDeletable())
-        {
-            delete i_old->second;
+        Event->to_Abort = true;
+        Event->Abort(now);
 
-            if (!force)                                     // need per-element cleanup
-                m_events.erase(i_old);
-        }
+        // non deletable events are kept in the list (not planned) until forced cleanup
+        if (force || Event->IsDeletable())
+            delete Event;
     }
-
-    // fast clear event list (in force case)
-    if (force)
-        m_events.clear();
 }
 
 void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime)
 {
     if (set_addtime)
-        Event->m_addTime = m_time;
+        Event->m_addTime = GetTime();
 
     Event->m_execTime = e_time;
-    m_events.insert(std::pair<uint64, BasicEvent*>(e_time, Event));
+    Event->m_owner = this;
+    m_events.push_back(&Event->m_ownerLink);
+
+    if (m_wheel)
+        m_wheel->Schedule(Event);
 }
 
-uint64 EventProcessor::CalculateTime(uint64 t_offset)
+void EventProcessor::ResumeEvents()
 {
-    return m_time + t_offset;
+    if (m_wheel && !m_parked.empty())
+        m_wheel->Resume(m_parked);
+}
+
+uint64 EventProcessor::CalculateTime(uint64 t_offset) const
+{
+    return GetTime() + t_offset;
+}
+
+void EventProcessor::SetTimerWheel(EventTimerWheel* wheel)
+{
+    if (wheel == m_wheel)
+        return;
+
+    uint64 oldTime = GetTime();
+
+    if (m_wheel)
+        m_wheel->CancelEvents(m_events);
+
+    m_wheel = wheel;
+    m_time = oldTime;
+
+    if (!m_wheel)
+        return;
+
+    // keep remaining delays, time of the new wheel is unrelated to the old one
+    uint64 newTime = m_wheel->GetTime();
+    for (EventLink* link = m_events.first(); !m_events.isEnd(link); link = EventLinkList::next(link))
+    {
+        BasicEvent* Event = link->GetEvent();
+        Event->m_execTime = Event->m_execTime > oldTime ? newTime + (Event->m_execTime - oldTime) : newTime;
+        Event->m_addTime = Event->m_addTime + newTime - oldTime;
+    }
+
+    m_wheel->ScheduleEvents(m_events);
 }
@@ -21,16 +21,98 @@
 
 #include "Platform/Define.h"
 
+#include <ace/Thread_Mutex.h>
+#include <ace/Guard_T.h>
+
 #include <map>
 #include <queue>
 
 // Note. All times are in milliseconds here.
 
+class BasicEvent;
+class EventLinkList;
+class EventProcessor;
+
+// Intrusive list hook. Every event owns two of them: one for the list of its owner
+// processor and one for the timer wheel slot (or the pending queue of the owner),
+// so adding, moving and cancelling events never allocates.
+class EventLink
+{
+    friend class EventLinkList;
+
+    public:
+        explicit EventLink(BasicEvent* event) : m_prev(NULL), m_next(NULL), m_event(event) {}
+        ~EventLink() { Unlink(); }
+
+        bool IsLinked() const { return m_next != NULL; }
+
+        void Unlink()
+        {
+            if (m_next)
+            {
+                m_prev->m_next = m_next;
+                m_next->m_prev = m_prev;
+                m_prev = NULL;
+                m_next = NULL;
+            }
+        }
+
+        BasicEvent* GetEvent() const { return m_event; }
+
+    private:
+        EventLink(EventLink const&);
+        EventLink& operator=(EventLink const&);
+
+        EventLink* m_prev;
+        EventLink* m_next;
+        BasicEvent* m_event;
+};
+
+class EventLinkList
+{
+    public:
+        EventLinkList() : m_head(NULL) { m_head.m_prev = m_head.m_next = &m_head; }
+        ~EventLinkList() { clear(); }
+
+        bool empty() const { return m_head.m_next == &m_head; }
+        uint32 size() const;
+
+        // first event in the list, NULL if empty
+        BasicEvent* front() const { return empty() ? NULL : m_head.m_next->m_event; }
+
+        // link (or move) at the list end
+        void push_back(EventLink* link)
+        {
+            link->Unlink();
+            link->m_prev = m_head.m_prev;
+            link->m_next = &m_head;
+            m_head.m_prev->m_next = link;
+            m_head.m_prev = link;
+        }
+
+        // move all elements of other list at the end of this one
+        void splice(EventLinkList& other);
+
+        // unlink all elements, events are not touched
+        void clear();
+
+        // iteration helpers, next() must be taken before the current element is unlinked
+        EventLink* first() const { return m_head.m_next; }
+        bool isEnd(EventLink const* link) const { return link == &m_head; }
+        static EventLink* next(EventLink* link) { return link->m_next; }
+
+    private:
+        EventLinkList(EventLinkList const&);
+        EventLinkList& operator=(EventLinkList const&);
+
+        EventLink m_head;
+};
+
 class BasicEvent
 {
     public:
         BasicEvent(uint32 type)
-            : to_Abort(false), m_type(type)
+            : to_Abort(false), m_type(type), m_ownerLink(this), m_timerLink(this), m_owner(NULL), m_planned(false)
         {};
 
         virtual ~BasicEvent()                               // override destructor to perform some actions on event removal
@@ -54,26 +136,103 @@ class BasicEvent
         uint64 m_addTime;                                   // time when the event was added to queue, filled by event handler
         uint64 m_execTime;                                  // planned time of next execution, filled by event handler
         uint32 const m_type;                                // Event type (for use in some calculation)
+
+        EventLink m_ownerLink;                              // link in the event list of the owner processor
+        EventLink m_timerLink;                              // link in a timer wheel slot, in the owner pending queue or in the owner parked list
+        EventProcessor* m_owner;                            // processor the event was added to, filled by event handler
+        bool m_planned;                                     // m_timerLink is in a wheel slot and counted by the wheel
 };
 
-typedef std::multimap<uint64, BasicEvent*> EventList;
+/**
+ * Hierarchical timing wheel.
+ *
+ * One wheel is shared by all event processors of a map, so a map update fires
+ * all due events of all its objects in one pass. Levels have WHEEL_SIZE slots,
+ * level 0 has 1 ms resolution and every next level is WHEEL_SIZE times coarser,
+ * events farther than the last level are kept in an overflow list that is
+ * re-examined every time the last level wraps around.
+ * Insert and cancel are O(1), slots of a coarser level are cascaded down when
+ * the finer level wraps around.
+ * Due events of a processor that can't execute events now (owner outside the
+ * updated cells of the map) are parked in the processor until it resumes them.
+ */
+class MANGOS_DLL_SPEC EventTimerWheel
+{
+    public:
+        typedef ACE_Thread_Mutex LockType;
+        typedef ACE_Guard<LockType> Guard;
+
+        EventTimerWheel();
+        ~EventTimerWheel();
+
+        uint64 GetTime() const { return m_time; }
+        uint32 GetScheduledCount() const { return m_scheduled; }
+
+        // plan event execution at Event->m_execTime
+        void Schedule(BasicEvent* Event);
+        void ScheduleEvents(EventLinkList& owned);
+
+        // remove planned execution of the event (or of all events of an owner list)
+        void Cancel(BasicEvent* Event);
+        void CancelEvents(EventLinkList& owned);
+
+        // plan parked events again, they are due, so they fire at the next tick
+        void Resume(EventLinkList& parked);
+
+        // advance time and execute all events that became due
+        void Update(uint32 p_time);
+
+    private:
+        enum
+        {
+            WHEEL_LEVELS    = 4,
+            WHEEL_BITS      = 6,
+            WHEEL_SIZE      = 1 << WHEEL_BITS,
+            WHEEL_MASK      = WHEEL_SIZE - 1
+        };
+
+        void Place(BasicEvent* Event, uint64 now);
+        void Unplan(BasicEvent* Event);
+        void Cascade(uint32 level, uint64 tick);
+
+        LockType m_lock;
+        uint64 m_time;                                      // all ticks up to this time are processed
+        uint32 m_scheduled;
+
+        EventLinkList m_slots[WHEEL_LEVELS][WHEEL_SIZE];
+        EventLinkList m_overflow;
+        EventLinkList m_due;                                // events collected for execution by current Update
+};
 
 class MANGOS_DLL_SPEC EventProcessor
 {
+    friend class EventTimerWheel;
+
     public:
 
         EventProcessor();
-        ~EventProcessor();
+        virtual ~EventProcessor();
 
-        void Update(uint32 p_time);
         void KillAllEvents(bool force);
         void AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime = true);
-        uint64 CalculateTime(uint64 t_offset);
+        uint64 CalculateTime(uint64 t_offset) const;
+        uint64 GetTime() const { return m_wheel ? m_wheel->GetTime() : m_time; }
+
+        // events are executed by the timer wheel of the owner's map, NULL detaches the processor
+        // (events are kept, but not executed), planned times are rebased to the time of the new wheel
+        void SetTimerWheel(EventTimerWheel* wheel);
+        EventTimerWheel* GetTimerWheel() const { return m_wheel; }
+
+        // called by the wheel for every due event, false parks the event until ResumeEvents
+        virtual bool CanExecuteEvents() const { return true; }
+        void ResumeEvents();
 
     protected:
 
-        uint64 m_time;
-        EventList m_events;
+        uint64 m_time;                                      // time base while not attached to a wheel
+        EventLinkList m_events;                             // all events owned by the processor, kept for abort on remove
+        EventLinkList m_parked;                             // due events waiting for ResumeEvents, linked by m_timerLink
+        EventTimerWheel* m_wheel;
         bool m_aborting;
 };
 
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_FLATMAP_H
+#define MANGOS_FLATMAP_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/**
+ * Map kept as a sorted vector of pairs, for small key spaces where a node per
+ * element of std::map costs more than the element itself. Has the subset of the
+ * std::map interface used by the code.
+ *
+ * Unlike std::map, insert and erase invalidate iterators and references to other
+ * elements: use the iterator returned by erase() when erasing in a loop.
+ */
+template<class Key, class Value>
+class FlatMap
+{
+    public:
+        typedef Key key_type;
+        typedef Value mapped_type;
+        typedef std::pair<Key, Value> value_type;
+        typedef typename std::vector<value_type>::iterator iterator;
+        typedef typename std::vector<value_type>::const_iterator const_iterator;
+        typedef typename std::vector<value_type>::size_type size_type;
+
+        iterator begin() { return m_elements.begin(); }
+        iterator end() { return m_elements.end(); }
+        const_iterator begin() const { return m_elements.begin(); }
+        const_iterator end() const { return m_elements.end(); }
+
+        size_type size() const { return m_elements.size(); }
+        bool empty() const { return m_elements.empty(); }
+        void clear() { m_elements.clear(); }
+
+        // capacity is kept by clear(), this returns it
+        void shrink()
+        {
+            std::vector<value_type>(m_elements).swap(m_elements);
+        }
+
+        size_type capacity() const { return m_elements.capacity(); }
+
+        iterator lower_bound(Key const& key)
+        {
+            return std::lower_bound(m_elements.begin(), m_elements.end(), key, KeyCompare());
+        }
+
+        const_iterator lower_bound(Key const& key) const
+        {
+            return std::lower_bound(m_elements.begin(), m_elements.end(), key, KeyCompare());
+        }
+
+        iterator find(Key const& key)
+        {
+            iterator itr = lower_bound(key);
+            return itr != end() && itr->first == key ? itr : end();
+        }
+
+        const_iterator find(Key const& key) const
+        {
+            const_iterator itr = lower_bound(key);
+            return itr != end() && itr->first == key ? itr : end();
+        }
+
+        size_type count(Key const& key) const { return find(key) != end() ? 1 : 0; }
+
+        std::pair<iterator, bool> insert(value_type const& value)
+        {
+            iterator itr = lower_bound(value.first);
+            if (itr != end() && itr->first == value.first)
+                return std::make_pair(itr, false);
+
+            return std::make_pair(m_elements.insert(itr, value), true);
+        }
+
+        Value& operator[](Key const& key)
+        {
+            return insert(value_type(key, Value())).first->second;
+        }
+
+        iterator erase(iterator itr) { return m_elements.erase(itr); }
+
+        size_type erase(Key const& key)
+        {
+            iterator itr = find(key);
+            if (itr == end())
+                return 0;
+
+            m_elements.erase(itr);
+            return 1;
+        }
+
+    private:
+        struct KeyCompare
+        {
+            bool operator()(value_type const& element, Key const& key) const { return element.first < key; }
+        };
+
+        std::vector<value_type> m_elements;
+};
+
+#endif
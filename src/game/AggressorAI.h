@@ -43,6 +43,7 @@ class MANGOS_DLL_DECL AggressorAI : public CreatureAI
         bool IsVisible(Unit*) const;
 
         void UpdateAI(const uint32);
+        bool HasOutOfCombatUpdate() const { return false; }
         static int Permissible(const Creature*);
 
     private:
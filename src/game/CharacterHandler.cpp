@@ -119,7 +119,7 @@ bool LoginQueryHolder::Initialize()
 class CharacterHandler
 {
     public:
-        void HandleCharEnumCallback(QueryResult* result, uint32 account)
+        void HandleCharEnumCallback(QueryResult* result, uint32 account, uint32 cacheVersion)
         {
             WorldSession* session = sWorld.FindSession(account);
             if (!session)
@@ -127,7 +127,7 @@ class CharacterHandler
                 delete result;
                 return;
             }
-            session->HandleCharEnum(result);
+            session->HandleCharEnum(result, cacheVersion);
         }
         void HandlePlayerLoginCallback(QueryResult* /*dummy*/, SqlQueryHolder* holder)
         {
@@ -167,7 +167,7 @@ class CharacterHandler
         }
 } chrHandler;
 
-void WorldSession::HandleCharEnum(QueryResult* result)
+void WorldSession::HandleCharEnum(QueryResult* result, uint32 cacheVersion)
 {
     WorldPacket data(SMSG_CHAR_ENUM, 100);                  // we guess size
 
@@ -191,13 +191,23 @@ void WorldSession::HandleCharEnum(QueryResult* result)
 
     data.put<uint8>(0, num);
 
+    sWorld.CacheCharEnum(GetAccountId(), data, cacheVersion);
+
     SendPacket(&data);
 }
 
 void WorldSession::HandleCharEnumOpcode(WorldPacket& /*recv_data*/)
 {
+    // list is requested after every return to character screen
+    WorldPacket data;
+    if (sWorld.GetCachedCharEnum(GetAccountId(), data))
+    {
+        SendPacket(&data);
+        return;
+    }
+
     /// get all the data necessary for loading all characters (along with their pets) on the account
-    CharacterDatabase.AsyncPQuery(&chrHandler, &CharacterHandler::HandleCharEnumCallback, GetAccountId(),
+    CharacterDatabase.AsyncPQuery(&chrHandler, &CharacterHandler::HandleCharEnumCallback, GetAccountId(), sWorld.GetCharEnumCacheVersion(),
          !sWorld.getConfig(CONFIG_BOOL_DECLINED_NAMES_USED) ?
     //   ------- Query Without Declined Names --------
     //           0               1                2                3                 4                  5                       6                        7
@@ -480,6 +490,7 @@ void WorldSession::HandleCharCreateOpcode(WorldPacket& recv_data)
 
     // Player created, save it now
     pNewChar.SaveToDB();
+    sWorld.InvalidateCharEnum(GetAccountId());
 
     sAccountMgr.UpdateCharactersCount(GetAccountId(), sWorld.getConfig(CONFIG_UINT32_REALMID));
 
@@ -617,6 +628,9 @@ void WorldSession::HandlePlayerLogin(LoginQueryHolder* holder)
 {
     ObjectGuid playerGuid = holder->GetGuid();
 
+    // position, level and other list data change while playing
+    sWorld.InvalidateCharEnum(GetAccountId());
+
     Player* pCurrChar = new Player(this);
     pCurrChar->GetMotionMaster()->Initialize();
 
@@ -1034,6 +1048,7 @@ void WorldSession::HandleChangePlayerNameOpcodeCallBack(QueryResult* result, uin
     CharacterDatabase.PExecute("UPDATE characters set name = '%s', at_login = at_login & ~ %u WHERE guid ='%u'", newname.c_str(), uint32(AT_LOGIN_RENAME), guidLow);
     CharacterDatabase.PExecute("DELETE FROM character_declinedname WHERE guid ='%u'", guidLow);
     CharacterDatabase.CommitTransaction();
+    sWorld.InvalidateCharEnum(session->GetAccountId());
 
     sLog.outChar("Account: %d (IP: %s) Character:[%s] (guid:%u) Changed name to: %s", session->GetAccountId(), session->GetRemoteAddress().c_str(), oldname.c_str(), guidLow, newname.c_str());
 
@@ -1124,6 +1139,7 @@ void WorldSession::HandleSetPlayerDeclinedNamesOpcode(WorldPacket& recv_data)
     CharacterDatabase.PExecute("INSERT INTO character_declinedname (guid, genitive, dative, accusative, instrumental, prepositional) VALUES ('%u','%s','%s','%s','%s','%s')",
                                guid.GetCounter(), declinedname.name[0].c_str(), declinedname.name[1].c_str(), declinedname.name[2].c_str(), declinedname.name[3].c_str(), declinedname.name[4].c_str());
     CharacterDatabase.CommitTransaction();
+    sWorld.InvalidateCharEnum(GetAccountId());
 
     WorldPacket data(SMSG_SET_PLAYER_DECLINED_NAMES_RESULT, 4 + 8);
     data << uint32(0);                                      // OK
@@ -1454,6 +1470,7 @@ void WorldSession::HandleCharFactionOrRaceChangeOpcode(WorldPacket& recv_data)
         }
     }
     CharacterDatabase.CommitTransaction();
+    sWorld.InvalidateCharEnum(GetAccountId());
 
     if (deletedGuild)
     {
@@ -1555,6 +1572,7 @@ void WorldSession::HandleCharCustomizeOpcode(WorldPacket& recv_data)
     Player::Customize(guid, gender, skin, face, hairStyle, hairColor, facialHair);
     CharacterDatabase.PExecute("UPDATE characters set name = '%s', at_login = at_login & ~ %u WHERE guid ='%u'", newname.c_str(), uint32(AT_LOGIN_CUSTOMIZE), guid.GetCounter());
     CharacterDatabase.PExecute("DELETE FROM character_declinedname WHERE guid ='%u'", guid.GetCounter());
+    sWorld.InvalidateCharEnum(GetAccountId());
 
     std::string IP_str = GetRemoteAddress();
     sLog.outChar("Account: %d (IP: %s), Character %s customized to: %s", GetAccountId(), IP_str.c_str(), guid.GetString().c_str(), newname.c_str());
@@ -199,6 +199,7 @@ class MANGOS_DLL_SPEC ChatHandler
         bool HandleCharacterDeletedOldCommand(char* args);
         bool HandleCharacterEraseCommand(char* args);
         bool HandleCharacterLevelCommand(char* args);
+        bool HandleCharacterMemoryCommand(char* args);
         bool HandleCharacterRenameCommand(char* args);
         bool HandleCharacterReputationCommand(char* args);
         bool HandleCharacterTitlesCommand(char* args);
@@ -209,6 +210,8 @@ class MANGOS_DLL_SPEC ChatHandler
         bool HandleDebugGetItemStateCommand(char* args);
         bool HandleDebugGetItemValueCommand(char* args);
         bool HandleDebugGetLootRecipientCommand(char* args);
+        bool HandleDebugLockStatsCommand(char* args);
+        bool HandleDebugMapUpdatesCommand(char* args);
         bool HandleDebugGetValueCommand(char* args);
         bool HandleDebugModItemValueCommand(char* args);
         bool HandleDebugModValueCommand(char* args);
@@ -516,6 +519,7 @@ class MANGOS_DLL_SPEC ChatHandler
         bool HandleServerLogLevelCommand(char* args);
         bool HandleServerMotdCommand(char* args);
         bool HandleServerPLimitCommand(char* args);
+        bool HandleServerProfileCommand(char* args);
         bool HandleServerRestartCommand(char* args);
         bool HandleServerSetMotdCommand(char* args);
         bool HandleServerShutDownCommand(char* args);
@@ -26,6 +26,19 @@
 #include "GossipDef.h"
 #include "World.h"
 #include "ObjectMgr.h"
+#include "MemoryPool.h"
+
+static ObjectPool CorpsePool("Corpse", sizeof(Corpse));
+
+void* Corpse::operator new(size_t size)
+{
+    return CorpsePool.Allocate(size);
+}
+
+void Corpse::operator delete(void* ptr, size_t size)
+{
+    CorpsePool.Deallocate(ptr, size);
+}
 
 Corpse::Corpse(CorpseType type) : WorldObject()
 {
@@ -53,6 +53,10 @@ class Corpse : public WorldObject
         explicit Corpse(CorpseType type = CORPSE_BONES);
         ~Corpse();
 
+        // bones are created and removed in numbers at battlegrounds
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr, size_t size);
+
         void AddToWorld();
         void RemoveFromWorld();
 
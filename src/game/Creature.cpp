@@ -50,11 +50,16 @@
 #include "CellImpl.h"
 #include "TemporarySummon.h"
 #include "movement/MoveSplineInit.h"
+#include "movement/MoveSpline.h"
 #include "CreatureLinkingMgr.h"
+#include "WorldProfiler.h"
+#include "MemoryPool.h"
 
 // apply implementation of the singletons
 #include "Policies/SingletonImp.h"
 
+static ObjectPool CreaturePool("Creature", sizeof(Creature));
+
 ObjectGuid CreatureData::GetObjectGuid(uint32 lowguid) const
 {
     // info existence checked at loading
@@ -134,6 +139,16 @@ bool CreatureCreatePos::Relocate(Creature* cr) const
     return true;
 }
 
+void* Creature::operator new(size_t size)
+{
+    return CreaturePool.Allocate(size);
+}
+
+void Creature::operator delete(void* ptr, size_t size)
+{
+    CreaturePool.Deallocate(ptr, size);
+}
+
 Creature::Creature(CreatureSubtype subtype) :
 Unit(), i_AI(NULL),
 lootForPickPocketed(false), lootForBody(false), lootForSkin(false),m_lootMoney(0),
@@ -141,7 +156,7 @@ m_corpseDecayTimer(0), m_respawnTime(0), m_respawnDelay(25), m_corpseDelay(60),
 m_subtype(subtype), m_defaultMovementType(IDLE_MOTION_TYPE), m_equipmentId(0),
 m_AlreadyCallAssistance(false), m_AlreadySearchedAssistance(false),
 m_regenHealth(true), m_AI_locked(false), m_isDeadByDefault(false),
-m_temporaryFactionFlags(TEMPFACTION_NONE), m_meleeDamageSchoolMask(SPELL_SCHOOL_MASK_NORMAL), m_originalEntry(0),
+m_temporaryFactionFlags(TEMPFACTION_NONE), m_idleSleepTime(0), m_idleAwakeTime(0), m_meleeDamageSchoolMask(SPELL_SCHOOL_MASK_NORMAL), m_originalEntry(0),
 m_creatureInfo(NULL)
 {
     m_regenTimer = 200;
@@ -453,6 +468,8 @@ uint32 Creature::ChooseDisplayId(const CreatureInfo* cinfo, const CreatureData*
 
 void Creature::Update(uint32 update_diff, uint32 diff)
 {
+    m_idleSleepTime = 0;
+
     switch (m_deathState)
     {
         case JUST_ALIVED:
@@ -583,6 +600,8 @@ void Creature::Update(uint32 update_diff, uint32 diff)
             {
                 if (AI())
                 {
+                    PROFILE_SCOPE(PROFILE_CREATURE_AI);
+
                     // do not allow the AI to be changed during update
                     LockAI(true);
                     AI()->UpdateAI(diff);   // AI not react good at real update delays (while freeze in non-active part of map)
@@ -599,6 +618,10 @@ void Creature::Update(uint32 update_diff, uint32 diff)
                 break;
 
             RegenerateAll(update_diff);
+
+            // nothing to do until some state change, map update can skip it for a while
+            if (CanSleepIdle())
+                m_idleSleepTime = WorldTimer::getMSTime();
             break;
         }
         default:
@@ -2737,3 +2760,93 @@ void Creature::SetWaterWalk(bool enable)
     data << GetPackGUID();
     SendMessageToSet(&data, true);
 }
+
+bool Creature::CanSleepIdle()
+{
+    uint32 sleepTime = sWorld.getConfig(CONFIG_UINT32_CREATURE_IDLE_SLEEP_TIME);
+    if (!sleepTime)
+        return false;
+
+    // kept awake by near player
+    if (m_idleAwakeTime && WorldTimer::getMSTimeDiff(m_idleAwakeTime, WorldTimer::getMSTime()) < sleepTime)
+        return false;
+
+    if (!isAlive() || m_isDeadByDefault || isInCombat() || IsInEvadeMode())
+        return false;
+
+    if (IsPet() || IsTotem() || IsTemporarySummon() || IsVehicle() || isActiveObject() || !GetCharmerOrOwnerGuid().IsEmpty())
+        return false;
+
+    // regeneration in progress
+    if (GetHealth() < GetMaxHealth() || GetPower(getPowerType()) < GetMaxPower(getPowerType()))
+        return false;
+
+    if (IsNonMeleeSpellCasted(false) || getAttackTimer(BASE_ATTACK) || getAttackTimer(OFF_ATTACK) || m_lastManaUseTimer)
+        return false;
+
+    for (uint32 i = 0; i < MAX_REACTIVE; ++i)
+        if (m_reactiveTimer[i])
+            return false;
+
+    if (!getThreatManager().isThreatListEmpty() || !getHostileRefManager().isEmpty())
+        return false;
+
+    if (GetMotionMaster()->GetCurrentMovementGeneratorType() != IDLE_MOTION_TYPE || !movespline->Finalized())
+        return false;
+
+    // new events are moved to the timer wheel only by own update
+    if (GetEvents()->HasQueuedEvents())
+        return false;
+
+    {
+        MAPLOCK_READ(this, MAP_LOCK_TYPE_AURAS);
+
+        if (!m_deletedHolders.empty())
+            return false;
+
+        // auras with duration or periodic ticks are updated by own update
+        SpellAuraHolderMap const& holders = GetSpellAuraHolderMap();
+        for (SpellAuraHolderMap::const_iterator itr = holders.begin(); itr != holders.end(); ++itr)
+        {
+            if (!itr->second->IsPermanent())
+                return false;
+
+            for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+            {
+                Aura* aura = itr->second->GetAuraByEffectIndex(SpellEffectIndex(i));
+                if (aura && aura->IsPeriodic())
+                    return false;
+            }
+        }
+    }
+
+    return !AI() || AI()->HasOutOfCombatUpdate();
+}
+
+bool Creature::IsIdleSleeping(uint32 now)
+{
+    if (!m_idleSleepTime)
+        return false;
+
+    // cheap recheck of state changes done by others after the creature fell asleep, full check is done by next update
+    if (WorldTimer::getMSTimeDiff(m_idleSleepTime, now) >= sWorld.getConfig(CONFIG_UINT32_CREATURE_IDLE_SLEEP_TIME) ||
+        !isAlive() || isInCombat() || IsInEvadeMode() || GetHealth() < GetMaxHealth() ||
+        GetPower(getPowerType()) < GetMaxPower(getPowerType()) || m_lastManaUseTimer ||
+        IsNonMeleeSpellCasted(false) || !movespline->Finalized() ||
+        GetMotionMaster()->GetCurrentMovementGeneratorType() != IDLE_MOTION_TYPE ||
+        GetEvents()->HasQueuedEvents())
+    {
+        WakeUp();
+        return false;
+    }
+
+    return true;
+}
+
+void Creature::WakeUp(bool keepAwake /*= false*/)
+{
+    m_idleSleepTime = 0;
+
+    if (keepAwake)
+        m_idleAwakeTime = WorldTimer::getMSTime();
+}
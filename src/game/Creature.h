@@ -470,6 +470,10 @@ class MANGOS_DLL_SPEC Creature : public Unit
         explicit Creature(CreatureSubtype subtype = CREATURE_SUBTYPE_GENERIC);
         virtual ~Creature();
 
+        // creatures of unloaded grids leave their memory to the creatures of the next loaded grid
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr, size_t size);
+
         void AddToWorld();
         void RemoveFromWorld();
 
@@ -716,11 +720,17 @@ class MANGOS_DLL_SPEC Creature : public Unit
         void LockAI(bool lock) { m_AI_locked = lock; };
         bool IsAILocked() const { return m_AI_locked; };
 
+        // idle creatures skip map updates for Creature.IdleUpdate.SleepTime, any state change wakes them up
+        bool IsIdleSleeping(uint32 now);
+        void WakeUp(bool keepAwake = false);
+
         void SetVirtualItem(VirtualItemSlot slot, uint32 item_id) { SetUInt32Value(UNIT_VIRTUAL_ITEM_SLOT_ID + slot, item_id); }
 
     protected:
         bool MeetsSelectAttackingRequirement(Unit* pTarget, SpellEntry const* pSpellInfo, uint32 selectFlags) const;
 
+        bool CanSleepIdle();
+
         bool CreateFromProto(uint32 guidlow, CreatureInfo const* cinfo, Team team, const CreatureData* data = NULL, GameEventCreatureData const* eventData = NULL);
         bool InitEntry(uint32 entry, const CreatureData* data = NULL, GameEventCreatureData const* eventData = NULL);
 
@@ -756,6 +766,9 @@ class MANGOS_DLL_SPEC Creature : public Unit
         bool m_isDeadByDefault;
         uint32 m_temporaryFactionFlags;                     // used for real faction changes (not auras etc)
 
+        uint32 m_idleSleepTime;                             // ms time of falling asleep, 0 if awake
+        uint32 m_idleAwakeTime;                             // ms time of last wake up by near player, 0 if none
+
         SpellSchoolMask m_meleeDamageSchoolMask;
         uint32 m_originalEntry;
 
@@ -250,6 +250,12 @@ class MANGOS_DLL_SPEC CreatureAI
          */
         virtual bool IsVisible(Unit* /*pWho*/) const { return false; }
 
+        /**
+         * Check if UpdateAI has work to do while the creature is idle and out of combat (timers, scripted movement)
+         * Note: Creatures with AI returning false can skip map updates while idle, see Creature::CanSleepIdle
+         */
+        virtual bool HasOutOfCombatUpdate() const { return true; }
+
         // Called when victim entered water and creature can not enter water
         // TODO: rather unused
         virtual bool canReachByRangeAttack(Unit*) { return false; }
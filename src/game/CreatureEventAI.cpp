@@ -583,13 +583,8 @@ void CreatureEventAI::ProcessAction(CreatureEventAI_Action const& action, uint32
                 m_creature->getThreatManager().modifyThreatPercent(target, action.threat_single_pct.percent);
             break;
         case ACTION_T_THREAT_ALL_PCT:
-        {
-            ThreatList const& threatList = m_creature->getThreatManager().getThreatList();
-            for (ThreatList::const_iterator i = threatList.begin(); i != threatList.end(); ++i)
-                if (Unit* Temp = m_creature->GetMap()->GetUnit((*i)->getUnitGuid()))
-                    m_creature->getThreatManager().modifyThreatPercent(Temp, action.threat_all_pct.percent);
+            m_creature->getThreatManager().modifyAllThreatPercent(action.threat_all_pct.percent);
             break;
-        }
         case ACTION_T_QUEST_EVENT:
             if (Unit* target = GetTargetByType(action.quest_event.target, pActionInvoker))
                 if (target->GetTypeId() == TYPEID_PLAYER)
@@ -1227,6 +1222,30 @@ bool CreatureEventAI::IsVisible(Unit* pl) const
            && pl->isVisibleForOrDetect(m_creature, m_creature, true);
 }
 
+bool CreatureEventAI::HasOutOfCombatUpdate() const
+{
+    if (m_bEmptyList)
+        return false;
+
+    // running timers and timed events are counted by UpdateAI diff, they need every update
+    for (CreatureEventAIList::const_iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+    {
+        if (i->Time)
+            return true;
+
+        switch (i->Event.event_type)
+        {
+            case EVENT_T_TIMER_OOC:
+            case EVENT_T_TIMER_GENERIC:
+                return true;
+            default:
+                break;
+        }
+    }
+
+    return false;
+}
+
 inline uint32 CreatureEventAI::GetRandActionParam(uint32 rnd, uint32 param1, uint32 param2, uint32 param3)
 {
     switch (rnd % 3)
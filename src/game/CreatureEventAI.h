@@ -623,6 +623,7 @@ class MANGOS_DLL_SPEC CreatureEventAI : public CreatureAI
         void DamageTaken(Unit* done_by, uint32& damage);
         void UpdateAI(const uint32 diff);
         bool IsVisible(Unit *) const;
+        bool HasOutOfCombatUpdate() const;
         void ReceiveEmote(Player* pPlayer, uint32 text_emote);
         void SummonedCreatureJustDied(Creature* unit);
         void SummonedCreatureDespawn(Creature* unit);
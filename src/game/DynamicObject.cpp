@@ -27,6 +27,19 @@
 #include "GridNotifiersImpl.h"
 #include "SpellMgr.h"
 #include "DBCStores.h"
+#include "MemoryPool.h"
+
+static ObjectPool DynamicObjectPool("DynamicObject", sizeof(DynamicObject));
+
+void* DynamicObject::operator new(size_t size)
+{
+    return DynamicObjectPool.Allocate(size);
+}
+
+void DynamicObject::operator delete(void* ptr, size_t size)
+{
+    DynamicObjectPool.Deallocate(ptr, size);
+}
 
 DynamicObject::DynamicObject() : WorldObject()
 {
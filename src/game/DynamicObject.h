@@ -37,6 +37,10 @@ class DynamicObject : public WorldObject
     public:
         explicit DynamicObject();
 
+        // created and deleted by area spells all the time
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr, size_t size);
+
         void AddToWorld();
         void RemoveFromWorld();
 
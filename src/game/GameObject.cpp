@@ -43,8 +43,20 @@
 #include "vmap/GameObjectModel.h"
 #include "vmap/DynamicTree.h"
 #include "SQLStorages.h"
+#include "MemoryPool.h"
 #include <G3D/Quat.h>
 
+static ObjectPool GameObjectPool("GameObject", sizeof(GameObject));
+
+void* GameObject::operator new(size_t size)
+{
+    return GameObjectPool.Allocate(size);
+}
+
+void GameObject::operator delete(void* ptr, size_t size)
+{
+    GameObjectPool.Deallocate(ptr, size);
+}
 
 GameObject::GameObject() : WorldObject(),
     m_model(NULL),
@@ -31,6 +31,10 @@
 #include "World.h"
 #include "Policies/SingletonImp.h"
 #include "Util.h"
+#include "Metrics/Metrics.h"
+
+#include <ace/Future.h>
+#include <ace/Method_Request.h>
 
 char const* MAP_MAGIC         = "MAPS";
 char const* MAP_VERSION_MAGIC = "v1.2";
@@ -254,16 +258,26 @@ uint16 GridMap::getArea(float x, float y)
     return m_area_map[lx * 16 + ly];
 }
 
-float GridMap::getHeightFromFlat(float /*x*/, float /*y*/) const
+// Height stored as: h5 - its v8 grid, h1-h4 - its v9 grid
+// +--------------> X
+// | h1-------h2     Coordinates is:
+// | | \  1  / |     h1 0,0
+// | |  \   /  |     h2 0,1
+// | | 2  h5 3 |     h3 1,0
+// | |  /   \  |     h4 1,1
+// | | /  4  \ |     h5 1/2,1/2
+// | h3-------h4
+// V Y
+// For find height need
+// 1 - detect triangle
+// 2 - solve linear equation from triangle points
+// Calculate coefficients for solve h = a*x + b*y + c
+//
+// T is the stored height type, A the type the coefficients are calculated in
+// (float for float heights, int32 for packed ones, those are scaled by caller)
+template<typename T, typename A>
+inline float InterpolateGridHeight(T const* V9, T const* V8, float x, float y)
 {
-    return m_gridHeight;
-}
-
-float GridMap::getHeightFromFloat(float x, float y) const
-{
-    if (!m_V8 || !m_V9)
-        return m_gridHeight;
-
     x = MAP_RESOLUTION * (32 - x / SIZE_OF_GRIDS);
     y = MAP_RESOLUTION * (32 - y / SIZE_OF_GRIDS);
 
@@ -274,31 +288,16 @@ float GridMap::getHeightFromFloat(float x, float y) const
     x_int &= (MAP_RESOLUTION - 1);
     y_int &= (MAP_RESOLUTION - 1);
 
-    // Height stored as: h5 - its v8 grid, h1-h4 - its v9 grid
-    // +--------------> X
-    // | h1-------h2     Coordinates is:
-    // | | \  1  / |     h1 0,0
-    // | |  \   /  |     h2 0,1
-    // | | 2  h5 3 |     h3 1,0
-    // | |  /   \  |     h4 1,1
-    // | | /  4  \ |     h5 1/2,1/2
-    // | h3-------h4
-    // V Y
-    // For find height need
-    // 1 - detect triangle
-    // 2 - solve linear equation from triangle points
-    // Calculate coefficients for solve h = a*x + b*y + c
-
-    float a, b, c;
-    // Select triangle:
+    A a, b, c;
+    T const* V9_h1_ptr = &V9[x_int * 128 + x_int + y_int];
+    A h5 = 2 * A(V8[x_int * 128 + y_int]);
     if (x + y < 1)
     {
         if (x > y)
         {
             // 1 triangle (h1, h2, h5 points)
-            float h1 = m_V9[(x_int) * 129 + y_int];
-            float h2 = m_V9[(x_int + 1) * 129 + y_int];
-            float h5 = 2 * m_V8[x_int * 128 + y_int];
+            A h1 = V9_h1_ptr[  0];
+            A h2 = V9_h1_ptr[129];
             a = h2 - h1;
             b = h5 - h1 - h2;
             c = h1;
@@ -306,9 +305,8 @@ float GridMap::getHeightFromFloat(float x, float y) const
         else
         {
             // 2 triangle (h1, h3, h5 points)
-            float h1 = m_V9[x_int * 129 + y_int  ];
-            float h3 = m_V9[x_int * 129 + y_int + 1];
-            float h5 = 2 * m_V8[x_int * 128 + y_int];
+            A h1 = V9_h1_ptr[0];
+            A h3 = V9_h1_ptr[1];
             a = h5 - h1 - h3;
             b = h3 - h1;
             c = h1;
@@ -319,9 +317,8 @@ float GridMap::getHeightFromFloat(float x, float y) const
         if (x > y)
         {
             // 3 triangle (h2, h4, h5 points)
-            float h2 = m_V9[(x_int + 1) * 129 + y_int  ];
-            float h4 = m_V9[(x_int + 1) * 129 + y_int + 1];
-            float h5 = 2 * m_V8[x_int * 128 + y_int];
+            A h2 = V9_h1_ptr[129];
+            A h4 = V9_h1_ptr[130];
             a = h2 + h4 - h5;
             b = h4 - h2;
             c = h5 - h4;
@@ -329,84 +326,46 @@ float GridMap::getHeightFromFloat(float x, float y) const
         else
         {
             // 4 triangle (h3, h4, h5 points)
-            float h3 = m_V9[(x_int) * 129 + y_int + 1];
-            float h4 = m_V9[(x_int + 1) * 129 + y_int + 1];
-            float h5 = 2 * m_V8[x_int * 128 + y_int];
+            A h3 = V9_h1_ptr[  1];
+            A h4 = V9_h1_ptr[130];
             a = h4 - h3;
             b = h3 + h4 - h5;
             c = h5 - h4;
         }
     }
+
     // Calculate height
-    return a * x + b * y + c;
+    return (a * x) + (b * y) + c;
 }
 
-float GridMap::getHeightFromUint8(float x, float y) const
+// batch version, storage type is resolved once for all points and the loop has no indirect calls
+template<typename T, typename A>
+void InterpolateGridHeights(T const* V9, T const* V8, float multiplier, float offset,
+                            float const* x, float const* y, float* heights, uint32 count)
 {
-    if (!m_uint8_V8 || !m_uint8_V9)
-        return m_gridHeight;
+    for (uint32 i = 0; i < count; ++i)
+        heights[i] = InterpolateGridHeight<T, A>(V9, V8, x[i], y[i]) * multiplier + offset;
+}
 
-    x = MAP_RESOLUTION * (32 - x / SIZE_OF_GRIDS);
-    y = MAP_RESOLUTION * (32 - y / SIZE_OF_GRIDS);
+float GridMap::getHeightFromFlat(float /*x*/, float /*y*/) const
+{
+    return m_gridHeight;
+}
 
-    int x_int = (int)x;
-    int y_int = (int)y;
-    x -= x_int;
-    y -= y_int;
-    x_int &= (MAP_RESOLUTION - 1);
-    y_int &= (MAP_RESOLUTION - 1);
+float GridMap::getHeightFromFloat(float x, float y) const
+{
+    if (!m_V8 || !m_V9)
+        return m_gridHeight;
 
-    int32 a, b, c;
-    uint8* V9_h1_ptr = &m_uint8_V9[x_int * 128 + x_int + y_int];
-    if (x + y < 1)
-    {
-        if (x > y)
-        {
-            // 1 triangle (h1, h2, h5 points)
-            int32 h1 = V9_h1_ptr[  0];
-            int32 h2 = V9_h1_ptr[129];
-            int32 h5 = 2 * m_uint8_V8[x_int * 128 + y_int];
-            a = h2 - h1;
-            b = h5 - h1 - h2;
-            c = h1;
-        }
-        else
-        {
-            // 2 triangle (h1, h3, h5 points)
-            int32 h1 = V9_h1_ptr[0];
-            int32 h3 = V9_h1_ptr[1];
-            int32 h5 = 2 * m_uint8_V8[x_int * 128 + y_int];
-            a = h5 - h1 - h3;
-            b = h3 - h1;
-            c = h1;
-        }
-    }
-    else
-    {
-        if (x > y)
-        {
-            // 3 triangle (h2, h4, h5 points)
-            int32 h2 = V9_h1_ptr[129];
-            int32 h4 = V9_h1_ptr[130];
-            int32 h5 = 2 * m_uint8_V8[x_int * 128 + y_int];
-            a = h2 + h4 - h5;
-            b = h4 - h2;
-            c = h5 - h4;
-        }
-        else
-        {
-            // 4 triangle (h3, h4, h5 points)
-            int32 h3 = V9_h1_ptr[  1];
-            int32 h4 = V9_h1_ptr[130];
-            int32 h5 = 2 * m_uint8_V8[x_int * 128 + y_int];
-            a = h4 - h3;
-            b = h3 + h4 - h5;
-            c = h5 - h4;
-        }
-    }
+    return InterpolateGridHeight<float, float>(m_V9, m_V8, x, y);
+}
 
-    // Calculate height
-    return (float)((a * x) + (b * y) + c) * m_gridIntHeightMultiplier + m_gridHeight;
+float GridMap::getHeightFromUint8(float x, float y) const
+{
+    if (!m_uint8_V8 || !m_uint8_V9)
+        return m_gridHeight;
+
+    return InterpolateGridHeight<uint8, int32>(m_uint8_V9, m_uint8_V8, x, y) * m_gridIntHeightMultiplier + m_gridHeight;
 }
 
 float GridMap::getHeightFromUint16(float x, float y) const
@@ -414,67 +373,19 @@ float GridMap::getHeightFromUint16(float x, float y) const
     if (!m_uint16_V8 || !m_uint16_V9)
         return m_gridHeight;
 
-    x = MAP_RESOLUTION * (32 - x / SIZE_OF_GRIDS);
-    y = MAP_RESOLUTION * (32 - y / SIZE_OF_GRIDS);
-
-    int x_int = (int)x;
-    int y_int = (int)y;
-    x -= x_int;
-    y -= y_int;
-    x_int &= (MAP_RESOLUTION - 1);
-    y_int &= (MAP_RESOLUTION - 1);
+    return InterpolateGridHeight<uint16, int32>(m_uint16_V9, m_uint16_V8, x, y) * m_gridIntHeightMultiplier + m_gridHeight;
+}
 
-    int32 a, b, c;
-    uint16* V9_h1_ptr = &m_uint16_V9[x_int * 128 + x_int + y_int];
-    if (x + y < 1)
-    {
-        if (x > y)
-        {
-            // 1 triangle (h1, h2, h5 points)
-            int32 h1 = V9_h1_ptr[  0];
-            int32 h2 = V9_h1_ptr[129];
-            int32 h5 = 2 * m_uint16_V8[x_int * 128 + y_int];
-            a = h2 - h1;
-            b = h5 - h1 - h2;
-            c = h1;
-        }
-        else
-        {
-            // 2 triangle (h1, h3, h5 points)
-            int32 h1 = V9_h1_ptr[0];
-            int32 h3 = V9_h1_ptr[1];
-            int32 h5 = 2 * m_uint16_V8[x_int * 128 + y_int];
-            a = h5 - h1 - h3;
-            b = h3 - h1;
-            c = h1;
-        }
-    }
+void GridMap::getHeights(float const* x, float const* y, float* heights, uint32 count) const
+{
+    if (m_gridGetHeight == &GridMap::getHeightFromUint16 && m_uint16_V8 && m_uint16_V9)
+        InterpolateGridHeights<uint16, int32>(m_uint16_V9, m_uint16_V8, m_gridIntHeightMultiplier, m_gridHeight, x, y, heights, count);
+    else if (m_gridGetHeight == &GridMap::getHeightFromUint8 && m_uint8_V8 && m_uint8_V9)
+        InterpolateGridHeights<uint8, int32>(m_uint8_V9, m_uint8_V8, m_gridIntHeightMultiplier, m_gridHeight, x, y, heights, count);
+    else if (m_gridGetHeight == &GridMap::getHeightFromFloat && m_V8 && m_V9)
+        InterpolateGridHeights<float, float>(m_V9, m_V8, 1.0f, 0.0f, x, y, heights, count);
     else
-    {
-        if (x > y)
-        {
-            // 3 triangle (h2, h4, h5 points)
-            int32 h2 = V9_h1_ptr[129];
-            int32 h4 = V9_h1_ptr[130];
-            int32 h5 = 2 * m_uint16_V8[x_int * 128 + y_int];
-            a = h2 + h4 - h5;
-            b = h4 - h2;
-            c = h5 - h4;
-        }
-        else
-        {
-            // 4 triangle (h3, h4, h5 points)
-            int32 h3 = V9_h1_ptr[  1];
-            int32 h4 = V9_h1_ptr[130];
-            int32 h5 = 2 * m_uint16_V8[x_int * 128 + y_int];
-            a = h4 - h3;
-            b = h3 + h4 - h5;
-            c = h5 - h4;
-        }
-    }
-
-    // Calculate height
-    return (float)((a * x) + (b * y) + c) * m_gridIntHeightMultiplier + m_gridHeight;
+        std::fill(heights, heights + count, m_gridHeight);
 }
 
 float GridMap::getLiquidLevel(float x, float y)
@@ -662,6 +573,93 @@ bool GridMap::ExistVMap(uint32 mapid, int gx, int gy)
     return true;
 }
 
+//////////////////////////////////////////////////////////////////////////
+
+// terrain of one grid: files are read in a loading thread (or inline without loading threads),
+// shared vmap tree and navmesh are changed only at publishing by the thread needing the grid
+struct TerrainGridLoad
+{
+    TerrainGridLoad(uint32 mapId, uint32 x, uint32 y) : mapId(mapId), x(x), y(y),
+        gridMap(NULL), navData(NULL), navDataSize(0), unusedCleanUps(0) {}
+
+    void Read();
+    void Discard();
+
+    uint32 mapId;
+    uint32 x;
+    uint32 y;
+
+    GridMap* gridMap;
+    std::vector<std::string> vmapModels;                    // with references taken by preloading
+    unsigned char* navData;                                 // NULL if there is no tile
+    uint32 navDataSize;
+
+    uint32 unusedCleanUps;                                  // read ahead but not needed yet
+    ACE_Future<bool> done;
+};
+
+void TerrainGridLoad::Read()
+{
+    // map file name
+    char* tmp = NULL;
+    int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
+    tmp = new char[len];
+    snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), mapId, x, y);
+    sLog.outDetail("Loading map %s", tmp);
+
+    gridMap = new GridMap();
+    if (!gridMap->loadData(tmp))
+    {
+        sLog.outError("Error load map file: \n %s\n", tmp);
+        // ASSERT(false);
+    }
+
+    delete[] tmp;
+
+    // models of VMAPs for the grid, the tile itself is added to the map tree at publishing
+    const MapEntry* i_mapEntry = sMapStore.LookupEntry(mapId);
+    if (i_mapEntry && !i_mapEntry->IsTransport())
+        VMAP::VMapFactory::createOrGetVMapManager()->preloadMap((sWorld.GetDataPath() + "vmaps").c_str(), mapId, x, y, vmapModels);
+
+    // navmesh tile data
+    navData = MMAP::MMapManager::readTile(mapId, x, y, navDataSize);
+}
+
+void TerrainGridLoad::Discard()
+{
+    if (gridMap)
+    {
+        gridMap->unloadData();
+        delete gridMap;
+        gridMap = NULL;
+    }
+
+    VMAP::VMapFactory::createOrGetVMapManager()->releaseModelInstances(vmapModels);
+    vmapModels.clear();
+
+    dtFree(navData);
+    navData = NULL;
+}
+
+// executed by a terrain loading thread
+class TerrainGridLoadRequest : public ACE_Method_Request
+{
+    public:
+        // own reference to the future, the load may be deleted by a waiting thread during set()
+        explicit TerrainGridLoadRequest(TerrainGridLoad* load) : m_load(load), m_done(load->done) {}
+
+        int call()
+        {
+            m_load->Read();
+            m_done.set(true);
+            return 0;
+        }
+
+    private:
+        TerrainGridLoad* m_load;
+        ACE_Future<bool> m_done;
+};
+
 //////////////////////////////////////////////////////////////////////////
 TerrainInfo::TerrainInfo(uint32 mapid) : m_mapId(mapid)
 {
@@ -685,6 +683,15 @@ TerrainInfo::TerrainInfo(uint32 mapid) : m_mapId(mapid)
 
 TerrainInfo::~TerrainInfo()
 {
+    // wait for reads still running in loading threads
+    for (GridLoadMap::const_iterator itr = m_gridLoads.begin(); itr != m_gridLoads.end(); ++itr)
+    {
+        bool done;
+        itr->second->done.get(done);
+        itr->second->Discard();
+        delete itr->second;
+    }
+
     for (int k = 0; k < MAX_NUMBER_OF_GRIDS; ++k)
         for (int i = 0; i < MAX_NUMBER_OF_GRIDS; ++i)
             delete m_GridMaps[i][k];
@@ -734,6 +741,8 @@ void TerrainInfo::CleanUpGrids(const uint32 diff)
     if (!i_timer.Passed())
         return;
 
+    CleanUpGridLoads();
+
     for (int y = 0; y < MAX_NUMBER_OF_GRIDS; ++y)
     {
         for (int x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
@@ -761,6 +770,25 @@ void TerrainInfo::CleanUpGrids(const uint32 diff)
     i_timer.Reset();
 }
 
+void TerrainInfo::CleanUpGridLoads()
+{
+    LOCK_GUARD lock(m_loadMutex);
+
+    // grids read ahead are kept for at least one clean up interval
+    for (GridLoadMap::iterator itr = m_gridLoads.begin(); itr != m_gridLoads.end();)
+    {
+        TerrainGridLoad* load = itr->second;
+        if (load->done.ready() && ++load->unusedCleanUps > 1)
+        {
+            load->Discard();
+            delete load;
+            m_gridLoads.erase(itr++);
+        }
+        else
+            ++itr;
+    }
+}
+
 int TerrainInfo::RefGrid(const uint32& x, const uint32& y)
 {
     MANGOS_ASSERT(x < MAX_NUMBER_OF_GRIDS);
@@ -802,6 +830,12 @@ float TerrainInfo::GetHeightStatic(float x, float y, float z, bool pUseVmaps, fl
     else
         mapHeight = VMAP_INVALID_HEIGHT_VALUE;
 
+    return SelectStaticHeight(x, y, z, mapHeight, pUseVmaps, maxSearchDist);
+}
+
+float TerrainInfo::SelectStaticHeight(float x, float y, float z, float mapHeight, bool pUseVmaps, float maxSearchDist) const
+{
+    float z2 = z + 2.f;
     float vmapHeight;
     if (pUseVmaps)
     {
@@ -847,6 +881,68 @@ float TerrainInfo::GetHeightStatic(float x, float y, float z, bool pUseVmaps, fl
     return mapHeight;
 }
 
+void TerrainInfo::SampleTerrain(TerrainSample* samples, uint32 count, uint32 flags, bool pUseVmaps, float maxSearchDist) const
+{
+    if (flags & TERRAIN_SAMPLE_HEIGHT)
+    {
+        // paths and splines have many points in a row on one grid, these go to the grid kernel at once
+        const uint32 chunkSize = 64;
+        float xs[chunkSize];
+        float ys[chunkSize];
+        float heights[chunkSize];
+
+        for (uint32 i = 0; i < count;)
+        {
+            int gx = (int)(32 - samples[i].x / SIZE_OF_GRIDS);
+            int gy = (int)(32 - samples[i].y / SIZE_OF_GRIDS);
+
+            uint32 n = 0;
+            for (; n < chunkSize && i + n < count; ++n)
+            {
+                TerrainSample const& sample = samples[i + n];
+                if ((int)(32 - sample.x / SIZE_OF_GRIDS) != gx || (int)(32 - sample.y / SIZE_OF_GRIDS) != gy)
+                    break;
+
+                xs[n] = sample.x;
+                ys[n] = sample.y;
+            }
+
+            GridMap* gmap = const_cast<TerrainInfo*>(this)->GetGrid(samples[i].x, samples[i].y);
+            if (gmap)
+                gmap->getHeights(xs, ys, heights, n);
+
+            for (uint32 j = 0; j < n; ++j)
+            {
+                TerrainSample& sample = samples[i + j];
+
+                // look from a bit higher pos to find the floor, ignore under surface case
+                float mapHeight = gmap && sample.z + 2.f > heights[j] ? heights[j] : VMAP_INVALID_HEIGHT_VALUE;
+                sample.height = SelectStaticHeight(sample.x, sample.y, sample.z, mapHeight, pUseVmaps, maxSearchDist);
+            }
+
+            i += n;
+        }
+    }
+
+    if (flags & (TERRAIN_SAMPLE_LIQUID | TERRAIN_SAMPLE_AREA))
+    {
+        for (uint32 i = 0; i < count; ++i)
+        {
+            TerrainSample& sample = samples[i];
+
+            if (flags & TERRAIN_SAMPLE_LIQUID)
+            {
+                GridMapLiquidData liquid;
+                sample.liquidStatus = getLiquidStatus(sample.x, sample.y, sample.z, MAP_ALL_LIQUIDS, &liquid);
+                sample.liquidLevel = sample.liquidStatus != LIQUID_MAP_NO_WATER ? liquid.level : INVALID_HEIGHT_VALUE;
+            }
+
+            if (flags & TERRAIN_SAMPLE_AREA)
+                sample.areaFlag = GetAreaFlag(sample.x, sample.y, sample.z);
+        }
+    }
+}
+
 inline bool IsOutdoorWMO(uint32 mogpFlags, int32 adtId, int32 rootId, int32 groupId,
                          WMOAreaTableEntry const* wmoEntry, AreaTableEntry const* atEntry)
 {
@@ -1174,6 +1270,10 @@ GridMap* TerrainInfo::GetGrid(const float x, const float y)
 
 GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y)
 {
+    static MetricCounter* foundRead = sMetrics.GetCounter("mangos_terrain_grid_loads_total", "Grid terrain loads by the state found when the grid was needed", "state=\"read\"");
+    static MetricCounter* foundReading = sMetrics.GetCounter("mangos_terrain_grid_loads_total", "Grid terrain loads by the state found when the grid was needed", "state=\"reading\"");
+    static MetricCounter* notFound = sMetrics.GetCounter("mangos_terrain_grid_loads_total", "Grid terrain loads by the state found when the grid was needed", "state=\"none\"");
+
     // double checked lock pattern
     if (!m_GridMaps[x][y])
     {
@@ -1181,50 +1281,131 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y)
 
         if (!m_GridMaps[x][y])
         {
-            GridMap* map = new GridMap();
-
-            // map file name
-            char* tmp = NULL;
-            int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
-            tmp = new char[len];
-            snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), m_mapId, x, y);
-            sLog.outDetail("Loading map %s", tmp);
-
-            if (!map->loadData(tmp))
+            TerrainGridLoad* load = NULL;
             {
-                sLog.outError("Error load map file: \n %s\n", tmp);
-                // ASSERT(false);
+                LOCK_GUARD loadLock(m_loadMutex);
+                GridLoadMap::iterator itr = m_gridLoads.find(MAX_NUMBER_OF_GRIDS * x + y);
+                if (itr != m_gridLoads.end())
+                {
+                    load = itr->second;
+                    m_gridLoads.erase(itr);
+                }
             }
 
-            delete[] tmp;
-            m_GridMaps[x][y] = map;
-
-            // load VMAPs for current map/grid...
-            const MapEntry* i_mapEntry = sMapStore.LookupEntry(m_mapId);
-            const char* mapName = i_mapEntry ? i_mapEntry->name[sWorld.GetDefaultDbcLocale()] : "UNNAMEDMAP\x0";
+            if (load)
+            {
+                (load->done.ready() ? foundRead : foundReading)->Inc();
 
-            int vmapLoadResult = i_mapEntry->IsTransport() ? VMAP::VMAP_LOAD_RESULT_IGNORED : VMAP::VMapFactory::createOrGetVMapManager()->loadMap((sWorld.GetDataPath()+ "vmaps").c_str(),  m_mapId, x, y);
-            switch (vmapLoadResult)
+                bool done;
+                load->done.get(done);
+            }
+            else
             {
-                case VMAP::VMAP_LOAD_RESULT_OK:
-                    sLog.outDetail("VMAP loaded name:%s, id:%d, x:%d, y:%d (vmap rep.: x:%d, y:%d)", mapName, m_mapId, x, y, x, y);
-                    break;
-                case VMAP::VMAP_LOAD_RESULT_ERROR:
-                    sLog.outDetail("Could not load VMAP name:%s, id:%d, x:%d, y:%d (vmap rep.: x:%d, y:%d)", mapName, m_mapId, x, y, x, y);
-                    break;
-                case VMAP::VMAP_LOAD_RESULT_IGNORED:
-                    DEBUG_LOG("Ignored VMAP name:%s, id:%d, x:%d, y:%d (vmap rep.: x:%d, y:%d)", mapName, m_mapId, x, y, x, y);
-                    break;
+                notFound->Inc();
+
+                load = new TerrainGridLoad(m_mapId, x, y);
+                load->Read();
             }
 
-            // load navmesh
-            MMAP::MMapFactory::createOrGetMMapManager()->loadMap(m_mapId, x, y);
+            PublishGrid(load);
+            delete load;
         }
     }
 
     return  m_GridMaps[x][y];
 }
 
+void TerrainInfo::PublishGrid(TerrainGridLoad* load)
+{
+    const uint32 x = load->x;
+    const uint32 y = load->y;
+
+    // load VMAPs for current map/grid...
+    const MapEntry* i_mapEntry = sMapStore.LookupEntry(m_mapId);
+    const char* mapName = i_mapEntry ? i_mapEntry->name[sWorld.GetDefaultDbcLocale()] : "UNNAMEDMAP\x0";
+
+    // models are referenced by the load already, so only the map tree is updated
+    int vmapLoadResult = !i_mapEntry || i_mapEntry->IsTransport() ? VMAP::VMAP_LOAD_RESULT_IGNORED : VMAP::VMapFactory::createOrGetVMapManager()->loadMap((sWorld.GetDataPath()+ "vmaps").c_str(),  m_mapId, x, y);
+    switch (vmapLoadResult)
+    {
+        case VMAP::VMAP_LOAD_RESULT_OK:
+            sLog.outDetail("VMAP loaded name:%s, id:%d, x:%d, y:%d (vmap rep.: x:%d, y:%d)", mapName, m_mapId, x, y, x, y);
+            break;
+        case VMAP::VMAP_LOAD_RESULT_ERROR:
+            sLog.outDetail("Could not load VMAP name:%s, id:%d, x:%d, y:%d (vmap rep.: x:%d, y:%d)", mapName, m_mapId, x, y, x, y);
+            break;
+        case VMAP::VMAP_LOAD_RESULT_IGNORED:
+            DEBUG_LOG("Ignored VMAP name:%s, id:%d, x:%d, y:%d (vmap rep.: x:%d, y:%d)", mapName, m_mapId, x, y, x, y);
+            break;
+    }
+
+    VMAP::VMapFactory::createOrGetVMapManager()->releaseModelInstances(load->vmapModels);
+    load->vmapModels.clear();
+
+    // load navmesh, data is taken over
+    if (load->navData)
+        MMAP::MMapFactory::createOrGetMMapManager()->loadMap(m_mapId, x, y, load->navData, load->navDataSize);
+    load->navData = NULL;
+
+    // grid is visible to other threads complete only
+    m_GridMaps[x][y] = load->gridMap;
+    load->gridMap = NULL;
+}
+
+void TerrainInfo::PreloadGrid(float x, float y)
+{
+    int gx = (int)(32 - x / SIZE_OF_GRIDS);                 // grid x
+    int gy = (int)(32 - y / SIZE_OF_GRIDS);                 // grid y
+
+    if (gx >= MAX_NUMBER_OF_GRIDS || gy >= MAX_NUMBER_OF_GRIDS ||
+        gx < 0 || gy < 0)
+        return;
+
+    // quick check if GridMap already loaded
+    if (m_GridMaps[gx][gy] || !sTerrainMgr.HasLoadThreads())
+        return;
+
+    LOCK_GUARD lock(m_loadMutex);
+
+    if (m_GridMaps[gx][gy])
+        return;
+
+    TerrainGridLoad*& load = m_gridLoads[MAX_NUMBER_OF_GRIDS * gx + gy];
+    if (load)
+    {
+        load->unusedCleanUps = 0;
+        return;
+    }
+
+    load = new TerrainGridLoad(m_mapId, gx, gy);
+    if (!sTerrainMgr.ScheduleGridLoad(load))
+    {
+        delete load;
+        m_gridLoads.erase(MAX_NUMBER_OF_GRIDS * gx + gy);
+    }
+}
+
+void TerrainInfo::PreloadArea(float x, float y, float radius)
+{
+    // with radius up to grid size corners of the square hit all grids in range
+    if (radius > SIZE_OF_GRIDS)
+        radius = SIZE_OF_GRIDS;
+
+    PreloadGrid(x - radius, y - radius);
+    PreloadGrid(x - radius, y + radius);
+    PreloadGrid(x + radius, y - radius);
+    PreloadGrid(x + radius, y + radius);
+}
+
+void TerrainInfo::ReadAhead(float x, float y, float orientation)
+{
+    float distance = sWorld.getConfig(CONFIG_FLOAT_TERRAIN_READ_AHEAD_DISTANCE);
+    if (distance <= 0.0f)
+        return;
+
+    PreloadGrid(x + distance * cos(orientation), y + distance * sin(orientation));
+}
+
 float TerrainInfo::GetWaterLevel(float x, float y, float z, float* pGround /*= NULL*/) const
 {
     if (const_cast<TerrainInfo*>(this)->GetGrid(x, y))
@@ -1259,6 +1440,7 @@ INSTANTIATE_CLASS_MUTEX(TerrainManager, ACE_Thread_Mutex);
 
 TerrainManager::TerrainManager()
 {
+    m_modelUnloadTimer.SetInterval(IN_MILLISECONDS);
 }
 
 TerrainManager::~TerrainManager()
@@ -1309,6 +1491,15 @@ void TerrainManager::Update(const uint32 diff)
     // global garbage collection for GridMap objects and VMaps
     for (TerrainDataMap::iterator iter = i_TerrainMap.begin(); iter != i_TerrainMap.end(); ++iter)
         iter->second->CleanUpGrids(diff);
+
+    // map threads are done, no model is queried now
+    m_modelUnloadTimer.Update(diff);
+    if (m_modelUnloadTimer.Passed())
+    {
+        m_modelUnloadTimer.Reset();
+        size_t budget = size_t(sWorld.getConfig(CONFIG_UINT32_VMAP_MODEL_MEMORY_BUDGET)) * 1024 * 1024;
+        VMAP::VMapFactory::createOrGetVMapManager()->unloadUnusedModelGroups(budget);
+    }
 }
 
 void TerrainManager::UnloadAll()
@@ -1317,6 +1508,29 @@ void TerrainManager::UnloadAll()
         delete it->second;
 
     i_TerrainMap.clear();
+
+    // no reads are left, all terrain waited for them
+    if (m_loadExecutor.activated())
+        m_loadExecutor.deactivate();
+}
+
+void TerrainManager::StartLoadThreads(uint32 threads)
+{
+    if (!threads || m_loadExecutor.activated())
+        return;
+
+    if (m_loadExecutor.activate(threads) == -1)
+        sLog.outError("TerrainManager: can't start %u terrain loading threads, grids are read by map threads", threads);
+    else
+        sLog.outString("Started %u terrain loading threads", threads);
+}
+
+bool TerrainManager::ScheduleGridLoad(TerrainGridLoad* load)
+{
+    if (!m_loadExecutor.activated())
+        return false;
+
+    return m_loadExecutor.execute(new TerrainGridLoadRequest(load)) == 0;
 }
 
 uint32 TerrainManager::GetAreaIdByAreaFlag(uint16 areaflag, uint32 map_id)
@@ -25,6 +25,8 @@
 #include "GridDefines.h"
 #include "Object.h"
 #include "SharedDefines.h"
+#include "DelayExecutor.h"
+#include "Timer.h"
 
 #include <bitset>
 #include <list>
@@ -36,6 +38,7 @@ class InstanceData;
 class Group;
 class BattleGround;
 class Map;
+struct TerrainGridLoad;
 
 struct GridMapFileHeader
 {
@@ -178,11 +181,36 @@ class GridMap
 
         uint16 getArea(float x, float y);
         float getHeight(float x, float y) { return (this->*m_gridGetHeight)(x, y); }
+        // heights of count points of this grid, with storage type resolved once for the whole batch
+        void getHeights(float const* x, float const* y, float* heights, uint32 count) const;
         float getLiquidLevel(float x, float y);
         uint8 getTerrainType(float x, float y);
         GridMapLiquidStatus getLiquidStatus(float x, float y, float z, uint8 ReqLiquidType, GridMapLiquidData *data = 0);
 };
 
+enum TerrainSampleFlags
+{
+    TERRAIN_SAMPLE_HEIGHT   = 0x01,                         // ground height, as GetHeightStatic
+    TERRAIN_SAMPLE_LIQUID   = 0x02,                         // liquid status and level of any liquid type
+    TERRAIN_SAMPLE_AREA     = 0x04,                         // area flag
+    TERRAIN_SAMPLE_ALL      = TERRAIN_SAMPLE_HEIGHT | TERRAIN_SAMPLE_LIQUID | TERRAIN_SAMPLE_AREA
+};
+
+// one point of a batched terrain query, see TerrainInfo::SampleTerrain
+struct TerrainSample
+{
+    TerrainSample() : x(0.0f), y(0.0f), z(0.0f), height(INVALID_HEIGHT_VALUE),
+        liquidStatus(LIQUID_MAP_NO_WATER), liquidLevel(INVALID_HEIGHT_VALUE), areaFlag(0) {}
+    TerrainSample(float _x, float _y, float _z) : x(_x), y(_y), z(_z), height(INVALID_HEIGHT_VALUE),
+        liquidStatus(LIQUID_MAP_NO_WATER), liquidLevel(INVALID_HEIGHT_VALUE), areaFlag(0) {}
+
+    float x, y, z;                                          // z is the position the height search starts from
+    float height;
+    GridMapLiquidStatus liquidStatus;
+    float liquidLevel;
+    uint16 areaFlag;
+};
+
 template<typename Countable>
 class MANGOS_DLL_SPEC Referencable
 {
@@ -212,6 +240,8 @@ public:
     uint32 GetMapId() const { return m_mapId; }
 
     float GetHeightStatic(float x, float y, float z, bool pCheckVMap=true, float maxSearchDist=DEFAULT_HEIGHT_SEARCH) const;
+    // fills requested TerrainSampleFlags data of count points, consecutive points of one grid are sampled together
+    void SampleTerrain(TerrainSample* samples, uint32 count, uint32 flags, bool pCheckVMap=true, float maxSearchDist=DEFAULT_HEIGHT_SEARCH) const;
     float GetWaterLevel(float x, float y, float z, float* pGround = NULL) const;
     float GetWaterOrGroundLevel(float x, float y, float z, float* pGround = NULL, bool swim = false) const;
     bool IsInWater(float x, float y, float z, GridMapLiquidData *data = 0, float min_depth = 2.0f) const;
@@ -232,6 +262,11 @@ public:
 
     bool IsNextZcoordOK(float x, float y, float oldZ, float maxDiff = 5.0f) const;
 
+    //start reading terrain files of grids in a loading thread, before a map thread needs them
+    void PreloadGrid(float x, float y);
+    void PreloadArea(float x, float y, float radius);
+    void ReadAhead(float x, float y, float orientation);
+
     //this method should be used only by TerrainManager
     //to cleanup unreferenced GridMap objects - they are too heavy
     //to destroy them dynamically, especially on highly populated servers
@@ -250,6 +285,11 @@ private:
 
     GridMap * GetGrid( const float x, const float y );
     GridMap * LoadMapAndVMap(const uint32 x, const uint32 y );
+    void PublishGrid(TerrainGridLoad* load);
+    void CleanUpGridLoads();
+
+    // selects between raw .map height (or INVALID_HEIGHT_VALUE) and vmap height below z
+    float SelectStaticHeight(float x, float y, float z, float mapHeight, bool pUseVmaps, float maxSearchDist) const;
 
     int RefGrid(const uint32& x, const uint32& y);
     int UnrefGrid(const uint32& x, const uint32& y);
@@ -266,6 +306,11 @@ private:
     typedef ACE_Guard<LOCK_TYPE> LOCK_GUARD;
     LOCK_TYPE m_mutex;
     LOCK_TYPE m_refMutex;
+
+    //grid loads started in loading threads and not yet published, by packed grid coordinates
+    typedef UNORDERED_MAP<uint32, TerrainGridLoad*> GridLoadMap;
+    GridLoadMap m_gridLoads;
+    LOCK_TYPE m_loadMutex;                                  // guards m_gridLoads
 };
 
 //class for managing TerrainData object and all sort of geometry querying operations
@@ -281,6 +326,11 @@ public:
     void Update(const uint32 diff);
     void UnloadAll();
 
+    //threads reading terrain files of grids, without them grids are read by the thread needing them
+    void StartLoadThreads(uint32 threads);
+    bool HasLoadThreads() { return m_loadExecutor.activated(); }
+    bool ScheduleGridLoad(TerrainGridLoad* load);
+
     uint16 GetAreaFlag(uint32 mapid, float x, float y, float z) const
     {
         TerrainInfo* pData = const_cast<TerrainManager*>(this)->LoadTerrain(mapid);
@@ -312,6 +362,9 @@ private:
 
     typedef MaNGOS::ClassLevelLockable<TerrainManager, ACE_Thread_Mutex>::Lock Guard;
     TerrainDataMap i_TerrainMap;
+
+    DelayExecutor m_loadExecutor;
+    IntervalTimer m_modelUnloadTimer;                       // groups of world models not queried in an interval are unloaded first
 };
 
 #define sTerrainMgr TerrainManager::Instance()
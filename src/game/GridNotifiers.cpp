@@ -127,6 +127,48 @@ void MessageDelivererExcept::Visit(CameraMapType& m)
     }
 }
 
+MovementRelayDeliverer::MovementRelayDeliverer(WorldObject const& mover, WorldPacket const& packet, Player const* skipped, uint32 tierMask)
+    : i_mover(mover), i_packet(packet), i_message(packet), i_skipped_receiver(skipped), i_tierMask(tierMask),
+    i_queue(sWorld.getConfig(CONFIG_BOOL_MOVEMENT_RELAY_COALESCE)), i_sent(0), i_skipped(0)
+{
+    float nearDist = sWorld.getConfig(CONFIG_FLOAT_MOVEMENT_RELAY_NEAR_DISTANCE);
+    float farDist = sWorld.getConfig(CONFIG_FLOAT_MOVEMENT_RELAY_FAR_DISTANCE);
+    i_nearDistSq = nearDist * nearDist;
+    i_farDistSq = farDist * farDist;
+}
+
+void MovementRelayDeliverer::Visit(CameraMapType& m)
+{
+    for (CameraMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
+    {
+        Player* owner = iter->getSource()->GetOwner();
+
+        if (!owner->InSamePhase(i_mover.GetPhaseMask()) || owner == i_skipped_receiver)
+            continue;
+
+        WorldObject const* body = iter->getSource()->GetBody();
+        float dx = body->GetPositionX() - i_mover.GetPositionX();
+        float dy = body->GetPositionY() - i_mover.GetPositionY();
+        float distSq = dx * dx + dy * dy;
+
+        MovementRelayTier tier = distSq < i_nearDistSq ? MOVEMENT_RELAY_NEAR : (distSq < i_farDistSq ? MOVEMENT_RELAY_MID : MOVEMENT_RELAY_FAR);
+        if (!(i_tierMask & (1 << tier)))
+        {
+            ++i_skipped;
+            continue;
+        }
+
+        if (WorldSession* session = owner->GetSession())
+        {
+            if (i_queue)
+                session->QueueMovement(i_packet);
+            else
+                session->SendPacket(i_message);
+            ++i_sent;
+        }
+    }
+}
+
 void ObjectMessageDeliverer::Visit(CameraMapType& m)
 {
     for (CameraMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
@@ -180,6 +222,7 @@ void ObjectUpdater::Visit(GridRefManager<T>& m)
     {
         WorldObject::UpdateHelper helper(iter->getSource());
         helper.Update(i_timeDiff);
+        ++i_updated;
     }
 }
 
@@ -47,11 +47,19 @@ inline void MaNGOS::ObjectUpdater::Visit(CreatureMapType& m)
     uint32  minUpdateTime = 0;
     uint32  visitorsCount = 0;
     uint8   visitCount = 1;
+    uint32  now = WorldTimer::getMSTime();
     std::vector<uint32> lastUpdateTimeList;
     lastUpdateTimeList.clear();
 
     for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
     {
+        // sleeping creatures don't take update slots of the others
+        if (iter->getSource()->IsIdleSleeping(now))
+        {
+            ++i_skipped;
+            continue;
+        }
+
         ++visitorsCount;
         lastUpdateTime = iter->getSource()->GetLastUpdateTime();
         if (lastUpdateTime == 0)
@@ -84,6 +92,9 @@ inline void MaNGOS::ObjectUpdater::Visit(CreatureMapType& m)
 
     for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
     {
+        if (iter->getSource()->IsIdleSleeping(now))
+            continue;
+
         lastUpdateTime = iter->getSource()->GetLastUpdateTime();
         diffTime = WorldTimer::getMSTimeDiff(lastUpdateTime, WorldTimer::getMSTime());
 
@@ -95,6 +106,7 @@ inline void MaNGOS::ObjectUpdater::Visit(CreatureMapType& m)
         WorldObject::UpdateHelper helper(iter->getSource());
         helper.Update(diffTime);
         iter->getSource()->SetLastUpdateTime();
+        ++i_updated;
         visitCount++;
         if (visitCount > sWorld.getConfig(CONFIG_UINT32_MAPUPDATE_MAXVISITS))
             break;
@@ -103,6 +115,10 @@ inline void MaNGOS::ObjectUpdater::Visit(CreatureMapType& m)
 
 inline void PlayerCreatureRelocationWorker(Player* pl, Creature* c)
 {
+    // player near sleeping creature, it must see him at usual update rate
+    if (c->IsWithinDistInMap(pl, sWorld.getConfig(CONFIG_FLOAT_CREATURE_IDLE_WAKE_RADIUS)))
+        c->WakeUp(true);
+
     // Creature AI reaction
     if (!c->hasUnitState(UNIT_STAT_LOST_CONTROL))
     {
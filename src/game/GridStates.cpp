@@ -47,8 +47,9 @@ ActiveState::Update(Map& m, NGridType& grid, GridInfo& info, const uint32& x, co
 }
 
 void
-IdleState::Update(Map& m, NGridType& grid, GridInfo&, const uint32& x, const uint32& y, const uint32&) const
+IdleState::Update(Map& m, NGridType& grid, GridInfo& info, const uint32& x, const uint32& y, const uint32&) const
 {
+    info.newUnloadGeneration();
     m.ResetGridExpiry(grid);
     grid.SetGridState(GRID_STATE_REMOVAL);
     DEBUG_LOG("Grid[%u,%u] on map %u moved to IDLE state", x, y, m.GetId());
@@ -62,7 +63,7 @@ RemovalState::Update(Map& m, NGridType& grid, GridInfo& info, const uint32& x, c
         info.UpdateTimeTracker(t_diff);
         if (info.getTimeTracker().Passed())
         {
-            if (!m.UnloadGrid(x, y, false))
+            if (!m.QueueGridUnload(x, y))
             {
                 DEBUG_LOG("Grid[%u,%u] for map %u differed unloading due to players or active objects nearby", x, y, m.GetId());
                 m.ResetGridExpiry(grid);
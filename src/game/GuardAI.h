@@ -44,6 +44,7 @@ class MANGOS_DLL_DECL GuardAI : public CreatureAI
         bool IsVisible(Unit*) const;
 
         void UpdateAI(const uint32);
+        bool HasOutOfCombatUpdate() const { return false; }
         static int Permissible(const Creature*);
 
     private:
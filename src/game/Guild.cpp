@@ -18,6 +18,7 @@
 
 #include "Database/DatabaseEnv.h"
 #include "WorldPacket.h"
+#include "SharedWorldPacket.h"
 #include "WorldSession.h"
 #include "Player.h"
 #include "Opcodes.h"
@@ -224,6 +225,9 @@ bool Guild::AddMember(ObjectGuid plGuid, uint32 plRank)
         newmember.BankResetTimeTab[i] = 0;
     members[lowguid] = newmember;
 
+    // guild is shown in the character list
+    sWorld.InvalidateCharEnum(newmember.accountId);
+
     std::string dbPnote   = newmember.Pnote;
     std::string dbOFFnote = newmember.OFFnote;
     CharacterDatabase.escape_string(dbPnote);
@@ -543,7 +547,13 @@ bool Guild::DelMember(ObjectGuid guid, bool isDisbanding)
         }
     }
 
-    members.erase(lowguid);
+    MemberList::iterator itr = members.find(lowguid);
+    if (itr != members.end())
+    {
+        // guild is shown in the character list
+        sWorld.InvalidateCharEnum(itr->second.accountId);
+        members.erase(itr);
+    }
 
     Player* player = sObjectMgr.GetPlayer(guid);
     // If player not online data in data field will be loaded from guild tabs no need to update it !!
@@ -597,11 +607,13 @@ void Guild::BroadcastToOfficers(WorldSession* session, const std::string& msg, u
 
 void Guild::BroadcastPacket(WorldPacket* packet)
 {
+    SharedWorldPacket sharedPacket(*packet);
+
     for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
     {
         Player* player = ObjectAccessor::FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
         if (player)
-            player->GetSession()->SendPacket(packet);
+            player->GetSession()->SendPacket(sharedPacket);
     }
 }
 
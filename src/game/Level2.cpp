@@ -4052,6 +4052,7 @@ bool ChatHandler::HandleCharacterRenameCommand(char* args)
 
         PSendSysMessage(LANG_RENAME_PLAYER_GUID, oldNameLink.c_str(), target_guid.GetCounter());
         CharacterDatabase.PExecute("UPDATE characters SET at_login = at_login | '1' WHERE guid = '%u'", target_guid.GetCounter());
+        sWorld.InvalidateCharEnum(sAccountMgr.GetPlayerAccountIdByGUID(target_guid));
     }
 
     return true;
@@ -4078,6 +4079,7 @@ bool ChatHandler::HandleCharacterCustomizeCommand(char* args)
 
         PSendSysMessage(LANG_CUSTOMIZE_PLAYER_GUID, oldNameLink.c_str(), target_guid.GetCounter());
         CharacterDatabase.PExecute("UPDATE characters SET at_login = at_login | '8' WHERE guid = '%u'", target_guid.GetCounter());
+        sWorld.InvalidateCharEnum(sAccountMgr.GetPlayerAccountIdByGUID(target_guid));
     }
 
     return true;
@@ -4107,6 +4109,7 @@ bool ChatHandler::HandleCharacterChangeFactionCommand(char* args)
         // TODO : add text into database
         PSendSysMessage(LANG_CUSTOMIZE_PLAYER_GUID, oldNameLink.c_str(), target_guid.GetCounter());
         CharacterDatabase.PExecute("UPDATE characters SET at_login = at_login | '320' WHERE guid = '%u'", target_guid.GetCounter());
+        sWorld.InvalidateCharEnum(sAccountMgr.GetPlayerAccountIdByGUID(target_guid));
     }
 
     return true;
@@ -4135,6 +4138,7 @@ bool ChatHandler::HandleCharacterChangeRaceCommand(char* args)
         // TODO : add text into database
         PSendSysMessage(LANG_CUSTOMIZE_PLAYER_GUID, oldNameLink.c_str(), target_guid.GetCounter());
         CharacterDatabase.PExecute("UPDATE characters SET at_login = at_login | '128' WHERE guid = '%u'", target_guid.GetCounter());
+        sWorld.InvalidateCharEnum(sAccountMgr.GetPlayerAccountIdByGUID(target_guid));
     }
 
     return true;
@@ -4158,6 +4162,27 @@ bool ChatHandler::HandleCharacterReputationCommand(char* args)
     return true;
 }
 
+bool ChatHandler::HandleCharacterMemoryCommand(char* args)
+{
+    Player* target;
+    if (!ExtractPlayerTarget(&args, &target))
+        return false;
+
+    PlayerMemoryUsage usage;
+    target->GetMemoryUsage(usage);
+
+    PSendSysMessage("Memory of player %s (estimated, in bytes):", GetNameLink(target).c_str());
+    PSendSysMessage("object     " SIZEFMTD, usage.object);
+    PSendSysMessage("spells     " SIZEFMTD, usage.spells);
+    PSendSysMessage("quests     " SIZEFMTD, usage.quests);
+    PSendSysMessage("auras      " SIZEFMTD, usage.auras);
+    PSendSysMessage("items      " SIZEFMTD, usage.items);
+    PSendSysMessage("visibility " SIZEFMTD, usage.visibility);
+    PSendSysMessage("other      " SIZEFMTD, usage.other);
+    PSendSysMessage("total      " SIZEFMTD, usage.GetTotal());
+    return true;
+}
+
 // change standstate
 bool ChatHandler::HandleModifyStandStateCommand(char* args)
 {
@@ -56,6 +56,8 @@
 #include "DBCEnums.h"
 #include "AuctionHouseBot/AuctionHouseBot.h"
 #include "SQLStorages.h"
+#include "WorldProfiler.h"
+#include "OpcodeWorkerPool.h"
 
 static uint32 ahbotQualityIds[MAX_AUCTION_QUALITY] =
 {
@@ -828,6 +830,7 @@ bool ChatHandler::HandleReloadSpellPetAurasCommand(char* /*args*/)
 bool ChatHandler::HandleReloadPageTextsCommand(char* /*args*/)
 {
     sLog.outString("Re-Loading Page Texts...");
+    OpcodeStoreWriteGuard guard(sOpcodeWorkerPool.GetStoreLock());
     sObjectMgr.LoadPageTexts();
     SendGlobalSysMessage("DB table `page_texts` reloaded.");
     return true;
@@ -1032,6 +1035,7 @@ bool ChatHandler::HandleReloadLocalesAchievementRewardCommand(char* /*args*/)
 bool ChatHandler::HandleReloadLocalesCreatureCommand(char* /*args*/)
 {
     sLog.outString("Re-Loading Locales Creature ...");
+    OpcodeStoreWriteGuard guard(sOpcodeWorkerPool.GetStoreLock());
     sObjectMgr.LoadCreatureLocales();
     SendGlobalSysMessage("DB table `locales_creature` reloaded.");
     return true;
@@ -1040,6 +1044,7 @@ bool ChatHandler::HandleReloadLocalesCreatureCommand(char* /*args*/)
 bool ChatHandler::HandleReloadLocalesGameobjectCommand(char* /*args*/)
 {
     sLog.outString("Re-Loading Locales Gameobject ... ");
+    OpcodeStoreWriteGuard guard(sOpcodeWorkerPool.GetStoreLock());
     sObjectMgr.LoadGameObjectLocales();
     SendGlobalSysMessage("DB table `locales_gameobject` reloaded.");
     return true;
@@ -1056,6 +1061,7 @@ bool ChatHandler::HandleReloadLocalesGossipMenuOptionCommand(char* /*args*/)
 bool ChatHandler::HandleReloadLocalesItemCommand(char* /*args*/)
 {
     sLog.outString("Re-Loading Locales Item ... ");
+    OpcodeStoreWriteGuard guard(sOpcodeWorkerPool.GetStoreLock());
     sObjectMgr.LoadItemLocales();
     SendGlobalSysMessage("DB table `locales_item` reloaded.");
     return true;
@@ -1072,6 +1078,7 @@ bool ChatHandler::HandleReloadLocalesNpcTextCommand(char* /*args*/)
 bool ChatHandler::HandleReloadLocalesPageTextCommand(char* /*args*/)
 {
     sLog.outString("Re-Loading Locales Page Text ... ");
+    OpcodeStoreWriteGuard guard(sOpcodeWorkerPool.GetStoreLock());
     sObjectMgr.LoadPageTextLocales();
     SendGlobalSysMessage("DB table `locales_page_text` reloaded.");
     return true;
@@ -4484,6 +4491,7 @@ void ChatHandler::HandleCharacterLevel(Player* player, ObjectGuid player_guid, u
     {
         // update level and XP at level, all other will be updated at loading
         CharacterDatabase.PExecute("UPDATE characters SET level = '%u', xp = 0 WHERE guid = '%u'", newlevel, player_guid.GetCounter());
+        sWorld.InvalidateCharEnum(sAccountMgr.GetPlayerAccountIdByGUID(player_guid));
     }
 }
 
@@ -5268,6 +5276,7 @@ bool ChatHandler::HandleResetAllCommand(char* args)
     }
 
     CharacterDatabase.PExecute("UPDATE characters SET at_login = at_login | '%u' WHERE (at_login & '%u') = '0'", atLogin, atLogin);
+    sWorld.ClearCharEnumCache();
     HashMapHolder<Player>::MapType const& plist = sObjectAccessor.GetPlayers();
     for (HashMapHolder<Player>::MapType::const_iterator itr = plist.begin(); itr != plist.end(); ++itr)
         itr->second->SetAtLoginFlag(atLogin);
@@ -6135,6 +6144,7 @@ bool ChatHandler::HandlePDumpLoadCommand(char* args)
     switch (PlayerDumpReader().LoadDump(file, account_id, name, lowguid))
     {
         case DUMP_SUCCESS:
+            sWorld.InvalidateCharEnum(account_id);
             PSendSysMessage(LANG_COMMAND_IMPORT_SUCCESS);
             break;
         case DUMP_FILE_OPEN_ERROR:
@@ -6355,6 +6365,89 @@ bool ChatHandler::HandleServerPLimitCommand(char* args)
     return true;
 }
 
+struct ProfileMapOrder
+{
+    bool operator()(std::pair<uint32, ProfileHistogram const*> const& a, std::pair<uint32, ProfileHistogram const*> const& b) const
+    {
+        return a.second->total > b.second->total;
+    }
+};
+
+struct ProfileOpcodeOrder
+{
+    bool operator()(ProfileOpcodeStats const& a, ProfileOpcodeStats const& b) const { return a.total > b.total; }
+};
+
+bool ChatHandler::HandleServerProfileCommand(char* args)
+{
+    if (*args)
+    {
+        bool value;
+        if (ExtractLiteralArg(&args, "reset"))
+        {
+            WorldProfiler::Reset();
+            SendSysMessage("World tick profile reset.");
+            return true;
+        }
+        else if (ExtractOnOff(&args, value))
+        {
+            WorldProfiler::SetEnabled(value);
+            PSendSysMessage("World tick profile collection %s.", value ? "enabled" : "disabled");
+            return true;
+        }
+
+        return false;
+    }
+
+    ProfileSnapshot snapshot;
+    WorldProfiler::GetSnapshot(snapshot);
+
+    PSendSysMessage("World tick profile (collection %s, slow tick dump %u ms), %u ticks, times per tick in ms:",
+        WorldProfiler::IsEnabled() ? "enabled" : "disabled", WorldProfiler::GetSlowTickThreshold(), snapshot.ticks);
+
+    if (!snapshot.ticks)
+        return true;
+
+    for (int i = 0; i < MAX_PROFILE_SUBSYSTEM; ++i)
+    {
+        ProfileHistogram const& histogram = snapshot.subsystems[i];
+        PSendSysMessage("%-14s avg %7.2f p50 %7.2f p95 %7.2f p99 %7.2f max %7.2f",
+            WorldProfiler::GetSubsystemName(ProfileSubsystem(i)), histogram.GetAverage() / 1000.0f,
+            histogram.GetPercentile(50.0f) / 1000.0f, histogram.GetPercentile(95.0f) / 1000.0f,
+            histogram.GetPercentile(99.0f) / 1000.0f, histogram.max / 1000.0f);
+    }
+
+    std::vector<std::pair<uint32, ProfileHistogram const*> > maps;
+    for (std::map<uint32, ProfileHistogram>::const_iterator itr = snapshot.maps.begin(); itr != snapshot.maps.end(); ++itr)
+        maps.push_back(std::make_pair(itr->first, &itr->second));
+    std::sort(maps.begin(), maps.end(), ProfileMapOrder());
+
+    SendSysMessage("Maps with highest update time (all instances of a map summed):");
+    for (uint32 i = 0; i < maps.size() && i < 10; ++i)
+    {
+        ProfileHistogram const& histogram = *maps[i].second;
+        MapEntry const* entry = sMapStore.LookupEntry(maps[i].first);
+
+        PSendSysMessage("%u (%s): updated in %u ticks, avg %.2f p95 %.2f p99 %.2f max %.2f",
+            maps[i].first, entry ? entry->name[GetSessionDbcLocale()] : "<unknown>", uint32(histogram.count),
+            histogram.GetAverage() / 1000.0f, histogram.GetPercentile(95.0f) / 1000.0f,
+            histogram.GetPercentile(99.0f) / 1000.0f, histogram.max / 1000.0f);
+    }
+
+    std::sort(snapshot.opcodes.begin(), snapshot.opcodes.end(), ProfileOpcodeOrder());
+
+    SendSysMessage("Opcodes with highest total time:");
+    for (uint32 i = 0; i < snapshot.opcodes.size() && i < 10; ++i)
+    {
+        ProfileOpcodeStats const& stats = snapshot.opcodes[i];
+        PSendSysMessage("%s: count " UI64FMTD ", total %.2f ms, avg %u us, max %u us",
+            LookupOpcodeName(stats.opcode), stats.count, stats.total / 1000.0f,
+            uint32(stats.total / stats.count), stats.max);
+    }
+
+    return true;
+}
+
 bool ChatHandler::HandleCastCommand(char* args)
 {
     if (!*args)
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "LoadTaskGraph.h"
+#include "Database/DatabaseEnv.h"
+#include "ProgressBar.h"
+#include "Timer.h"
+#include "Log.h"
+#include "Util.h"
+
+#include <ace/Guard_T.h>
+#include <ace/Thread_Manager.h>
+
+#include <algorithm>
+
+typedef ACE_Guard<ACE_Thread_Mutex> LoadGraphGuard;
+
+LoadTaskGraph::LoadTaskGraph() : m_startTime(0), m_wallTime(0), m_threads(1), m_cond(m_lock), m_finished(0)
+{
+}
+
+void LoadTaskGraph::AddTask(char const* name, LoadFunction function, char const* dependencies /*= NULL*/)
+{
+    uint32 index = m_tasks.size();
+    m_tasks.push_back(Task(name, function));
+
+    if (!dependencies)
+        return;
+
+    Tokens names(dependencies, ',');
+    for (Tokens::const_iterator itr = names.begin(); itr != names.end(); ++itr)
+    {
+        uint32 dep = 0;
+        while (dep < index && m_tasks[dep].name != *itr)
+            ++dep;
+
+        // only tasks declared before can be used, so the graph can't have cycles
+        if (dep == index)
+        {
+            sLog.outError("LoadTaskGraph: task '%s' depends on unknown (or later declared) task '%s'", name, *itr);
+            MANGOS_ASSERT(false);
+        }
+
+        m_tasks[index].dependencies.push_back(dep);
+        m_tasks[dep].dependents.push_back(index);
+    }
+
+    m_tasks[index].pending = m_tasks[index].dependencies.size();
+}
+
+void LoadTaskGraph::Run(uint32 threads)
+{
+    m_startTime = WorldTimer::getMSTime();
+    m_threads = threads > m_tasks.size() ? m_tasks.size() : threads;
+
+    if (m_threads <= 1)
+    {
+        // declaration order is a valid execution order
+        m_threads = 1;
+        for (uint32 i = 0; i < m_tasks.size(); ++i)
+            RunTask(i);
+    }
+    else
+    {
+        for (uint32 i = 0; i < m_tasks.size(); ++i)
+            if (!m_tasks[i].pending)
+                m_ready.insert(i);
+
+        // interleaved progress bars of concurrent loaders are unreadable
+        bool showBars = BarGoLink::GetOutputState();
+        BarGoLink::SetOutputState(false);
+
+        sLog.outString("Loading static data with %u threads...", m_threads);
+
+        int group = ACE_Thread_Manager::instance()->spawn_n(m_threads, (ACE_THR_FUNC)&WorkerThread, this);
+        if (group == -1)
+        {
+            sLog.outError("LoadTaskGraph: can't start %u loader threads, loading in main thread", m_threads);
+            m_threads = 1;
+            RunWorker();
+        }
+        else
+            ACE_Thread_Manager::instance()->wait_grp(group);
+
+        BarGoLink::SetOutputState(showBars);
+    }
+
+    m_wallTime = WorldTimer::getMSTimeDiff(m_startTime, WorldTimer::getMSTime());
+}
+
+ACE_THR_FUNC_RETURN LoadTaskGraph::WorkerThread(void* arg)
+{
+    // loaders use own connections of the pools, thread must be known by DB client library
+    WorldDatabase.ThreadStart();
+
+    ((LoadTaskGraph*)arg)->RunWorker();
+
+    WorldDatabase.ThreadEnd();
+    return 0;
+}
+
+void LoadTaskGraph::RunWorker()
+{
+    for (;;)
+    {
+        uint32 index;
+        {
+            LoadGraphGuard guard(m_lock);
+
+            while (m_ready.empty() && m_finished < m_tasks.size())
+                m_cond.wait();
+
+            if (m_ready.empty())
+                return;
+
+            index = *m_ready.begin();
+            m_ready.erase(m_ready.begin());
+        }
+
+        RunTask(index);
+
+        LoadGraphGuard guard(m_lock);
+
+        ++m_finished;
+
+        Task const& task = m_tasks[index];
+        for (std::vector<uint32>::const_iterator itr = task.dependents.begin(); itr != task.dependents.end(); ++itr)
+            if (--m_tasks[*itr].pending == 0)
+                m_ready.insert(*itr);
+
+        // wake up others for new ready tasks or for exit
+        m_cond.broadcast();
+    }
+}
+
+void LoadTaskGraph::RunTask(uint32 index)
+{
+    Task& task = m_tasks[index];
+
+    uint32 start = WorldTimer::getMSTime();
+    task.startTime = WorldTimer::getMSTimeDiff(m_startTime, start);
+
+    task.function();
+
+    task.duration = WorldTimer::getMSTimeDiff(start, WorldTimer::getMSTime());
+}
+
+struct LoadTaskDurationOrder
+{
+    LoadTaskDurationOrder(std::vector<uint32> const& durations) : m_durations(durations) {}
+    bool operator()(uint32 a, uint32 b) const { return m_durations[a] > m_durations[b]; }
+
+    std::vector<uint32> const& m_durations;
+};
+
+void LoadTaskGraph::PrintStatistics() const
+{
+    if (m_tasks.empty())
+        return;
+
+    // longest chain ending at every task, dependencies are always declared before dependents
+    std::vector<uint32> pathTime(m_tasks.size(), 0);
+    std::vector<int32> pathPrev(m_tasks.size(), -1);
+    std::vector<uint32> durations(m_tasks.size(), 0);
+    uint32 totalTime = 0;
+    uint32 last = 0;
+
+    for (uint32 i = 0; i < m_tasks.size(); ++i)
+    {
+        Task const& task = m_tasks[i];
+        for (std::vector<uint32>::const_iterator itr = task.dependencies.begin(); itr != task.dependencies.end(); ++itr)
+        {
+            if (pathPrev[i] < 0 || pathTime[*itr] > pathTime[pathPrev[i]])
+                pathPrev[i] = *itr;
+        }
+
+        pathTime[i] = task.duration + (pathPrev[i] < 0 ? 0 : pathTime[pathPrev[i]]);
+        durations[i] = task.duration;
+        totalTime += task.duration;
+
+        if (pathTime[i] > pathTime[last])
+            last = i;
+    }
+
+    sLog.outString();
+    sLog.outString("Static data loaded in %u ms by %u thread(s), sum of loader times %u ms, critical path %u ms",
+        m_wallTime, m_threads, totalTime, pathTime[last]);
+
+    std::vector<uint32> order(m_tasks.size());
+    for (uint32 i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), LoadTaskDurationOrder(durations));
+
+    sLog.outString("Loader times:");
+    for (std::vector<uint32>::const_iterator itr = order.begin(); itr != order.end(); ++itr)
+    {
+        Task const& task = m_tasks[*itr];
+        sLog.outString("  %-28s %7u ms (started at %7u ms)", task.name.c_str(), task.duration, task.startTime);
+    }
+
+    std::vector<uint32> path;
+    for (int32 i = last; i >= 0; i = pathPrev[i])
+        path.push_back(i);
+
+    sLog.outString("Critical path:");
+    for (std::vector<uint32>::const_reverse_iterator itr = path.rbegin(); itr != path.rend(); ++itr)
+        sLog.outString("  %-28s %7u ms", m_tasks[*itr].name.c_str(), m_tasks[*itr].duration);
+    sLog.outString();
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_LOADTASKGRAPH_H
+#define MANGOS_LOADTASKGRAPH_H
+
+#include "Common.h"
+
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include <set>
+
+/**
+ * Startup loader graph.
+ *
+ * Every loader of static data declares the loaders it must run after. Loaders
+ * without unfinished dependencies are run concurrently by a pool of threads, with
+ * one thread they run exactly in declaration order. Wall time of every loader and
+ * the critical path (the longest chain of dependent loaders) are kept for report.
+ */
+class LoadTaskGraph
+{
+    public:
+        typedef void (*LoadFunction)();
+
+        LoadTaskGraph();
+
+        // dependencies are comma separated names of tasks added before this one
+        void AddTask(char const* name, LoadFunction function, char const* dependencies = NULL);
+
+        // run all tasks and return when the last one is done
+        void Run(uint32 threads);
+
+        void PrintStatistics() const;
+
+    private:
+        struct Task
+        {
+            Task(char const* _name, LoadFunction _function) : name(_name), function(_function), pending(0), startTime(0), duration(0) {}
+
+            std::string name;
+            LoadFunction function;
+            std::vector<uint32> dependencies;
+            std::vector<uint32> dependents;
+            uint32 pending;                                 // count of not finished dependencies
+            uint32 startTime;                               // in ms since graph start
+            uint32 duration;                                // in ms
+        };
+
+        static ACE_THR_FUNC_RETURN WorkerThread(void* arg);
+        void RunWorker();
+        void RunTask(uint32 index);
+
+        std::vector<Task> m_tasks;
+        uint32 m_startTime;
+        uint32 m_wallTime;
+        uint32 m_threads;
+
+        ACE_Thread_Mutex m_lock;                            // guards all below
+        ACE_Condition_Thread_Mutex m_cond;
+        std::set<uint32> m_ready;                           // ready tasks, lower index (earlier declared) first
+        uint32 m_finished;
+};
+
+#endif
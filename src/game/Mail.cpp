@@ -297,42 +297,167 @@ void MailDraft::SendMailTo(MailReceiver const& receiver, MailSender const& sende
 
     // For online receiver update in game mail status and data
     if (pReceiver)
+        addToMailbox(pReceiver, mailId, sender, checked, deliver_time, expire_time);
+    else if (!m_items.empty())
+        deleteIncludedItems();
+}
+
+struct MassMailOnlineReceiver
+{
+    MassMailOnlineReceiver(Player* _player, uint32 _mailId, MailDraft* _draft) : player(_player), mailId(_mailId), draft(_draft) {}
+
+    Player* player;
+    uint32 mailId;
+    MailDraft* draft;                                       // clone with items
+};
+
+/**
+ * Sends copies of the mail to many receivers with a few set based statements.
+ *
+ * Mails without items are stored by one INSERT ... SELECT, so subject and body are sent
+ * to the database once. Included items are cloned for every receiver, mails with items
+ * are stored in one transaction. Online receivers get the mail after it is queued.
+ * The draft itself is not sent, included items stay owned by the caller.
+ *
+ * @param receivers            Low guids of the receiving characters, not existing are skipped.
+ * @param sender               The MailSender from which this mail is originated.
+ * @param checked              The mask used to specify the mail.
+ */
+void MailDraft::SendMailToMany(std::vector<uint32> const& receivers, MailSender const& sender, MailCheckMask checked)
+{
+    std::vector<MassMailOnlineReceiver> online;
+    std::vector<ObjectGuid> single;                         // need template items generated at send
+
+    time_t deliver_time = time(NULL);
+    time_t expire_time = deliver_time + ((m_COD > 0) ? 3 * DAY : 30 * DAY);
+
+    bool has_items = !m_items.empty();
+
+    std::ostringstream mailIds;                             // receiver => mail id
+    std::ostringstream guids;
+    std::ostringstream itemRows;
+    uint32 count = 0;
+
+    if (has_items)
+        CharacterDatabase.BeginTransaction();
+
+    for (std::vector<uint32>::const_iterator itr = receivers.begin(); itr != receivers.end(); ++itr)
     {
-        pReceiver->AddNewMailDeliverTime(deliver_time);
+        ObjectGuid receiverGuid = ObjectGuid(HIGHGUID_PLAYER, *itr);
+        Player* pReceiver = sObjectMgr.GetPlayer(receiverGuid);
 
-        Mail* m = new Mail;
-        m->messageID = mailId;
-        m->mailTemplateId = GetMailTemplateId();
-        m->subject = GetSubject();
-        m->body = GetBody();
-        m->money = GetMoney();
-        m->COD = GetCOD();
+        if (!pReceiver && !sAccountMgr.GetPlayerAccountIdByGUID(receiverGuid))
+            continue;
 
-        for (MailItemMap::const_iterator mailItemIter = m_items.begin(); mailItemIter != m_items.end(); ++mailItemIter)
+        if (pReceiver && m_mailTemplateId && m_mailTemplateItemsNeed)
         {
-            Item* item = mailItemIter->second;
-            m->AddItem(item->GetGUIDLow(), item->GetEntry());
+            single.push_back(receiverGuid);
+            continue;
         }
 
-        m->messageType = sender.GetMailMessageType();
-        m->stationery = sender.GetStationery();
-        m->sender = sender.GetSenderId();
-        m->receiverGuid = receiver.GetPlayerGuid();
-        m->expire_time = expire_time;
-        m->deliver_time = deliver_time;
-        m->checked = checked;
-        m->state = MAIL_STATE_UNCHANGED;
+        uint32 mailId = sObjectMgr.GenerateMailID();
+        mailIds << " WHEN " << *itr << " THEN " << mailId;
+        guids << (count ? "," : "") << *itr;
+        ++count;
 
-        pReceiver->AddMail(m);                           // to insert new mail to beginning of maillist
+        MailDraft* draft = NULL;
+        if (has_items)
+        {
+            draft = new MailDraft;
+            draft->CloneFrom(*this);                        // items are saved in the transaction
 
-        if (!m_items.empty())
+            for (MailItemMap::const_iterator mailItemIter = draft->m_items.begin(); mailItemIter != draft->m_items.end(); ++mailItemIter)
+            {
+                Item* item = mailItemIter->second;
+                itemRows << (itemRows.tellp() > 0 ? "," : "") << "(" << mailId << "," << item->GetGUIDLow() << "," << item->GetEntry() << "," << *itr << ")";
+            }
+        }
+
+        if (pReceiver)
+            online.push_back(MassMailOnlineReceiver(pReceiver, mailId, draft));
+        else if (draft)
         {
-            for (MailItemMap::iterator mailItemIter = m_items.begin(); mailItemIter != m_items.end(); ++mailItemIter)
-                pReceiver->AddMItem(mailItemIter->second);
+            draft->deleteIncludedItems();
+            delete draft;
         }
     }
-    else if (!m_items.empty())
-        deleteIncludedItems();
+
+    if (count)
+    {
+        std::string safe_subject = GetSubject();
+        CharacterDatabase.escape_string(safe_subject);
+
+        std::string safe_body = GetBody();
+        CharacterDatabase.escape_string(safe_body);
+
+        std::ostringstream ss;
+        ss << "INSERT INTO mail (id,messageType,stationery,mailTemplateId,sender,receiver,subject,body,has_items,expire_time,deliver_time,money,cod,checked) "
+           << "SELECT CASE guid" << mailIds.str() << " END, " << uint32(sender.GetMailMessageType()) << ", " << uint32(sender.GetStationery()) << ", "
+           << GetMailTemplateId() << ", " << sender.GetSenderId() << ", guid, '" << safe_subject << "', '" << safe_body << "', " << (has_items ? 1 : 0) << ", "
+           << uint64(expire_time) << ", " << uint64(deliver_time) << ", " << m_money << ", " << m_COD << ", " << uint32(checked) << " "
+           << "FROM characters WHERE guid IN (" << guids.str() << ")";
+        CharacterDatabase.Execute(ss.str().c_str());
+
+        if (itemRows.tellp() > 0)
+            CharacterDatabase.Execute(("INSERT INTO mail_items (mail_id,item_guid,item_template,receiver) VALUES " + itemRows.str()).c_str());
+    }
+
+    if (has_items)
+        CharacterDatabase.CommitTransaction();
+
+    for (std::vector<MassMailOnlineReceiver>::const_iterator itr = online.begin(); itr != online.end(); ++itr)
+    {
+        MailDraft* draft = itr->draft ? itr->draft : this;
+        draft->addToMailbox(itr->player, itr->mailId, sender, checked, deliver_time, expire_time);
+        delete itr->draft;                                  // items are owned by the receiver now
+    }
+
+    for (std::vector<ObjectGuid>::const_iterator itr = single.begin(); itr != single.end(); ++itr)
+    {
+        MailDraft draft;
+        draft.CloneFrom(*this);
+        draft.SendMailTo(MailReceiver(sObjectMgr.GetPlayer(*itr), *itr), sender, checked);
+    }
+}
+
+/**
+ * Adds a mail already stored in the database to the mail list of an online receiver,
+ * included items are handed over to the receiver.
+ */
+void MailDraft::addToMailbox(Player* receiver, uint32 mailId, MailSender const& sender, MailCheckMask checked, time_t deliver_time, time_t expire_time)
+{
+    receiver->AddNewMailDeliverTime(deliver_time);
+
+    Mail* m = new Mail;
+    m->messageID = mailId;
+    m->mailTemplateId = GetMailTemplateId();
+    m->subject = GetSubject();
+    m->body = GetBody();
+    m->money = GetMoney();
+    m->COD = GetCOD();
+
+    for (MailItemMap::const_iterator mailItemIter = m_items.begin(); mailItemIter != m_items.end(); ++mailItemIter)
+    {
+        Item* item = mailItemIter->second;
+        m->AddItem(item->GetGUIDLow(), item->GetEntry());
+    }
+
+    m->messageType = sender.GetMailMessageType();
+    m->stationery = sender.GetStationery();
+    m->sender = sender.GetSenderId();
+    m->receiverGuid = receiver->GetObjectGuid();
+    m->expire_time = expire_time;
+    m->deliver_time = deliver_time;
+    m->checked = checked;
+    m->state = MAIL_STATE_UNCHANGED;
+
+    receiver->AddMail(m);                                   // to insert new mail to beginning of maillist
+
+    if (!m_items.empty())
+    {
+        for (MailItemMap::iterator mailItemIter = m_items.begin(); mailItemIter != m_items.end(); ++mailItemIter)
+            receiver->AddMItem(mailItemIter->second);
+    }
 }
 
 /**
@@ -220,6 +220,8 @@ class MailDraft
         uint32 GetMoney() const { return m_money; }
         /// Returns the Cost of delivery of this MailDraft.
         uint32 GetCOD() const { return m_COD; }
+        /// Returns true if items are included in this MailDraft (not counting mail template items).
+        bool HasItems() const { return !m_items.empty(); }
     public:                                                 // modifiers
 
         // this two modifiers expected to be applied in normal case to blank draft and exclusively, it will work and with mixed cases but this will be not normal way use.
@@ -244,12 +246,14 @@ class MailDraft
     public:                                                 // finishers
         void SendReturnToSender(uint32 sender_acc, ObjectGuid sender_guid, ObjectGuid receiver_guid);
         void SendMailTo(MailReceiver const& receiver, MailSender const& sender, MailCheckMask checked = MAIL_CHECK_MASK_NONE, uint32 deliver_delay = 0);
+        void SendMailToMany(std::vector<uint32> const& receivers, MailSender const& sender, MailCheckMask checked = MAIL_CHECK_MASK_NONE);
     private:
         MailDraft(MailDraft const&);                        // trap decl, no body, mail draft must cloned only explicitly...
         MailDraft& operator=(MailDraft const&);             // trap decl, no body, ...because items clone is high price operation
 
         void deleteIncludedItems(bool inDB = false);
         bool prepareItems(Player* receiver);                ///< called from SendMailTo for generate mailTemplateBase items
+        void addToMailbox(Player* receiver, uint32 mailId, MailSender const& sender, MailCheckMask checked, time_t deliver_time, time_t expire_time);
 
         /// The ID of the template associated with this MailDraft.
         uint16      m_mailTemplateId;
@@ -29,6 +29,7 @@
 #include "ObjectAccessor.h"
 #include "ObjectMgr.h"
 #include "World.h"
+#include "SharedWorldPacket.h"
 #include "ScriptMgr.h"
 #include "Group.h"
 #include "MapRefManager.h"
@@ -37,6 +38,8 @@
 #include "VMapFactory.h"
 #include "MoveMap.h"
 #include "BattleGround/BattleGroundMgr.h"
+#include "WorldProfiler.h"
+#include "Metrics/Metrics.h"
 
 Map::~Map()
 {
@@ -64,7 +67,7 @@ Map::~Map()
 
 void Map::LoadMapAndVMap(int gx,int gy)
 {
-    if(m_bLoadedGrids[gx][gx])
+    if(m_bLoadedGrids[gx][gy])
         return;
 
     GridMap * pInfo = m_TerrainData->Load(gx, gy);
@@ -73,12 +76,16 @@ void Map::LoadMapAndVMap(int gx,int gy)
 }
 
 Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode)
-  : i_mapEntry (sMapStore.LookupEntry(id)), i_spawnMode(SpawnMode),
+  : i_gridUnloadOrder(0), i_unloadingGrid(NULL), i_unloadingCell(0),
+  i_mapEntry (sMapStore.LookupEntry(id)), i_spawnMode(SpawnMode),
   i_id(id), i_InstanceId(InstanceId), m_unloadTimer(0),
   m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE),
   m_activeNonPlayersIter(m_activeNonPlayers.end()),
   i_gridExpiry(expiry), m_TerrainData(sTerrainMgr.LoadTerrain(id)),
-  i_data(NULL), i_script_id(0)
+  i_data(NULL), i_script_id(0),
+  m_lastUpdatedObjects(0), m_lastSkippedIdleCreatures(0),
+  m_totalUpdatedObjects(0), m_totalSkippedIdleCreatures(0),
+  m_updateTimeMetric(NULL)
 {
     m_CreatureGuids.Set(sObjectMgr.GetFirstTemporaryCreatureLowGuid());
     m_GameObjectGuids.Set(sObjectMgr.GetFirstTemporaryGameObjectLowGuid());
@@ -102,6 +109,11 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode)
     MapPersistentState* persistentState = sMapPersistentStateMgr.AddPersistentState(i_mapEntry, GetInstanceId(), GetDifficulty(), 0, IsDungeon());
     persistentState->SetUsedByMapState(this);
     SetBroken(false);
+
+    for (int i = 0; i < MAP_LOCK_TYPE_MAX; ++i)
+        i_lock[i].SetLockClass(MapLockType(i));
+
+    m_Events.SetTimerWheel(&m_EventWheel);
 }
 
 MapPersistentState* Map::GetPersistentState() const
@@ -213,7 +225,7 @@ void Map::DeleteFromWorld(Player* pl)
 {
     sObjectAccessor.RemoveObject(pl);
 
-    WriteGuard Guard(GetLock(MAP_LOCK_TYPE_AURAS));
+    WriteGuard Guard(pl->GetLock(MAP_LOCK_TYPE_AURAS));
 
     delete pl;
 }
@@ -228,6 +240,10 @@ void Map::setUnitCell(Creature* obj)
 void
 Map::EnsureGridCreated(const GridPair &p)
 {
+    // objects of a grid torn down partly are missing, unload the rest and load it again
+    if (i_unloadingGrid && i_unloadingGrid == getNGrid(p.x_coord, p.y_coord))
+        FinishGridUnload();
+
     if(!getNGrid(p.x_coord, p.y_coord))
     {
         setNGrid(new NGridType(p.x_coord*MAX_NUMBER_OF_GRIDS + p.y_coord, p.x_coord, p.y_coord, i_gridExpiry, sWorld.getConfig(CONFIG_BOOL_GRID_UNLOAD)),
@@ -266,6 +282,7 @@ Map::EnsureGridLoadedAtEnter(const Cell &cell, Player *player)
         }
 
         ResetGridExpiry(*getNGrid(cell.GridX(), cell.GridY()), 0.1f);
+        grid->getGridInfoRef()->newUnloadGeneration();
         grid->SetGridState(GRID_STATE_ACTIVE);
     }
     else
@@ -328,6 +345,9 @@ bool Map::Add(Player *player)
     player->SetMap(this);
     CreateAttackersStorageFor(player->GetObjectGuid());
 
+    // read terrain of all grids in sight in parallel, the own grid is waited for at once
+    m_TerrainData->PreloadArea(player->GetPositionX(), player->GetPositionY(), GetVisibilityDistance(player));
+
     // update player state for other player and visa-versa
     CellPair p = MaNGOS::ComputeCellPair(player->GetPositionX(), player->GetPositionY());
     Cell cell(p);
@@ -480,6 +500,10 @@ bool Map::loaded(const GridPair &p) const
 
 void Map::Update(const uint32 &t_diff)
 {
+    PROFILE_SCOPE_ARG(PROFILE_MAP_UPDATE, GetId());
+    ProfilePhase phase(PROFILE_MAP_GRID_LOADING, GetId());
+    uint32 updateStartTime = WorldTimer::getMSTime();
+
     m_dyn_tree.update(t_diff);
     uint32 loadingObjectToGridUpdateTime = WorldTimer::getMSTime();
 
@@ -510,9 +534,11 @@ void Map::Update(const uint32 &t_diff)
             break;
     }
 
+    phase.Switch(PROFILE_MAP_SCRIPTS);
     UpdateEvents(t_diff);
 
     /// update worldsessions for existing players
+    phase.Switch(PROFILE_MAP_SESSIONS);
     for(m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
         Player* plr = m_mapRefIter->getSource();
@@ -527,7 +553,16 @@ void Map::Update(const uint32 &t_diff)
         }
     }
 
+    // movement relayed while processing the sessions, one packet per client
+    for(m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+    {
+        Player* plr = m_mapRefIter->getSource();
+        if(plr && plr->IsInWorld())
+            plr->GetSession()->SendQueuedMovement();
+    }
+
     /// update players at tick
+    phase.Switch(PROFILE_MAP_PLAYERS);
     for(m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
         Player* plr = m_mapRefIter->getSource();
@@ -539,6 +574,7 @@ void Map::Update(const uint32 &t_diff)
     }
 
     /// update active cells around players and active objects
+    phase.Switch(PROFILE_MAP_OBJECTS);
     resetMarkedCells();
 
     MaNGOS::ObjectUpdater updater(t_diff);
@@ -618,7 +654,13 @@ void Map::Update(const uint32 &t_diff)
         }
     }
 
+    m_lastUpdatedObjects = updater.i_updated;
+    m_lastSkippedIdleCreatures = updater.i_skipped;
+    m_totalUpdatedObjects += updater.i_updated;
+    m_totalSkippedIdleCreatures += updater.i_skipped;
+
     // Send world objects and item update field changes
+    phase.Switch(PROFILE_MAP_SEND_UPDATES);
     SendObjectUpdates();
 
     // Calculate and send map-related WorldState updates
@@ -626,6 +668,7 @@ void Map::Update(const uint32 &t_diff)
 
     // Don't unload grids if it's battleground, since we may have manually added GOs,creatures, those doesn't load from DB at grid re-load !
     // This isn't really bother us, since as soon as we have instanced BG-s, the whole map unloads as the BG gets ended
+    phase.Switch(PROFILE_MAP_GRID_LOADING);
     if (!IsBattleGroundOrArena())
     {
         for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end(); )
@@ -636,14 +679,27 @@ void Map::Update(const uint32 &t_diff)
             MANGOS_ASSERT(grid->GetGridState() >= 0 && grid->GetGridState() < MAX_GRID_STATE);
             sMapMgr.UpdateGridState(grid->GetGridState(), *this, *grid, *info, grid->getX(), grid->getY(), t_diff);
         }
+
+        UpdateGridUnloads();
     }
 
     ///- Process necessary scripts
+    phase.Switch(PROFILE_MAP_SCRIPTS);
     if (!m_scriptSchedule.empty())
         ScriptsProcess();
 
     if(i_data)
         i_data->Update(t_diff);
+
+    if (sWorld.getConfig(CONFIG_BOOL_METRICS_ENABLE))
+    {
+        // instances of one map share the histogram
+        if (!m_updateTimeMetric)
+            m_updateTimeMetric = sMetrics.GetHistogram("mangos_map_update_duration_ms", "Duration of map updates in milliseconds",
+                MetricUpdateTimeBounds, METRIC_UPDATE_TIME_BOUNDS, MetricLabel("map", GetId()));
+
+        m_updateTimeMetric->Observe(WorldTimer::getMSTimeDiff(updateStartTime, WorldTimer::getMSTime()));
+    }
 }
 
 void Map::Remove(Player *player, bool remove)
@@ -653,6 +709,10 @@ void Map::Remove(Player *player, bool remove)
 
     sLFGMgr.OnPlayerLeaveMap(player, this);
 
+    // movement of units of this map, must arrive before the client leaves it
+    if (WorldSession* session = player->GetSession())
+        session->SendQueuedMovement();
+
     if(remove)
         player->CleanupsBeforeDelete();
     else
@@ -763,6 +823,10 @@ Map::PlayerRelocation(Player *player, float x, float y, float z, float orientati
 
     player->Relocate(x, y, z, orientation);
 
+    // terrain of the grid the player moves to is read before it is entered
+    if (!same_cell)
+        m_TerrainData->ReadAhead(x, y, orientation);
+
     if( old_cell.DiffGrid(new_cell) || old_cell.DiffCell(new_cell) )
     {
         DEBUG_FILTER_LOG(LOG_FILTER_PLAYER_MOVES, "Player %s relocation grid[%u,%u]cell[%u,%u]->grid[%u,%u]cell[%u,%u]", player->GetName(), old_cell.GridX(), old_cell.GridY(), old_cell.CellX(), old_cell.CellY(), new_cell.GridX(), new_cell.GridY(), new_cell.CellX(), new_cell.CellY());
@@ -784,6 +848,7 @@ Map::PlayerRelocation(Player *player, float x, float y, float z, float orientati
     if( !same_cell && newGrid->GetGridState()!= GRID_STATE_ACTIVE )
     {
         ResetGridExpiry(*newGrid, 0.1f);
+        newGrid->getGridInfoRef()->newUnloadGeneration();
         newGrid->SetGridState(GRID_STATE_ACTIVE);
     }
 }
@@ -868,23 +933,134 @@ bool Map::UnloadGrid(const uint32 &x, const uint32 &y, bool pForce)
     NGridType *grid = getNGrid(x, y);
     MANGOS_ASSERT( grid != NULL);
 
+    if(!pForce && ActiveObjectsNearGrid(x, y) )
+        return false;
+
+    // the rest of a grid torn down partly goes now
+    if (grid == i_unloadingGrid)
+        i_unloadingGrid = NULL;
+
+    BeginGridUnload(*grid);
+    EndGridUnload(x, y);
+    return true;
+}
+
+bool Map::QueueGridUnload(const uint32 &x, const uint32 &y)
+{
+    NGridType *grid = getNGrid(x, y);
+    MANGOS_ASSERT(grid != NULL);
+
+    if (grid->getGridInfoRef()->isUnloadQueued() || grid == i_unloadingGrid)
+        return true;
+
+    if (ActiveObjectsNearGrid(x, y))
+        return false;
+
+    uint32 playerDistance = MAX_NUMBER_OF_GRIDS;
+    for (MapRefManager::iterator itr = m_mapRefManager.begin(); itr != m_mapRefManager.end(); ++itr)
     {
-        if(!pForce && ActiveObjectsNearGrid(x, y) )
-            return false;
+        Player* player = itr->getSource();
+        GridPair p = MaNGOS::ComputeGridPair(player->GetPositionX(), player->GetPositionY());
+        uint32 dx = p.x_coord > x ? p.x_coord - x : x - p.x_coord;
+        uint32 dy = p.y_coord > y ? p.y_coord - y : y - p.y_coord;
+        playerDistance = std::min(playerDistance, std::max(dx, dy));
+    }
+
+    grid->getGridInfoRef()->setUnloadQueued(true);
+    i_gridUnloadQueue.push(GridUnloadQueueMember(x, y, playerDistance, ++i_gridUnloadOrder, grid->getGridInfoRef()->getUnloadGeneration()));
+    return true;
+}
+
+void Map::UpdateGridUnloads()
+{
+    static MetricCounter* unloaded = sMetrics.GetCounter("mangos_grid_unloads_total", "Expired grids taken from the unload queue", "result=\"unloaded\"");
+    static MetricCounter* kept = sMetrics.GetCounter("mangos_grid_unloads_total", "Expired grids taken from the unload queue", "result=\"kept\"");
+
+    if (!i_unloadingGrid && i_gridUnloadQueue.empty())
+        return;
+
+    uint32 startTime = WorldTimer::getMSTime();
+    do
+    {
+        if (!i_unloadingGrid)
+        {
+            if (i_gridUnloadQueue.empty())
+                return;
+
+            GridUnloadQueueMember member = i_gridUnloadQueue.top();
+            i_gridUnloadQueue.pop();
+
+            // activated since it was queued, maybe expired again with a newer entry
+            NGridType* grid = getNGrid(member.x, member.y);
+            if (!grid || !grid->getGridInfoRef()->isUnloadQueued() || grid->getGridInfoRef()->getUnloadGeneration() != member.generation)
+                continue;
+
+            grid->getGridInfoRef()->setUnloadQueued(false);
+            if (grid->GetGridState() != GRID_STATE_REMOVAL || grid->getUnloadLock())
+                continue;
+
+            if (ActiveObjectsNearGrid(member.x, member.y))
+            {
+                DEBUG_LOG("Grid[%u,%u] for map %u differed unloading due to players or active objects nearby", member.x, member.y, i_id);
+                ResetGridExpiry(*grid);
+                kept->Inc();
+                continue;
+            }
+
+            BeginGridUnload(*grid);
+            i_unloadingGrid = grid;
+            i_unloadingCell = 0;
+        }
+
+        // not marked while objects are deleted, a grid load caused by them finds the grid as it is
+        NGridType* grid = i_unloadingGrid;
+        i_unloadingGrid = NULL;
 
-        DEBUG_LOG("Unloading grid[%u,%u] for map %u", x,y, i_id);
         ObjectGridUnloader unloader(*grid);
+        unloader.UnloadCell(i_unloadingCell % MAX_NUMBER_OF_CELLS, i_unloadingCell / MAX_NUMBER_OF_CELLS);
+
+        if (++i_unloadingCell < MAX_NUMBER_OF_CELLS * MAX_NUMBER_OF_CELLS)
+            i_unloadingGrid = grid;
+        else
+        {
+            EndGridUnload(grid->getX(), grid->getY());
+            unloaded->Inc();
+        }
+    }
+    while (WorldTimer::getMSTimeDiff(startTime, WorldTimer::getMSTime()) < sWorld.getConfig(CONFIG_UINT32_GRID_UNLOAD_ALLOWEDTIME));
+}
+
+void Map::BeginGridUnload(NGridType& grid)
+{
+    DEBUG_LOG("Unloading grid[%u,%u] for map %u", grid.getX(), grid.getY(), i_id);
+    ObjectGridUnloader unloader(grid);
 
-        // Finish remove and delete all creatures with delayed remove before moving to respawn grids
-        // Must know real mob position before move
-        RemoveAllObjectsInRemoveList();
+    // Finish remove and delete all creatures with delayed remove before moving to respawn grids
+    // Must know real mob position before move
+    RemoveAllObjectsInRemoveList();
 
-        // move creatures to respawn grids if this is diff.grid or to remove list
-        unloader.MoveToRespawnN();
+    // move creatures to respawn grids if this is diff.grid or to remove list
+    unloader.MoveToRespawnN();
 
-        // Finish remove and delete all creatures with delayed remove before unload
-        RemoveAllObjectsInRemoveList();
+    // Finish remove and delete all creatures with delayed remove before unload
+    RemoveAllObjectsInRemoveList();
+}
+
+void Map::FinishGridUnload()
+{
+    if (!i_unloadingGrid)
+        return;
+
+    NGridType* grid = i_unloadingGrid;
+    i_unloadingGrid = NULL;
+    EndGridUnload(grid->getX(), grid->getY());
+}
 
+void Map::EndGridUnload(uint32 x, uint32 y)
+{
+    {
+        // all cells, also objects moved into cells torn down before
+        ObjectGridUnloader unloader(*getNGrid(x, y));
         unloader.UnloadN();
         delete getNGrid(x, y);
         setNGrid(NULL, x, y);
@@ -902,11 +1078,13 @@ bool Map::UnloadGrid(const uint32 &x, const uint32 &y, bool pForce)
     }
 
     DEBUG_LOG("Unloading grid[%u,%u] for map %u finished", x,y, i_id);
-    return true;
 }
 
 void Map::UnloadAll(bool pForce)
 {
+    FinishGridUnload();
+    i_gridUnloadQueue = GridUnloadQueue();
+
     while (!i_loadingObjectQueue.empty())
     {
         LoadingObjectQueueMember* member = i_loadingObjectQueue.top();
@@ -1138,8 +1316,10 @@ uint32 Map::GetPlayersCountExceptGMs() const
 
 void Map::SendToPlayers(WorldPacket const* data) const
 {
+    SharedWorldPacket sharedData(*data);
+
     for(MapRefManager::const_iterator itr = m_mapRefManager.begin(); itr != m_mapRefManager.end(); ++itr)
-        itr->getSource()->GetSession()->SendPacket(data);
+        itr->getSource()->GetSession()->SendPacket(sharedData);
 }
 
 bool Map::ActiveObjectsNearGrid(uint32 x, uint32 y) const
@@ -2326,6 +2506,14 @@ float Map::GetHeight(uint32 phasemask, float x, float y, float z, bool pCheckVMa
     return std::max<float>(m_TerrainData->GetHeightStatic(x,y,z,pCheckVMap,maxSearchDist), m_dyn_tree.getHeight(x, y,z,maxSearchDist, phasemask));
 }
 
+void Map::GetHeights(uint32 phasemask, TerrainSample* samples, uint32 count, bool pCheckVMap/*=true*/, float maxSearchDist/*=DEFAULT_HEIGHT_SEARCH*/) const
+{
+    m_TerrainData->SampleTerrain(samples, count, TERRAIN_SAMPLE_HEIGHT, pCheckVMap, maxSearchDist);
+
+    for (uint32 i = 0; i < count; ++i)
+        samples[i].height = std::max<float>(samples[i].height, m_dyn_tree.getHeight(samples[i].x, samples[i].y, samples[i].z, maxSearchDist, phasemask));
+}
+
 void Map::InsertGameObjectModel(const GameObjectModel& mdl)
 {
     m_dyn_tree.insert(mdl);
@@ -2389,5 +2577,7 @@ void Map::UpdateEvents(uint32 update_diff)
         ReadGuard Guard(GetLock());
         GetEvents()->RenewEvents();
     }
-    GetEvents()->Update(update_diff);
+
+    // fire due events of the map and of all objects on it
+    m_EventWheel.Update(update_diff);
 }
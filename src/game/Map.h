@@ -54,6 +54,7 @@ class MapPersistentState;
 class WorldPersistentState;
 class DungeonPersistentState;
 class BattleGroundPersistentState;
+class MetricHistogram;
 struct ScriptInfo;
 class BattleGround;
 class GridMap;
@@ -122,6 +123,32 @@ class LoadingObjectsCompare
 
 typedef std::priority_queue<LoadingObjectQueueMember*, std::vector<LoadingObjectQueueMember*>, LoadingObjectsCompare> LoadingObjectsQueue;
 
+struct GridUnloadQueueMember
+{
+    explicit GridUnloadQueueMember(uint32 _x, uint32 _y, uint32 _playerDistance, uint32 _order, uint32 _generation) :
+        x(_x), y(_y), playerDistance(_playerDistance), order(_order), generation(_generation)
+    {}
+    uint32 x;
+    uint32 y;
+    uint32 playerDistance;                                  // in grids, to the nearest player of the map when queued
+    uint32 order;
+    uint32 generation;                                      // unload generation of the grid when queued
+};
+
+// grids far from players first, they are the least likely to be needed again soon
+class GridUnloadCompare
+{
+    public:
+        bool operator() (GridUnloadQueueMember const& lqm, GridUnloadQueueMember const& rqm) const
+        {
+            if (lqm.playerDistance != rqm.playerDistance)
+                return lqm.playerDistance < rqm.playerDistance;
+            return lqm.order > rqm.order;
+        }
+};
+
+typedef std::priority_queue<GridUnloadQueueMember, std::vector<GridUnloadQueueMember>, GridUnloadCompare> GridUnloadQueue;
+
 class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
 {
     friend class MapReference;
@@ -185,6 +212,8 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
         void SetUnloadLock(const GridPair &p, bool on) { getNGrid(p.x_coord, p.y_coord)->setUnloadExplicitLock(on); }
         void LoadGrid(const Cell& cell, bool no_unload = false);
         bool UnloadGrid(const uint32 &x, const uint32 &y, bool pForce);
+        // expired grid is unloaded by later updates within GridUnload.MaxAllowedTime, false if objects are near it
+        bool QueueGridUnload(const uint32 &x, const uint32 &y);
         virtual void UnloadAll(bool pForce);
 
         void ResetGridExpiry(NGridType &grid, float factor = 1) const
@@ -323,6 +352,8 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
 
         // dynamic VMaps
         float GetHeight(uint32 phasemask, float x, float y, float z, bool pCheckVMap=true, float maxSearchDist=DEFAULT_HEIGHT_SEARCH) const;
+        // GetHeight of many points at once, result is stored in TerrainSample::height
+        void GetHeights(uint32 phasemask, TerrainSample* samples, uint32 count, bool pCheckVMap=true, float maxSearchDist=DEFAULT_HEIGHT_SEARCH) const;
         bool IsInLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask) const;
         bool GetHitPosition(float srcX, float srcY, float srcZ, float& destX, float& destY, float& destZ, uint32 phasemask, float modifyDist) const;
 
@@ -339,10 +370,17 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
 
         // Event handler
         WorldObjectEventProcessor* GetEvents();
+        EventTimerWheel* GetEventWheel() { return &m_EventWheel; }
         void UpdateEvents(uint32 update_diff);
         void KillAllEvents(bool force);
         void AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime = true);
 
+        // object update statistics, last tick and totals since map creation
+        uint32 GetLastUpdatedObjects() const { return m_lastUpdatedObjects; }
+        uint32 GetLoadedGridsCount() const { return GridRefManager<NGridType>::getSize(); }
+        uint32 GetLastSkippedIdleCreatures() const { return m_lastSkippedIdleCreatures; }
+        uint64 GetTotalUpdatedObjects() const { return m_totalUpdatedObjects; }
+        uint64 GetTotalSkippedIdleCreatures() const { return m_totalSkippedIdleCreatures; }
 
     private:
         void LoadMapAndVMap(int gx, int gy);
@@ -383,6 +421,11 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
         void setNGrid(NGridType* grid, uint32 x, uint32 y);
         void ScriptsProcess();
 
+        void UpdateGridUnloads();
+        void BeginGridUnload(NGridType& grid);
+        void EndGridUnload(uint32 x, uint32 y);
+        void FinishGridUnload();
+
         void SendObjectUpdates();
         std::set<Object *> i_objectsToClientUpdate;
         std::set<Object *> i_objectsToClientNotUpdate;
@@ -390,6 +433,11 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
 
         LoadingObjectsQueue i_loadingObjectQueue;
 
+        GridUnloadQueue i_gridUnloadQueue;
+        uint32 i_gridUnloadOrder;
+        NGridType* i_unloadingGrid;                         // torn down cell by cell, cells below i_unloadingCell are done
+        uint32 i_unloadingCell;
+
     protected:
         MapEntry const* i_mapEntry;
         uint8 i_spawnMode;
@@ -447,8 +495,16 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
         AttackersMap        m_attackersMap;
         bool                m_broken;
 
+        // shared by the event processors of all objects on the map, must outlive them
+        EventTimerWheel     m_EventWheel;
         WorldObjectEventProcessor m_Events;
 
+        uint32              m_lastUpdatedObjects;
+        uint32              m_lastSkippedIdleCreatures;
+        uint64              m_totalUpdatedObjects;
+        uint64              m_totalSkippedIdleCreatures;
+
+        MetricHistogram*    m_updateTimeMetric;             // created at first update with enabled metrics
 };
 
 class MANGOS_DLL_SPEC WorldMap : public Map
@@ -32,6 +32,8 @@
 #include "SharedDefines.h"
 #include "World.h"
 #include "ObjectMgr.h"
+#include "Log.h"
+#include "Timer.h"
 
 INSTANTIATE_SINGLETON_1(MassMailMgr);
 
@@ -71,18 +73,61 @@ void MassMailMgr::AddMassMailTask(MailDraft* mailProto, MailSender sender, char
     CharacterDatabase.AsyncPQuery(&massMailerQueryHandler, &MassMailerQueryHandler::HandleQueryCallback, mailProto, sender, query);
 }
 
+void MassMailMgr::SendBulk(MassMail& task, uint32 count)
+{
+    std::vector<uint32> receivers;
+    receivers.reserve(std::min(count, uint32(task.m_receivers.size())));
+
+    while (!task.m_receivers.empty() && receivers.size() < count)
+    {
+        receivers.push_back(*task.m_receivers.begin());
+        task.m_receivers.erase(task.m_receivers.begin());
+    }
+
+    // last receiver gets the prototype with its own items, as in one by one sending
+    uint32 last = 0;
+    if (task.m_receivers.empty() && !receivers.empty())
+    {
+        last = receivers.back();
+        receivers.pop_back();
+    }
+
+    task.m_protoMail->SendMailToMany(receivers, task.m_sender, MAIL_CHECK_MASK_RETURNED);
+
+    if (last)
+    {
+        ObjectGuid receiver_guid = ObjectGuid(HIGHGUID_PLAYER, last);
+        task.m_protoMail->SendMailTo(MailReceiver(sObjectMgr.GetPlayer(receiver_guid), receiver_guid), task.m_sender, MAIL_CHECK_MASK_RETURNED);
+    }
+}
+
 void MassMailMgr::Update(bool sendall /*= false*/)
 {
     if (m_massMails.empty())
         return;
 
-    uint32 maxcount = sWorld.getConfig(CONFIG_UINT32_MASS_MAILER_SEND_PER_TICK);
+    uint32 sendcount = sWorld.getConfig(CONFIG_UINT32_MASS_MAILER_SEND_PER_TICK);
+    uint32 bulkcount = sWorld.getConfig(CONFIG_UINT32_MASS_MAILER_BULK_SEND_PER_TICK);
+    uint32 maxcount = sendcount;
 
     do
     {
         MassMail& task = m_massMails.front();
 
-        while (!task.m_receivers.empty() && (sendall || maxcount > 0))
+        if (!task.m_startTime)
+        {
+            task.m_startTime = WorldTimer::getMSTime();
+            task.m_total = task.m_receivers.size();
+        }
+
+        if (bulkcount)
+        {
+            // mails with items are cloned one by one, so they are stored in smaller batches
+            SendBulk(task, task.m_protoMail->HasItems() ? sendcount : bulkcount);
+            maxcount = 0;                                   // one batch per tick
+        }
+
+        while (!bulkcount && !task.m_receivers.empty() && (sendall || maxcount > 0))
         {
             uint32 receiver_lowguid = *task.m_receivers.begin();
             task.m_receivers.erase(task.m_receivers.begin());
@@ -113,7 +158,11 @@ void MassMailMgr::Update(bool sendall /*= false*/)
         }
 
         if (task.m_receivers.empty())
+        {
+            sLog.outString("MassMailMgr: mail sent to %u receivers in %u ms (%s)", task.m_total,
+                WorldTimer::getMSTimeDiff(task.m_startTime, WorldTimer::getMSTime()), bulkcount ? "bulk" : "one by one");
             m_massMails.pop_front();
+        }
     }
     while(!m_massMails.empty() && (sendall || maxcount > 0));
 }
@@ -122,14 +171,23 @@ void MassMailMgr::GetStatistic(uint32& tasks, uint32& mails, uint32& needTime) c
 {
     tasks = m_massMails.size();
 
+    uint32 maxcount = sWorld.getConfig(CONFIG_UINT32_MASS_MAILER_SEND_PER_TICK);
+    uint32 bulkcount = sWorld.getConfig(CONFIG_UINT32_MASS_MAILER_BULK_SEND_PER_TICK);
+
     uint32 mailsCount = 0;
+    uint32 ticksCount = 0;
     for (MassMailList::const_iterator mailItr = m_massMails.begin(); mailItr != m_massMails.end(); ++mailItr)
+    {
+        uint32 perTick = bulkcount && !mailItr->m_protoMail->HasItems() ? bulkcount : maxcount;
+
         mailsCount += mailItr->m_receivers.size();
+        ticksCount += (mailItr->m_receivers.size() + perTick - 1) / perTick;
+    }
 
     mails = mailsCount;
 
     // 50 msecs is tick length
-    needTime = 50 * mailsCount / sWorld.getConfig(CONFIG_UINT32_MASS_MAILER_SEND_PER_TICK) / IN_MILLISECONDS;
+    needTime = 50 * ticksCount / IN_MILLISECONDS;
 }
 
 
@@ -92,6 +92,9 @@ class MassMailMgr
 
         /**
          * Next step in mass mail activity, send some amount mails from queued tasks
+         *
+         * With enabled bulk sending (MassMailer.BulkSendPerTick) one batch of mails is stored per tick
+         * by set based statements, else mails are sent one by one.
          */
         void Update(bool sendall = false);
 
@@ -101,13 +104,14 @@ class MassMailMgr
         struct MassMail
         {
             explicit MassMail(MailDraft* mailProto, MailSender sender)
-                : m_protoMail(mailProto), m_sender(sender)
+                : m_protoMail(mailProto), m_sender(sender), m_startTime(0), m_total(0)
             {
                 MANGOS_ASSERT(mailProto);
             }
 
             MassMail(MassMail const& massmail)
-                : m_protoMail(const_cast<MassMail&>(massmail).m_protoMail), m_sender(massmail.m_sender)
+                : m_protoMail(const_cast<MassMail&>(massmail).m_protoMail), m_sender(massmail.m_sender),
+                m_startTime(massmail.m_startTime), m_total(massmail.m_total)
             {
             }
 
@@ -116,8 +120,14 @@ class MassMailMgr
 
             MailSender m_sender;
             ReceiversList m_receivers;
+
+            uint32 m_startTime;                             // time of first send, for report
+            uint32 m_total;                                 // receivers at first send
         };
 
+        /// Send next part of the task with set based statements
+        void SendBulk(MassMail& task, uint32 count);
+
         typedef std::list<MassMail> MassMailList;
 
         /// List of current queued mass mail tasks
@@ -140,24 +140,8 @@ namespace MMAP
         return uint32(x << 16 | y);
     }
 
-    bool MMapManager::loadMap(uint32 mapId, int32 x, int32 y)
+    unsigned char* MMapManager::readTile(uint32 mapId, int32 x, int32 y, uint32& dataSize)
     {
-        // make sure the mmap is loaded and ready to load tiles
-        if(!loadMapData(mapId))
-            return false;
-
-        // get this mmap data
-        MMapData* mmap = loadedMMaps[mapId];
-        MANGOS_ASSERT(mmap->navMesh);
-
-        // check if we already have this tile loaded
-        uint32 packedGridPos = packTileID(x, y);
-        if (mmap->mmapLoadedTiles.find(packedGridPos) != mmap->mmapLoadedTiles.end())
-        {
-            sLog.outError("MMAP:loadMap: Asked to load already loaded navmesh tile. %03u%02i%02i.mmtile", mapId, x, y);
-            return false;
-        }
-
         // load this tile :: mmaps/MMMXXYY.mmtile
         uint32 pathLen = sWorld.GetDataPath().length() + strlen("mmaps/%03i%02i%02i.mmtile")+1;
         char* fileName = new char[pathLen];
@@ -168,19 +152,17 @@ namespace MMAP
         {
             sLog.outDebug("MMAP:loadMap: Could not open mmtile file '%s'", fileName);
             delete [] fileName;
-            return false;
+            return NULL;
         }
         delete [] fileName;
 
         // read header
         MmapTileHeader fileHeader;
-        fread(&fileHeader, sizeof(MmapTileHeader), 1, file);
-
-        if (fileHeader.mmapMagic != MMAP_MAGIC)
+        if (fread(&fileHeader, sizeof(MmapTileHeader), 1, file) != 1 || fileHeader.mmapMagic != MMAP_MAGIC)
         {
             sLog.outError("MMAP:loadMap: Bad header in mmap %03u%02i%02i.mmtile", mapId, x, y);
             fclose(file);
-            return false;
+            return NULL;
         }
 
         if (fileHeader.mmapVersion != MMAP_VERSION)
@@ -188,7 +170,7 @@ namespace MMAP
             sLog.outError("MMAP:loadMap: %03u%02i%02i.mmtile was built with generator v%i, expected v%i",
                                                 mapId, x, y, fileHeader.mmapVersion, MMAP_VERSION);
             fclose(file);
-            return false;
+            return NULL;
         }
 
         unsigned char* data = (unsigned char*)dtAlloc(fileHeader.size, DT_ALLOC_PERM);
@@ -200,16 +182,50 @@ namespace MMAP
         if(!result)
         {
             sLog.outError("MMAP:loadMap: Bad header or data in mmap %03u%02i%02i.mmtile", mapId, x, y);
+            dtFree(data);
+            return NULL;
+        }
+
+        dataSize = fileHeader.size;
+        return data;
+    }
+
+    bool MMapManager::loadMap(uint32 mapId, int32 x, int32 y, unsigned char* data, uint32 dataSize)
+    {
+        // make sure the mmap is loaded and ready to load tiles
+        if(!loadMapData(mapId))
+        {
+            dtFree(data);
             return false;
         }
 
+        // get this mmap data
+        MMapData* mmap = loadedMMaps[mapId];
+        MANGOS_ASSERT(mmap->navMesh);
+
+        // check if we already have this tile loaded
+        uint32 packedGridPos = packTileID(x, y);
+        if (mmap->mmapLoadedTiles.find(packedGridPos) != mmap->mmapLoadedTiles.end())
+        {
+            sLog.outError("MMAP:loadMap: Asked to load already loaded navmesh tile. %03u%02i%02i.mmtile", mapId, x, y);
+            dtFree(data);
+            return false;
+        }
+
+        if (!data)
+        {
+            data = readTile(mapId, x, y, dataSize);
+            if (!data)
+                return false;
+        }
+
         dtMeshHeader* header = (dtMeshHeader*)data;
         dtTileRef tileRef = 0;
 
         dtStatus stat;
         {
             WriteGuard Guard(GetLock(mapId));
-            stat = mmap->navMesh->addTile(data, fileHeader.size, DT_TILE_FREE_DATA, 0, &tileRef);
+            stat = mmap->navMesh->addTile(data, dataSize, DT_TILE_FREE_DATA, 0, &tileRef);
         }
 
         // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
@@ -370,8 +386,7 @@ namespace MMAP
 
     ObjectLockType& MMapManager::GetLock(uint32 mapId, MapLockType _lockType)
     {
-        // need implement method for fast find first instanceable map by num.
-        Map* map = sMapMgr.FindMap(mapId, 0);
-        return map ? map->GetLock(_lockType) : sWorld.GetLock(_lockType);
+        // navmesh is shared by all instances of the map, so lock by map id, not by map object
+        return ObjectLockTable::GetLock(mapId, _lockType);
     }
 }
@@ -76,7 +76,8 @@ namespace MMAP
             MMapManager() : loadedTiles(0) {}
             ~MMapManager();
 
-            bool loadMap(uint32 mapId, int32 x, int32 y);
+            // data of the tile can be read before by readTile, it is taken over in any case
+            bool loadMap(uint32 mapId, int32 x, int32 y, unsigned char* data = NULL, uint32 dataSize = 0);
             bool unloadMap(uint32 mapId, int32 x, int32 y);
             bool unloadMap(uint32 mapId);
             bool unloadMapInstance(uint32 mapId, uint32 instanceId);
@@ -85,6 +86,9 @@ namespace MMAP
             dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId, uint32 instanceId);
             dtNavMesh const* GetNavMesh(uint32 mapId);
 
+            // reads a tile file, does not touch loaded navmeshes so can be used from any thread
+            static unsigned char* readTile(uint32 mapId, int32 x, int32 y, uint32& dataSize);
+
             uint32 getLoadedTilesCount() const { return loadedTiles; }
             uint32 getLoadedMapsCount() const { return loadedMMaps.size(); }
 
@@ -31,6 +31,9 @@
 #include "WaypointMovementGenerator.h"
 #include "MapPersistentStateMgr.h"
 #include "ObjectMgr.h"
+#include "GridNotifiers.h"
+#include "CellImpl.h"
+#include "Metrics/Metrics.h"
 
 void WorldSession::HandleMoveWorldportAckOpcode( WorldPacket & /*recv_data*/ )
 {
@@ -210,8 +213,9 @@ void WorldSession::HandleMoveWorldportAckOpcode()
     //lets process all delayed operations on successful teleport
     GetPlayer()->ProcessDelayedOperations();
 
-    // Set last WS update time to 0 - grant sending ALL WS updates from new map.
+    // Set last WS update time and version to 0 - grant sending ALL WS updates from new map.
     GetPlayer()->SetLastWorldStateUpdateTime(time_t(0));
+    GetPlayer()->ResetWorldStateVersion();
 }
 
 void WorldSession::HandleMoveTeleportAckOpcode(WorldPacket& recv_data)
@@ -307,7 +311,40 @@ void WorldSession::HandleMovementOpcodes( WorldPacket & recv_data )
     WorldPacket data(opcode, recv_data.size());
     data << mover->GetPackGUID();             // write guid
     movementInfo.Write(data);                               // write data
-    mover->SendMessageToSetExcept(&data, _player);
+    RelayMovement(mover, data);
+}
+
+/// Send movement of our mover to observers, heartbeats less often to distant ones
+void WorldSession::RelayMovement(Unit* mover, WorldPacket const& data)
+{
+    static MetricCounter* relayedSent = sMetrics.GetCounter("mangos_movement_relay_total", "Movement packets of players relayed to observers", "result=\"sent\"");
+    static MetricCounter* relayedSkipped = sMetrics.GetCounter("mangos_movement_relay_total", "Movement packets of players relayed to observers", "result=\"skipped\"");
+
+    if (!mover->IsInWorld())
+        return;
+
+    // only heartbeats repeat the movement state and may be dropped, the client extrapolates the position meanwhile;
+    // a dropped facing or pitch change would stay wrong until the next movement packet
+    bool repeated = data.GetOpcode() == MSG_MOVE_HEARTBEAT;
+
+    uint32 now = WorldTimer::getMSTime();
+    uint32 intervals[MAX_MOVEMENT_RELAY_TIER] = { 0, sWorld.getConfig(CONFIG_UINT32_MOVEMENT_RELAY_MID_INTERVAL), sWorld.getConfig(CONFIG_UINT32_MOVEMENT_RELAY_FAR_INTERVAL) };
+
+    uint32 tierMask = 0;
+    for (int i = 0; i < MAX_MOVEMENT_RELAY_TIER; ++i)
+    {
+        if (repeated && WorldTimer::getMSTimeDiff(m_movementRelayTime[i], now) < intervals[i])
+            continue;
+
+        tierMask |= 1 << i;
+        m_movementRelayTime[i] = now;
+    }
+
+    MaNGOS::MovementRelayDeliverer notifier(*mover, data, _player, tierMask);
+    Cell::VisitWorldObjects(mover, notifier, mover->GetMap()->GetVisibilityDistance(mover));
+
+    relayedSent->Inc(notifier.i_sent);
+    relayedSkipped->Inc(notifier.i_skipped);
 }
 
 void WorldSession::HandleForceSpeedChangeAckOpcodes(WorldPacket &recv_data)
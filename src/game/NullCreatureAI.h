@@ -36,6 +36,7 @@ class MANGOS_DLL_DECL NullCreatureAI : public CreatureAI
         bool IsVisible(Unit *) const { return false;  }
 
         void UpdateAI(const uint32) {}
+        bool HasOutOfCombatUpdate() const { return false; }
         static int Permissible(const Creature *) { return PERMIT_BASE_IDLE;  }
 };
 #endif
@@ -46,6 +46,7 @@
 #include "UpdateFieldFlags.h"
 #include "Group.h"
 #include "CreatureLinkingMgr.h"
+#include "MemoryPool.h"
 
 #define TERRAIN_LOS_STEP_DISTANCE   3.0f        // sample distance for terrain LoS
 
@@ -132,22 +133,18 @@ Object::~Object( )
         MANGOS_ASSERT(false);
     }
 
-    if (m_uint32Values)
-    {
-        //DEBUG_LOG("Object desctr 1 check (%p)",(void*)this);
-        delete [] m_uint32Values;
-        delete [] m_uint32Values_mirror;
-        //DEBUG_LOG("Object desctr 2 check (%p)",(void*)this);
-    }
+    // mirror is allocated in the same block
+    MemoryPool::Deallocate(m_uint32Values, 2 * m_valuesCount * sizeof(uint32));
 }
 
 void Object::_InitValues()
 {
-    m_uint32Values = new uint32[ m_valuesCount ];
-    memset(m_uint32Values, 0, m_valuesCount*sizeof(uint32));
+    // values and mirror in one pooled block, sized per type by m_valuesCount
+    // (players exceed the pool's size classes and get it from operator new)
+    m_uint32Values = static_cast<uint32*>(MemoryPool::Allocate(2 * m_valuesCount * sizeof(uint32)));
+    memset(m_uint32Values, 0, 2 * m_valuesCount * sizeof(uint32));
 
-    m_uint32Values_mirror = new uint32[ m_valuesCount ];
-    memset(m_uint32Values_mirror, 0, m_valuesCount*sizeof(uint32));
+    m_uint32Values_mirror = m_uint32Values + m_valuesCount;
 
     m_objectUpdated = false;
 }
@@ -1080,7 +1077,7 @@ void Object::MarkForClientUpdate()
 WorldObject::WorldObject()
     : m_groupLootTimer(0), m_groupLootId(0), m_lootGroupRecipientId(0), m_transportInfo(NULL),
     m_currMap(NULL), m_mapId(0), m_InstanceId(0), m_phaseMask(PHASEMASK_NORMAL), m_viewPoint(*this), m_isActiveObject(false),
-    m_LastUpdateTime(WorldTimer::getMSTime())
+    m_LastUpdateTime(WorldTimer::getMSTime()), m_Events(this)
 {
 }
 
@@ -1711,6 +1708,8 @@ void WorldObject::SetMap(Map * map)
     //lets save current map's Id/instanceId
     m_mapId = map->GetId();
     m_InstanceId = map->GetInstanceId();
+    // planned events continue on the timer wheel of the new map
+    m_Events.SetTimerWheel(map->GetEventWheel());
 }
 
 TerrainInfo const* WorldObject::GetTerrain() const
@@ -2305,12 +2304,11 @@ void WorldObject::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime)
         GetEvents()->AddEvent(Event, e_time, set_addtime);
 }
 
-void WorldObject::UpdateEvents(uint32 update_diff, uint32 time)
+void WorldObject::UpdateEvents(uint32 /*update_diff*/, uint32 /*time*/)
 {
-    {
-        MAPLOCK_READ(this, MAP_LOCK_TYPE_DEFAULT);
-        GetEvents()->RenewEvents();
-    }
-
-    GetEvents()->Update(update_diff);
+    // only plan new events and events parked while the object was out of the updated cells,
+    // due events are executed in bulk by Map::UpdateEvents
+    MAPLOCK_READ(this, MAP_LOCK_TYPE_DEFAULT);
+    GetEvents()->RenewEvents();
+    GetEvents()->ResumeEvents();
 }
@@ -596,7 +596,7 @@ class MANGOS_DLL_SPEC WorldObject : public Object
         void SetMap(Map * map);
         Map * GetMap() const { return m_currMap; }
         //used to check all object's GetMap() calls when object is not in world!
-        void ResetMap() { m_currMap = NULL; }
+        void ResetMap() { m_Events.SetTimerWheel(NULL); m_currMap = NULL; }
 
         ObjectLockType& GetLock(MapLockType _locktype = MAP_LOCK_TYPE_DEFAULT);
 
@@ -642,7 +642,7 @@ class MANGOS_DLL_SPEC WorldObject : public Object
         void UpdateWorldState(uint32 state, uint32 value);
         uint32 GetWorldState(uint32 state);
 
-        // Event handler
+        // Event handler (events are executed by the map timer wheel, see Map::UpdateEvents)
         WorldObjectEventProcessor* GetEvents();
         void UpdateEvents(uint32 update_diff, uint32 time);
         void KillAllEvents(bool force);
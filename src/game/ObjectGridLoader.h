@@ -64,13 +64,14 @@ class MANGOS_DLL_DECL ObjectGridUnloader
         void UnloadN()
         {
             for(unsigned int x=0; x < MAX_NUMBER_OF_CELLS; ++x)
-            {
                 for(unsigned int y=0; y < MAX_NUMBER_OF_CELLS; ++y)
-                {
-                    GridLoader<Player, AllWorldObjectTypes, AllGridObjectTypes> loader;
-                    loader.Unload(i_grid(x, y), *this);
-                }
-            }
+                    UnloadCell(x, y);
+        }
+
+        void UnloadCell(uint32 x, uint32 y)
+        {
+            GridLoader<Player, AllWorldObjectTypes, AllGridObjectTypes> loader;
+            loader.Unload(i_grid(x, y), *this);
         }
 
         void Unload(GridType &grid);
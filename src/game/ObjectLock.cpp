@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2011-2012 /dev/rsa for MangosR2 <http://github.com/MangosR2>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ObjectLock.h"
+
+volatile bool ObjectLockStats::m_enabled = false;
+ObjectLockStats::ClassStats ObjectLockStats::m_stats[MAP_LOCK_TYPE_MAX];
+
+ObjectLockTable::Stripe ObjectLockTable::m_stripes[MAP_LOCK_TYPE_MAX][ObjectLockTable::LOCK_TABLE_STRIPES];
+
+// stripes must know their lock class before first use, m_stripes is defined above so it is already constructed
+static struct ObjectLockTableInitializer
+{
+    ObjectLockTableInitializer() { ObjectLockTable::Initialize(); }
+} s_objectLockTableInitializer;
+
+void ObjectLockStats::Reset()
+{
+    for (int i = 0; i < MAP_LOCK_TYPE_MAX; ++i)
+    {
+        m_stats[i].acquired = 0;
+        m_stats[i].contended = 0;
+        m_stats[i].waitTime = 0;
+        m_stats[i].maxWaitTime = 0;
+        m_stats[i].holdTime = 0;
+    }
+}
+
+void ObjectLockStats::AddAcquire(MapLockType lockClass, ACE_hrtime_t waitTime, bool contended)
+{
+    ClassStats& stats = m_stats[lockClass];
+    ++stats.acquired;
+
+    if (!contended)
+        return;
+
+    long waitUs = long(waitTime / 1000);
+    ++stats.contended;
+    stats.waitTime += waitUs;
+
+    // not exact under races, good enough for a statistic
+    if (waitUs > stats.maxWaitTime.value())
+        stats.maxWaitTime = waitUs;
+}
+
+void ObjectLockStats::AddHold(MapLockType lockClass, ACE_hrtime_t holdTime)
+{
+    m_stats[lockClass].holdTime += long(holdTime / 1000);
+}
+
+char const* ObjectLockStats::GetClassName(MapLockType lockClass)
+{
+    switch (lockClass)
+    {
+        case MAP_LOCK_TYPE_DEFAULT:  return "default";
+        case MAP_LOCK_TYPE_AURAS:    return "auras";
+        case MAP_LOCK_TYPE_MMAP:     return "mmap";
+        case MAP_LOCK_TYPE_MOVEMENT: return "movement";
+        default:                     return "unknown";
+    }
+}
+
+void ObjectLockTable::Initialize()
+{
+    for (int i = 0; i < MAP_LOCK_TYPE_MAX; ++i)
+        for (int j = 0; j < LOCK_TABLE_STRIPES; ++j)
+            m_stripes[i][j].lock.SetLockClass(MapLockType(i));
+}
@@ -24,6 +24,8 @@
 #include "Policies/ThreadingModel.h"
 #include "ace/RW_Thread_Mutex.h"
 #include "ace/Thread_Mutex.h"
+#include "ace/Atomic_Op.h"
+#include "ace/OS_NS_time.h"
 
 enum MapLockType
 {
@@ -34,9 +36,228 @@ enum MapLockType
     MAP_LOCK_TYPE_MAX,
 };
 
-typedef   ACE_RW_Thread_Mutex                ObjectLockType;
-typedef   ACE_Read_Guard<ObjectLockType>     ReadGuard;
-typedef   ACE_Write_Guard<ObjectLockType>    WriteGuard;
+/**
+ * Lock usage statistics, collected per lock class (MapLockType).
+ * Collection is disabled by default, so the hot paths only pay
+ * for one flag check; it is switched by `.debug lockstats`.
+ */
+class MANGOS_DLL_SPEC ObjectLockStats
+{
+    public:
+        typedef ACE_Atomic_Op<ACE_Thread_Mutex, long> Counter;
+
+        struct ClassStats
+        {
+            Counter acquired;                               // successful acquires (read and write)
+            Counter contended;                              // acquires that had to wait
+            Counter waitTime;                               // total wait time, in microseconds
+            Counter maxWaitTime;                            // longest single wait, in microseconds
+            Counter holdTime;                               // total hold time of guarded sections, in microseconds
+        };
+
+        static bool IsEnabled() { return m_enabled; }
+        static void SetEnabled(bool enabled) { m_enabled = enabled; }
+        static void Reset();
+
+        static void AddAcquire(MapLockType lockClass, ACE_hrtime_t waitTime, bool contended);
+        static void AddHold(MapLockType lockClass, ACE_hrtime_t holdTime);
+
+        static ClassStats const& GetStats(MapLockType lockClass) { return m_stats[lockClass]; }
+        static char const* GetClassName(MapLockType lockClass);
+
+    private:
+        static volatile bool m_enabled;
+        static ClassStats m_stats[MAP_LOCK_TYPE_MAX];
+};
+
+/**
+ * Read/write lock with ACE_RW_Thread_Mutex interface that knows its lock class,
+ * so contention can be accounted when statistics are enabled.
+ */
+class MANGOS_DLL_SPEC ObjectRWLock
+{
+    public:
+        explicit ObjectRWLock(MapLockType lockClass = MAP_LOCK_TYPE_DEFAULT) : m_class(lockClass) {}
+
+        MapLockType GetLockClass() const { return m_class; }
+        void SetLockClass(MapLockType lockClass) { m_class = lockClass; }
+
+        int acquire_read()
+        {
+            if (!ObjectLockStats::IsEnabled())
+                return m_lock.acquire_read();
+
+            if (m_lock.tryacquire_read() == 0)
+            {
+                ObjectLockStats::AddAcquire(m_class, 0, false);
+                return 0;
+            }
+
+            ACE_hrtime_t start = ACE_OS::gethrtime();
+            int result = m_lock.acquire_read();
+            ObjectLockStats::AddAcquire(m_class, ACE_OS::gethrtime() - start, true);
+            return result;
+        }
+
+        int acquire_write()
+        {
+            if (!ObjectLockStats::IsEnabled())
+                return m_lock.acquire_write();
+
+            if (m_lock.tryacquire_write() == 0)
+            {
+                ObjectLockStats::AddAcquire(m_class, 0, false);
+                return 0;
+            }
+
+            ACE_hrtime_t start = ACE_OS::gethrtime();
+            int result = m_lock.acquire_write();
+            ObjectLockStats::AddAcquire(m_class, ACE_OS::gethrtime() - start, true);
+            return result;
+        }
+
+        int acquire() { return acquire_write(); }
+        int tryacquire_read() { return m_lock.tryacquire_read(); }
+        int tryacquire_write() { return m_lock.tryacquire_write(); }
+        int tryacquire() { return m_lock.tryacquire_write(); }
+        int release() { return m_lock.release(); }
+
+    private:
+        ObjectRWLock(ObjectRWLock const&);
+        ObjectRWLock& operator=(ObjectRWLock const&);
+
+        ACE_RW_Thread_Mutex m_lock;
+        MapLockType m_class;
+};
+
+typedef   ObjectRWLock                       ObjectLockType;
+
+/**
+ * Scoped guards for ObjectLockType. The lock is released only if it was really
+ * acquired (a nested acquire of a lock already write-held by the same thread fails
+ * instead of blocking), hold time is accounted when statistics are enabled.
+ */
+template<bool WRITE>
+class ObjectLockGuard
+{
+    public:
+        explicit ObjectLockGuard(ObjectLockType& lock) : m_lock(lock), m_start(0)
+        {
+            m_owner = (WRITE ? m_lock.acquire_write() : m_lock.acquire_read()) == 0;
+            if (m_owner && ObjectLockStats::IsEnabled())
+                m_start = ACE_OS::gethrtime();
+        }
+
+        ~ObjectLockGuard()
+        {
+            if (!m_owner)
+                return;
+
+            if (m_start)
+                ObjectLockStats::AddHold(m_lock.GetLockClass(), ACE_OS::gethrtime() - m_start);
+
+            m_lock.release();
+        }
+
+        bool locked() const { return m_owner; }
+
+    private:
+        ObjectLockGuard(ObjectLockGuard const&);
+        ObjectLockGuard& operator=(ObjectLockGuard const&);
+
+        ObjectLockType& m_lock;
+        ACE_hrtime_t m_start;
+        bool m_owner;
+};
+
+typedef   ObjectLockGuard<false>             ReadGuard;
+typedef   ObjectLockGuard<true>              WriteGuard;
+
+/**
+ * Scoped guard for the locks of two objects. The locks are always taken in ascending
+ * address order, a lock common to both objects (same map) is taken once.
+ */
+template<bool WRITE>
+class ObjectLockPairGuard
+{
+    public:
+        ObjectLockPairGuard(ObjectLockType& lock1, ObjectLockType& lock2) : m_start(0)
+        {
+            m_locks[0] = &lock1 < &lock2 ? &lock1 : &lock2;
+            m_locks[1] = &lock1 == &lock2 ? NULL : (&lock1 < &lock2 ? &lock2 : &lock1);
+
+            for (int i = 0; i < 2; ++i)
+                m_owner[i] = m_locks[i] && (WRITE ? m_locks[i]->acquire_write() : m_locks[i]->acquire_read()) == 0;
+
+            if (ObjectLockStats::IsEnabled())
+                m_start = ACE_OS::gethrtime();
+        }
+
+        ~ObjectLockPairGuard()
+        {
+            ACE_hrtime_t holdTime = m_start ? ACE_OS::gethrtime() - m_start : 0;
+
+            for (int i = 1; i >= 0; --i)
+            {
+                if (!m_owner[i])
+                    continue;
+
+                if (m_start)
+                    ObjectLockStats::AddHold(m_locks[i]->GetLockClass(), holdTime);
+
+                m_locks[i]->release();
+            }
+        }
+
+    private:
+        ObjectLockPairGuard(ObjectLockPairGuard const&);
+        ObjectLockPairGuard& operator=(ObjectLockPairGuard const&);
+
+        ObjectLockType* m_locks[2];
+        bool m_owner[2];
+        ACE_hrtime_t m_start;
+};
+
+typedef   ObjectLockPairGuard<false>         ReadPairGuard;
+
+/**
+ * Global table of striped locks for data shared by all instances of a map,
+ * navmesh tiles are loaded and unloaded under a stripe selected by map id.
+ * Every stripe uses its own cache line.
+ *
+ * Per-object data (aura containers, movement state) stays guarded by the locks of
+ * the object's map: code holding the aura lock of one unit takes the one of another
+ * unit (damage, proc and bonus calculation), with map locks that is a nested read of
+ * the same lock, with per-object stripes it would be two locks taken in any order.
+ */
+class MANGOS_DLL_SPEC ObjectLockTable
+{
+    public:
+        static ObjectLockType& GetLock(uint64 key, MapLockType lockClass)
+        {
+            // fibonacci hashing, low guid bits are sequential counters
+            uint32 stripe = uint32((key * UI64LIT(0x9E3779B97F4A7C15)) >> (64 - LOCK_TABLE_STRIPES_BITS));
+            return m_stripes[lockClass][stripe].lock;
+        }
+
+        static void Initialize();
+
+    private:
+        enum
+        {
+            LOCK_TABLE_STRIPES_BITS = 8,
+            LOCK_TABLE_STRIPES      = 1 << LOCK_TABLE_STRIPES_BITS,
+            LOCK_CACHE_LINE_SIZE    = 64
+        };
+
+        struct Stripe
+        {
+            ObjectLockType lock;
+            char pad[LOCK_CACHE_LINE_SIZE - sizeof(ObjectLockType) % LOCK_CACHE_LINE_SIZE];
+        };
+
+        static Stripe m_stripes[MAP_LOCK_TYPE_MAX][LOCK_TABLE_STRIPES];
+};
 
 #ifndef MAPLOCK_READ
 #  define MAPLOCK_READ(OBJ,TYPE) ReadGuard Guard((OBJ)->GetLock(TYPE));
@@ -50,6 +271,10 @@ typedef   ACE_Write_Guard<ObjectLockType>    WriteGuard;
 #  define MAPLOCK_READ2(OBJ,TYPE) ReadGuard Guard2((OBJ)->GetLock(TYPE));
 #endif
 
+#ifndef MAPLOCK_READ_PAIR
+#  define MAPLOCK_READ_PAIR(OBJ1,OBJ2,TYPE) ReadPairGuard Guard((OBJ1)->GetLock(TYPE), (OBJ2)->GetLock(TYPE));
+#endif
+
 #ifndef MAPLOCK_WRITE
 #  define MAPLOCK_WRITE(OBJ,TYPE) WriteGuard Guard((OBJ)->GetLock(TYPE));
 #endif
@@ -1166,8 +1166,12 @@ void ObjectMgr::LoadCreatureModelRace()
 void ObjectMgr::LoadCreatures()
 {
     uint32 count = 0;
-    //                                                0                       1   2    3
-    QueryResult *result = WorldDatabase.Query("SELECT creature.guid, creature.id, map, modelid,"
+
+    // prepared statement: the numeric columns are read without string conversion
+    static SqlStatementID selCreatures;
+
+    //                                                                             0                       1   2    3
+    SqlStatement stmt = WorldDatabase.CreateStatement(selCreatures, "SELECT creature.guid, creature.id, map, modelid,"
     //   4             5           6           7           8            9              10         11
         "equipment_id, position_x, position_y, position_z, orientation, spawntimesecs, spawndist, currentwaypoint,"
     //   12         13       14          15            16         17         18
@@ -1179,6 +1183,8 @@ void ObjectMgr::LoadCreatures()
         "LEFT OUTER JOIN pool_creature ON creature.guid = pool_creature.guid "
         "LEFT OUTER JOIN pool_creature_template ON creature.id = pool_creature_template.id");
 
+    QueryResult *result = stmt.Query();
+
     if (!result)
     {
         BarGoLink bar(1);
@@ -1418,8 +1424,10 @@ void ObjectMgr::LoadGameObjects()
 {
     uint32 count = 0;
 
-    //                                                0                           1   2    3           4           5           6
-    QueryResult *result = WorldDatabase.Query("SELECT gameobject.guid, gameobject.id, map, position_x, position_y, position_z, orientation,"
+    static SqlStatementID selGameObjects;
+
+    //                                                                               0                           1   2    3           4           5           6
+    SqlStatement stmt = WorldDatabase.CreateStatement(selGameObjects, "SELECT gameobject.guid, gameobject.id, map, position_x, position_y, position_z, orientation,"
     //   7          8          9          10         11             12            13     14         15         16
         "rotation0, rotation1, rotation2, rotation3, spawntimesecs, animprogress, state, spawnMask, phaseMask, event,"
     //   17                          18
@@ -1429,6 +1437,8 @@ void ObjectMgr::LoadGameObjects()
         "LEFT OUTER JOIN pool_gameobject ON gameobject.guid = pool_gameobject.guid "
         "LEFT OUTER JOIN pool_gameobject_template ON gameobject.id = pool_gameobject_template.id");
 
+    QueryResult *result = stmt.Query();
+
     if (!result)
     {
         BarGoLink bar(1);
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "OpcodeWorkerPool.h"
+#include "WorldSession.h"
+#include "WorldPacket.h"
+#include "Log.h"
+#include "Metrics/Metrics.h"
+
+#include <ace/Guard_T.h>
+#include <ace/Thread_Manager.h>
+#include <ace/TSS_T.h>
+
+typedef ACE_Guard<ACE_Thread_Mutex> OpcodeWorkerGuard;
+
+// time a packet waited for a worker, in microseconds
+static long const QueueTimeBounds[] = { 50, 100, 250, 500, 1000, 2500, 5000, 10000, 50000, 250000 };
+
+struct OpcodeWorkerThreadState
+{
+    OpcodeWorkerThreadState() : worker(false) {}
+
+    bool worker;
+};
+
+static ACE_TSS<OpcodeWorkerThreadState> WorkerThreadState;
+
+OpcodeWorkerPool::OpcodeWorkerPool() : m_threads(0), m_group(-1), m_cond(m_lock), m_stopping(false)
+{
+    for (uint32 i = 0; i < NUM_MSG_TYPES; ++i)
+        m_queueTime[i] = NULL;
+}
+
+OpcodeWorkerPool::~OpcodeWorkerPool()
+{
+    Stop();
+}
+
+OpcodeWorkerPool& OpcodeWorkerPool::Instance()
+{
+    static OpcodeWorkerPool pool;
+    return pool;
+}
+
+bool OpcodeWorkerPool::Start(uint32 threads)
+{
+    if (!threads)
+        return true;
+
+    for (uint32 i = 0; i < NUM_MSG_TYPES; ++i)
+    {
+        if (opcodeTable[i].packetProcessing != PROCESS_READONLY_ASYNC || m_queueTime[i])
+            continue;
+
+        std::string label = std::string("opcode=\"") + opcodeTable[i].name + "\"";
+        m_queueTime[i] = sMetrics.GetHistogram("mangos_async_opcode_queue_microseconds", "Time read-only opcodes waited for a worker thread",
+            QueueTimeBounds, sizeof(QueueTimeBounds) / sizeof(QueueTimeBounds[0]), label);
+    }
+
+    m_stopping = false;
+    m_group = ACE_Thread_Manager::instance()->spawn_n(threads, (ACE_THR_FUNC)&WorkerThread, this);
+    if (m_group == -1)
+    {
+        sLog.outError("OpcodeWorkerPool: can't start %u worker threads, read-only opcodes are processed by session updates", threads);
+        return false;
+    }
+
+    m_threads = threads;
+    return true;
+}
+
+void OpcodeWorkerPool::Stop()
+{
+    if (!m_threads)
+        return;
+
+    {
+        OpcodeWorkerGuard guard(m_lock);
+        m_stopping = true;
+        m_cond.broadcast();
+    }
+
+    ACE_Thread_Manager::instance()->wait_grp(m_group);
+    m_threads = 0;
+    m_group = -1;
+
+    // sessions wait for their packets, the rest is executed here
+    while (!m_jobs.empty())
+    {
+        Job job = m_jobs.front();
+        m_jobs.pop_front();
+        job.session->ExecuteAsyncOpcode(job.packet);
+    }
+}
+
+bool OpcodeWorkerPool::Enqueue(WorldSession* session, WorldPacket* packet)
+{
+    if (!m_threads)
+        return false;
+
+    OpcodeWorkerGuard guard(m_lock);
+    m_jobs.push_back(Job(session, packet));
+    m_cond.signal();
+    return true;
+}
+
+uint32 OpcodeWorkerPool::GetQueueSize()
+{
+    OpcodeWorkerGuard guard(m_lock);
+    return uint32(m_jobs.size());
+}
+
+bool OpcodeWorkerPool::IsWorkerThread()
+{
+    return WorkerThreadState->worker;
+}
+
+ACE_THR_FUNC_RETURN OpcodeWorkerPool::WorkerThread(void* arg)
+{
+    WorkerThreadState->worker = true;
+    ((OpcodeWorkerPool*)arg)->RunWorker();
+    return 0;
+}
+
+void OpcodeWorkerPool::RunWorker()
+{
+    for (;;)
+    {
+        Job job;
+        {
+            OpcodeWorkerGuard guard(m_lock);
+
+            while (m_jobs.empty() && !m_stopping)
+                m_cond.wait();
+
+            if (m_stopping)
+                return;
+
+            job = m_jobs.front();
+            m_jobs.pop_front();
+        }
+
+        if (MetricHistogram* queueTime = m_queueTime[job.packet->GetOpcode()])
+            queueTime->Observe(long((ACE_OS::gethrtime() - job.queued) / 1000));
+
+        ACE_Read_Guard<ACE_RW_Thread_Mutex> storeGuard(m_storeLock);
+        job.session->ExecuteAsyncOpcode(job.packet);
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_OPCODEWORKERPOOL_H
+#define MANGOS_OPCODEWORKERPOOL_H
+
+#include "Common.h"
+#include "Opcodes.h"
+
+#include <ace/Condition_Thread_Mutex.h>
+#include <ace/Guard_T.h>
+#include <ace/OS_NS_time.h>
+#include <ace/RW_Thread_Mutex.h>
+#include <ace/Thread_Mutex.h>
+
+#include <deque>
+
+class WorldSession;
+class WorldPacket;
+class MetricHistogram;
+
+/**
+ * Threads executing PROCESS_READONLY_ASYNC opcodes out of the world and map threads.
+ *
+ * Handlers of such opcodes only read template stores and the session locale,
+ * and send their answer to the socket of the session. The session is kept alive
+ * until its queued packets are executed. Reloads of the stores read by these
+ * handlers must hold the store lock for writing.
+ *
+ * Without threads the packets are executed at once by the session update.
+ */
+class OpcodeWorkerPool
+{
+    public:
+        OpcodeWorkerPool();
+        ~OpcodeWorkerPool();
+
+        static OpcodeWorkerPool& Instance();
+
+        bool Start(uint32 threads);
+        void Stop();
+
+        // takes ownership of the packet, false if there are no threads
+        bool Enqueue(WorldSession* session, WorldPacket* packet);
+
+        uint32 GetQueueSize();
+
+        ACE_RW_Thread_Mutex& GetStoreLock() { return m_storeLock; }
+
+        static bool IsWorkerThread();
+
+    private:
+        struct Job
+        {
+            Job() : session(NULL), packet(NULL), queued(0) {}
+            Job(WorldSession* _session, WorldPacket* _packet) : session(_session), packet(_packet), queued(ACE_OS::gethrtime()) {}
+
+            WorldSession* session;
+            WorldPacket* packet;
+            ACE_hrtime_t queued;
+        };
+
+        static ACE_THR_FUNC_RETURN WorkerThread(void* arg);
+        void RunWorker();
+
+        uint32 m_threads;
+        int m_group;
+
+        MetricHistogram* m_queueTime[NUM_MSG_TYPES];        // for opcodes of the pool only
+
+        ACE_RW_Thread_Mutex m_storeLock;                    // read by executed handlers
+
+        ACE_Thread_Mutex m_lock;                            // guards all below
+        ACE_Condition_Thread_Mutex m_cond;
+        std::deque<Job> m_jobs;
+        bool m_stopping;
+};
+
+// held while reloading stores read by PROCESS_READONLY_ASYNC handlers
+typedef ACE_Write_Guard<ACE_RW_Thread_Mutex> OpcodeStoreWriteGuard;
+
+#define sOpcodeWorkerPool OpcodeWorkerPool::Instance()
+
+#endif
@@ -19,6 +19,7 @@
 #include "MoveMap.h"
 #include "GridMap.h"
 #include "Creature.h"
+#include "Map.h"
 #include "PathFinder.h"
 #include "Log.h"
 
@@ -475,6 +476,8 @@ void PathFinder::BuildPointPath(const float *startPoint, const float *endPoint)
 
     pointCount = tempPointCounter;
 
+    SnapToGround();
+
     // first point is always our current location - we need the next one
     setActualEndPosition(m_pathPoints[pointCount-1]);
 
@@ -517,6 +520,29 @@ void PathFinder::BuildShortcut()
     m_type = PATHFIND_SHORTCUT;
 }
 
+void PathFinder::SnapToGround()
+{
+    if (m_sourceUnit->GetTypeId() == TYPEID_UNIT && ((Creature const*)m_sourceUnit)->CanFly())
+        return;
+
+    // first point is our current location; steps of smooth paths already have the height of the
+    // navmesh detail mesh, only the corners of straight paths and the end point need the ground
+    uint32 last = m_pathPoints.size() - 1;
+    uint32 first = m_useStraightPath ? 1 : last;
+    uint32 count = last - first + 1;
+
+    TerrainSample samples[MAX_POINT_PATH_LENGTH];
+    for (uint32 i = 0; i < count; ++i)
+        samples[i] = TerrainSample(m_pathPoints[first + i].x, m_pathPoints[first + i].y, m_pathPoints[first + i].z);
+
+    m_sourceUnit->GetMap()->GetHeights(m_sourceUnit->GetPhaseMask(), samples, count);
+
+    // points far from the ground are on water surface or where vmaps differ from the navmesh
+    for (uint32 i = 0; i < count; ++i)
+        if (samples[i].height > INVALID_HEIGHT && fabs(samples[i].height - samples[i].z) < GROUND_SNAP_DISTANCE)
+            m_pathPoints[first + i].z = samples[i].height;
+}
+
 void PathFinder::createFilter()
 {
     uint16 includeFlags = 0;
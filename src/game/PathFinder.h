@@ -44,6 +44,9 @@ class Unit;
 #define SKIP_POINT_LIMIT        6
 #define LINE_FAULT              0.5f
 
+// navmesh heights are approximated, closer ground is used for the path points
+#define GROUND_SNAP_DISTANCE    2.0f
+
 #define VERTEX_SIZE       3
 #define INVALID_POLYREF   0
 
@@ -122,6 +125,7 @@ class PathFinder
         void BuildPolyPath(const Vector3 &startPos, const Vector3 &endPos);
         void BuildPointPath(const float *startPoint, const float *endPoint);
         void BuildShortcut();
+        void SnapToGround();
 
         NavTerrain getNavTerrain(float x, float y, float z);
         void createFilter();
@@ -473,7 +473,8 @@ Player::Player (WorldSession *session): Unit(), m_mover(this), m_camera(NULL), m
     m_deathTimer = 0;
     m_deathExpireTime = 0;
 
-    m_lastWSUpdateTime = 0; // == 0 in initialise, for review all updates
+    m_lastWSUpdateTime = 0;
+    m_lastWSVersion = 0;    // == 0 in initialise, for review all updates
 
     m_swingErrorMsg = 0;
 
@@ -4478,6 +4479,9 @@ void Player::DeleteFromDB(ObjectGuid playerguid, uint32 accountId, bool updateRe
 
     sAccountMgr.ClearPlayerDataCache(playerguid);
 
+    if (accountId)
+        sWorld.InvalidateCharEnum(accountId);
+
     if (updateRealmChars)
         sAccountMgr.UpdateCharactersCount(accountId, sWorld.getConfig(CONFIG_UINT32_REALMID));
 }
@@ -8813,7 +8817,11 @@ void Player::SendUpdatedWorldStates(bool force)
     if (IsBeingTeleported() || GetLastWorldStateUpdateTime() == time(NULL))
         return;
 
-    WorldStateSet wsSet = sWorldStateMgr.GetUpdatedWorldStatesFor(this, force ? 0 : GetLastWorldStateUpdateTime());
+    if (force)
+        m_lastWSVersion = 0;
+
+    WorldStateSet wsSet = sWorldStateMgr.GetUpdatedWorldStatesFor(this, m_lastWSVersion);
+    SetLastWorldStateUpdateTime(time(NULL));
 
     if (wsSet.empty())
         return;
@@ -8823,8 +8831,6 @@ void Player::SendUpdatedWorldStates(bool force)
         //DEBUG_LOG("Player::SendUpdatedWorldStates send state %u instance %u value %u to %s",(*itr)->GetId(), (*itr)->GetInstance(),(*itr)->GetValue(),GetObjectGuid().GetString().c_str());
         _SendUpdateWorldState((*itr)->GetId(), (*itr)->GetValue());
     }
-
-    SetLastWorldStateUpdateTime(time(NULL));
 }
 
 void Player::SendInitWorldStates(uint32 zoneid, uint32 areaid)
@@ -17947,7 +17953,7 @@ void Player::_SaveActions()
                         stmt.addUInt32(uint32(itr->first));
                         stmt.addUInt32(i);
                         stmt.Execute();
-                        m_actionButtons[i].erase(itr++);
+                        itr = m_actionButtons[i].erase(itr);
                     }
                     break;
                 default:
@@ -18677,6 +18683,9 @@ void Player::SavePositionInDB(ObjectGuid guid, uint32 mapid, float x, float y, f
         << "transguid='0',taxi_path='' WHERE guid='"<< guid.GetCounter() <<"'";
     DEBUG_LOG("%s", ss.str().c_str());
     CharacterDatabase.Execute(ss.str().c_str());
+
+    // zone is shown in the character list
+    sWorld.InvalidateCharEnum(sAccountMgr.GetPlayerAccountIdByGUID(guid));
 }
 
 void Player::SetUInt32ValueInArray(Tokens& tokens,uint16 index, uint32 value)
@@ -24390,6 +24399,87 @@ bool Player::NeedGoingToHomebind()
     return false;
 }
 
+// estimates of container memory: element plus allocator nodes, tree nodes have three pointers and a color
+template<class Container>
+static size_t TreeMemoryUsage(Container const& container)
+{
+    return container.size() * (sizeof(typename Container::value_type) + 4 * sizeof(void*));
+}
+
+template<class Container>
+static size_t HashMemoryUsage(Container const& container)
+{
+    return container.size() * (sizeof(typename Container::value_type) + 2 * sizeof(void*)) + container.bucket_count() * sizeof(void*);
+}
+
+template<class Container>
+static size_t ListMemoryUsage(Container const& container)
+{
+    return container.size() * (sizeof(typename Container::value_type) + 2 * sizeof(void*));
+}
+
+template<class Container>
+static size_t VectorMemoryUsage(Container const& container)
+{
+    return container.capacity() * sizeof(typename Container::value_type);
+}
+
+static size_t ItemMemoryUsage(Item* item)
+{
+    if (!item->IsBag())
+        return sizeof(Item) + 2 * ITEM_END * sizeof(uint32);
+
+    Bag* bag = (Bag*)item;
+    size_t usage = sizeof(Bag) + 2 * CONTAINER_END * sizeof(uint32);
+    for (uint32 i = 0; i < bag->GetBagSize(); ++i)
+        if (Item* bagItem = bag->GetItemByPos(i))
+            usage += ItemMemoryUsage(bagItem);
+    return usage;
+}
+
+void Player::GetMemoryUsage(PlayerMemoryUsage& usage)
+{
+    usage.object = sizeof(Player) + 2 * m_valuesCount * sizeof(uint32);
+
+    usage.spells = HashMemoryUsage(m_spells) + TreeMemoryUsage(m_spellCooldowns);
+    for (int i = 0; i < MAX_TALENT_SPEC_COUNT; ++i)
+    {
+        usage.spells += HashMemoryUsage(m_talents[i]);
+        usage.spells += m_actionButtons[i].capacity() * sizeof(ActionButtonList::value_type);
+    }
+    for (int i = 0; i < MAX_SPELLMOD; ++i)
+        usage.spells += ListMemoryUsage(m_spellMods[i]);
+
+    usage.quests = TreeMemoryUsage(mQuestStatus) + TreeMemoryUsage(m_timedquests) +
+        TreeMemoryUsage(m_weeklyquests) + TreeMemoryUsage(m_monthlyquests);
+
+    SpellAuraHolderMap const& holders = GetSpellAuraHolderMap();
+    usage.auras = TreeMemoryUsage(holders);
+    for (SpellAuraHolderMap::const_iterator itr = holders.begin(); itr != holders.end(); ++itr)
+    {
+        usage.auras += sizeof(SpellAuraHolder);
+        for (int i = 0; i < MAX_EFFECT_INDEX; ++i)
+            if (itr->second->GetAuraByEffectIndex(SpellEffectIndex(i)))
+                usage.auras += sizeof(Aura);
+    }
+    for (int i = 0; i < TOTAL_AURAS; ++i)
+        usage.auras += ListMemoryUsage(GetAurasByType(AuraType(i)));
+
+    for (int i = 0; i < PLAYER_SLOTS_COUNT; ++i)
+        if (m_items[i])
+            usage.items += ItemMemoryUsage(m_items[i]);
+    usage.items += VectorMemoryUsage(m_itemUpdateQueue) + ListMemoryUsage(m_itemDuration) + ListMemoryUsage(m_enchantDuration);
+
+    usage.visibility = TreeMemoryUsage(m_clientGUIDs);
+
+    usage.other = HashMemoryUsage(mSkillStatus) + TreeMemoryUsage(m_EquipmentSets) + ListMemoryUsage(m_channels);
+    for (int i = 0; i < MAX_DIFFICULTY; ++i)
+        usage.other += HashMemoryUsage(m_boundInstances[i]);
+    usage.other += m_mail.size() * (sizeof(Mail*) + sizeof(Mail)) + HashMemoryUsage(mMitems);
+    for (ItemMap::const_iterator itr = mMitems.begin(); itr != mMitems.end(); ++itr)
+        usage.other += ItemMemoryUsage(itr->second);
+}
+
 uint32 Player::GetEquipGearScore(bool withBags, bool withBank)
 {
     if (withBags && withBank && m_cachedGS > 0)
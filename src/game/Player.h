@@ -40,6 +40,7 @@
 #include "LFG.h"
 #include "AntiCheat.h"
 #include "AccountMgr.h"
+#include "Utilities/FlatMap.h"
 
 // Playerbot mod
 #include "playerbot/PlayerbotMgr.h"
@@ -189,7 +190,8 @@ enum ActionButtonIndex
 
 #define  MAX_ACTION_BUTTONS 144                             //checked in 3.2.0
 
-typedef std::map<uint8,ActionButton> ActionButtonList;
+// at most MAX_ACTION_BUTTONS, a node per button costs more than the button
+typedef FlatMap<uint8,ActionButton> ActionButtonList;
 
 enum GlyphUpdateState
 {
@@ -692,6 +694,22 @@ struct EquipmentSet
 
 typedef std::map<uint32, EquipmentSet> EquipmentSets;
 
+// bytes used by a player per subsystem, estimated from element counts and container overhead
+struct PlayerMemoryUsage
+{
+    PlayerMemoryUsage() : object(0), spells(0), quests(0), auras(0), items(0), visibility(0), other(0) {}
+
+    size_t object;                                          // Player itself and its update values
+    size_t spells;                                          // spells, talents, cooldowns, spell mods, action buttons
+    size_t quests;
+    size_t auras;                                           // aura holders and their auras
+    size_t items;                                           // items in all slots and bags, durations
+    size_t visibility;                                      // objects known by the client
+    size_t other;                                           // skills, instance binds, mails, channels, equipment sets
+
+    size_t GetTotal() const { return object + spells + quests + auras + items + visibility + other; }
+};
+
 struct ItemPosCount
 {
     ItemPosCount(uint16 _pos, uint32 _count) : pos(_pos), count(_count) {}
@@ -1345,6 +1363,8 @@ class MANGOS_DLL_SPEC Player : public Unit
 
         uint32 m_stableSlots;
 
+        void GetMemoryUsage(PlayerMemoryUsage& usage);
+
         uint32 GetEquipGearScore(bool withBags = true, bool withBank = false);
         void ResetCachedGearScore() { m_cachedGS = 0; }
         typedef std::vector<uint32/*item level*/> GearScoreVec;
@@ -2079,6 +2099,7 @@ class MANGOS_DLL_SPEC Player : public Unit
         void SendUpdatedWorldStates(bool force = false);
         time_t const& GetLastWorldStateUpdateTime() { return m_lastWSUpdateTime; };
         void SetLastWorldStateUpdateTime(time_t _time)   { m_lastWSUpdateTime = _time; };
+        void ResetWorldStateVersion()                    { m_lastWSVersion = 0; };
 
         void SendDirectMessage(WorldPacket *data);
 
@@ -2645,6 +2666,7 @@ class MANGOS_DLL_SPEC Player : public Unit
         time_t m_deathExpireTime;
 
         time_t m_lastWSUpdateTime;
+        uint32 m_lastWSVersion;                             // world state change log version sent to client
 
         uint32 m_restTime;
 
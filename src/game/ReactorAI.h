@@ -36,6 +36,7 @@ class MANGOS_DLL_DECL ReactorAI : public CreatureAI
         bool IsVisible(Unit *) const;
 
         void UpdateAI(const uint32);
+        bool HasOutOfCombatUpdate() const { return false; }
         static int Permissible(const Creature *);
 
     private:
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ace/Message_Block.h>
+#include <ace/Atomic_Op.h>
+#include <ace/Malloc_Base.h>
+#include <ace/Thread_Mutex.h>
+
+#include "SharedWorldPacket.h"
+
+/// Payload bytes shared by all recipients, released by the network threads.
+class SharedWorldPacket::Payload
+{
+    public:
+        explicit Payload(WorldPacket const& packet) : m_refs(1), m_size(packet.size()), m_data(new char[packet.size()])
+        {
+            if (m_size)
+                memcpy(m_data, packet.contents(), m_size);
+        }
+
+        void AddRef() { ++m_refs; }
+        void Release() { if (--m_refs == 0) delete this; }
+
+        char const* GetData() const { return m_data; }
+        size_t GetSize() const { return m_size; }
+
+    private:
+        ~Payload() { delete[] m_data; }
+
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_refs;
+        size_t m_size;
+        char* m_data;
+};
+
+/**
+ * Data block of one socket referencing the payload. The block itself has one owner,
+ * so it needs no locking strategy; the payload is shared through its atomic count.
+ */
+class SharedPayloadBlock : public ACE_Data_Block
+{
+    public:
+        SharedPayloadBlock(SharedWorldPacket::Payload* payload, ACE_Allocator* allocator) :
+            ACE_Data_Block(payload->GetSize(), ACE_Message_Block::MB_DATA, payload->GetData(), NULL, NULL, ACE_Message_Block::DONT_DELETE, allocator),
+            m_payload(payload)
+        {
+            m_payload->AddRef();
+        }
+
+        ~SharedPayloadBlock() { m_payload->Release(); }
+
+    private:
+        SharedWorldPacket::Payload* m_payload;
+};
+
+SharedWorldPacket::SharedWorldPacket(WorldPacket const& packet) : m_packet(packet), m_payload(NULL)
+{
+}
+
+SharedWorldPacket::~SharedWorldPacket()
+{
+    if (m_payload)
+        m_payload->Release();
+}
+
+ACE_Message_Block* SharedWorldPacket::DuplicatePayload() const
+{
+    if (!m_payload)
+        ACE_NEW_RETURN(m_payload, Payload(m_packet), NULL);
+
+    // the data block is freed by ACE with its allocator
+    ACE_Allocator* allocator = ACE_Allocator::instance();
+    void* mem = allocator->malloc(sizeof(SharedPayloadBlock));
+    if (!mem)
+        return NULL;
+
+    ACE_Data_Block* block = new (mem) SharedPayloadBlock(m_payload, allocator);
+
+    ACE_Message_Block* mb;
+    ACE_NEW_NORETURN(mb, ACE_Message_Block(block));
+    if (!mb)
+    {
+        block->release();
+        return NULL;
+    }
+
+    mb->wr_ptr(m_payload->GetSize());
+    return mb;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** \addtogroup u2w User to World Communication
+ * @{
+ * \file SharedWorldPacket.h
+ */
+
+#ifndef _SHAREDWORLDPACKET_H
+#define _SHAREDWORLDPACKET_H
+
+#include "Common.h"
+#include "WorldPacket.h"
+
+class ACE_Message_Block;
+
+/**
+ * SharedWorldPacket.
+ *
+ * Wrapper used when the same packet is sent to many sessions
+ * (channel, guild, group, map wide and grid broadcasts).
+ *
+ * The payload of the wrapped packet is serialized at most once into
+ * a reference counted ACE_Data_Block. Every socket that can not put
+ * the packet into its output buffer queues only its own (encrypted)
+ * header block chained with a duplicate of the shared payload block,
+ * so N recipients cost one payload copy instead of N.
+ *
+ * The object itself must be used from one thread only (the broadcasting
+ * one) and must not outlive the wrapped packet, the payload block can be
+ * released from any network thread.
+ */
+class SharedWorldPacket
+{
+    public:
+        /// Payloads smaller than this are still copied into the socket output buffer.
+        static const size_t MIN_SHARED_PAYLOAD_SIZE = 256;
+
+        explicit SharedWorldPacket(WorldPacket const& packet);
+        ~SharedWorldPacket();
+
+        WorldPacket const& GetPacket() const { return m_packet; }
+        uint16 GetOpcode() const { return m_packet.GetOpcode(); }
+        size_t size() const { return m_packet.size(); }
+        bool empty() const { return m_packet.empty(); }
+
+        /// True if sockets should reference the payload instead of copying it.
+        bool IsShareable() const { return m_packet.size() >= MIN_SHARED_PAYLOAD_SIZE; }
+
+        /// Return a new message block referencing the shared payload, the caller must release() it.
+        /// @return NULL on allocation failure
+        ACE_Message_Block* DuplicatePayload() const;
+
+        class Payload;
+
+    private:
+        SharedWorldPacket(SharedWorldPacket const&);
+        SharedWorldPacket& operator=(SharedWorldPacket const&);
+
+        WorldPacket const& m_packet;
+
+        /// Lazily created on first DuplicatePayload() call.
+        mutable Payload* m_payload;
+};
+
+#endif  /* _SHAREDWORLDPACKET_H */
+
+/// @}
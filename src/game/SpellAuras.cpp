@@ -587,7 +587,7 @@ Aura* SpellAuraHolder::CreateAura(SpellEntry const* spellproto, SpellEffectIndex
 
 Aura* SpellAuraHolder::CreateAura(AuraClassType type, SpellEffectIndex eff, int32* currentBasePoints, SpellAuraHolderPtr holder, Unit* target, Unit* caster, Item* castItem)
 {
-    AddAura(Aura(type, m_spellProto, eff, currentBasePoints, holder, target, caster, castItem),eff);
+    AddAura(new Aura(type, m_spellProto, eff, currentBasePoints, holder, target, caster, castItem),eff);
 
     return GetAuraByEffectIndex(eff);
 }
@@ -1455,14 +1455,7 @@ void Aura::TriggerSpell()
                         if (target->GetTypeId() != TYPEID_UNIT)
                             return;
 
-                        ThreatList const& tList = target->getThreatManager().getThreatList();
-                        for (ThreatList::const_iterator itr = tList.begin();itr != tList.end(); ++itr)
-                        {
-                            Unit* pUnit = target->GetMap()->GetUnit((*itr)->getUnitGuid());
-
-                            if (pUnit && target->getThreatManager().getThreat(pUnit))
-                                target->getThreatManager().modifyThreatPercent(pUnit, -100);
-                        }
+                        target->getThreatManager().modifyAllThreatPercent(-100);
 
                         if (Unit* pEnemy = target->SelectRandomUnfriendlyTarget(target->getVictim(), 100.0f))
                             ((Creature*)target)->AI()->AttackStart(pEnemy);
@@ -10490,7 +10483,9 @@ m_permanent(false), m_isRemovedOnShapeLost(true), m_deleted(false), m_in_use(0)
 {
     MANGOS_ASSERT(target);
     MANGOS_ASSERT(spellproto && spellproto == sSpellStore.LookupEntry( spellproto->Id ) && "`info` must be pointer to sSpellStore element");
-    m_aurasStorage.clear();
+
+    for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+        m_auras[i] = NULL;
 
     if (!caster)
         m_casterGuid = target->GetObjectGuid();
@@ -10554,24 +10549,24 @@ m_permanent(false), m_isRemovedOnShapeLost(true), m_deleted(false), m_in_use(0)
     }
 }
 
-void SpellAuraHolder::AddAura(Aura const& aura, SpellEffectIndex index)
+void SpellAuraHolder::AddAura(Aura* aura, SpellEffectIndex index)
 {
     if (/*Aura* _aura = */GetAuraByEffectIndex(index))
     {
         DEBUG_LOG("SpellAuraHolder::AddAura attempt to add aura (effect %u) to holder of spell %u, but holder already have active aura!", index, GetId());
         RemoveAura(index);
     }
-    if (!m_aurasStorage.empty())
+
+    if (Aura* oldAura = m_auras[index])
     {
-        AuraStorage::iterator itr = m_aurasStorage.find(index);
-        if (itr != m_aurasStorage.end())
         {
             MAPLOCK_WRITE(m_target, MAP_LOCK_TYPE_AURAS);
-            m_aurasStorage.erase(itr);
+            m_auras[index] = NULL;
         }
+        delete oldAura;
     }
 
-    m_aurasStorage.insert(AuraStorage::value_type(index,aura));
+    m_auras[index] = aura;
     m_auraFlags |= (1 << index);
 }
 
@@ -10585,29 +10580,31 @@ void SpellAuraHolder::CleanupsBeforeDelete()
     for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
         RemoveAura(SpellEffectIndex(i));
 
-    if (!m_aurasStorage.empty())
-        m_aurasStorage.clear();
+    // auras keep holder references, detach all slots before the deletes can release the holder
+    Aura* auras[MAX_EFFECT_INDEX];
+    for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+    {
+        auras[i] = m_auras[i];
+        m_auras[i] = NULL;
+    }
+
+    for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+        delete auras[i];
 }
 
 Aura* SpellAuraHolder::GetAuraByEffectIndex(SpellEffectIndex index)
 {
-    if ((m_auraFlags & (1 << index)) && !m_aurasStorage.empty())
-    {
-        AuraStorage::iterator itr = m_aurasStorage.find(index);
-        if (itr != m_aurasStorage.end())
-            return &itr->second;
-    }
+    // AFLAG_NOT_CASTER shares the flag bit of MAX_EFFECT_INDEX
+    if (index < MAX_EFFECT_INDEX && (m_auraFlags & (1 << index)))
+        return m_auras[index];
     return (Aura*)NULL;
 }
 
 Aura const* SpellAuraHolder::GetAura(SpellEffectIndex index) const
 {
-    if ((m_auraFlags & (1 << index)) && !m_aurasStorage.empty())
-    {
-        AuraStorage::const_iterator itr = m_aurasStorage.find(index);
-        if (itr != m_aurasStorage.end())
-            return &itr->second;
-    }
+    // AFLAG_NOT_CASTER shares the flag bit of MAX_EFFECT_INDEX
+    if (index < MAX_EFFECT_INDEX && (m_auraFlags & (1 << index)))
+        return m_auras[index];
     return (Aura*)NULL;
 }
 
@@ -12338,6 +12335,8 @@ void SpellAuraHolder::HandleSpellSpecificBoostsForward(bool apply)
 SpellAuraHolder::~SpellAuraHolder()
 {
 //    DEBUG_LOG("SpellAuraHolder:: destructor for SpellAuraHolder of spell %u called.", GetId());
+    for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+        delete m_auras[i];
 }
 
 void SpellAuraHolder::Update(uint32 diff)
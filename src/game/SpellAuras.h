@@ -63,8 +63,6 @@ struct DamageInfo;
 // forward decl
 class Aura;
 
-typedef std::map<SpellEffectIndex,Aura> AuraStorage;
-
 // internal helper
 struct ReapplyAffectedPassiveAurasHelper;
 
@@ -197,7 +195,7 @@ class MANGOS_DLL_SPEC SpellAuraHolder
         ~SpellAuraHolder();
 
     private:
-        void AddAura(Aura const& aura, SpellEffectIndex index);
+        void AddAura(Aura* aura, SpellEffectIndex index);
 
         SpellEntry const* m_spellProto;
 
@@ -220,7 +218,9 @@ class MANGOS_DLL_SPEC SpellAuraHolder
         DiminishingGroup m_AuraDRGroup:8;                   // Diminishing
         TrackedAuraType m_trackedAuraType: 8;               // store if the caster tracks the aura - can change at spell steal for example
 
-        AuraStorage       m_aurasStorage;                   // Auras storage
+        // Auras storage, slot per effect index. Auras are owned but allocated separately, not inline:
+        // an aura keeps a holder reference, releasing it from the aura destructor can delete the holder
+        Aura* m_auras[MAX_EFFECT_INDEX];
 
         bool m_permanent:1;
         bool m_isPassive:1;
@@ -593,8 +593,8 @@ class MANGOS_DLL_SPEC AuraPair
         {
             return
                 !m_holder ||
-                !m_holder->GetAura(m_index) ||
                 (m_index == MAX_EFFECT_INDEX) ||
+                !m_holder->GetAura(m_index) ||
                 m_holder->IsEmptyHolder() ||
                 (withDeleted && m_holder->IsDeleted())
                 ;
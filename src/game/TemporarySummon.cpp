@@ -22,6 +22,19 @@
 #include "CellImpl.h"
 #include "GridNotifiersImpl.h"
 #include "GridNotifiers.h"
+#include "MemoryPool.h"
+
+static ObjectPool TemporarySummonPool("TemporarySummon", sizeof(TemporarySummon));
+
+void* TemporarySummon::operator new(size_t size)
+{
+    return TemporarySummonPool.Allocate(size);
+}
+
+void TemporarySummon::operator delete(void* ptr, size_t size)
+{
+    TemporarySummonPool.Deallocate(ptr, size);
+}
 
 TemporarySummon::TemporarySummon( ObjectGuid summoner ) :
 Creature(CREATURE_SUBTYPE_TEMPORARY_SUMMON), m_type(TEMPSUMMON_TIMED_OR_CORPSE_DESPAWN), m_timer(0), m_lifetime(0), m_summoner(summoner), m_isActive(true)
@@ -30,6 +30,10 @@ class TemporarySummon : public Creature
         explicit TemporarySummon(ObjectGuid summoner = ObjectGuid());
         virtual ~TemporarySummon(){};
 
+        // own pool, Creature's one is for objects of its size only
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr, size_t size);
+
         void Update(uint32 update_diff, uint32 time) override;
         void Summon(TempSummonType type, uint32 lifetime);
         void MANGOS_DLL_SPEC UnSummon(uint32 delay = 0);
@@ -65,6 +65,8 @@ HostileReference::HostileReference(Unit* pUnit, ThreatManager *pThreatManager, f
     iUnitGuid = pUnit->GetObjectGuid();
     iOnline = true;
     iAccessible = true;
+    iListIndex = 0;
+    iClientThreat = THREAT_CLIENT_UNKNOWN;
 }
 
 //============================================================
@@ -219,6 +221,79 @@ void ThreatContainer::clearReferences()
     iThreatList.clear();
 }
 
+//============================================================
+
+void ThreatContainer::addReference(HostileReference* pHostileReference)
+{
+    ThreatList::WriteGuard guard(iThreatList.GetLock());
+    std::vector<HostileReference*>& list = iThreatList.getSource();
+
+    pHostileReference->iListIndex = list.size();
+    list.push_back(pHostileReference);
+    iDirty = true;
+    iOrderChanged = true;
+}
+
+//============================================================
+
+void ThreatContainer::remove(HostileReference* pRef)
+{
+    ThreatList::WriteGuard guard(iThreatList.GetLock());
+    std::vector<HostileReference*>& list = iThreatList.getSource();
+
+    // the index belongs to the other container if the reference was added there first
+    uint32 index = pRef->iListIndex;
+    if (index >= list.size() || list[index] != pRef)
+    {
+        std::vector<HostileReference*>::iterator itr = std::find(list.begin(), list.end(), pRef);
+        if (itr == list.end())
+            return;
+        index = uint32(itr - list.begin());
+    }
+
+    list.erase(list.begin() + index);
+    for (; index < list.size(); ++index)
+        list[index]->iListIndex = index;
+}
+
+//============================================================
+
+// Check if the list is dirty and sort if necessary
+
+void ThreatContainer::update()
+{
+    if (!iDirty)
+        return;
+
+    iDirty = false;
+
+    ThreatList::WriteGuard guard(iThreatList.GetLock());
+    std::vector<HostileReference*>& list = iThreatList.getSource();
+
+    // only few references change their place between updates, insertion sort is linear then,
+    // equal threat keeps the previous order
+    for (uint32 i = 1; i < list.size(); ++i)
+    {
+        HostileReference* ref = list[i];
+        float threat = ref->getThreat();
+
+        uint32 index = i;
+        while (index > 0 && list[index - 1]->getThreat() < threat)
+        {
+            list[index] = list[index - 1];
+            list[index]->iListIndex = index;
+            --index;
+        }
+
+        if (index != i)
+        {
+            list[index] = ref;
+            ref->iListIndex = index;
+            iOrderChanged = true;
+        }
+    }
+}
+
 //============================================================
 // Return the HostileReference of NULL, if not found
 HostileReference* ThreatContainer::getReferenceByTarget(Unit* pVictim)
@@ -270,26 +345,6 @@ void ThreatContainer::modifyThreatPercent(Unit *pVictim, int32 pPercent)
     }
 }
 
-//============================================================
-
-bool HostileReferenceSortPredicate(const HostileReference* lhs, const HostileReference* rhs)
-{
-    // std::list::sort ordering predicate must be: (Pred(x,y)&&Pred(y,x))==false
-    return lhs->getThreat() > rhs->getThreat();             // reverse sorting
-}
-
-//============================================================
-// Check if the list is dirty and sort if necessary
-
-void ThreatContainer::update()
-{
-    if(iDirty && iThreatList.size() >1)
-    {
-        iThreatList.sort(HostileReferenceSortPredicate);
-    }
-    iDirty = false;
-}
-
 //============================================================
 // Check if a target is a second choice target for the attacker
 // if (bCheckThreatArea) consider IsOutOfThreatArea - expected to be only set for pCurrentVictim
@@ -415,7 +470,7 @@ HostileReference* ThreatContainer::selectNextVictim(Creature* pAttacker, Hostile
 //============================================================
 
 ThreatManager::ThreatManager(Unit* owner)
-: iCurrentVictim(NULL), iOwner(owner), iUpdateTimer(THREAT_UPDATE_INTERVAL), iUpdateNeed(false)
+: iCurrentVictim(NULL), iOwner(owner), iUpdateTimer(THREAT_UPDATE_INTERVAL), iUpdateNeed(false), iDeltaUpdates(0)
 {
 }
 
@@ -428,6 +483,7 @@ void ThreatManager::clearReferences()
     iCurrentVictim = NULL;
     iUpdateTimer.Reset(THREAT_UPDATE_INTERVAL);
     iUpdateNeed = false;
+    iDeltaUpdates = 0;
 }
 
 //============================================================
@@ -510,6 +566,28 @@ void ThreatManager::modifyThreatPercent(Unit *pVictim, int32 pPercent)
 
 //============================================================
 
+void ThreatManager::modifyAllThreatPercent(int32 pPercent)
+{
+    // removed references leave the list at once, walk a copy
+    ThreatList const& threatList = iThreatContainer.getThreatList();
+    std::vector<HostileReference*> refs(threatList.begin(), threatList.end());
+
+    for (std::vector<HostileReference*>::const_iterator itr = refs.begin(); itr != refs.end(); ++itr)
+    {
+        if (pPercent < -100)
+        {
+            (*itr)->removeReference();
+            delete *itr;
+        }
+        else
+            (*itr)->addThreatPercent(pPercent);
+    }
+
+    iUpdateNeed = true;
+}
+
+//============================================================
+
 Unit* ThreatManager::getHostileTarget()
 {
     iThreatContainer.update();
@@ -588,9 +666,9 @@ void ThreatManager::processThreatEvent(ThreatRefStatusChangeEvent* threatRefStat
     switch(threatRefStatusChangeEvent->getType())
     {
         case UEV_THREAT_REF_THREAT_CHANGE:
-            if((getCurrentVictim() == hostileReference && threatRefStatusChangeEvent->getFValue()<0.0f) ||
-                (getCurrentVictim() != hostileReference && threatRefStatusChangeEvent->getFValue()>0.0f))
-                setDirty(true);                             // the order in the threat list might have changed
+            // the order in the threat list might have changed, it is restored by the next update
+            if (hostileReference->isOnline())
+                setDirty(true);
             break;
         case UEV_THREAT_REF_ONLINE_STATUS:
             if(!hostileReference->isOnline())
@@ -598,30 +676,26 @@ void ThreatManager::processThreatEvent(ThreatRefStatusChangeEvent* threatRefStat
                 if (hostileReference == getCurrentVictim())
                 {
                     setCurrentVictim(NULL);
-                    setDirty(true);
                 }
                 if (getOwner() && getOwner()->IsInWorld())
                     if (/*Unit* target = */getOwner()->GetMap()->GetUnit(hostileReference->getUnitGuid()))
                         getOwner()->SendThreatRemove(hostileReference);
+                hostileReference->resetClientThreat();
                 iThreatContainer.remove(hostileReference);
                 iUpdateNeed = true;
                 iThreatOfflineContainer.addReference(hostileReference);
             }
             else
             {
-                if(getCurrentVictim() && hostileReference->getThreat() > (1.1f * getCurrentVictim()->getThreat()))
-                    setDirty(true);
+                // remove first, both containers use the index of the reference
+                iThreatOfflineContainer.remove(hostileReference);
                 iThreatContainer.addReference(hostileReference);
                 iUpdateNeed = true;
-                iThreatOfflineContainer.remove(hostileReference);
             }
             break;
         case UEV_THREAT_REF_REMOVE_FROM_LIST:
             if (hostileReference == getCurrentVictim())
-            {
                 setCurrentVictim(NULL);
-                setDirty(true);
-            }
             if(hostileReference->isOnline())
             {
                 if (getOwner() && getOwner()->IsInWorld())
@@ -644,7 +718,18 @@ void ThreatManager::UpdateForClient(uint32 diff)
     iUpdateTimer.Update(diff);
     if (iUpdateTimer.Passed())
     {
-        iOwner->SendThreatUpdate();
+        iThreatContainer.update();
+
+        // clients don't reorder a partial list, so the full one is sent if the order changed,
+        // and now and then for players that came in range meanwhile
+        bool full = iThreatContainer.isOrderChanged() || ++iDeltaUpdates >= THREAT_FULL_UPDATE_PERIOD;
+        if (full)
+        {
+            iDeltaUpdates = 0;
+            iThreatContainer.setOrderSent();
+        }
+
+        iOwner->SendThreatUpdate(!full);
         iUpdateTimer.Reset(THREAT_UPDATE_INTERVAL);
         iUpdateNeed = false;
     }
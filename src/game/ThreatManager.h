@@ -35,6 +35,7 @@ class ThreatManager;
 struct SpellEntry;
 
 #define THREAT_UPDATE_INTERVAL 1 * IN_MILLISECONDS    // Server should send threat update to client periodically each second
+#define THREAT_FULL_UPDATE_PERIOD 10                    // Every n-th update has the full list, others only changed values
 
 //==============================================================
 // Class to calculate the real threat based
@@ -84,6 +85,12 @@ class MANGOS_DLL_SPEC HostileReference : public Reference<Unit, ThreatManager>
 
         float getTempThreatModifyer() { return iTempThreatModifyer; }
 
+        //=================================================
+        // threat value known by clients, only changed values are sent in threat updates
+        bool isClientUpdateNeeded() const { return iClientThreat != uint32(iThreat); }
+        void setClientThreatSent() { iClientThreat = uint32(iThreat); }
+        void resetClientThreat() { iClientThreat = THREAT_CLIENT_UNKNOWN; }
+
         //=================================================
         // check, if source can reach target and set the status
         void updateOnlineStatus();
@@ -119,6 +126,10 @@ class MANGOS_DLL_SPEC HostileReference : public Reference<Unit, ThreatManager>
         // Tell our refFrom (source) object, that the link is cut (Target destroyed)
         void sourceObjectDestroyLink();
     private:
+        friend class ThreatContainer;
+
+        static uint32 const THREAT_CLIENT_UNKNOWN = 0xFFFFFFFF;
+
         // Inform the source, that the status of that reference was changed
         void fireStatusChanged(ThreatRefStatusChangeEvent& pThreatRefStatusChangeEvent);
 
@@ -129,6 +140,8 @@ class MANGOS_DLL_SPEC HostileReference : public Reference<Unit, ThreatManager>
         ObjectGuid iUnitGuid;
         bool iOnline;
         bool iAccessible;
+        uint32 iListIndex;                                  // position in the threat container holding the reference
+        uint32 iClientThreat;
 };
 
 //==============================================================
@@ -136,21 +149,25 @@ class ThreatManager;
 
 typedef ACE_Based::LockedVector<HostileReference*> ThreatList;
 
+// References are kept ordered by threat, highest first. A threat change only marks
+// the list dirty, the order is restored by update() before the victim selection and
+// the client update, so the list can be iterated while threat is modified.
 class MANGOS_DLL_SPEC ThreatContainer
 {
     private:
         ThreatList iThreatList;
         bool iDirty;
+        bool iOrderChanged;                                 // order differs from the one sent to clients last time
     protected:
         friend class ThreatManager;
 
-        void remove(HostileReference* pRef) { iThreatList.remove(pRef); }
-        void addReference(HostileReference* pHostileReference) { iThreatList.push_back(pHostileReference); }
+        void remove(HostileReference* pRef);
+        void addReference(HostileReference* pHostileReference);
         void clearReferences();
         // Sort the list if necessary
         void update();
     public:
-        ThreatContainer() { iDirty = false; }
+        ThreatContainer() : iDirty(false), iOrderChanged(false) {}
         ~ThreatContainer() { clearReferences(); }
 
         HostileReference* addThreat(Unit* pVictim, float pThreat);
@@ -161,10 +178,6 @@ class MANGOS_DLL_SPEC ThreatContainer
 
         HostileReference* selectNextVictim(Creature* pAttacker, HostileReference* pCurrentVictim);
 
-        void setDirty(bool pDirty) { iDirty = pDirty; }
-
-        bool isDirty() const { return iDirty; }
-
         bool empty() const { return(iThreatList.empty()); }
 
         HostileReference* getMostHated() { return iThreatList.empty() ? NULL : iThreatList.front(); }
@@ -172,6 +185,14 @@ class MANGOS_DLL_SPEC ThreatContainer
         HostileReference* getReferenceByTarget(Unit* pVictim);
 
         ThreatList const& getThreatList() const { return iThreatList; }
+
+        void setDirty(bool pDirty) { iDirty = pDirty; }
+
+        bool isDirty() const { return iDirty; }
+
+        bool isOrderChanged() const { return iOrderChanged; }
+
+        void setOrderSent() { iOrderChanged = false; }
 };
 
 //=================================================
@@ -195,6 +216,9 @@ class MANGOS_DLL_SPEC ThreatManager
 
         void modifyThreatPercent(Unit *pVictim, int32 pPercent);
 
+        // modify threat of all online references, also removes them for percent below -100
+        void modifyAllThreatPercent(int32 pPercent);
+
         float getThreat(Unit *pVictim, bool pAlsoSearchOfflineList = false);
 
         bool isThreatListEmpty() const { return iThreatContainer.empty(); }
@@ -223,6 +247,7 @@ class MANGOS_DLL_SPEC ThreatManager
         Unit* iOwner;
         ShortTimeTracker iUpdateTimer;
         bool iUpdateNeed;
+        uint32 iDeltaUpdates;                               // updates with changed values only since last full one
         ThreatContainer iThreatContainer;
         ThreatContainer iThreatOfflineContainer;
 };
@@ -25,6 +25,19 @@
 #include "SpellMgr.h"
 #include "CreatureAI.h"
 #include "InstanceData.h"
+#include "MemoryPool.h"
+
+static ObjectPool TotemPool("Totem", sizeof(Totem));
+
+void* Totem::operator new(size_t size)
+{
+    return TotemPool.Allocate(size);
+}
+
+void Totem::operator delete(void* ptr, size_t size)
+{
+    TotemPool.Deallocate(ptr, size);
+}
 
 Totem::Totem() : Creature(CREATURE_SUBTYPE_TOTEM)
 {
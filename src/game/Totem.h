@@ -35,6 +35,10 @@ class Totem : public Creature
     public:
         explicit Totem();
         virtual ~Totem(){};
+
+        // resummoned on every cast, own pool like TemporarySummon
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr, size_t size);
         bool Create(uint32 guidlow, CreatureCreatePos& cPos, CreatureInfo const* cinfo, Unit* owner);
         void Update(uint32 update_diff, uint32 time) override;
         void Summon(Unit* owner);
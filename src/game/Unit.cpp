@@ -53,6 +53,7 @@
 #include "movement/MoveSpline.h"
 #include "CreatureLinkingMgr.h"
 #include "UpdateFieldFlags.h"
+#include "WorldProfiler.h"
 
 #include <math.h>
 #include <stdarg.h>
@@ -351,6 +352,8 @@ void Unit::Update( uint32 update_diff, uint32 p_time )
     }else
     m_AurasCheck -= p_time;*/
 
+    ProfilePhase phase(PROFILE_UNIT_SPELLS);
+
     // WARNING! Order of execution here is important, do not change.
     // Spells must be processed with event system BEFORE they go to _UpdateSpells.
     // Or else we may have some SPELL_STATE_FINISHED spells stalled in pointers, that is bad.
@@ -362,6 +365,8 @@ void Unit::Update( uint32 update_diff, uint32 p_time )
         CleanupDeletedHolders(false);
     }
 
+    phase.Switch(PROFILE_UNIT_STATE);
+
     if (m_lastManaUseTimer)
     {
         if (update_diff >= m_lastManaUseTimer)
@@ -416,6 +421,8 @@ void Unit::Update( uint32 update_diff, uint32 p_time )
     ModifyAuraState(AURA_STATE_HEALTHLESS_20_PERCENT, GetHealth() < GetMaxHealth()*0.20f);
     ModifyAuraState(AURA_STATE_HEALTHLESS_35_PERCENT, GetHealth() < GetMaxHealth()*0.35f);
     ModifyAuraState(AURA_STATE_HEALTH_ABOVE_75_PERCENT, GetHealth() > GetMaxHealth()*0.75f);
+
+    phase.Switch(PROFILE_UNIT_MOVEMENT);
     UpdateSplineMovement(p_time);
     GetUnitStateMgr().Update(p_time);
 }
@@ -4301,14 +4308,20 @@ int32 Unit::GetTotalAuraModifier(AuraType auratype) const
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
     for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
     {
-        if((*i)->IsStacking())
-            modifier += (*i)->GetModifier()->m_amount;
+        // resolve the holder slot once per aura, this is called for every stat recalculation
+        Aura const* aura = (*i)();
+        if (!aura)
+            continue;
+
+        int32 amount = aura->GetModifier()->m_amount;
+        if (aura->IsStacking())
+            modifier += amount;
         else
         {
-            if((*i)->GetModifier()->m_amount > nonStackingPos)
-                nonStackingPos = (*i)->GetModifier()->m_amount;
-            else if((*i)->GetModifier()->m_amount < nonStackingNeg)
-                nonStackingNeg = (*i)->GetModifier()->m_amount;
+            if (amount > nonStackingPos)
+                nonStackingPos = amount;
+            else if (amount < nonStackingNeg)
+                nonStackingNeg = amount;
         }
     }
 
@@ -4324,14 +4337,19 @@ float Unit::GetTotalAuraMultiplier(AuraType auratype) const
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
     for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
     {
-        if((*i)->IsStacking())
-            multiplier *= (100.0f + (*i)->GetModifier()->m_amount)/100.0f;
+        Aura const* aura = (*i)();
+        if (!aura)
+            continue;
+
+        int32 amount = aura->GetModifier()->m_amount;
+        if (aura->IsStacking())
+            multiplier *= (100.0f + amount)/100.0f;
         else
         {
-            if((*i)->GetModifier()->m_amount > nonStackingPos)
-                nonStackingPos = (*i)->GetModifier()->m_amount;
-            else if((*i)->GetModifier()->m_amount < nonStackingNeg)
-                nonStackingNeg = (*i)->GetModifier()->m_amount;
+            if (amount > nonStackingPos)
+                nonStackingPos = amount;
+            else if (amount < nonStackingNeg)
+                nonStackingNeg = amount;
         }
     }
 
@@ -4344,8 +4362,11 @@ int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype, bool nonStackingOnly)
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
     for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-        if (!(nonStackingOnly && (*i)->IsStacking()) && (*i)->GetModifier()->m_amount > modifier)
-            modifier = (*i)->GetModifier()->m_amount;
+    {
+        Aura const* aura = (*i)();
+        if (aura && !(nonStackingOnly && aura->IsStacking()) && aura->GetModifier()->m_amount > modifier)
+            modifier = aura->GetModifier()->m_amount;
+    }
 
     return modifier;
 }
@@ -4356,8 +4377,11 @@ int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype, bool nonStackingOnly)
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
     for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-        if (!(nonStackingOnly && (*i)->IsStacking()) && (*i)->GetModifier()->m_amount < modifier)
-            modifier = (*i)->GetModifier()->m_amount;
+    {
+        Aura const* aura = (*i)();
+        if (aura && !(nonStackingOnly && aura->IsStacking()) && aura->GetModifier()->m_amount < modifier)
+            modifier = aura->GetModifier()->m_amount;
+    }
 
     return modifier;
 }
@@ -4760,6 +4784,10 @@ bool Unit::AddSpellAuraHolder(SpellAuraHolderPtr holder)
         return false;
     }
 
+    // durations and periodic ticks of the new aura are updated by own update
+    if (GetTypeId() == TYPEID_UNIT)
+        ((Creature*)this)->WakeUp();
+
     SpellAuraHolderQueue holdersToRemove;
     SpellAuraHolderPtr holderToStackAdd;
     // passive and persistent auras can stack with themselves any number of times
@@ -8877,8 +8905,7 @@ void Unit::MeleeDamageBonusDone(DamageInfo* damageInfo, uint32 stack)
     if (damageInfo->damage == 0 || ( damageInfo->GetSpellProto() && damageInfo->GetSpellProto()->HasAttribute(SPELL_ATTR_EX6_NO_DMG_MODS)))
         return;
 
-    MAPLOCK_READ(this,MAP_LOCK_TYPE_AURAS);
-    MAPLOCK_READ1(pVictim,MAP_LOCK_TYPE_AURAS);
+    MAPLOCK_READ_PAIR(this, pVictim, MAP_LOCK_TYPE_AURAS);
 
     // differentiate for weapon damage based spells
     bool isWeaponDamageBasedSpell = !(damageInfo->GetSpellProto() && (damageInfo->damageType == DOT || IsSpellHaveEffect(damageInfo->GetSpellProto(), SPELL_EFFECT_SCHOOL_DAMAGE)));
@@ -13300,22 +13327,32 @@ uint32 Unit::GetCombatRatingDamageReduction(CombatRating cr, float rate, float c
     return uint32 (percent * damage / 100.0f);
 }
 
-void Unit::SendThreatUpdate()
+void Unit::SendThreatUpdate(bool onlyChanged /*= false*/)
 {
     ThreatList const& tlist = getThreatManager().getThreatList();
-    if (uint32 count = tlist.size())
+
+    uint32 count = 0;
+    for (ThreatList::const_iterator itr = tlist.begin(); itr != tlist.end(); ++itr)
+        if (!onlyChanged || (*itr)->isClientUpdateNeeded())
+            ++count;
+
+    if (!count)
+        return;
+
+    DEBUG_FILTER_LOG(LOG_FILTER_COMBAT, "WORLD: Send SMSG_THREAT_UPDATE Message");
+    WorldPacket data(SMSG_THREAT_UPDATE, 8 + count * 8);
+    data << GetPackGUID();
+    data << uint32(count);
+    for (ThreatList::const_iterator itr = tlist.begin(); itr != tlist.end(); ++itr)
     {
-        DEBUG_FILTER_LOG(LOG_FILTER_COMBAT, "WORLD: Send SMSG_THREAT_UPDATE Message");
-        WorldPacket data(SMSG_THREAT_UPDATE, 8 + count * 8);
-        data << GetPackGUID();
-        data << uint32(count);
-        for (ThreatList::const_iterator itr = tlist.begin(); itr != tlist.end(); ++itr)
-        {
-            data << (*itr)->getUnitGuid().WriteAsPacked();
-            data << uint32((*itr)->getThreat());
-        }
-        SendMessageToSet(&data, false);
+        if (onlyChanged && !(*itr)->isClientUpdateNeeded())
+            continue;
+
+        data << (*itr)->getUnitGuid().WriteAsPacked();
+        data << uint32((*itr)->getThreat());
+        (*itr)->setClientThreatSent();
     }
+    SendMessageToSet(&data, false);
 }
 
 void Unit::SendHighestThreatUpdate(HostileReference* pHostilReference)
@@ -13332,6 +13369,7 @@ void Unit::SendHighestThreatUpdate(HostileReference* pHostilReference)
         {
             data << (*itr)->getUnitGuid().WriteAsPacked();
             data << uint32((*itr)->getThreat());
+            (*itr)->setClientThreatSent();
         }
         SendMessageToSet(&data, false);
     }
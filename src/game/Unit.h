@@ -1624,7 +1624,7 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         void SendHighestThreatUpdate(HostileReference* pHostileReference);
         void SendThreatClear();
         void SendThreatRemove(HostileReference* pHostileReference);
-        void SendThreatUpdate();
+        void SendThreatUpdate(bool onlyChanged = false);
 
         bool isAlive() const { return (m_deathState == ALIVE); };
         bool isDead() const { return ( m_deathState == DEAD || m_deathState == CORPSE ); };
@@ -67,6 +67,12 @@
 #include "CharacterDatabaseCleaner.h"
 #include "CreatureLinkingMgr.h"
 #include "LFGMgr.h"
+#include "LoadTaskGraph.h"
+#include "WorldProfiler.h"
+#include "WorldSocketMgr.h"
+#include "Metrics/Metrics.h"
+#include "OpcodeWorkerPool.h"
+#include "MemoryPool.h"
 #include "warden/WardenDataStorage.h"
 
 INSTANTIATE_SINGLETON_1( World );
@@ -99,6 +105,9 @@ World::World()
     m_maxQueuedSessionCount = 0;
     m_NextDailyQuestReset = 0;
     m_NextWeeklyQuestReset = 0;
+    m_charEnumCacheSweepTime = 0;
+    m_charEnumCacheVersion = 0;
+    m_charEnumCacheClearVersion = 0;
 
     m_defaultDbcLocale = LOCALE_enUS;
     m_availableDbcLocaleMask = 0;
@@ -114,6 +123,9 @@ World::World()
 
     for(int i = 0; i < CONFIG_BOOL_VALUE_COUNT; ++i)
         m_configBoolValues[i] = false;
+
+    for(int i = 0; i < MAP_LOCK_TYPE_MAX; ++i)
+        i_lock[i].SetLockClass(MapLockType(i));
 }
 
 /// World destructor
@@ -127,6 +139,9 @@ World::~World()
         m_sessions.erase(m_sessions.begin());
     }
 
+    for (Queue::const_iterator itr = m_replacedSessions.begin(); itr != m_replacedSessions.end(); ++itr)
+        delete *itr;
+
     ///- Empty the WeatherMap
     for (WeatherMap::const_iterator itr = m_weathers.begin(); itr != m_weathers.end(); ++itr)
         delete itr->second;
@@ -137,6 +152,8 @@ World::~World()
     while (cliCmdQueue.next(command))
         delete command;
 
+    ClearCharEnumCache();
+
     VMAP::VMapFactory::clear();
     MMAP::MMapFactory::clear();
 
@@ -146,6 +163,7 @@ World::~World()
 /// Cleanups before world stop
 void World::CleanupsBeforeStop()
 {
+    sOpcodeWorkerPool.Stop();                        // sessions wait for packets in worker threads
     KickAll();                                       // save and kick all players
     UpdateSessions(1);                               // real players unload required UpdateSessions call
     sBattleGroundMgr.DeleteAllBattleGrounds();       // unload battleground templates before different singletons destroyed
@@ -183,6 +201,94 @@ WorldSession* World::FindSession(uint32 id) const
         return NULL;
 }
 
+uint32 World::GetCharEnumCacheVersion()
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_charEnumCacheLock, 0);
+    return m_charEnumCacheVersion;
+}
+
+bool World::GetCachedCharEnum(uint32 accountId, WorldPacket& data)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_charEnumCacheLock, false);
+
+    CharEnumCacheMap::const_iterator itr = m_charEnumCache.find(accountId);
+    if (itr == m_charEnumCache.end() || !itr->second.packet || itr->second.expireTime <= time(NULL))
+        return false;
+
+    data = *itr->second.packet;
+    return true;
+}
+
+void World::CacheCharEnum(uint32 accountId, WorldPacket const& data, uint32 version)
+{
+    uint32 cacheTime = getConfig(CONFIG_UINT32_CHAR_ENUM_CACHE_TIME);
+    if (!cacheTime)
+        return;
+
+    time_t now = time(NULL);
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_charEnumCacheLock);
+
+    // drop expired lists and invalidation marks, at most once per cache time
+    if (m_charEnumCacheSweepTime <= now)
+    {
+        for (CharEnumCacheMap::iterator itr = m_charEnumCache.begin(); itr != m_charEnumCache.end();)
+        {
+            if (itr->second.expireTime <= now)
+            {
+                delete itr->second.packet;
+                m_charEnumCache.erase(itr++);
+            }
+            else
+                ++itr;
+        }
+
+        m_charEnumCacheSweepTime = now + cacheTime;
+    }
+
+    // characters changed while the list was loaded
+    if (version < m_charEnumCacheClearVersion)
+        return;
+
+    CharEnumCacheEntry& entry = m_charEnumCache[accountId];
+    if (version < entry.version)
+        return;
+
+    if (entry.packet)
+        *entry.packet = data;
+    else
+        entry.packet = new WorldPacket(data);
+    entry.expireTime = now + cacheTime;
+}
+
+void World::InvalidateCharEnum(uint32 accountId)
+{
+    // unknown account of an offline character
+    uint32 cacheTime = getConfig(CONFIG_UINT32_CHAR_ENUM_CACHE_TIME);
+    if (!cacheTime || !accountId)
+        return;
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_charEnumCacheLock);
+
+    // the mark is kept while lists loaded before may arrive
+    CharEnumCacheEntry& entry = m_charEnumCache[accountId];
+    delete entry.packet;
+    entry.packet = NULL;
+    entry.version = ++m_charEnumCacheVersion;
+    entry.expireTime = time(NULL) + cacheTime;
+}
+
+void World::ClearCharEnumCache()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_charEnumCacheLock);
+
+    for (CharEnumCacheMap::const_iterator itr = m_charEnumCache.begin(); itr != m_charEnumCache.end(); ++itr)
+        delete itr->second.packet;
+
+    m_charEnumCache.clear();
+    m_charEnumCacheClearVersion = ++m_charEnumCacheVersion;
+}
+
 /// Remove a given session
 bool World::RemoveSession(uint32 id)
 {
@@ -234,7 +340,11 @@ World::AddSession_ (WorldSession* s)
             if (RemoveQueuedSession(old->second))
                 decrease_session = false;
             // not remove replaced session form queue if listed
-            delete old->second;
+            // worker threads may still execute packets of it
+            if (old->second->HasAsyncPackets())
+                m_replacedSessions.push_back(old->second);
+            else
+                delete old->second;
         }
     }
 
@@ -544,6 +654,7 @@ void World::LoadConfigSettings(bool reload)
 
     setConfigPos(CONFIG_FLOAT_CREATURE_FAMILY_ASSISTANCE_RADIUS,      "CreatureFamilyAssistanceRadius",     10.0f);
     setConfigPos(CONFIG_FLOAT_CREATURE_FAMILY_FLEE_ASSISTANCE_RADIUS, "CreatureFamilyFleeAssistanceRadius", 30.0f);
+    setConfigPos(CONFIG_FLOAT_CREATURE_IDLE_WAKE_RADIUS,              "Creature.IdleUpdate.WakeRadius",     40.0f);
 
     ///- Read other configuration items from the config file
 
@@ -566,8 +677,18 @@ void World::LoadConfigSettings(bool reload)
         sMapMgr.SetGridCleanUpDelay(getConfig(CONFIG_UINT32_INTERVAL_GRIDCLEAN));
 
     setConfig(CONFIG_UINT32_NUMTHREADS, "MapUpdate.Threads", 3);
+    setConfigMinMax(CONFIG_UINT32_STARTUP_LOAD_THREADS, "StartupLoad.Threads", 1, 1, 16);
     setConfig(CONFIG_BOOL_THREADS_DYNAMIC,"MapUpdate.DynamicThreadsCount", false);
 
+    setConfig(CONFIG_BOOL_PROFILER_ENABLE, "Profiler.Enable", false);
+    setConfig(CONFIG_UINT32_PROFILER_SLOW_TICK, "Profiler.SlowTick", 0);
+    WorldProfiler::SetEnabled(getConfig(CONFIG_BOOL_PROFILER_ENABLE));
+    WorldProfiler::SetSlowTickThreshold(getConfig(CONFIG_UINT32_PROFILER_SLOW_TICK));
+
+    // exporter is started only once, by the main thread
+    if (configNoReload(reload, CONFIG_BOOL_METRICS_ENABLE, "Metrics.Enable", false))
+        setConfig(CONFIG_BOOL_METRICS_ENABLE, "Metrics.Enable", false);
+
     setConfigMinMax(CONFIG_FLOAT_LOADBALANCE_HIGHVALUE, "MapUpdate.LoadBalanceHighValue", 0.8f, 0.5f, 1.0f);
     setConfigMinMax(CONFIG_FLOAT_LOADBALANCE_LOWVALUE, "MapUpdate.LoadBalanceLowValue", 0.2f, 0.0f, 0.5f);
 
@@ -579,6 +700,11 @@ void World::LoadConfigSettings(bool reload)
     setConfigMinMax(CONFIG_UINT32_MAPUPDATE_MAXVISITS, "MapUpdate.MaxVisitsInUpdate", 20, 10, 100);
 
     setConfigMinMax(CONFIG_UINT32_OBJECTLOADINGSPLITTER_ALLOWEDTIME, "ObjectLoadingSplitter.MaxAllowedTime", 10, 5, 1000);
+    setConfigMinMax(CONFIG_UINT32_GRID_UNLOAD_ALLOWEDTIME, "GridUnload.MaxAllowedTime", 5, 1, 1000);
+
+    // threads are started once, at world start
+    if (configNoReload(reload, CONFIG_UINT32_ASYNC_OPCODE_THREADS, "AsyncOpcode.Threads", 2))
+        setConfigMinMax(CONFIG_UINT32_ASYNC_OPCODE_THREADS, "AsyncOpcode.Threads", 2, 0, 16);
 
     setConfig(CONFIG_UINT32_INTERVAL_CHANGEWEATHER, "ChangeWeatherInterval", 10 * MINUTE * IN_MILLISECONDS);
 
@@ -611,6 +737,8 @@ void World::LoadConfigSettings(bool reload)
 
     setConfig(CONFIG_UINT32_CHARACTERS_CREATING_DISABLED, "CharactersCreatingDisabled", 0);
 
+    setConfig(CONFIG_UINT32_CHAR_ENUM_CACHE_TIME, "CharEnumCacheTime", 60);
+
     setConfigMinMax(CONFIG_UINT32_CHARACTERS_PER_REALM, "CharactersPerRealm", 10, 1, 10);
 
     // must be after CONFIG_UINT32_CHARACTERS_PER_REALM
@@ -734,6 +862,7 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_UINT32_MAIL_DELIVERY_DELAY, "MailDeliveryDelay", HOUR);
 
     setConfigMin(CONFIG_UINT32_MASS_MAILER_SEND_PER_TICK, "MassMailer.SendPerTick", 10, 1);
+    setConfig(CONFIG_UINT32_MASS_MAILER_BULK_SEND_PER_TICK, "MassMailer.BulkSendPerTick", 1000);
 
     setConfig(CONFIG_UINT32_UPTIME_UPDATE, "UpdateUptimeInterval", 10);
     if (reload)
@@ -785,6 +914,7 @@ void World::LoadConfigSettings(bool reload)
 
     setConfig(CONFIG_UINT32_CREATURE_FAMILY_ASSISTANCE_DELAY, "CreatureFamilyAssistanceDelay", 1500);
     setConfig(CONFIG_UINT32_CREATURE_FAMILY_FLEE_DELAY,       "CreatureFamilyFleeDelay",       7000);
+    setConfig(CONFIG_UINT32_CREATURE_IDLE_SLEEP_TIME,         "Creature.IdleUpdate.SleepTime", 2000);
 
     setConfig(CONFIG_UINT32_WORLD_BOSS_LEVEL_DIFF, "WorldBossLevelDiff", 3);
 
@@ -907,6 +1037,12 @@ void World::LoadConfigSettings(bool reload)
     m_relocation_ai_notify_delay = sConfig.GetIntDefault("Visibility.AIRelocationNotifyDelay", 1000u);
     m_relocation_lower_limit_sq  = pow(sConfig.GetFloatDefault("Visibility.RelocationLowerLimit",10), 2);
 
+    setConfig(CONFIG_BOOL_MOVEMENT_RELAY_COALESCE, "Visibility.MovementRelay.Coalesce", true);
+    setConfigPos(CONFIG_FLOAT_MOVEMENT_RELAY_NEAR_DISTANCE, "Visibility.MovementRelay.NearDistance", 30.0f);
+    setConfigMin(CONFIG_FLOAT_MOVEMENT_RELAY_FAR_DISTANCE, "Visibility.MovementRelay.FarDistance", 60.0f, getConfig(CONFIG_FLOAT_MOVEMENT_RELAY_NEAR_DISTANCE));
+    setConfig(CONFIG_UINT32_MOVEMENT_RELAY_MID_INTERVAL, "Visibility.MovementRelay.MidInterval", 1000);
+    setConfig(CONFIG_UINT32_MOVEMENT_RELAY_FAR_INTERVAL, "Visibility.MovementRelay.FarInterval", 2000);
+
     m_VisibleUnitGreyDistance = sConfig.GetFloatDefault("Visibility.Distance.Grey.Unit", 1);
     if (m_VisibleUnitGreyDistance >  MAX_VISIBILITY_DISTANCE)
     {
@@ -1000,6 +1136,10 @@ void World::LoadConfigSettings(bool reload)
     }
 
     setConfig(CONFIG_BOOL_VMAP_INDOOR_CHECK, "vmap.enableIndoorCheck", true);
+    // models already loaded keep the way they were read
+    if (configNoReload(reload, CONFIG_BOOL_VMAP_LAZY_GROUP_LOADING, "vmap.lazyGroupLoading", true))
+        setConfig(CONFIG_BOOL_VMAP_LAZY_GROUP_LOADING, "vmap.lazyGroupLoading", true);
+    setConfig(CONFIG_UINT32_VMAP_MODEL_MEMORY_BUDGET, "vmap.modelMemoryBudget", 0);
     bool enableLOS = true;
     bool enableHeight = true;
     std::string ignoreSpellIds = sConfig.GetStringDefault("vmap.ignoreSpellIds", "");
@@ -1009,9 +1149,10 @@ void World::LoadConfigSettings(bool reload)
 
     VMAP::VMapFactory::createOrGetVMapManager()->setEnableLineOfSightCalc(enableLOS);
     VMAP::VMapFactory::createOrGetVMapManager()->setEnableHeightCalc(enableHeight);
+    VMAP::VMapFactory::createOrGetVMapManager()->setEnableLazyModelLoading(getConfig(CONFIG_BOOL_VMAP_LAZY_GROUP_LOADING));
     VMAP::VMapFactory::preventSpellsFromBeingTestedForLoS(ignoreSpellIds.c_str());
-    sLog.outString( "WORLD: VMap support included. LineOfSight:%i, getHeight:%i, indoorCheck:%i",
-        enableLOS, enableHeight, getConfig(CONFIG_BOOL_VMAP_INDOOR_CHECK) ? 1 : 0);
+    sLog.outString( "WORLD: VMap support included. LineOfSight:%i, getHeight:%i, indoorCheck:%i, lazyGroupLoading:%i",
+        enableLOS, enableHeight, getConfig(CONFIG_BOOL_VMAP_INDOOR_CHECK) ? 1 : 0, getConfig(CONFIG_BOOL_VMAP_LAZY_GROUP_LOADING) ? 1 : 0);
     sLog.outString( "WORLD: VMap data directory is: %svmaps",m_dataPath.c_str());
 
     setConfig(CONFIG_BOOL_MMAP_ENABLED, "mmap.enabled", true);
@@ -1019,6 +1160,11 @@ void World::LoadConfigSettings(bool reload)
     MMAP::MMapFactory::preventPathfindingOnMaps(ignoreMapIds.c_str());
     sLog.outString("WORLD: mmap pathfinding %sabled", getConfig(CONFIG_BOOL_MMAP_ENABLED) ? "en" : "dis");
 
+    // threads are started once, at map system start
+    if (configNoReload(reload, CONFIG_UINT32_TERRAIN_LOAD_THREADS, "TerrainLoad.Threads", 2))
+        setConfigMinMax(CONFIG_UINT32_TERRAIN_LOAD_THREADS, "TerrainLoad.Threads", 2, 0, 16);
+    setConfigMin(CONFIG_FLOAT_TERRAIN_READ_AHEAD_DISTANCE, "TerrainLoad.ReadAheadDistance", 100.0f, 0.0f);
+
     // reset duel system
     setConfig(CONFIG_BOOL_RESET_DUEL_AREA_ENABLED, "DuelReset.Enable", false);
     std::string areaIdsEnabledDuel = sConfig.GetStringDefault("DuelReset.AreaIds", "");
@@ -1084,108 +1230,22 @@ void World::LoadConfigSettings(bool reload)
     // initialize chat logs (and lexics cutter)
     sChatLog.Initialize();
 }
-extern void LoadGameObjectModelList();
-/// Initialize the World
-void World::SetInitialWorldSettings()
-{
-    ///- Initialize the random number generator
-    srand((unsigned int)time(NULL));
-
-    ///- Time server startup
-    uint32 uStartTime = WorldTimer::getMSTime();
-
-    ///- Initialize detour memory management
-    dtAllocSetCustom(dtCustomAlloc, dtCustomFree);
-
-    ///- Initialize config settings
-    LoadConfigSettings();
-
-    ///- Check the existence of the map files for all races start areas.
-    if (!MapManager::ExistMapAndVMap(0,-6240.32f, 331.033f) ||
-        !MapManager::ExistMapAndVMap(0,-8949.95f,-132.493f) ||
-        !MapManager::ExistMapAndVMap(0,-8949.95f,-132.493f) ||
-        !MapManager::ExistMapAndVMap(1,-618.518f,-4251.67f) ||
-        !MapManager::ExistMapAndVMap(0, 1676.35f, 1677.45f) ||
-        !MapManager::ExistMapAndVMap(1, 10311.3f, 832.463f) ||
-        !MapManager::ExistMapAndVMap(1,-2917.58f,-257.98f) ||
-        (m_configUint32Values[CONFIG_UINT32_EXPANSION] &&
-        (!MapManager::ExistMapAndVMap(530,10349.6f,-6357.29f) || !MapManager::ExistMapAndVMap(530,-3961.64f,-13931.2f))))
-    {
-        sLog.outError("Correct *.map files not found in path '%smaps' or *.vmtree/*.vmtile files in '%svmaps'. Please place *.map and vmap files in appropriate directories or correct the DataDir value in the mangosd.conf file.",m_dataPath.c_str(),m_dataPath.c_str());
-        Log::WaitBeforeContinueIfNeed();
-        exit(1);
-    }
-
-    ///- Loading strings. Getting no records means core load has to be canceled because no error message can be output.
-    sLog.outString();
-    sLog.outString("Loading MaNGOS strings...");
-    if (!sObjectMgr.LoadMangosStrings())
-    {
-        Log::WaitBeforeContinueIfNeed();
-        exit(1);                                            // Error message displayed in function already
-    }
-
-    ///- Update the realm entry in the database with the realm type from the config file
-    //No SQL injection as values are treated as integers
-
-    // not send custom type REALM_FFA_PVP to realm list
-    uint32 server_type = IsFFAPvPRealm() ? REALM_TYPE_PVP : getConfig(CONFIG_UINT32_GAME_TYPE);
-    uint32 realm_zone = getConfig(CONFIG_UINT32_REALM_ZONE);
-    LoginDatabase.PExecute("UPDATE realmlist SET icon = %u, timezone = %u WHERE id = '%u'", server_type, realm_zone, getConfig(CONFIG_UINT32_REALMID));
-
-    ///- Remove the bones (they should not exist in DB though) and old corpses after a restart
-    CharacterDatabase.PExecute("DELETE FROM corpse WHERE corpse_type = '0' OR time < (UNIX_TIMESTAMP()-'%u')", 3*DAY);
-
-    ///- Load the DBC files
-    sLog.outString("Initialize data stores...");
-    LoadDBCStores(m_dataPath);
-    DetectDBCLang();
-    sObjectMgr.SetDBCLocaleIndex(GetDefaultDbcLocale());    // Get once for all the locale index of DBC language (console/broadcasts)
-
-    sLog.outString("Loading GameObject models...");
-    LoadGameObjectModelList();
-
-    sLog.outString( "Loading SpellDbc..." );
-    sSpellMgr.LoadSpellDbc();
-
-    sLog.outString( "Loading SpellTemplate..." );
-    sObjectMgr.LoadSpellTemplate();
-
-    sLog.outString( "Loading Script Names...");
-    sScriptMgr.LoadScriptNames();
-
-    sLog.outString( "Loading WorldTemplate..." );
-    sObjectMgr.LoadWorldTemplate();
-
-    sLog.outString( "Loading InstanceTemplate..." );
-    sObjectMgr.LoadInstanceTemplate();
-
-    sLog.outString("Loading SkillLineAbilityMultiMap Data...");
-    sSpellMgr.LoadSkillLineAbilityMap();
-
-    sLog.outString("Loading SkillRaceClassInfoMultiMap Data...");
-    sSpellMgr.LoadSkillRaceClassInfoMap();
-
-    ///- Clean up and pack instances
-    sLog.outString( "Cleaning up instances..." );
-    sMapPersistentStateMgr.CleanupInstances();              // must be called before `creature_respawn`/`gameobject_respawn` tables
-
-    sLog.outString( "Packing instances..." );
-    sMapPersistentStateMgr.PackInstances();
-
-    sLog.outString( "Packing groups..." );
-    sObjectMgr.PackGroupIds();                              // must be after CleanupInstances
-
-    ///- Init highest guids before any guid using table loading to prevent using not initialized guids in some code.
-    sObjectMgr.SetHighestGuids();                           // must be after PackInstances() and PackGroupIds()
-    sLog.outString();
+// Startup loaders of static and dynamic data, see World::AddStartupLoaders for their dependencies
 
+static void LoadPageTextsTask()
+{
     sLog.outString( "Loading Page Texts..." );
     sObjectMgr.LoadPageTexts();
+}
 
-    sLog.outString( "Loading Game Object Templates..." );   // must be after LoadPageTexts
+static void LoadGameObjectTemplatesTask()
+{
+    sLog.outString( "Loading Game Object Templates..." );
     sObjectMgr.LoadGameobjectInfo();
+}
 
+static void LoadSpellsTask()
+{
     sLog.outString( "Loading Spell Chain Data..." );
     sSpellMgr.LoadSpellChains();
 
@@ -1212,10 +1272,16 @@ void World::SetInitialWorldSettings()
 
     sLog.outString( "Loading Aggro Spells Definitions...");
     sSpellMgr.LoadSpellThreats();
+}
 
+static void LoadGossipTextsTask()
+{
     sLog.outString( "Loading NPC Texts..." );
     sObjectMgr.LoadGossipText();
+}
 
+static void LoadItemsTask()
+{
     sLog.outString( "Loading Item Random Enchantments Table..." );
     LoadRandomEnchantmentsTable();
 
@@ -1227,7 +1293,10 @@ void World::SetInitialWorldSettings()
 
     sLog.outString("Loading Item expire converts...");      // must be after LoadItemPrototypes
     sObjectMgr.LoadItemExpireConverts();
+}
 
+static void LoadCreatureTemplatesTask()
+{
     sLog.outString( "Loading Creature Model Based Info Data..." );
     sObjectMgr.LoadCreatureModelInfo();
 
@@ -1244,15 +1313,24 @@ void World::SetInitialWorldSettings()
     sLog.outString( "Loading Creature Model for race..." ); // must be after creature templates
     sObjectMgr.LoadCreatureModelRace();
 
-    sLog.outString( "Loading SpellsScriptTarget...");
-    sSpellMgr.LoadSpellScriptTarget();                      // must be after LoadCreatureTemplates and LoadGameobjectInfo
-
     sLog.outString("Loading Vehicle Accessory...");         // must be after creature templates
     sObjectMgr.LoadVehicleAccessory();
+}
 
+static void LoadSpellScriptTargetsTask()
+{
+    sLog.outString( "Loading SpellsScriptTarget...");
+    sSpellMgr.LoadSpellScriptTarget();
+}
+
+static void LoadItemRequiredTargetsTask()
+{
     sLog.outString( "Loading ItemRequiredTarget...");
     sObjectMgr.LoadItemRequiredTarget();
+}
 
+static void LoadReputationTask()
+{
     sLog.outString( "Loading Reputation Reward Rates...");
     sObjectMgr.LoadReputationRewardRate();
 
@@ -1261,42 +1339,69 @@ void World::SetInitialWorldSettings()
 
     sLog.outString( "Loading Reputation Spillover Data..." );
     sObjectMgr.LoadReputationSpilloverTemplate();
+}
 
+static void LoadPointsOfInterestTask()
+{
     sLog.outString( "Loading Points Of Interest Data..." );
     sObjectMgr.LoadPointsOfInterest();
+}
 
+static void LoadCreaturesTask()
+{
     sLog.outString( "Loading Creature Data..." );
     sObjectMgr.LoadCreatures();
+}
 
+static void LoadPetSpellsTask()
+{
     sLog.outString( "Loading pet levelup spells..." );
     sSpellMgr.LoadPetLevelupSpellMap();
 
     sLog.outString( "Loading pet default spell additional to levelup spells..." );
     sSpellMgr.LoadPetDefaultSpells();
+}
 
+static void LoadCreatureAddonsTask()
+{
     sLog.outString( "Loading Creature Addon Data..." );
     sLog.outString();
-    sObjectMgr.LoadCreatureAddons();                        // must be after LoadCreatureTemplates() and LoadCreatures()
+    sObjectMgr.LoadCreatureAddons();
     sLog.outString( ">>> Creature Addon Data loaded" );
     sLog.outString();
+}
 
+static void LoadGameObjectsTask()
+{
     sLog.outString( "Loading Gameobject Data..." );
     sObjectMgr.LoadGameObjects();
 
     sLog.outString( "Loading Gameobject Addon Data..." );
     sObjectMgr.LoadGameObjectAddon();
+}
 
-    sLog.outString( "Loading CreatureLinking Data..." );    // must be after Creatures
+static void LoadCreatureLinkingTask()
+{
+    sLog.outString( "Loading CreatureLinking Data..." );
     sCreatureLinkingMgr.LoadFromDB();
+}
 
+static void LoadPoolsTask()
+{
     sLog.outString( "Loading Objects Pooling Data...");
     sPoolMgr.LoadFromDB();
+}
 
+static void LoadWeatherTask()
+{
     sLog.outString( "Loading Weather Data..." );
     sObjectMgr.LoadWeatherZoneChances();
+}
 
+static void LoadQuestsTask()
+{
     sLog.outString( "Loading Quests..." );
-    sObjectMgr.LoadQuests();                                // must be loaded after DBCs, creature_template, item_template, gameobject tables
+    sObjectMgr.LoadQuests();
 
     sLog.outString( "Loading Quest POI" );
     sObjectMgr.LoadQuestPOI();
@@ -1306,37 +1411,54 @@ void World::SetInitialWorldSettings()
     sObjectMgr.LoadQuestRelations();                        // must be after quest load
     sLog.outString( ">>> Quests Relations loaded" );
     sLog.outString();
+}
 
-    sLog.outString( "Loading Game Event Data...");          // must be after sPoolMgr.LoadFromDB and quests to properly load pool events and quests for events
+static void LoadGameEventsTask()
+{
+    sLog.outString( "Loading Game Event Data...");
     sLog.outString();
     sGameEventMgr.LoadFromDB();
     sLog.outString( ">>> Game Event Data loaded" );
     sLog.outString();
+}
 
-    // Load Conditions
+static void LoadConditionsTask()
+{
     sLog.outString( "Loading Conditions..." );
     sObjectMgr.LoadConditions();
+}
 
-    sLog.outString( "Creating map persistent states for non-instanceable maps..." );   // must be after PackInstances(), LoadCreatures(), sPoolMgr.LoadFromDB(), sGameEventMgr.LoadFromDB();
+static void LoadMapPersistentStatesTask()
+{
+    sLog.outString( "Creating map persistent states for non-instanceable maps..." );
     sMapPersistentStateMgr.InitWorldMaps();
 
-    sLog.outString( "Loading Creature Respawn Data..." );   // must be after LoadCreatures(), and sMapPersistentStateMgr.InitWorldMaps() , and PackInstances()
+    sLog.outString( "Loading Creature Respawn Data..." );   // must be after sMapPersistentStateMgr.InitWorldMaps()
     sMapPersistentStateMgr.LoadCreatureRespawnTimes();
 
-    sLog.outString( "Loading Gameobject Respawn Data..." ); // must be after LoadGameObjects(), and sMapPersistentStateMgr.InitWorldMaps()
+    sLog.outString( "Loading Gameobject Respawn Data..." ); // must be after sMapPersistentStateMgr.InitWorldMaps()
     sMapPersistentStateMgr.LoadGameobjectRespawnTimes();
+}
 
+static void LoadSpellClickSpellsTask()
+{
     sLog.outString( "Loading UNIT_NPC_FLAG_SPELLCLICK Data..." );
     sObjectMgr.LoadNPCSpellClickSpells();
+}
 
-    sLog.outString( "Loading SpellArea Data..." );          // must be after quest load
+static void LoadSpellAreasTask()
+{
+    sLog.outString( "Loading SpellArea Data..." );
     sSpellMgr.LoadSpellAreas();
+}
 
+static void LoadAreaTriggersTask()
+{
     sLog.outString( "Loading AreaTrigger definitions..." );
-    sObjectMgr.LoadAreaTriggerTeleports();                  // must be after item template load
+    sObjectMgr.LoadAreaTriggerTeleports();
 
     sLog.outString( "Loading Quest Area Triggers..." );
-    sObjectMgr.LoadQuestAreaTriggers();                     // must be after LoadQuests
+    sObjectMgr.LoadQuestAreaTriggers();
 
     sLog.outString( "Loading Tavern Area Triggers..." );
     sObjectMgr.LoadTavernAreaTriggers();
@@ -1346,16 +1468,25 @@ void World::SetInitialWorldSettings()
 
     sLog.outString( "Loading event id script names..." );
     sScriptMgr.LoadEventIdScripts();
+}
 
+static void LoadGraveyardZonesTask()
+{
     sLog.outString( "Loading Graveyard-zone links...");
     sObjectMgr.LoadGraveyardZones();
+}
 
+static void LoadSpellTargetPositionsTask()
+{
     sLog.outString( "Loading spell target destination coordinates..." );
     sSpellMgr.LoadSpellTargetPositions();
 
     sLog.outString( "Loading spell pet auras..." );
     sSpellMgr.LoadSpellPetAuras();
+}
 
+static void LoadPlayerInfoTask()
+{
     sLog.outString( "Loading Player Create Info & Level Stats..." );
     sLog.outString();
     sObjectMgr.LoadPlayerInfo();
@@ -1364,12 +1495,21 @@ void World::SetInitialWorldSettings()
 
     sLog.outString( "Loading Exploration BaseXP Data..." );
     sObjectMgr.LoadExplorationBaseXP();
+}
 
+static void LoadPetNamesTask()
+{
     sLog.outString( "Loading Pet Name Parts..." );
     sObjectMgr.LoadPetNames();
+}
 
+static void CleanCharacterDatabaseTask()
+{
     CharacterDatabaseCleaner::CleanDatabase();
+}
 
+static void LoadPetDataTask()
+{
     sLog.outString( "Loading the max pet number..." );
     sObjectMgr.LoadPetNumber();
 
@@ -1378,22 +1518,37 @@ void World::SetInitialWorldSettings()
 
     sLog.outString( "Loading pet scaling data..." );
     sObjectMgr.LoadPetScalingData();
+}
 
+static void LoadCorpsesTask()
+{
     sLog.outString( "Loading Player Corpses..." );
     sObjectMgr.LoadCorpses();
+}
 
+static void LoadMailLevelRewardsTask()
+{
     sLog.outString( "Loading Player level dependent mail rewards..." );
     sObjectMgr.LoadMailLevelRewards();
+}
 
+static void LoadSpellDisabledTask()
+{
     sLog.outString( "Loading Spell disabled..." );
     sObjectMgr.LoadSpellDisabledEntrys();
+}
 
+static void LoadLootTablesTask()
+{
     sLog.outString( "Loading Loot Tables..." );
     sLog.outString();
     LoadLootTables();
     sLog.outString( ">>> Loot Tables loaded" );
     sLog.outString();
+}
 
+static void LoadSkillTablesTask()
+{
     sLog.outString( "Loading Skill Discovery Table..." );
     sSpellMgr.LoadSkillDiscoveryTable();
 
@@ -1402,117 +1557,194 @@ void World::SetInitialWorldSettings()
 
     sLog.outString( "Loading Skill Fishing base level requirements..." );
     sObjectMgr.LoadFishingBaseSkillLevel();
+}
 
+static void LoadAchievementsTask()
+{
     sLog.outString();
     sLog.outString( "Loading Achievements..." );
     sAchievementMgr.LoadAchievementReferenceList();
     sAchievementMgr.LoadAchievementCriteriaList();
     sAchievementMgr.LoadAchievementCriteriaRequirements();
     sAchievementMgr.LoadRewards();
-    sAchievementMgr.LoadRewardLocales();
     sAchievementMgr.LoadCompletedAchievements();
     sLog.outString( ">>> Achievements loaded" );
     sLog.outString();
+}
+
+static void LoadAchievementLocalesTask()
+{
+    sLog.outString( "Loading Achievement reward locales..." );
+    sAchievementMgr.LoadRewardLocales();
+}
 
-    sLog.outString( "Loading Instance encounters data..." );  // must be after Creature loading
+static void LoadInstanceEncountersTask()
+{
+    sLog.outString( "Loading Instance encounters data..." );
     sObjectMgr.LoadInstanceEncounters();
+}
 
+static void LoadGossipScriptsTask()
+{
     sLog.outString( "Loading Gossip scripts..." );
-    sScriptMgr.LoadGossipScripts();                         // must be before gossip menu options
+    sScriptMgr.LoadGossipScripts();
+}
 
+static void LoadGossipMenusTask()
+{
     sObjectMgr.LoadGossipMenus();
+}
 
+static void LoadVendorsTask()
+{
     sLog.outString( "Loading Vendors..." );
-    sObjectMgr.LoadVendorTemplates();                       // must be after load ItemTemplate
-    sObjectMgr.LoadVendors();                               // must be after load CreatureTemplate, VendorTemplate, and ItemTemplate
+    sObjectMgr.LoadVendorTemplates();
+    sObjectMgr.LoadVendors();                               // must be after VendorTemplate
+}
 
+static void LoadTrainersTask()
+{
     sLog.outString( "Loading Trainers..." );
-    sObjectMgr.LoadTrainerTemplates();                      // must be after load CreatureTemplate
-    sObjectMgr.LoadTrainers();                              // must be after load CreatureTemplate, TrainerTemplate
+    sObjectMgr.LoadTrainerTemplates();
+    sObjectMgr.LoadTrainers();                              // must be after TrainerTemplate
+}
 
-    sLog.outString( "Loading Waypoint scripts..." );        // before loading from creature_movement
+static void LoadMovementScriptsTask()
+{
+    sLog.outString( "Loading Waypoint scripts..." );
     sScriptMgr.LoadCreatureMovementScripts();
+}
 
+static void LoadWaypointsTask()
+{
     sLog.outString( "Loading Waypoints..." );
     sLog.outString();
     sWaypointMgr.Load();
+}
 
-    ///- Loading localization data
+static void LoadLocalesTask()
+{
     sLog.outString( "Loading Localization strings..." );
-    sObjectMgr.LoadCreatureLocales();                       // must be after CreatureInfo loading
-    sObjectMgr.LoadGameObjectLocales();                     // must be after GameobjectInfo loading
-    sObjectMgr.LoadItemLocales();                           // must be after ItemPrototypes loading
-    sObjectMgr.LoadQuestLocales();                          // must be after QuestTemplates loading
-    sObjectMgr.LoadGossipTextLocales();                     // must be after LoadGossipText
-    sObjectMgr.LoadPageTextLocales();                       // must be after PageText loading
-    sObjectMgr.LoadGossipMenuItemsLocales();                // must be after gossip menu items loading
-    sObjectMgr.LoadPointOfInterestLocales();                // must be after POI loading
+    sObjectMgr.LoadCreatureLocales();
+    sObjectMgr.LoadGameObjectLocales();
+    sObjectMgr.LoadItemLocales();
+    sObjectMgr.LoadQuestLocales();
+    sObjectMgr.LoadGossipTextLocales();
+    sObjectMgr.LoadPageTextLocales();
+    sObjectMgr.LoadGossipMenuItemsLocales();
+    sObjectMgr.LoadPointOfInterestLocales();
     sLog.outString( ">>> Localization strings loaded" );
     sLog.outString();
+}
 
-    sLog.outString("Loading LFG rewards...");               // After load all static data
+static void LoadLFGRewardsTask()
+{
+    sLog.outString("Loading LFG rewards...");
     sLFGMgr.LoadRewards();
+}
 
-    ///- Load dynamic data tables from the database
+static void LoadAuctionsTask()
+{
     sLog.outString( "Loading Auctions..." );
     sLog.outString();
     sAuctionMgr.LoadAuctionItems();
     sAuctionMgr.LoadAuctions();
     sLog.outString( ">>> Auctions loaded" );
     sLog.outString();
+}
 
+static void LoadGuildsTask()
+{
     sLog.outString( "Loading Guilds..." );
     sGuildMgr.LoadGuilds();
+}
 
+static void LoadArenaTeamsTask()
+{
     sLog.outString( "Loading ArenaTeams..." );
     sObjectMgr.LoadArenaTeams();
+}
 
+static void LoadGroupsTask()
+{
     sLog.outString( "Loading Groups..." );
     sObjectMgr.LoadGroups();
+}
 
+static void LoadReservedNamesTask()
+{
     sLog.outString( "Loading ReservedNames..." );
     sObjectMgr.LoadReservedPlayersNames();
+}
 
+static void LoadGameObjectsForQuestsTask()
+{
     sLog.outString( "Loading GameObjects for quests..." );
     sObjectMgr.LoadGameObjectForQuests();
+}
 
+static void LoadBattleMastersTask()
+{
     sLog.outString( "Loading BattleMasters..." );
     sBattleGroundMgr.LoadBattleMastersEntry();
 
     sLog.outString( "Loading BattleGround event indexes..." );
     sBattleGroundMgr.LoadBattleEventIndexes();
+}
 
+static void LoadGameTeleTask()
+{
     sLog.outString( "Loading GameTeleports..." );
     sObjectMgr.LoadGameTele();
+}
 
+static void LoadGMTicketsTask()
+{
     sLog.outString( "Loading GM tickets...");
     sTicketMgr.LoadGMTickets();
+}
 
+static void LoadAntiCheatConfigTask()
+{
     sLog.outString( "Loading AntiCheat config..." );
     sObjectMgr.LoadAntiCheatConfig();
+}
 
+static void LoadWorldStatesTask()
+{
     sLog.outString( "Loading WorldState templates and data..." );
     sWorldStateMgr.Initialize();
+}
 
+static void ReturnOldMailsTask()
+{
     ///- Handle outdated emails (delete/return)
     sLog.outString( "Returning old mails..." );
     sObjectMgr.ReturnOrDeleteOldMails(false);
+}
 
-    ///- Load and initialize scripts
+static void LoadScriptsTask()
+{
     sLog.outString( "Loading Scripts..." );
     sLog.outString();
-    sScriptMgr.LoadQuestStartScripts();                         // must be after load Creature/Gameobject(Template/Data) and QuestTemplate
-    sScriptMgr.LoadQuestEndScripts();                           // must be after load Creature/Gameobject(Template/Data) and QuestTemplate
-    sScriptMgr.LoadSpellScripts();                              // must be after load Creature/Gameobject(Template/Data)
-    sScriptMgr.LoadGameObjectScripts();                         // must be after load Creature/Gameobject(Template/Data)
-    sScriptMgr.LoadGameObjectTemplateScripts();                 // must be after load Creature/Gameobject(Template/Data)
-    sScriptMgr.LoadEventScripts();                              // must be after load Creature/Gameobject(Template/Data)
+    sScriptMgr.LoadQuestStartScripts();
+    sScriptMgr.LoadQuestEndScripts();
+    sScriptMgr.LoadSpellScripts();
+    sScriptMgr.LoadGameObjectScripts();
+    sScriptMgr.LoadGameObjectTemplateScripts();
+    sScriptMgr.LoadEventScripts();
     sLog.outString( ">>> Scripts loaded" );
     sLog.outString();
+}
 
+static void LoadScriptStringsTask()
+{
     sLog.outString( "Loading Scripts text locales..." );    // must be after Load*Scripts calls
     sScriptMgr.LoadDbScriptStrings();
+}
 
+static void LoadCreatureEventAITask()
+{
     sLog.outString( "Loading CreatureEventAI Texts...");
     sEventAIMgr.LoadCreatureEventAI_Texts(false);       // false, will checked in LoadCreatureEventAI_Scripts
 
@@ -1521,6 +1753,182 @@ void World::SetInitialWorldSettings()
 
     sLog.outString( "Loading CreatureEventAI Scripts...");
     sEventAIMgr.LoadCreatureEventAI_Scripts();
+}
+
+/**
+ * Declare startup loaders and the loaders they must run after.
+ *
+ * Declaration order is the historical load order and is used as is with one loader thread.
+ * Besides data that a loader checks or uses, a dependency is needed when two loaders write
+ * the same container: the grid cell guid index of ObjectMgr (creatures, gameobjects, map
+ * states, corpses) and the locale index / mangos string tables (locales, achievement reward
+ * locales, script texts, EventAI texts).
+ */
+void World::AddStartupLoaders(LoadTaskGraph& loaders)
+{
+    loaders.AddTask("PageTexts",            &LoadPageTextsTask);
+    loaders.AddTask("GameObjectTemplates",  &LoadGameObjectTemplatesTask,   "PageTexts");
+    loaders.AddTask("Spells",               &LoadSpellsTask);
+    loaders.AddTask("GossipTexts",          &LoadGossipTextsTask);
+    loaders.AddTask("Items",                &LoadItemsTask,                 "PageTexts");
+    loaders.AddTask("CreatureTemplates",    &LoadCreatureTemplatesTask);
+    loaders.AddTask("SpellScriptTargets",   &LoadSpellScriptTargetsTask,    "CreatureTemplates,GameObjectTemplates");
+    loaders.AddTask("ItemRequiredTargets",  &LoadItemRequiredTargetsTask,   "Spells,Items,CreatureTemplates");
+    loaders.AddTask("Reputation",           &LoadReputationTask,            "CreatureTemplates");
+    loaders.AddTask("PointsOfInterest",     &LoadPointsOfInterestTask);
+    loaders.AddTask("Creatures",            &LoadCreaturesTask,             "CreatureTemplates");
+    loaders.AddTask("PetSpells",            &LoadPetSpellsTask,             "Spells,CreatureTemplates");
+    loaders.AddTask("CreatureAddons",       &LoadCreatureAddonsTask,        "Creatures");
+    loaders.AddTask("GameObjects",          &LoadGameObjectsTask,           "GameObjectTemplates,Creatures");
+    loaders.AddTask("CreatureLinking",      &LoadCreatureLinkingTask,       "Creatures");
+    loaders.AddTask("Pools",                &LoadPoolsTask,                 "Creatures,GameObjects");
+    loaders.AddTask("Weather",              &LoadWeatherTask);
+    loaders.AddTask("Quests",               &LoadQuestsTask,                "Spells,Items,CreatureTemplates,GameObjectTemplates");
+    loaders.AddTask("GameEvents",           &LoadGameEventsTask,            "Items,Pools,Quests");
+    loaders.AddTask("Conditions",           &LoadConditionsTask,            "Spells,Items,Quests,GameEvents");
+    loaders.AddTask("MapPersistentStates",  &LoadMapPersistentStatesTask,   "Pools,GameEvents");
+    loaders.AddTask("SpellClickSpells",     &LoadSpellClickSpellsTask,      "Spells,CreatureTemplates,Quests");
+    loaders.AddTask("SpellAreas",           &LoadSpellAreasTask,            "Spells,Quests");
+    loaders.AddTask("AreaTriggers",         &LoadAreaTriggersTask,          "Items,Quests,GameObjectTemplates");
+    loaders.AddTask("GraveyardZones",       &LoadGraveyardZonesTask);
+    loaders.AddTask("SpellTargetPositions", &LoadSpellTargetPositionsTask,  "Spells");
+    loaders.AddTask("PlayerInfo",           &LoadPlayerInfoTask,            "Spells,Items");
+    loaders.AddTask("PetNames",             &LoadPetNamesTask);
+    loaders.AddTask("CharacterCleanup",     &CleanCharacterDatabaseTask);
+    loaders.AddTask("PetData",              &LoadPetDataTask,               "CreatureTemplates");
+    loaders.AddTask("Corpses",              &LoadCorpsesTask,               "GameObjects,MapPersistentStates");
+    loaders.AddTask("MailLevelRewards",     &LoadMailLevelRewardsTask,      "CreatureTemplates");
+    loaders.AddTask("SpellDisabled",        &LoadSpellDisabledTask);
+    loaders.AddTask("LootTables",           &LoadLootTablesTask,            "Items,CreatureTemplates,GameObjectTemplates,Conditions");
+    loaders.AddTask("SkillTables",          &LoadSkillTablesTask,           "Spells,Items");
+    loaders.AddTask("Achievements",         &LoadAchievementsTask,          "Items,CreatureTemplates,Quests,CharacterCleanup");
+    loaders.AddTask("InstanceEncounters",   &LoadInstanceEncountersTask,    "CreatureTemplates");
+    loaders.AddTask("GossipScripts",        &LoadGossipScriptsTask,         "Spells,Items,Creatures,GameObjects,Quests,AreaTriggers");
+    loaders.AddTask("GossipMenus",          &LoadGossipMenusTask,           "GossipTexts,PointsOfInterest,Conditions,GossipScripts");
+    loaders.AddTask("Vendors",              &LoadVendorsTask,               "Items,CreatureTemplates,GameEvents");
+    loaders.AddTask("Trainers",             &LoadTrainersTask,              "Spells,CreatureTemplates");
+    loaders.AddTask("MovementScripts",      &LoadMovementScriptsTask,       "GossipScripts");
+    loaders.AddTask("Waypoints",            &LoadWaypointsTask,             "Creatures,MovementScripts");
+    loaders.AddTask("Locales",              &LoadLocalesTask,               "CreatureTemplates,GameObjectTemplates,Items,Quests,GossipTexts,PointsOfInterest,GossipMenus");
+    loaders.AddTask("LFGRewards",           &LoadLFGRewardsTask,            "Items,Quests");
+    loaders.AddTask("Auctions",             &LoadAuctionsTask,              "Items");
+    loaders.AddTask("Guilds",               &LoadGuildsTask,                "Items");
+    loaders.AddTask("ArenaTeams",           &LoadArenaTeamsTask);
+    loaders.AddTask("Groups",               &LoadGroupsTask,                "MapPersistentStates");
+    loaders.AddTask("ReservedNames",        &LoadReservedNamesTask);
+    loaders.AddTask("GameObjectsForQuests", &LoadGameObjectsForQuestsTask,  "Quests,LootTables");
+    loaders.AddTask("BattleMasters",        &LoadBattleMastersTask,         "CreatureTemplates,GameObjects");
+    loaders.AddTask("GameTele",             &LoadGameTeleTask);
+    loaders.AddTask("GMTickets",            &LoadGMTicketsTask);
+    loaders.AddTask("AntiCheatConfig",      &LoadAntiCheatConfigTask);
+    loaders.AddTask("WorldStates",          &LoadWorldStatesTask,           "MapPersistentStates,Groups");
+    loaders.AddTask("OldMails",             &ReturnOldMailsTask,            "Items");
+    loaders.AddTask("Scripts",              &LoadScriptsTask,               "MovementScripts");
+    loaders.AddTask("AchievementLocales",   &LoadAchievementLocalesTask,    "Achievements,Locales");
+    loaders.AddTask("ScriptStrings",        &LoadScriptStringsTask,         "Scripts,AchievementLocales");
+    loaders.AddTask("CreatureEventAI",      &LoadCreatureEventAITask,       "ScriptStrings,Spells,Items,CreatureTemplates,Quests,Conditions");
+}
+
+extern void LoadGameObjectModelList();
+/// Initialize the World
+void World::SetInitialWorldSettings()
+{
+    ///- Initialize the random number generator
+    srand((unsigned int)time(NULL));
+
+    ///- Time server startup
+    uint32 uStartTime = WorldTimer::getMSTime();
+
+    ///- Initialize detour memory management
+    dtAllocSetCustom(dtCustomAlloc, dtCustomFree);
+
+    ///- Initialize config settings
+    LoadConfigSettings();
+
+    ///- Check the existence of the map files for all races start areas.
+    if (!MapManager::ExistMapAndVMap(0,-6240.32f, 331.033f) ||
+        !MapManager::ExistMapAndVMap(0,-8949.95f,-132.493f) ||
+        !MapManager::ExistMapAndVMap(0,-8949.95f,-132.493f) ||
+        !MapManager::ExistMapAndVMap(1,-618.518f,-4251.67f) ||
+        !MapManager::ExistMapAndVMap(0, 1676.35f, 1677.45f) ||
+        !MapManager::ExistMapAndVMap(1, 10311.3f, 832.463f) ||
+        !MapManager::ExistMapAndVMap(1,-2917.58f,-257.98f) ||
+        (m_configUint32Values[CONFIG_UINT32_EXPANSION] &&
+        (!MapManager::ExistMapAndVMap(530,10349.6f,-6357.29f) || !MapManager::ExistMapAndVMap(530,-3961.64f,-13931.2f))))
+    {
+        sLog.outError("Correct *.map files not found in path '%smaps' or *.vmtree/*.vmtile files in '%svmaps'. Please place *.map and vmap files in appropriate directories or correct the DataDir value in the mangosd.conf file.",m_dataPath.c_str(),m_dataPath.c_str());
+        Log::WaitBeforeContinueIfNeed();
+        exit(1);
+    }
+
+    ///- Loading strings. Getting no records means core load has to be canceled because no error message can be output.
+    sLog.outString();
+    sLog.outString("Loading MaNGOS strings...");
+    if (!sObjectMgr.LoadMangosStrings())
+    {
+        Log::WaitBeforeContinueIfNeed();
+        exit(1);                                            // Error message displayed in function already
+    }
+
+    ///- Update the realm entry in the database with the realm type from the config file
+    //No SQL injection as values are treated as integers
+
+    // not send custom type REALM_FFA_PVP to realm list
+    uint32 server_type = IsFFAPvPRealm() ? REALM_TYPE_PVP : getConfig(CONFIG_UINT32_GAME_TYPE);
+    uint32 realm_zone = getConfig(CONFIG_UINT32_REALM_ZONE);
+    LoginDatabase.PExecute("UPDATE realmlist SET icon = %u, timezone = %u WHERE id = '%u'", server_type, realm_zone, getConfig(CONFIG_UINT32_REALMID));
+
+    ///- Remove the bones (they should not exist in DB though) and old corpses after a restart
+    CharacterDatabase.PExecute("DELETE FROM corpse WHERE corpse_type = '0' OR time < (UNIX_TIMESTAMP()-'%u')", 3*DAY);
+
+    ///- Load the DBC files
+    sLog.outString("Initialize data stores...");
+    LoadDBCStores(m_dataPath);
+    DetectDBCLang();
+    sObjectMgr.SetDBCLocaleIndex(GetDefaultDbcLocale());    // Get once for all the locale index of DBC language (console/broadcasts)
+
+    sLog.outString("Loading GameObject models...");
+    LoadGameObjectModelList();
+
+    sLog.outString( "Loading SpellDbc..." );
+    sSpellMgr.LoadSpellDbc();
+
+    sLog.outString( "Loading SpellTemplate..." );
+    sObjectMgr.LoadSpellTemplate();
+
+    sLog.outString( "Loading Script Names...");
+    sScriptMgr.LoadScriptNames();
+
+    sLog.outString( "Loading WorldTemplate..." );
+    sObjectMgr.LoadWorldTemplate();
+
+    sLog.outString( "Loading InstanceTemplate..." );
+    sObjectMgr.LoadInstanceTemplate();
+
+    sLog.outString("Loading SkillLineAbilityMultiMap Data...");
+    sSpellMgr.LoadSkillLineAbilityMap();
+
+    sLog.outString("Loading SkillRaceClassInfoMultiMap Data...");
+    sSpellMgr.LoadSkillRaceClassInfoMap();
+
+    ///- Clean up and pack instances
+    sLog.outString( "Cleaning up instances..." );
+    sMapPersistentStateMgr.CleanupInstances();              // must be called before `creature_respawn`/`gameobject_respawn` tables
+
+    sLog.outString( "Packing instances..." );
+    sMapPersistentStateMgr.PackInstances();
+
+    sLog.outString( "Packing groups..." );
+    sObjectMgr.PackGroupIds();                              // must be after CleanupInstances
+
+    ///- Init highest guids before any guid using table loading to prevent using not initialized guids in some code.
+    sObjectMgr.SetHighestGuids();                           // must be after PackInstances() and PackGroupIds()
+    sLog.outString();
+
+    ///- Load static and dynamic data, loaders without mutual dependencies are run concurrently
+    LoadTaskGraph loaders;
+    AddStartupLoaders(loaders);
+    loaders.Run(getConfig(CONFIG_UINT32_STARTUP_LOAD_THREADS));
 
     sLog.outString("Initializing Scripts...");
     switch(sScriptMgr.LoadScriptLibrary(MANGOS_SCRIPT_NAME))
@@ -1565,6 +1973,7 @@ void World::SetInitialWorldSettings()
     m_timers[WUPDATE_DELETECHARS].SetInterval(DAY*IN_MILLISECONDS); // check for chars to delete every day
     m_timers[WUPDATE_AUTOBROADCAST].SetInterval(abtimer);
     m_timers[WUPDATE_WORLDSTATE].SetInterval(1*MINUTE*IN_MILLISECONDS);
+    m_timers[WUPDATE_METRICS].SetInterval(1*IN_MILLISECONDS);
 
     // for AhBot
     m_timers[WUPDATE_AHBOT].SetInterval(20*IN_MILLISECONDS); // every 20 sec
@@ -1583,6 +1992,8 @@ void World::SetInitialWorldSettings()
     ///- Initialize MapManager
     sLog.outString( "Starting Map System" );
     sMapMgr.Initialize();
+    sTerrainMgr.StartLoadThreads(getConfig(CONFIG_UINT32_TERRAIN_LOAD_THREADS));
+    sOpcodeWorkerPool.Start(getConfig(CONFIG_UINT32_ASYNC_OPCODE_THREADS));
 
     ///- Initialize Battlegrounds
     sLog.outString( "Starting BattleGround System" );
@@ -1627,6 +2038,8 @@ void World::SetInitialWorldSettings()
     sLog.outString("Initialize AuctionHouseBot...");
     sAuctionBot.Initialize();
 
+    loaders.PrintStatistics();
+
     sLog.outString( "WORLD: World initialized" );
 
     uint32 uStartInterval = WorldTimer::getMSTimeDiff(uStartTime, WorldTimer::getMSTime());
@@ -1682,6 +2095,9 @@ void World::DetectDBCLang()
 /// Update the World !
 void World::Update(uint32 diff)
 {
+    WorldProfiler::BeginTick();
+    uint32 tickStartTime = WorldTimer::getMSTime();
+
     m_updateTime = diff;
 
     ///- Update the different timers
@@ -1717,6 +2133,8 @@ void World::Update(uint32 diff)
     /// <ul><li> Handle auctions when the timer has passed
     if (m_timers[WUPDATE_AUCTIONS].Passed())
     {
+        PROFILE_SCOPE(PROFILE_WORLD_AUCTIONS);
+
         m_timers[WUPDATE_AUCTIONS].Reset();
 
         ///- Update mails (return old mails with item, or delete them)
@@ -1734,12 +2152,16 @@ void World::Update(uint32 diff)
     /// <li> Handle AHBot operations
     if (m_timers[WUPDATE_AHBOT].Passed())
     {
+        PROFILE_SCOPE(PROFILE_WORLD_AUCTIONS);
         sAuctionBot.Update();
         m_timers[WUPDATE_AHBOT].Reset();
     }
 
     /// <li> Handle session updates
-    UpdateSessions(diff);
+    {
+        PROFILE_SCOPE(PROFILE_WORLD_SESSIONS);
+        UpdateSessions(diff);
+    }
 
     /// <li> Handle weather updates when the timer has passed
     if (m_timers[WUPDATE_WEATHERS].Passed())
@@ -1772,9 +2194,18 @@ void World::Update(uint32 diff)
 
     /// <li> Handle all other objects
     ///- Update objects (maps, transport, creatures,...)
-    sMapMgr.Update(diff);
-    sBattleGroundMgr.Update(diff);
-    sOutdoorPvPMgr.Update(diff);
+    {
+        PROFILE_SCOPE(PROFILE_WORLD_MAPS);
+        sMapMgr.Update(diff);
+    }
+    {
+        PROFILE_SCOPE(PROFILE_WORLD_BATTLEGROUNDS);
+        sBattleGroundMgr.Update(diff);
+    }
+    {
+        PROFILE_SCOPE(PROFILE_WORLD_OUTDOORPVP);
+        sOutdoorPvPMgr.Update(diff);
+    }
 
     ///- Delete all characters which have been deleted X days before
     if (m_timers[WUPDATE_DELETECHARS].Passed())
@@ -1791,10 +2222,16 @@ void World::Update(uint32 diff)
     }
 
     // Check if any group can be created by dungeon finder
-    sLFGMgr.Update(diff);
+    {
+        PROFILE_SCOPE(PROFILE_WORLD_LFG);
+        sLFGMgr.Update(diff);
+    }
 
     // execute callbacks from sql queries that were queued recently
-    UpdateResultQueue();
+    {
+        PROFILE_SCOPE(PROFILE_WORLD_DB_RESULTS);
+        UpdateResultQueue();
+    }
 
     ///- Erase corpses once every 20 minutes
     if (m_timers[WUPDATE_CORPSES].Passed())
@@ -1835,6 +2272,126 @@ void World::Update(uint32 diff)
 
     //cleanup unused GridMap objects as well as VMaps
     sTerrainMgr.Update(diff);
+
+    if (getConfig(CONFIG_BOOL_METRICS_ENABLE))
+    {
+        if (m_timers[WUPDATE_METRICS].Passed())
+        {
+            m_timers[WUPDATE_METRICS].Reset();
+            UpdateMetrics();
+        }
+
+        static MetricHistogram* tickTime = sMetrics.GetHistogram("mangos_world_tick_duration_ms", "Duration of world updates in milliseconds",
+            MetricUpdateTimeBounds, METRIC_UPDATE_TIME_BOUNDS);
+
+        tickTime->Observe(WorldTimer::getMSTimeDiff(tickStartTime, WorldTimer::getMSTime()));
+    }
+
+    WorldProfiler::EndTick();
+}
+
+/// Refresh exported gauges, called once per second from world thread when metrics are enabled
+void World::UpdateMetrics()
+{
+    static MetricGauge* activeSessions = sMetrics.GetGauge("mangos_sessions_active", "Sessions of players in the world or at character screen");
+    static MetricGauge* queuedSessions = sMetrics.GetGauge("mangos_sessions_queued", "Sessions waiting in the login queue");
+    static MetricGauge* connections = sMetrics.GetGauge("mangos_network_connections", "Open world sockets");
+    static MetricGauge* instances = sMetrics.GetGauge("mangos_instances", "Created instances of dungeons and battlegrounds");
+    static MetricGauge* mmapTiles = sMetrics.GetGauge("mangos_mmap_tiles_loaded", "Loaded navigation mesh tiles");
+    static MetricGauge* characterQueue = sMetrics.GetGauge("mangos_db_async_queue", "Queued asynchronous database operations", "db=\"character\"");
+    static MetricGauge* worldQueue = sMetrics.GetGauge("mangos_db_async_queue", "Queued asynchronous database operations", "db=\"world\"");
+    static MetricGauge* loginQueue = sMetrics.GetGauge("mangos_db_async_queue", "Queued asynchronous database operations", "db=\"login\"");
+    static MetricGauge* residentBytes = sMetrics.GetGauge("mangos_process_resident_bytes", "Physical memory used by the process");
+    static MetricGauge* asyncOpcodeQueue = sMetrics.GetGauge("mangos_async_opcode_queue", "Read-only opcodes waiting for a worker thread");
+
+    activeSessions->Set(GetActiveSessionCount());
+    queuedSessions->Set(GetQueuedSessionCount());
+    connections->Set(sWorldSocketMgr->GetConnectionCount());
+    instances->Set(sMapMgr.GetNumInstances());
+    mmapTiles->Set(MMAP::MMapFactory::createOrGetMMapManager()->getLoadedTilesCount());
+    characterQueue->Set(CharacterDatabase.GetAsyncQueueSize());
+    worldQueue->Set(WorldDatabase.GetAsyncQueueSize());
+    loginQueue->Set(LoginDatabase.GetAsyncQueueSize());
+    residentBytes->Set(GetProcessResidentBytes());
+    asyncOpcodeQueue->Set(sOpcodeWorkerPool.GetQueueSize());
+
+    // packet and SQL operation pool, allocations of threads are counted in batches
+    static MetricGauge* poolAllocations[MEMORY_POOL_CLASSES] = { NULL };
+    static MetricGauge* poolUsed[MEMORY_POOL_CLASSES];
+    static MetricGauge* poolReserved[MEMORY_POOL_CLASSES];
+    static MetricGauge* poolOversize = sMetrics.GetGauge("mangos_mempool_oversize_allocations", "Allocations too big for the pool, passed to operator new");
+
+    MemoryPool::ClassStatistics poolStats[MEMORY_POOL_CLASSES];
+    MemoryPool::GetStatistics(poolStats);
+    for (uint32 i = 0; i < MEMORY_POOL_CLASSES; ++i)
+    {
+        if (!poolAllocations[i])
+        {
+            std::string label = MetricLabel("size", uint32(poolStats[i].blockSize));
+            poolAllocations[i] = sMetrics.GetGauge("mangos_mempool_allocations", "Blocks allocated from the pool since start", label);
+            poolUsed[i] = sMetrics.GetGauge("mangos_mempool_used_blocks", "Blocks of the pool in use", label);
+            poolReserved[i] = sMetrics.GetGauge("mangos_mempool_reserved_bytes", "Memory reserved by the pool in slabs", label);
+        }
+
+        poolAllocations[i]->Set(poolStats[i].allocations);
+        poolUsed[i]->Set(poolStats[i].allocations - poolStats[i].deallocations);
+        poolReserved[i]->Set(poolStats[i].slabs * MEMORY_POOL_SLAB_SIZE);
+    }
+    poolOversize->Set(MemoryPool::GetOversizeAllocations());
+
+    // per class object pools, created at static initialization so the list does not change
+    std::vector<ObjectPool::Statistics> objectPoolStats;
+    ObjectPool::GetAllStatistics(objectPoolStats);
+    static std::vector<MetricGauge*> objectPoolUsed;
+    static std::vector<MetricGauge*> objectPoolReserved;
+    for (uint32 i = 0; i < objectPoolStats.size(); ++i)
+    {
+        if (i >= objectPoolUsed.size())
+        {
+            std::string label = std::string("type=\"") + objectPoolStats[i].name + "\"";
+            objectPoolUsed.push_back(sMetrics.GetGauge("mangos_object_pool_used", "Objects of the class pool in use", label));
+            objectPoolReserved.push_back(sMetrics.GetGauge("mangos_object_pool_reserved_bytes", "Memory reserved by the class pool in slabs", label));
+        }
+
+        objectPoolUsed[i]->Set(objectPoolStats[i].allocations - objectPoolStats[i].deallocations);
+        objectPoolReserved[i]->Set(objectPoolStats[i].slabs * long(objectPoolStats[i].slabSize));
+    }
+
+    // per map state, maps without loaded instances keep exported as zero
+    std::map<uint32, uint32> grids, players, objects;
+    for (MapMetricsMap::const_iterator itr = m_mapMetrics.begin(); itr != m_mapMetrics.end(); ++itr)
+    {
+        grids[itr->first] = 0;
+        players[itr->first] = 0;
+        objects[itr->first] = 0;
+    }
+
+    MapManager::MapMapType const& maps = sMapMgr.Maps();
+    for (MapManager::MapMapType::const_iterator itr = maps.begin(); itr != maps.end(); ++itr)
+    {
+        Map const* map = itr->second;
+        grids[map->GetId()] += map->GetLoadedGridsCount();
+        players[map->GetId()] += map->GetPlayers().getSize();
+        objects[map->GetId()] += map->GetLastUpdatedObjects();
+    }
+
+    for (std::map<uint32, uint32>::const_iterator itr = grids.begin(); itr != grids.end(); ++itr)
+    {
+        MapMetricsMap::iterator metrics = m_mapMetrics.find(itr->first);
+        if (metrics == m_mapMetrics.end())
+        {
+            std::string label = MetricLabel("map", itr->first);
+            MapMetrics& created = m_mapMetrics[itr->first];
+            created.grids = sMetrics.GetGauge("mangos_map_grids_loaded", "Loaded grids of all instances of the map", label);
+            created.players = sMetrics.GetGauge("mangos_map_players", "Players in all instances of the map", label);
+            created.objects = sMetrics.GetGauge("mangos_map_updated_objects", "Objects updated in the last tick by all instances of the map", label);
+            metrics = m_mapMetrics.find(itr->first);
+        }
+
+        metrics->second.grids->Set(itr->second);
+        metrics->second.players->Set(players[itr->first]);
+        metrics->second.objects->Set(objects[itr->first]);
+    }
 }
 
 /// Send a packet to all players (except self if mentioned)
@@ -2242,6 +2799,18 @@ void World::UpdateSessions(uint32 diff)
     while(addSessQueue.next(sess))
         AddSession_ (sess);
 
+    ///- Delete replaced sessions no longer used by worker threads
+    for (Queue::iterator itr = m_replacedSessions.begin(); itr != m_replacedSessions.end();)
+    {
+        if ((*itr)->HasAsyncPackets())
+            ++itr;
+        else
+        {
+            delete *itr;
+            itr = m_replacedSessions.erase(itr);
+        }
+    }
+
     ///- Then send an update signal to remaining ones
     for (SessionMap::iterator itr = m_sessions.begin(), next; itr != m_sessions.end(); itr = next)
     {
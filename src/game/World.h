@@ -43,6 +43,8 @@ class Weather;
 class SqlResultQueue;
 class QueryResult;
 class WorldSocket;
+class LoadTaskGraph;
+class MetricGauge;
 
 // ServerMessages.dbc
 enum ServerMessageType
@@ -83,7 +85,8 @@ enum WorldTimers
     WUPDATE_AHBOT       = 6,
     WUPDATE_AUTOBROADCAST = 7,
     WUPDATE_WORLDSTATE  = 8,
-    WUPDATE_COUNT       = 9
+    WUPDATE_METRICS     = 9,
+    WUPDATE_COUNT       = 10
 };
 
 /// Configuration elements
@@ -141,6 +144,7 @@ enum eConfigUInt32Values
     CONFIG_UINT32_GROUP_VISIBILITY,
     CONFIG_UINT32_MAIL_DELIVERY_DELAY,
     CONFIG_UINT32_MASS_MAILER_SEND_PER_TICK,
+    CONFIG_UINT32_MASS_MAILER_BULK_SEND_PER_TICK,
     CONFIG_UINT32_UPTIME_UPDATE,
     CONFIG_UINT32_AUCTION_DEPOSIT_MIN,
     CONFIG_UINT32_SKILL_CHANCE_ORANGE,
@@ -160,6 +164,7 @@ enum eConfigUInt32Values
     CONFIG_UINT32_CHATFLOOD_MUTE_TIME,
     CONFIG_UINT32_CREATURE_FAMILY_ASSISTANCE_DELAY,
     CONFIG_UINT32_CREATURE_FAMILY_FLEE_DELAY,
+    CONFIG_UINT32_CREATURE_IDLE_SLEEP_TIME,
     CONFIG_UINT32_WORLD_BOSS_LEVEL_DIFF,
     CONFIG_UINT32_QUEST_DAILY_RESET_HOUR,
     CONFIG_UINT32_QUEST_WEEKLY_RESET_WEEK_DAY,
@@ -197,6 +202,8 @@ enum eConfigUInt32Values
     CONFIG_UINT32_ANTICHEAT_GMLEVEL,
     CONFIG_UINT32_ANTICHEAT_ACTION_DELAY,
     CONFIG_UINT32_NUMTHREADS,
+    CONFIG_UINT32_STARTUP_LOAD_THREADS,
+    CONFIG_UINT32_PROFILER_SLOW_TICK,
     CONFIG_UINT32_RANDOM_BG_RESET_HOUR,
     CONFIG_UINT32_LOSERNOCHANGE,
     CONFIG_UINT32_LOSERHALFCHANGE,
@@ -218,6 +225,13 @@ enum eConfigUInt32Values
     CONFIG_UINT32_VMSS_FORCEUNLOADDELAY,
     CONFIG_UINT32_WORLD_STATE_EXPIRETIME,
     CONFIG_UINT32_OBJECTLOADINGSPLITTER_ALLOWEDTIME,
+    CONFIG_UINT32_MOVEMENT_RELAY_MID_INTERVAL,
+    CONFIG_UINT32_MOVEMENT_RELAY_FAR_INTERVAL,
+    CONFIG_UINT32_CHAR_ENUM_CACHE_TIME,
+    CONFIG_UINT32_TERRAIN_LOAD_THREADS,
+    CONFIG_UINT32_VMAP_MODEL_MEMORY_BUDGET,
+    CONFIG_UINT32_GRID_UNLOAD_ALLOWEDTIME,
+    CONFIG_UINT32_ASYNC_OPCODE_THREADS,
     CONFIG_UINT32_VALUE_COUNT
 };
 
@@ -302,6 +316,7 @@ enum eConfigFloatValues
     CONFIG_FLOAT_LISTEN_RANGE_TEXTEMOTE,
     CONFIG_FLOAT_CREATURE_FAMILY_FLEE_ASSISTANCE_RADIUS,
     CONFIG_FLOAT_CREATURE_FAMILY_ASSISTANCE_RADIUS,
+    CONFIG_FLOAT_CREATURE_IDLE_WAKE_RADIUS,
     CONFIG_FLOAT_GROUP_XP_DISTANCE,
     CONFIG_FLOAT_THREAT_RADIUS,
     CONFIG_FLOAT_GHOST_RUN_SPEED_WORLD,
@@ -311,6 +326,9 @@ enum eConfigFloatValues
     CONFIG_FLOAT_CROWDCONTROL_HP_BASE,
     CONFIG_FLOAT_LOADBALANCE_HIGHVALUE,
     CONFIG_FLOAT_LOADBALANCE_LOWVALUE,
+    CONFIG_FLOAT_MOVEMENT_RELAY_NEAR_DISTANCE,
+    CONFIG_FLOAT_MOVEMENT_RELAY_FAR_DISTANCE,
+    CONFIG_FLOAT_TERRAIN_READ_AHEAD_DISTANCE,
     CONFIG_FLOAT_VALUE_COUNT
 };
 
@@ -378,6 +396,7 @@ enum eConfigBoolValues
     CONFIG_BOOL_STATS_SAVE_ONLY_ON_LOGOUT,
     CONFIG_BOOL_CLEAN_CHARACTER_DB,
     CONFIG_BOOL_VMAP_INDOOR_CHECK,
+    CONFIG_BOOL_VMAP_LAZY_GROUP_LOADING,
     CONFIG_BOOL_LOOT_CHESTS_IGNORE_DB,
     CONFIG_BOOL_PET_UNSUMMON_AT_MOUNT,
     CONFIG_BOOL_RAID_FLAGS_UNIQUE,
@@ -396,6 +415,8 @@ enum eConfigBoolValues
     CONFIG_BOOL_ALLOW_HONOR_KILLS_TITLES,
     CONFIG_BOOL_PET_SAVE_ALL,
     CONFIG_BOOL_THREADS_DYNAMIC,
+    CONFIG_BOOL_PROFILER_ENABLE,
+    CONFIG_BOOL_METRICS_ENABLE,
     CONFIG_BOOL_VMSS_ENABLE,
     CONFIG_BOOL_VMSS_TRYSKIPFIRST,
     CONFIG_BOOL_PLAYERBOT_ALLOW_SUMMON_OPPOSITE_FACTION,
@@ -413,6 +434,7 @@ enum eConfigBoolValues
     CONFIG_BOOL_RESILENCE_ALTERNATIVE_CALCULATION,
     CONFIG_BOOL_BLINK_ANIMATION_TYPE,
     CONFIG_BOOL_FACTION_AND_RACE_CHANGE_WITHOUT_RENAMING,
+    CONFIG_BOOL_MOVEMENT_RELAY_COALESCE,
     CONFIG_BOOL_VALUE_COUNT
 };
 
@@ -535,6 +557,16 @@ class World
         uint32 GetMaxActiveSessionCount() const { return m_maxActiveSessionCount; }
         Player* FindPlayerInZone(uint32 zone);
 
+        /// Character list of an account kept for CONFIG_UINT32_CHAR_ENUM_CACHE_TIME seconds,
+        /// must be invalidated at every change of the account characters shown in the list.
+        /// A list loaded from DB is cached only if nothing was invalidated since the version
+        /// taken at start of the load.
+        uint32 GetCharEnumCacheVersion();
+        bool GetCachedCharEnum(uint32 accountId, WorldPacket& data);
+        void CacheCharEnum(uint32 accountId, WorldPacket const& data, uint32 version);
+        void InvalidateCharEnum(uint32 accountId);
+        void ClearCharEnumCache();
+
         Weather* FindWeather(uint32 id) const;
         Weather* AddWeather(uint32 zone_id);
         void RemoveWeather(uint32 zone_id);
@@ -692,6 +724,8 @@ class World
         void InitRandomBGResetTime();
         void ResetRandomBG();
 
+        void UpdateMetrics();
+
     private:
         void setConfig(eConfigUInt32Values index, char const* fieldname, uint32 defvalue);
         void setConfig(eConfigInt32Values index, char const* fieldname, int32 defvalue);
@@ -721,10 +755,35 @@ class World
         uint32 mail_timer_expires;
         uint32 m_updateTime;
 
+        // exported per map gauges, created at first metrics update of the map
+        struct MapMetrics
+        {
+            MetricGauge* grids;
+            MetricGauge* players;
+            MetricGauge* objects;
+        };
+        typedef std::map<uint32, MapMetrics> MapMetricsMap;
+        MapMetricsMap m_mapMetrics;                         // by map id, all instances summed
+
         typedef UNORDERED_MAP<uint32, Weather*> WeatherMap;
         WeatherMap m_weathers;
         typedef UNORDERED_MAP<uint32, WorldSession*> SessionMap;
         SessionMap m_sessions;
+
+        struct CharEnumCacheEntry
+        {
+            CharEnumCacheEntry() : expireTime(0), packet(NULL), version(0) {}
+
+            time_t expireTime;
+            WorldPacket* packet;                            // NULL after invalidation
+            uint32 version;                                 // of last invalidation
+        };
+        typedef UNORDERED_MAP<uint32, CharEnumCacheEntry> CharEnumCacheMap;
+        CharEnumCacheMap m_charEnumCache;                   // by account id
+        time_t m_charEnumCacheSweepTime;
+        uint32 m_charEnumCacheVersion;
+        uint32 m_charEnumCacheClearVersion;
+        ACE_Thread_Mutex m_charEnumCacheLock;               // guards all above
         uint32 m_maxActiveSessionCount;
         uint32 m_maxQueuedSessionCount;
 
@@ -737,6 +796,7 @@ class World
         LocaleConstant m_defaultDbcLocale;                     // from config for one from loaded DBC locales
         uint32 m_availableDbcLocaleMask;                       // by loaded DBC
         void DetectDBCLang();
+        void AddStartupLoaders(LoadTaskGraph& loaders);
         bool m_allowMovement;
         std::string m_motd;
         std::string m_dataPath;
@@ -770,6 +830,9 @@ class World
         void AddSession_(WorldSession* s);
         ACE_Based::LockedQueue<WorldSession*, ACE_Thread_Mutex> addSessQueue;
 
+        //replaced sessions deleted when OpcodeWorkerPool is done with them
+        Queue m_replacedSessions;
+
         //used versions
         std::string m_DBVersion;
         std::string m_CreatureEventAIVersion;
@@ -33,24 +33,19 @@
 
 // Event processor
 
-WorldObjectEventProcessor::WorldObjectEventProcessor()
+WorldObjectEventProcessor::WorldObjectEventProcessor(WorldObject const* owner) : m_owner(owner)
 {
-    //m_time = WorldTimer::getMSTime();
-    m_events.clear();
 }
 
-void WorldObjectEventProcessor::Update(uint32 p_time, bool force)
+WorldObjectEventProcessor::~WorldObjectEventProcessor()
 {
-    if (force)
-        RenewEvents();
-
-    EventProcessor::Update(p_time);
+    KillAllEvents(true);
 }
 
 void WorldObjectEventProcessor::KillAllEvents(bool force)
 {
-    if (force)
-        RenewEvents();
+    // queued events must be known to the processor before it aborts them
+    RenewEvents();
 
     EventProcessor::KillAllEvents(force);
 }
@@ -58,49 +53,75 @@ void WorldObjectEventProcessor::KillAllEvents(bool force)
 void WorldObjectEventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime)
 {
     if (set_addtime)
-        Event->m_addTime = m_time;
+        Event->m_addTime = GetTime();
 
     Event->m_execTime = e_time;
-    m_queue.push(std::pair<uint64, BasicEvent*>(e_time, Event));
+
+    // re-added event still planned for its old time must leave the wheel before it joins the queue
+    if (m_wheel)
+        m_wheel->Cancel(Event);
+
+    m_queue.push_back(&Event->m_timerLink);
 }
 
 void WorldObjectEventProcessor::RenewEvents()
 {
-    while (!m_queue.empty())
+    while (BasicEvent* Event = m_queue.front())
     {
-        if (m_queue.front().second)
+        Event->m_timerLink.Unlink();
+
+        switch (Event->GetType())
         {
-            switch (m_queue.front().second->GetType())
+            case WORLDOBJECT_EVENT_TYPE_UNIQUE:
             {
-                case WORLDOBJECT_EVENT_TYPE_UNIQUE:
+                bool needInsert = true;
+                for (EventLink* link = m_events.first(); !m_events.isEnd(link); link = EventLinkList::next(link))
                 {
-                    bool needInsert = true;
-                    for (EventList::const_iterator i = m_events.begin(); i != m_events.end(); ++i)
+                    // re-added event is still in the list
+                    if (link->GetEvent() != Event && link->GetEvent()->GetType() == WORLDOBJECT_EVENT_TYPE_UNIQUE)
                     {
-                        if (i->second->GetType() == WORLDOBJECT_EVENT_TYPE_UNIQUE)
-                        {
-                            BasicEvent* event = m_queue.front().second;
-                            delete event;
-                            needInsert = false;
-                            break;
-                        }
+                        delete Event;
+                        needInsert = false;
+                        break;
                     }
-                    if (needInsert)
-                        m_events.insert(m_queue.front());
-                    break;
                 }
-                case WORLDOBJECT_EVENT_TYPE_REPEATABLE:
-                case WORLDOBJECT_EVENT_TYPE_DEATH:
-                case WORLDOBJECT_EVENT_TYPE_COMMON:
-                default:
-                    m_events.insert(m_queue.front());
-                    break;
+                if (needInsert)
+                    EventProcessor::AddEvent(Event, Event->m_execTime, false);
+                break;
             }
+            case WORLDOBJECT_EVENT_TYPE_REPEATABLE:
+            case WORLDOBJECT_EVENT_TYPE_DEATH:
+            case WORLDOBJECT_EVENT_TYPE_COMMON:
+            default:
+                EventProcessor::AddEvent(Event, Event->m_execTime, false);
+                break;
         }
-        m_queue.pop();
     }
 }
 
+void WorldObjectEventProcessor::SetTimerWheel(EventTimerWheel* wheel)
+{
+    RenewEvents();
+    EventProcessor::SetTimerWheel(wheel);
+}
+
+bool WorldObjectEventProcessor::CanExecuteEvents() const
+{
+    // map events always fire, object events only in the cells updated by the last map update
+    // (as when the owner update executed them), others wait for the owner's next update
+    if (!m_owner)
+        return true;
+
+    if (!m_owner->IsInWorld())
+        return false;
+
+    CellPair p = MaNGOS::ComputeCellPair(m_owner->GetPositionX(), m_owner->GetPositionY());
+    if (p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP)
+        return false;
+
+    return m_owner->GetMap()->isCellMarked(p.y_coord * TOTAL_NUMBER_OF_CELLS_PER_MAP + p.x_coord);
+}
+
 void WorldObjectEventProcessor::CleanupEventList()
 {
     KillAllEvents(true);
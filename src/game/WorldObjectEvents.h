@@ -27,6 +27,7 @@
 class Spell;
 class Unit;
 class Creature;
+class WorldObject;
 struct WorldLocation;
 
 enum WorldObjectEventType
@@ -38,26 +39,26 @@ enum WorldObjectEventType
     WORLDOBJECT_EVENT_TYPE_MAX
 };
 
-typedef std::queue<std::pair<uint64, BasicEvent*> > EventNewQueue;
-
 class MANGOS_DLL_SPEC WorldObjectEventProcessor : public EventProcessor
 {
     public:
-        WorldObjectEventProcessor();
-        ~WorldObjectEventProcessor() {};
+        explicit WorldObjectEventProcessor(WorldObject const* owner = NULL);
+        ~WorldObjectEventProcessor();
 
-        void Update(uint32 p_time, bool force = false);
         void KillAllEvents(bool force);
         void CleanupEventList();
         void AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime = true);
         void RenewEvents();
+        void SetTimerWheel(EventTimerWheel* wheel);
+        bool CanExecuteEvents() const;
 
         uint32 size(bool withQueue = false)  const { return (withQueue ? (m_events.size() + m_queue.size()) :  m_events.size()); };
         bool   empty() const { return m_events.empty(); };
+        bool   HasQueuedEvents() const { return !m_queue.empty(); };
 
     protected:
-        void _AddEvents();
-        EventNewQueue m_queue;
+        EventLinkList m_queue;                              // events added since last RenewEvents, linked by m_timerLink
+        WorldObject const* m_owner;                         // NULL for the map own events
 };
 
 // Spell events
@@ -0,0 +1,376 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "WorldProfiler.h"
+#include "Opcodes.h"
+#include "Config/Config.h"
+#include "Log.h"
+#include "Util.h"
+
+#include <ace/Atomic_Op.h>
+#include <ace/Guard_T.h>
+#include <ace/Thread.h>
+#include <ace/Thread_Mutex.h>
+
+#include <algorithm>
+#include <stdio.h>
+
+typedef ACE_Guard<ACE_Thread_Mutex> ProfileGuard;
+// nanoseconds of the current tick, overflow on 32 bit platforms needs a subsystem running over 2 seconds in one tick
+typedef ACE_Atomic_Op<ACE_Thread_Mutex, long> ProfileCounter;
+
+#define TRACE_MIN_FINE_DURATION     100000                  // ns, shorter unit, AI and opcode timers are not traced
+#define TRACE_MAX_EVENTS            200000
+#define SLOW_TICK_DUMP_INTERVAL     10                      // s, at most one dump per interval
+
+struct ProfileOpcodeCounters
+{
+    ProfileCounter count;
+    ProfileCounter total;                                   // in microseconds
+    ProfileCounter max;
+};
+
+struct ProfileTraceEvent
+{
+    ProfileSubsystem subsystem;
+    uint32 arg;
+    uint32 thread;
+    ACE_hrtime_t start;
+    ACE_hrtime_t duration;
+};
+
+volatile bool WorldProfiler::m_enabled = false;
+uint32 WorldProfiler::m_slowTickThreshold = 0;
+
+// current tick, updated by all map threads
+static ProfileCounter s_tickTime[MAX_PROFILE_SUBSYSTEM];
+static ProfileOpcodeCounters s_opcodes[NUM_MSG_TYPES];
+static ACE_hrtime_t s_tickStart = 0;
+
+// per tick data, only changed at end of tick (when map threads are idle) and by reset
+static ACE_Thread_Mutex s_dataLock;
+static uint32 s_ticks = 0;
+static ProfileHistogram s_histograms[MAX_PROFILE_SUBSYSTEM];
+static std::map<uint32, ProfileHistogram> s_mapHistograms;
+static std::map<uint32, ACE_hrtime_t> s_tickMapTime;
+
+// timers of the current tick for the slow tick dump
+static ACE_Thread_Mutex s_traceLock;
+static volatile bool s_tracing = false;
+static std::vector<ProfileTraceEvent> s_trace;
+static std::map<ACE_thread_t, uint32> s_threadIds;
+static time_t s_lastDump = 0;
+
+static uint32 GetHistogramBucket(uint32 us)
+{
+    if (us < 4)
+        return us;
+
+    uint32 bit = 2;
+    while (bit < 31 && (us >> (bit + 1)))
+        ++bit;
+
+    return (bit - 1) * 4 + ((us >> (bit - 2)) & 3);
+}
+
+static uint32 GetHistogramBucketLowerBound(uint32 bucket)
+{
+    if (bucket < 4)
+        return bucket;
+
+    return (4 + bucket % 4) << (bucket / 4 - 1);
+}
+
+void ProfileHistogram::Reset()
+{
+    memset(buckets, 0, sizeof(buckets));
+    count = 0;
+    total = 0;
+    max = 0;
+}
+
+void ProfileHistogram::Add(uint32 us)
+{
+    ++buckets[GetHistogramBucket(us)];
+    ++count;
+    total += us;
+    if (us > max)
+        max = us;
+}
+
+uint32 ProfileHistogram::GetPercentile(float percent) const
+{
+    if (!count)
+        return 0;
+
+    uint64 rank = uint64(count * percent / 100.0f);
+    if (rank >= count)
+        rank = count - 1;
+
+    uint64 seen = 0;
+    for (uint32 i = 0; i < PROFILE_HISTOGRAM_BUCKETS; ++i)
+    {
+        seen += buckets[i];
+        if (seen > rank)
+            return GetHistogramBucketLowerBound(i);
+    }
+
+    return max;
+}
+
+void WorldProfiler::Reset()
+{
+    ProfileGuard guard(s_dataLock);
+
+    s_ticks = 0;
+    for (int i = 0; i < MAX_PROFILE_SUBSYSTEM; ++i)
+        s_histograms[i].Reset();
+    s_mapHistograms.clear();
+
+    for (int i = 0; i < NUM_MSG_TYPES; ++i)
+    {
+        s_opcodes[i].count = 0;
+        s_opcodes[i].total = 0;
+        s_opcodes[i].max = 0;
+    }
+}
+
+void WorldProfiler::BeginTick()
+{
+    if (!m_enabled)
+    {
+        s_tickStart = 0;
+        return;
+    }
+
+    for (int i = 0; i < MAX_PROFILE_SUBSYSTEM; ++i)
+        s_tickTime[i] = 0;
+
+    if (m_slowTickThreshold)
+    {
+        ProfileGuard guard(s_traceLock);
+        s_trace.clear();
+        s_tracing = true;
+    }
+
+    s_tickStart = ACE_OS::gethrtime();
+}
+
+void WorldProfiler::EndTick()
+{
+    // profiler was enabled while the tick was running
+    if (!s_tickStart)
+        return;
+
+    ACE_hrtime_t tickStart = s_tickStart;
+    ACE_hrtime_t tickTime = ACE_OS::gethrtime() - tickStart;
+    s_tickStart = 0;
+    s_tracing = false;
+
+    {
+        ProfileGuard guard(s_dataLock);
+
+        ++s_ticks;
+        s_histograms[PROFILE_WORLD_TICK].Add(uint32(tickTime / 1000));
+
+        // everything of the world thread without own timer
+        ACE_hrtime_t other = tickTime;
+        for (int i = PROFILE_WORLD_TICK + 1; i < PROFILE_WORLD_OTHER; ++i)
+            other -= std::min(other, ACE_hrtime_t(s_tickTime[i].value()));
+        s_tickTime[PROFILE_WORLD_OTHER] = long(other);
+
+        // subsystems not running in this tick count with 0, so the average is per tick
+        for (int i = PROFILE_WORLD_TICK + 1; i < MAX_PROFILE_SUBSYSTEM; ++i)
+            s_histograms[i].Add(uint32(s_tickTime[i].value() / 1000));
+
+        for (std::map<uint32, ACE_hrtime_t>::const_iterator itr = s_tickMapTime.begin(); itr != s_tickMapTime.end(); ++itr)
+            s_mapHistograms[itr->first].Add(uint32(itr->second / 1000));
+        s_tickMapTime.clear();
+    }
+
+    if (!m_slowTickThreshold || tickTime < ACE_hrtime_t(m_slowTickThreshold) * 1000000)
+        return;
+
+    time_t now = time(NULL);
+    if (now < s_lastDump + SLOW_TICK_DUMP_INTERVAL)
+        return;
+
+    s_lastDump = now;
+    DumpTrace(tickStart, tickTime);
+}
+
+void WorldProfiler::Add(ProfileSubsystem subsystem, ACE_hrtime_t start, ACE_hrtime_t end, uint32 arg /*= 0*/)
+{
+    ACE_hrtime_t duration = end - start;
+    s_tickTime[subsystem] += long(duration);
+
+    if (subsystem == PROFILE_MAP_UPDATE)
+    {
+        // once per map and tick, instances of same map are summed
+        ProfileGuard guard(s_dataLock);
+        s_tickMapTime[arg] += duration;
+    }
+    else if (subsystem == PROFILE_OPCODES && arg < NUM_MSG_TYPES)
+    {
+        ProfileOpcodeCounters& counters = s_opcodes[arg];
+        long us = long(duration / 1000);
+
+        ++counters.count;
+        counters.total += us;
+
+        // not exact under races, good enough for a statistic
+        if (us > counters.max.value())
+            counters.max = us;
+    }
+
+    if (!s_tracing || (subsystem >= PROFILE_UNIT_SPELLS && duration < TRACE_MIN_FINE_DURATION))
+        return;
+
+    ProfileGuard guard(s_traceLock);
+
+    if (!s_tracing || s_trace.size() >= TRACE_MAX_EVENTS)
+        return;
+
+    ACE_thread_t self = ACE_Thread::self();
+    std::map<ACE_thread_t, uint32>::const_iterator itr = s_threadIds.find(self);
+    uint32 thread;
+    if (itr != s_threadIds.end())
+        thread = itr->second;
+    else
+    {
+        thread = s_threadIds.size();
+        s_threadIds[self] = thread;
+    }
+
+    ProfileTraceEvent event;
+    event.subsystem = subsystem;
+    event.arg = arg;
+    event.thread = thread;
+    event.start = start;
+    event.duration = duration;
+    s_trace.push_back(event);
+}
+
+void WorldProfiler::GetSnapshot(ProfileSnapshot& snapshot)
+{
+    ProfileGuard guard(s_dataLock);
+
+    snapshot.ticks = s_ticks;
+    for (int i = 0; i < MAX_PROFILE_SUBSYSTEM; ++i)
+        snapshot.subsystems[i] = s_histograms[i];
+    snapshot.maps = s_mapHistograms;
+
+    snapshot.opcodes.clear();
+    for (int i = 0; i < NUM_MSG_TYPES; ++i)
+    {
+        if (!s_opcodes[i].count.value())
+            continue;
+
+        ProfileOpcodeStats stats;
+        stats.opcode = uint16(i);
+        stats.count = s_opcodes[i].count.value();
+        stats.total = s_opcodes[i].total.value();
+        stats.max = s_opcodes[i].max.value();
+        snapshot.opcodes.push_back(stats);
+    }
+}
+
+char const* WorldProfiler::GetSubsystemName(ProfileSubsystem subsystem)
+{
+    switch (subsystem)
+    {
+        case PROFILE_WORLD_TICK:          return "world tick";
+        case PROFILE_WORLD_SESSIONS:      return "sessions";
+        case PROFILE_WORLD_MAPS:          return "maps";
+        case PROFILE_WORLD_BATTLEGROUNDS: return "battlegrounds";
+        case PROFILE_WORLD_OUTDOORPVP:    return "outdoor pvp";
+        case PROFILE_WORLD_AUCTIONS:      return "auctions";
+        case PROFILE_WORLD_LFG:           return "lfg";
+        case PROFILE_WORLD_DB_RESULTS:    return "db results";
+        case PROFILE_WORLD_OTHER:         return "world other";
+        case PROFILE_MAP_UPDATE:          return "map update";
+        case PROFILE_MAP_GRID_LOADING:    return "grid loading";
+        case PROFILE_MAP_SESSIONS:        return "map sessions";
+        case PROFILE_MAP_PLAYERS:         return "players";
+        case PROFILE_MAP_OBJECTS:         return "objects";
+        case PROFILE_MAP_SEND_UPDATES:    return "send updates";
+        case PROFILE_MAP_SCRIPTS:         return "scripts";
+        case PROFILE_UNIT_SPELLS:         return "unit spells";
+        case PROFILE_UNIT_STATE:          return "unit state";
+        case PROFILE_UNIT_MOVEMENT:       return "unit movement";
+        case PROFILE_CREATURE_AI:         return "creature ai";
+        case PROFILE_OPCODES:             return "opcodes";
+        default:                          return "unknown";
+    }
+}
+
+void WorldProfiler::DumpTrace(ACE_hrtime_t tickStart, ACE_hrtime_t tickTime)
+{
+    // the world thread is idle meanwhile, but timers of other threads can still come
+    std::vector<ProfileTraceEvent> trace;
+    std::map<ACE_thread_t, uint32> threadIds;
+    {
+        ProfileGuard guard(s_traceLock);
+        trace.swap(s_trace);
+        threadIds = s_threadIds;
+    }
+
+    if (trace.empty())
+        return;
+
+    std::string filename = sConfig.GetStringDefault("LogsDir", "");
+    if (!filename.empty() && filename[filename.size() - 1] != '/' && filename[filename.size() - 1] != '\\')
+        filename += '/';
+    filename += "slowtick_" + TimeToTimestampStr(time(NULL)) + ".json";
+
+    FILE* file = fopen(filename.c_str(), "w");
+    if (!file)
+    {
+        sLog.outError("WorldProfiler: can't create slow tick trace file %s", filename.c_str());
+        return;
+    }
+
+    // Chrome trace-event format, complete events in microseconds from start of the tick
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"tick\"}}");
+    fprintf(file, ",\n{\"name\":\"world tick\",\"cat\":\"world\",\"ph\":\"X\",\"ts\":0,\"dur\":%.3f,\"pid\":1,\"tid\":0}", tickTime / 1000.0);
+
+    for (std::map<ACE_thread_t, uint32>::const_iterator itr = threadIds.begin(); itr != threadIds.end(); ++itr)
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}", itr->second + 1, itr->second + 1);
+
+    for (std::vector<ProfileTraceEvent>::const_iterator itr = trace.begin(); itr != trace.end(); ++itr)
+    {
+        double ts = itr->start > tickStart ? (itr->start - tickStart) / 1000.0 : 0.0;
+        double dur = itr->duration / 1000.0;
+
+        if (itr->subsystem == PROFILE_OPCODES)
+            fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"opcode\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                LookupOpcodeName(uint16(itr->arg)), ts, dur, itr->thread + 1);
+        else if (itr->subsystem >= PROFILE_MAP_UPDATE && itr->subsystem < PROFILE_UNIT_SPELLS)
+            fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"map\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"map\":%u}}",
+                GetSubsystemName(itr->subsystem), ts, dur, itr->thread + 1, itr->arg);
+        else
+            fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                GetSubsystemName(itr->subsystem), itr->subsystem < PROFILE_MAP_UPDATE ? "world" : "unit", ts, dur, itr->thread + 1);
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    sLog.outString("WorldProfiler: tick of %u ms written to %s (%u timers)", uint32(tickTime / 1000000), filename.c_str(), uint32(trace.size()));
+}
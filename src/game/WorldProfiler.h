@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_WORLDPROFILER_H
+#define MANGOS_WORLDPROFILER_H
+
+#include "Common.h"
+#include "Platform/Define.h"
+
+#include <ace/OS_NS_time.h>
+
+#include <map>
+
+enum ProfileSubsystem
+{
+    PROFILE_WORLD_TICK,                                     // whole World::Update
+    PROFILE_WORLD_SESSIONS,                                 // World::UpdateSessions: thread unsafe opcodes, logouts
+    PROFILE_WORLD_MAPS,                                     // MapManager::Update, including wait for map threads
+    PROFILE_WORLD_BATTLEGROUNDS,
+    PROFILE_WORLD_OUTDOORPVP,
+    PROFILE_WORLD_AUCTIONS,                                 // auction house, AH bot, expired mails
+    PROFILE_WORLD_LFG,
+    PROFILE_WORLD_DB_RESULTS,                               // callbacks of async queries
+    PROFILE_WORLD_OTHER,                                    // rest of the world tick: resets, game events, cli commands...
+    PROFILE_MAP_UPDATE,                                     // Map::Update, sum of all maps
+    PROFILE_MAP_GRID_LOADING,                               // object loading queue and grid state changes
+    PROFILE_MAP_SESSIONS,                                   // map thread safe opcodes
+    PROFILE_MAP_PLAYERS,
+    PROFILE_MAP_OBJECTS,                                    // creatures and game objects of active cells
+    PROFILE_MAP_SEND_UPDATES,                               // Map::SendObjectUpdates
+    PROFILE_MAP_SCRIPTS,                                    // db scripts and instance scripts
+    PROFILE_UNIT_SPELLS,                                    // events, spells and auras of Unit::Update
+    PROFILE_UNIT_STATE,                                     // timers, threat, vehicles and aura states of Unit::Update
+    PROFILE_UNIT_MOVEMENT,                                  // splines and unit state manager of Unit::Update
+    PROFILE_CREATURE_AI,
+    PROFILE_OPCODES,                                        // all opcode handlers
+    MAX_PROFILE_SUBSYSTEM
+};
+
+#define PROFILE_HISTOGRAM_BUCKETS   128
+
+/**
+ * Histogram of per-tick times in microseconds. Buckets grow exponentially,
+ * with 4 linear sub-buckets per power of two, so percentiles are exact to 25%.
+ */
+struct ProfileHistogram
+{
+    ProfileHistogram() { Reset(); }
+
+    void Reset();
+    void Add(uint32 us);
+
+    // lower bound of the bucket holding the given percentile
+    uint32 GetPercentile(float percent) const;
+    uint32 GetAverage() const { return count ? uint32(total / count) : 0; }
+
+    uint32 buckets[PROFILE_HISTOGRAM_BUCKETS];
+    uint64 count;
+    uint64 total;
+    uint32 max;
+};
+
+struct ProfileOpcodeStats
+{
+    ProfileOpcodeStats() : opcode(0), count(0), total(0), max(0) {}
+
+    uint16 opcode;
+    uint64 count;
+    uint64 total;                                           // in microseconds
+    uint32 max;
+};
+
+struct ProfileSnapshot
+{
+    uint32 ticks;
+    ProfileHistogram subsystems[MAX_PROFILE_SUBSYSTEM];
+    std::map<uint32, ProfileHistogram> maps;                // by map id, of ticks the map was updated
+    std::vector<ProfileOpcodeStats> opcodes;                // opcodes handled at least once
+};
+
+/**
+ * Low overhead profiler of the world tick.
+ *
+ * Scoped timers in World::Update, Map::Update, opcode handlers and Unit::Update
+ * add their time to the current tick, at end of every tick the sums go to per
+ * subsystem and per map id histograms. Nested subsystems are part of their
+ * parents (unit spells are part of map objects, that are part of the map update).
+ * Map level times are summed over all maps, so with map threads they can be
+ * higher than the world tick.
+ *
+ * Disabled profiler costs one flag check per scope. With a slow tick threshold
+ * set, timers of the tick are recorded and ticks longer than the threshold
+ * are written to the logs directory as Chrome trace-event JSON.
+ */
+class MANGOS_DLL_SPEC WorldProfiler
+{
+    public:
+        static bool IsEnabled() { return m_enabled; }
+        static void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+        // in ms, 0 disables dumps of slow ticks
+        static void SetSlowTickThreshold(uint32 ms) { m_slowTickThreshold = ms; }
+        static uint32 GetSlowTickThreshold() { return m_slowTickThreshold; }
+
+        static void Reset();
+
+        // called by the world thread around World::Update
+        static void BeginTick();
+        static void EndTick();
+
+        // arg is the map id for map subsystems and the opcode for PROFILE_OPCODES
+        static void Add(ProfileSubsystem subsystem, ACE_hrtime_t start, ACE_hrtime_t end, uint32 arg = 0);
+
+        static void GetSnapshot(ProfileSnapshot& snapshot);
+        static char const* GetSubsystemName(ProfileSubsystem subsystem);
+
+    private:
+        static void DumpTrace(ACE_hrtime_t tickStart, ACE_hrtime_t tickTime);
+
+        static volatile bool m_enabled;
+        static uint32 m_slowTickThreshold;
+};
+
+/// Adds the time of its scope to a subsystem of the current tick
+class ProfileScope
+{
+    public:
+        explicit ProfileScope(ProfileSubsystem subsystem, uint32 arg = 0) :
+            m_subsystem(subsystem), m_arg(arg), m_start(WorldProfiler::IsEnabled() ? ACE_OS::gethrtime() : 0) {}
+
+        ~ProfileScope()
+        {
+            if (m_start)
+                WorldProfiler::Add(m_subsystem, m_start, ACE_OS::gethrtime(), m_arg);
+        }
+
+    private:
+        ProfileScope(ProfileScope const&);
+        ProfileScope& operator=(ProfileScope const&);
+
+        ProfileSubsystem m_subsystem;
+        uint32 m_arg;
+        ACE_hrtime_t m_start;
+};
+
+/// Adds the time between switches to the current subsystem, for sequential steps of one function
+class ProfilePhase
+{
+    public:
+        explicit ProfilePhase(ProfileSubsystem subsystem, uint32 arg = 0) :
+            m_subsystem(subsystem), m_arg(arg), m_start(WorldProfiler::IsEnabled() ? ACE_OS::gethrtime() : 0) {}
+
+        ~ProfilePhase()
+        {
+            if (m_start)
+                WorldProfiler::Add(m_subsystem, m_start, ACE_OS::gethrtime(), m_arg);
+        }
+
+        void Switch(ProfileSubsystem subsystem)
+        {
+            if (m_start || WorldProfiler::IsEnabled())
+            {
+                ACE_hrtime_t now = ACE_OS::gethrtime();
+                if (m_start)
+                    WorldProfiler::Add(m_subsystem, m_start, now, m_arg);
+
+                m_start = WorldProfiler::IsEnabled() ? now : 0;
+            }
+
+            m_subsystem = subsystem;
+        }
+
+    private:
+        ProfilePhase(ProfilePhase const&);
+        ProfilePhase& operator=(ProfilePhase const&);
+
+        ProfileSubsystem m_subsystem;
+        uint32 m_arg;
+        ACE_hrtime_t m_start;
+};
+
+#define PROFILE_SCOPE(SUBSYSTEM) ProfileScope profileScope(SUBSYSTEM);
+#define PROFILE_SCOPE_ARG(SUBSYSTEM,ARG) ProfileScope profileScope(SUBSYSTEM, ARG);
+
+#endif
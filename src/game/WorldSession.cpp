@@ -26,6 +26,7 @@
 #include "Log.h"
 #include "Opcodes.h"
 #include "WorldPacket.h"
+#include "SharedWorldPacket.h"
 #include "WorldSession.h"
 #include "Player.h"
 #include "ObjectMgr.h"
@@ -42,6 +43,8 @@
 #include "zlib/zlib.h"
 #include "warden/WardenWin.h"
 #include "warden/WardenMac.h"
+#include "WorldProfiler.h"
+#include "OpcodeWorkerPool.h"
 
 // Playerbot mod
 #include "playerbot/PlayerbotMgr.h"
@@ -67,7 +70,8 @@ static bool MapSessionFilterHelper(WorldSession* session, OpcodeHandler const& o
 bool MapSessionFilter::Process(WorldPacket * packet)
 {
     OpcodeHandler const& opHandle = opcodeTable[packet->GetOpcode()];
-    if (opHandle.packetProcessing == PROCESS_INPLACE)
+    // read-only packets are only handed to the worker threads, by the update seeing them first
+    if (opHandle.packetProcessing == PROCESS_INPLACE || opHandle.packetProcessing == PROCESS_READONLY_ASYNC)
         return true;
 
     // let's check if our opcode can be really processed in Map::Update()
@@ -80,7 +84,7 @@ bool WorldSessionFilter::Process(WorldPacket* packet)
 {
     OpcodeHandler const& opHandle = opcodeTable[packet->GetOpcode()];
     // check if packet handler is supposed to be safe
-    if (opHandle.packetProcessing == PROCESS_INPLACE)
+    if (opHandle.packetProcessing == PROCESS_INPLACE || opHandle.packetProcessing == PROCESS_READONLY_ASYNC)
         return true;
 
     // let's check if our opcode can't be processed in Map::Update()
@@ -92,8 +96,11 @@ WorldSession::WorldSession(uint32 id, WorldSocket *sock, AccountTypes sec, uint8
 m_muteTime(mute_time), _player(NULL), m_Socket(sock),_security(sec), _accountId(id), m_expansion(expansion), _logoutTime(0),
 m_inQueue(false), m_playerLoading(false), m_playerLogout(false), m_playerRecentlyLogout(false), m_playerSave(false),
 m_sessionDbcLocale(sWorld.GetAvailableDbcLocale(locale)), m_sessionDbLocaleIndex(sObjectMgr.GetIndexForLocale(locale)),
-m_latency(0), m_tutorialState(TUTORIALDATA_UNCHANGED), m_Warden(NULL)
+m_latency(0), m_tutorialState(TUTORIALDATA_UNCHANGED), m_asyncPackets(0), m_movementQueueCount(0), m_Warden(NULL)
 {
+    for (int i = 0; i < MAX_MOVEMENT_RELAY_TIER; ++i)
+        m_movementRelayTime[i] = 0;
+
     if (sock)
     {
         m_Address = sock->GetRemoteAddress ();
@@ -139,6 +146,117 @@ char const* WorldSession::GetPlayerName() const
 
 /// Send a packet to the client
 void WorldSession::SendPacket(WorldPacket const* packet)
+{
+    // answers of read-only opcodes go from the worker thread to the socket, the player may be logging out
+    if (m_asyncPackets.value() && OpcodeWorkerPool::IsWorkerThread())
+    {
+        // socketless (playerbot) session
+        if (!m_Socket)
+            return;
+
+        if (m_Socket->SendPacket(*packet) == -1)
+            m_Socket->CloseSocket();
+        return;
+    }
+
+    // queued movement of others was generated before this packet, keep the order
+    if (m_movementQueueCount)
+        SendQueuedMovement();
+
+    if (!HandleOutgoingPacket(*packet))
+        return;
+
+    if (m_Socket->SendPacket (*packet) == -1)
+        m_Socket->CloseSocket ();
+}
+
+/// Send a packet broadcasted to many sessions, the payload is shared between their sockets
+void WorldSession::SendPacket(SharedWorldPacket const& packet)
+{
+    if (m_movementQueueCount)
+        SendQueuedMovement();
+
+    if (!HandleOutgoingPacket(packet.GetPacket()))
+        return;
+
+    if (m_Socket->SendPacket (packet) == -1)
+        m_Socket->CloseSocket ();
+}
+
+/// Queue a movement packet of another unit, sent with all movement of the map update by SendQueuedMovement()
+void WorldSession::QueueMovement(WorldPacket const& packet)
+{
+    // bots have nobody to save bandwidth for, size of a queued packet is one byte;
+    // SendPacket sends the packets queued before first
+    if (!m_Socket || packet.size() + 2 > 0xFF)
+    {
+        SendPacket(&packet);
+        return;
+    }
+
+    ACE_Guard<ACE_Thread_Mutex> guard(m_movementQueueLock);
+    m_movementQueue << uint8(packet.size() + 2);
+    m_movementQueue << uint16(packet.GetOpcode());
+    m_movementQueue.append(packet.contents(), packet.size());
+    ++m_movementQueueCount;
+}
+
+void WorldSession::SendQueuedMovement()
+{
+    WorldPacket data;
+    {
+        ACE_Guard<ACE_Thread_Mutex> guard(m_movementQueueLock);
+
+        if (!m_movementQueueCount)
+            return;
+
+        uint32 size = m_movementQueue.wpos();
+
+        if (m_movementQueueCount == 1)
+        {
+            // nothing to coalesce, send the packet as it was
+            data.Initialize(m_movementQueue.read<uint16>(1), size - 3);
+            data.append(m_movementQueue.contents() + 3, size - 3);
+        }
+        else
+        {
+            bool compressed = false;
+
+            if (size >= MOVEMENT_QUEUE_COMPRESS_SIZE)
+            {
+                uLongf destSize = compressBound(size);
+
+                data.Initialize(SMSG_COMPRESSED_MOVES, 4 + destSize);
+                data.resize(4 + destSize);
+                data.put<uint32>(0, size);
+
+                int z_res = compress2(const_cast<uint8*>(data.contents()) + 4, &destSize, m_movementQueue.contents(), size, sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
+                if (z_res == Z_OK)
+                {
+                    data.resize(4 + destSize);
+                    compressed = true;
+                }
+                else
+                    sLog.outError("Can't compress movement packet (zlib: compress2) Error code: %i (%s)", z_res, zError(z_res));
+            }
+
+            if (!compressed)
+            {
+                data.Initialize(SMSG_MULTIPLE_MOVES, 4 + size);
+                data << uint32(size);
+                data.append(m_movementQueue);
+            }
+        }
+
+        m_movementQueue.clear();
+        m_movementQueueCount = 0;
+    }
+
+    SendPacket(&data);
+}
+
+/// Common part of SendPacket, return false if there is no socket to send the packet to
+bool WorldSession::HandleOutgoingPacket(WorldPacket const& packet)
 {
     // Playerbot mod: send packet to bot AI
     if (!sWorld.getConfig(CONFIG_BOOL_PLAYERBOT_DISABLE))
@@ -146,14 +264,14 @@ void WorldSession::SendPacket(WorldPacket const* packet)
         if (GetPlayer() && GetPlayer()->IsInWorld())
         {
             if (GetPlayer()->GetPlayerbotAI())
-                GetPlayer()->GetPlayerbotAI()->HandleBotOutgoingPacket(*packet);
+                GetPlayer()->GetPlayerbotAI()->HandleBotOutgoingPacket(packet);
             else if (GetPlayer()->GetPlayerbotMgr())
-                GetPlayer()->GetPlayerbotMgr()->HandleMasterOutgoingPacket(*packet);
+                GetPlayer()->GetPlayerbotMgr()->HandleMasterOutgoingPacket(packet);
         }
     }
 
     if (!m_Socket)
-        return;
+        return false;
 
     #ifdef MANGOS_DEBUG
 
@@ -172,10 +290,10 @@ void WorldSession::SendPacket(WorldPacket const* packet)
     if((cur_time - lastTime) < 60)
     {
         sendPacketCount+=1;
-        sendPacketBytes+=packet->size();
+        sendPacketBytes+=packet.size();
 
         sendLastPacketCount+=1;
-        sendLastPacketBytes+=packet->size();
+        sendLastPacketBytes+=packet.size();
     }
     else
     {
@@ -186,13 +304,12 @@ void WorldSession::SendPacket(WorldPacket const* packet)
 
         lastTime = cur_time;
         sendLastPacketCount = 1;
-        sendLastPacketBytes = packet->wpos();               // wpos is real written size
+        sendLastPacketBytes = packet.wpos();               // wpos is real written size
     }
 
     #endif                                                  // !MANGOS_DEBUG
 
-    if (m_Socket->SendPacket (*packet) == -1)
-        m_Socket->CloseSocket ();
+    return true;
 }
 
 /// Add an incoming packet to the queue
@@ -201,6 +318,28 @@ void WorldSession::QueuePacket(WorldPacket* new_packet)
     _recvQueue.add(new_packet);
 }
 
+/// Execute a PROCESS_READONLY_ASYNC packet in a worker thread of OpcodeWorkerPool
+void WorldSession::ExecuteAsyncOpcode(WorldPacket* packet)
+{
+    OpcodeHandler const& opHandle = opcodeTable[packet->GetOpcode()];
+    try
+    {
+        (this->*opHandle.handler)(*packet);
+
+        if (packet->rpos() < packet->wpos() && sLog.HasLogLevelOrHigher(LOG_LVL_DEBUG))
+            LogUnprocessedTail(packet);
+    }
+    catch (ByteBufferException &)
+    {
+        // no kick from here, the client only gets no answer
+        sLog.outError("WorldSession::ExecuteAsyncOpcode ByteBufferException occured while parsing a packet (opcode: %u) from client %s, accountid=%i.",
+            packet->GetOpcode(), GetRemoteAddress().c_str(), GetAccountId());
+    }
+
+    delete packet;
+    --m_asyncPackets;
+}
+
 /// Logging helper for unexpected opcodes
 void WorldSession::LogUnexpectedOpcode(WorldPacket* packet, const char *reason)
 {
@@ -359,8 +498,8 @@ bool WorldSession::Update(PacketFilter& updater)
     if (m_Socket && !m_Socket->IsClosed() && m_Warden && GetPlayer() && !GetPlayer()->GetPlayerbotAI())
         m_Warden->Update();
 
-    ///- Cleanup socket pointer if need
-    if (m_Socket && m_Socket->IsClosed())
+    ///- Cleanup socket pointer if need, not while workers may still send to it
+    if (m_Socket && m_Socket->IsClosed() && !m_asyncPackets.value())
     {
         m_Socket->RemoveReference();
         m_Socket = NULL;
@@ -531,6 +670,9 @@ void WorldSession::LogoutPlayer(bool Save)
         if(Save)
             GetPlayer()->SaveToDB();
 
+        // the list is read again after the save, both go by the async connection
+        sWorld.InvalidateCharEnum(GetAccountId());
+
         ///- Leave all channels before player delete...
         GetPlayer()->CleanupChannels();
 
@@ -1058,6 +1200,21 @@ void WorldSession::SendRedirectClient(std::string& ip, uint16 port)
 
 void WorldSession::ExecuteOpcode( OpcodeHandler const& opHandle, WorldPacket* packet )
 {
+    // socketless (playerbot) sessions get their answers through HandleOutgoingPacket, in this thread
+    if (opHandle.packetProcessing == PROCESS_READONLY_ASYNC && m_Socket)
+    {
+        // the pool gets a copy, the caller still reads the packet (playerbot master packets)
+        ++m_asyncPackets;
+        if (sOpcodeWorkerPool.Enqueue(this, new WorldPacket(*packet)))
+        {
+            packet->rpos(packet->wpos());
+            return;
+        }
+        --m_asyncPackets;
+    }
+
+    PROFILE_SCOPE_ARG(PROFILE_OPCODES, packet->GetOpcode());
+
     // need prevent do internal far teleports in handlers because some handlers do lot steps
     // or call code that can do far teleports in some conditions unexpectedly for generic way work code
     if (_player)
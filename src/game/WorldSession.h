@@ -33,6 +33,8 @@
 #include "Item.h"
 #include "warden/WardenBase.h"
 
+#include <ace/Atomic_Op.h>
+
 struct ItemPrototype;
 struct AuctionEntry;
 struct AuctionHouseEntry;
@@ -45,6 +47,7 @@ class Object;
 class Player;
 class Unit;
 class WorldPacket;
+class SharedWorldPacket;
 class WorldSocket;
 class QueryResult;
 class LoginQueryHolder;
@@ -72,6 +75,18 @@ enum AccountDataType
 #define GLOBAL_CACHE_MASK           0x15
 #define PER_CHARACTER_CACHE_MASK    0xEA
 
+// Distance of an observer to a moving player, farther observers get less heartbeats
+enum MovementRelayTier
+{
+    MOVEMENT_RELAY_NEAR             = 0,                    // closer than Visibility.MovementRelay.NearDistance, all packets
+    MOVEMENT_RELAY_MID              = 1,                    // heartbeats once per Visibility.MovementRelay.MidInterval
+    MOVEMENT_RELAY_FAR              = 2,                    // beyond Visibility.MovementRelay.FarDistance, heartbeats once per FarInterval
+    MAX_MOVEMENT_RELAY_TIER         = 3
+};
+
+// queued movement bigger than this is sent as SMSG_COMPRESSED_MOVES, smaller as SMSG_MULTIPLE_MOVES
+#define MOVEMENT_QUEUE_COMPRESS_SIZE    512
+
 struct AccountData
 {
     AccountData() : Time(0), Data("") {}
@@ -208,6 +223,11 @@ class MANGOS_DLL_SPEC WorldSession
         void SendAddonsInfo();
 
         void SendPacket(WorldPacket const* packet);
+        void SendPacket(SharedWorldPacket const& packet);
+
+        /// Movement of other units is collected and sent once per map update
+        void QueueMovement(WorldPacket const& packet);
+        void SendQueuedMovement();
         void SendNotification(const char *format,...) ATTR_PRINTF(2,3);
         void SendNotification(int32 string_id,...);
         void SendPetNameInvalid(uint32 error, const std::string& name, DeclinedName *declinedName);
@@ -255,6 +275,10 @@ class MANGOS_DLL_SPEC WorldSession
 
         bool Update(PacketFilter& updater);
 
+        // called by OpcodeWorkerPool for PROCESS_READONLY_ASYNC packets, takes ownership of the packet
+        void ExecuteAsyncOpcode(WorldPacket* packet);
+        bool HasAsyncPackets() const { return m_asyncPackets.value() != 0; }
+
         /// Handle the authentication waiting queue (to be completed)
         void SendAuthWaitQue(uint32 position);
 
@@ -384,7 +408,7 @@ class MANGOS_DLL_SPEC WorldSession
         void HandleCharDeleteOpcode(WorldPacket& recvPacket);
         void HandleCharCreateOpcode(WorldPacket& recvPacket);
         void HandlePlayerLoginOpcode(WorldPacket& recvPacket);
-        void HandleCharEnum(QueryResult * result);
+        void HandleCharEnum(QueryResult * result, uint32 cacheVersion);
         void HandlePlayerLogin(LoginQueryHolder * holder);
 
         // played time
@@ -887,9 +911,12 @@ class MANGOS_DLL_SPEC WorldSession
         void moveItems(Item* myItems[], Item* hisItems[]);
         bool VerifyMovementInfo(MovementInfo const& movementInfo, ObjectGuid const& guid) const;
         void HandleMoverRelocation(MovementInfo& movementInfo);
+        void RelayMovement(Unit* mover, WorldPacket const& data);
 
         void ExecuteOpcode( OpcodeHandler const& opHandle, WorldPacket* packet );
 
+        bool HandleOutgoingPacket(WorldPacket const& packet);
+
         // logging helper
         void LogUnexpectedOpcode(WorldPacket *packet, const char * reason);
         void LogUnprocessedTail(WorldPacket *packet);
@@ -918,6 +945,14 @@ class MANGOS_DLL_SPEC WorldSession
         AddonsList m_addonsList;
         ACE_Based::LockedQueue<WorldPacket*, ACE_Thread_Mutex> _recvQueue;
 
+        // packets executed by OpcodeWorkerPool, session and socket are kept until they are done
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_asyncPackets;
+
+        ACE_Thread_Mutex m_movementQueueLock;               // guards the movement queue, flushed by any sender
+        ByteBuffer m_movementQueue;                         // size, opcode and payload of every queued movement packet
+        uint32 m_movementQueueCount;
+        uint32 m_movementRelayTime[MAX_MOVEMENT_RELAY_TIER];// last heartbeat of our mover sent to the tier
+
         // Warden
         WardenBase *m_Warden;
 };
@@ -23,7 +23,9 @@
 #include <ace/os_include/netinet/os_tcp.h>
 #include <ace/os_include/sys/os_types.h>
 #include <ace/os_include/sys/os_socket.h>
+#include <ace/os_include/sys/os_uio.h>
 #include <ace/OS_NS_string.h>
+#include <ace/OS_NS_sys_socket.h>
 #include <ace/Reactor.h>
 #include <ace/Auto_Ptr.h>
 
@@ -33,6 +35,7 @@
 #include "Util.h"
 #include "World.h"
 #include "WorldPacket.h"
+#include "SharedWorldPacket.h"
 #include "SharedDefines.h"
 #include "ByteBuffer.h"
 #include "Opcodes.h"
@@ -203,6 +206,49 @@ int WorldSocket::SendPacket(const WorldPacket& pct)
     return 0;
 }
 
+int WorldSocket::SendPacket(const SharedWorldPacket& pct)
+{
+    // Small payloads are cheaper to copy into the output buffer.
+    if (!pct.IsShareable())
+        return SendPacket(pct.GetPacket());
+
+    ACE_GUARD_RETURN(LockType, Guard, m_OutBufferLock, -1);
+
+    if (closing_)
+        return -1;
+
+    // Dump outgoing packet.
+    sLog.outWorldPacketDump(uint32(get_handle()), pct.GetOpcode(), LookupOpcodeName(pct.GetOpcode()), &pct.GetPacket(), false);
+
+    ServerPktHeader header(pct.size()+2, pct.GetOpcode());
+    m_Crypt.EncryptSend((uint8*)header.header, header.getHeaderLength());
+
+    // Only the header is private to this socket, the payload block is shared between all recipients.
+    ACE_Message_Block* mb;
+
+    ACE_NEW_RETURN(mb, ACE_Message_Block(header.getHeaderLength()), -1);
+
+    mb->copy((char*)header.header, header.getHeaderLength());
+
+    ACE_Message_Block* payload = pct.DuplicatePayload();
+    if (!payload)
+    {
+        mb->release();
+        return -1;
+    }
+
+    mb->cont(payload);
+
+    if (msg_queue()->enqueue_tail(mb, (ACE_Time_Value*)&ACE_Time_Value::zero) == -1)
+    {
+        sLog.outError("WorldSocket::SendPacket enqueue_tail");
+        mb->release();
+        return -1;
+    }
+
+    return 0;
+}
+
 long WorldSocket::AddReference(void)
 {
     return static_cast<long>(add_reference());
@@ -377,13 +423,20 @@ int WorldSocket::handle_output_queue(GuardType& g)
         return -1;
     }
 
-    const size_t send_len = mblk->length();
+    const size_t send_len = mblk->total_length();
+
+    ssize_t n;
 
+    if (mblk->cont())
+        n = send_chain(mblk);
+    else
+    {
 #ifdef MSG_NOSIGNAL
-    ssize_t n = peer().send (mblk->rd_ptr(), send_len, MSG_NOSIGNAL);
+        n = peer().send (mblk->rd_ptr(), send_len, MSG_NOSIGNAL);
 #else
-    ssize_t n = peer().send (mblk->rd_ptr(), send_len);
+        n = peer().send (mblk->rd_ptr(), send_len);
 #endif // MSG_NOSIGNAL
+    }
 
     if (n == 0)
     {
@@ -404,7 +457,14 @@ int WorldSocket::handle_output_queue(GuardType& g)
     }
     else if (n < (ssize_t)send_len) //now n > 0
     {
-        mblk->rd_ptr (static_cast<size_t> (n));
+        // skip the sent part, it can span over several blocks of a chain
+        size_t sent = static_cast<size_t> (n);
+        for (ACE_Message_Block* mb = mblk; mb && sent > 0; mb = mb->cont())
+        {
+            const size_t len = std::min(sent, mb->length());
+            mb->rd_ptr (len);
+            sent -= len;
+        }
 
         if (msg_queue()->enqueue_head(mblk, (ACE_Time_Value*)&ACE_Time_Value::zero) == -1)
         {
@@ -425,6 +485,36 @@ int WorldSocket::handle_output_queue(GuardType& g)
     ACE_NOTREACHED(return -1);
 }
 
+ssize_t WorldSocket::send_chain(ACE_Message_Block* mblk)
+{
+    // header + shared payload, a few spare entries don't hurt
+    const int MAX_CHAIN_BLOCKS = 4;
+
+    iovec iov[MAX_CHAIN_BLOCKS];
+    int iovcnt = 0;
+
+    for (ACE_Message_Block* mb = mblk; mb && iovcnt < MAX_CHAIN_BLOCKS; mb = mb->cont())
+    {
+        if (mb->length() == 0)
+            continue;
+
+        iov[iovcnt].iov_base = mb->rd_ptr();
+        iov[iovcnt].iov_len = mb->length();
+        ++iovcnt;
+    }
+
+#ifdef MSG_NOSIGNAL
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+
+    return ACE_OS::sendmsg(get_handle(), &msg, MSG_NOSIGNAL);
+#else
+    return peer().sendv(iov, iovcnt);
+#endif // MSG_NOSIGNAL
+}
+
 int WorldSocket::handle_close(ACE_HANDLE h, ACE_Reactor_Mask)
 {
     // Critical section
@@ -488,7 +578,8 @@ int WorldSocket::handle_input_header(void)
 
     header.size -= 4;
 
-    ACE_NEW_RETURN(m_RecvWPct, WorldPacket((uint16) header.cmd, header.size), -1);
+    // pooled packets have no nothrow operator new, so no ACE_NEW_RETURN here
+    m_RecvWPct = new WorldPacket((uint16) header.cmd, header.size);
 
     if (header.size > 0)
     {
@@ -46,6 +46,7 @@
 
 class ACE_Message_Block;
 class WorldPacket;
+class SharedWorldPacket;
 class WorldSession;
 
 /// Handler that can communicate over stream sockets.
@@ -61,7 +62,9 @@ typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> WorldHandler;
  *
  * For output the class uses one buffer (64K usually) and
  * a queue where it stores packet if there is no place on
- * the queue. The reason this is done, is because the server
+ * the queue. Broadcasted packets (SharedWorldPacket) with a big
+ * payload are queued as a chain of a private header block and a
+ * reference to the shared payload, such chains are sent with writev. The reason this is done, is because the server
  * does really a lot of small-size writes to it, and it doesn't
  * scale well to allocate memory for every. When something is
  * written to the output buffer the socket is not immediately
@@ -116,6 +119,12 @@ class WorldSocket : protected WorldHandler
         /// @return -1 of failure
         int SendPacket (const WorldPacket& pct);
 
+        /// Send a packet that is broadcasted to many sockets, this function is reentrant.
+        /// Large payloads are not copied, only the header is queued with a reference to the shared body.
+        /// @param pct shared packet to send
+        /// @return -1 of failure
+        int SendPacket (const SharedWorldPacket& pct);
+
         /// Add reference to this object.
         long AddReference (void);
 
@@ -163,6 +172,9 @@ class WorldSocket : protected WorldHandler
         /// Drain the queue if its not empty.
         int handle_output_queue (GuardType& g);
 
+        /// Send a queued message block chain (header + shared payload) with one writev call.
+        ssize_t send_chain (ACE_Message_Block* mblk);
+
         /// process one incoming packet.
         /// @param new_pct received packet ,note that you need to delete it.
         int ProcessIncoming (WorldPacket* new_pct);
@@ -311,6 +311,19 @@ void WorldSocketMgr::Wait()
     }
 }
 
+long WorldSocketMgr::GetConnectionCount() const
+{
+    // network is started after the world thread
+    if (!m_NetThreads)
+        return 0;
+
+    long count = 0;
+    for (size_t i = 0; i < m_NetThreadsCount; ++i)
+        count += m_NetThreads[i].Connections();
+
+    return count;
+}
+
 int WorldSocketMgr::OnSocketOpen(WorldSocket* sock)
 {
     // set some options here
@@ -54,6 +54,9 @@ class WorldSocketMgr
         std::string& GetBindAddress() { return m_addr; }
         ACE_UINT16 GetBindPort() { return m_port; }
 
+        /// Open sockets of all network threads .
+        long GetConnectionCount() const;
+
         /// Make this class singleton .
         static WorldSocketMgr* Instance();
 
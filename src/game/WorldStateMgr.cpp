@@ -27,6 +27,7 @@
 #include "BattleGround/BattleGroundMgr.h"
 #include "GridNotifiers.h"
 #include "CellImpl.h"
+#include "Metrics/Metrics.h"
 
 INSTANTIATE_SINGLETON_1(WorldStateMgr);
 
@@ -67,9 +68,9 @@ void WorldStateMgr::Update()
                         if (bl && bl->HolidayWorldStateId == state->GetId())
                         {
                             if (BattleGroundMgr::IsBGWeekend(BattleGroundTypeId(bl->id)))
-                                state->SetValue(WORLD_STATE_ADD);
+                                SetStateValue(state, WORLD_STATE_ADD);
                             else
-                                state->SetValue(WORLD_STATE_REMOVE);
+                                SetStateValue(state, WORLD_STATE_REMOVE);
                         }
                     }
                     break;
@@ -96,6 +97,7 @@ void WorldStateMgr::Update()
                 if (state->HasFlag(WORLD_STATE_FLAG_INITIAL_STATE))
                 {
                     state->Initialize();
+                    LogChange(state);
                     continue;
                 }
 
@@ -111,6 +113,10 @@ void WorldStateMgr::Update()
     {
         // Update part 2 - remove states with WORLD_STATE_FLAG_DELETED flag
         WriteGuard guard(GetLock());
+
+        // log entries must not point to removed states
+        PruneChangeLogs();
+
         for (WorldStateMap::iterator itr = m_worldState.begin(); itr != m_worldState.end();)
         {
             if (itr->second.HasFlag(WORLD_STATE_FLAG_DELETED))
@@ -422,7 +428,7 @@ void WorldStateMgr::LoadFromDB()
             if (WorldState const* state  = GetWorldState(tmpl, instanceId))
             {
                 if (state->GetValue() != _value)
-                    const_cast<WorldState*>(state)->SetValue(_value);
+                    SetStateValue(const_cast<WorldState*>(state), _value);
             }
             else
                 m_worldState.insert(WorldStateMap::value_type(stateId, WorldState(tmpl, instanceId, flags, _value, renewtime)));
@@ -769,32 +775,173 @@ WorldStateSet WorldStateMgr::GetWorldStatesFor(Player* player, uint32 flags)
     return statesSet;
 };
 
-WorldStateSet WorldStateMgr::GetUpdatedWorldStatesFor(Player* player, time_t updateTime)
+WorldStateSet WorldStateMgr::GetUpdatedWorldStatesFor(Player* player, uint32& version)
 {
+    static MetricCounter* refreshes = sMetrics.GetCounter("mangos_worldstate_refreshes_total", "Updated world state lookups of players", "kind=\"log\"");
+    static MetricCounter* fullRefreshes = sMetrics.GetCounter("mangos_worldstate_refreshes_total", "Updated world state lookups of players", "kind=\"full\"");
+    static MetricCounter* checks = sMetrics.GetCounter("mangos_worldstate_refresh_checks_total", "World states checked against player conditions in updated state lookups");
+
     WorldStateSet statesSet;
     statesSet.clear();
 
     ReadGuard guard(GetLock());
-    for (WorldStateMap::iterator itr = m_worldState.begin(); itr != m_worldState.end(); ++itr)
+
+    WorldStateSet changed;
+    uint32 lastVersion = version;
+    bool full;
     {
-            if (itr->second.HasFlag(WORLD_STATE_FLAG_ACTIVE) && 
-                itr->second.GetRenewTime() >= updateTime &&
-                itr->second.GetRenewTime() != time(NULL) &&
-                IsFitToCondition(player, &itr->second))
-                {
-                    // Always send UpLinked worldstate with own chains
-                    // Attention! possible need sent ALL linked chain in this case. need tests.
-                    if (itr->second.GetTemplate() && itr->second.GetTemplate()->m_linkedId)
-                        if (WorldStateTemplate const* tmpl = FindTemplate(itr->second.GetTemplate()->m_linkedId, itr->second.GetType(), itr->second.GetCondition()))
-                            if (WorldState const* state = GetWorldState(tmpl, itr->second.GetInstance()))
-                                statesSet.push_back(state);
+        ACE_Guard<ACE_Thread_Mutex> logGuard(m_changeLock);
 
-                    statesSet.push_back(&itr->second);
+        // new players and players with changes not in the logs anymore check all states
+        full = !lastVersion || lastVersion < m_prunedVersion;
+        version = m_version;
+
+        if (!full && lastVersion < m_version)
+        {
+            WorldStateScope scopes[] =
+            {
+                WorldStateScope(WORLD_STATE_SCOPE_GLOBAL),
+                WorldStateScope(WORLD_STATE_SCOPE_OTHER),
+                WorldStateScope(WORLD_STATE_SCOPE_MAP, player->GetMapId(), player->GetInstanceId()),
+                WorldStateScope(WORLD_STATE_SCOPE_ZONE, player->GetZoneId(), player->GetInstanceId()),
+                WorldStateScope(WORLD_STATE_SCOPE_ZONE_ALL_INSTANCES, player->GetZoneId()),
+                WorldStateScope(WORLD_STATE_SCOPE_AREA, player->GetAreaId(), player->GetInstanceId()),
+            };
+
+            for (uint32 i = 0; i < sizeof(scopes) / sizeof(scopes[0]); ++i)
+            {
+                WorldStateChangeLogMap::const_iterator log = m_changeLogs.find(scopes[i]);
+                if (log == m_changeLogs.end())
+                    continue;
+
+                // newest changes are at the end
+                WorldStateChangeLog::const_reverse_iterator itr = log->second.rbegin();
+                for (; itr != log->second.rend() && itr->version > lastVersion; ++itr)
+                {
+                    // state changed again later, newer entry is used
+                    if (itr->version == itr->state->GetVersion())
+                        changed.push_back(itr->state);
                 }
+            }
+        }
     }
+
+    if (full)
+    {
+        fullRefreshes->Inc();
+        checks->Inc(m_worldState.size());
+
+        for (WorldStateMap::iterator itr = m_worldState.begin(); itr != m_worldState.end(); ++itr)
+        {
+            if (itr->second.HasFlag(WORLD_STATE_FLAG_ACTIVE) &&
+                (!lastVersion || itr->second.GetVersion() > lastVersion) &&
+                IsFitToCondition(player, &itr->second))
+                AddUpdatedState(statesSet, &itr->second);
+        }
+    }
+    else
+    {
+        refreshes->Inc();
+        checks->Inc(changed.size());
+
+        for (WorldStateSet::const_iterator itr = changed.begin(); itr != changed.end(); ++itr)
+        {
+            if ((*itr)->HasFlag(WORLD_STATE_FLAG_ACTIVE) && IsFitToCondition(player, *itr))
+                AddUpdatedState(statesSet, *itr);
+        }
+    }
+
     return statesSet;
 };
 
+void WorldStateMgr::AddUpdatedState(WorldStateSet& statesSet, WorldState const* state)
+{
+    // Always send UpLinked worldstate with own chains
+    // Attention! possible need sent ALL linked chain in this case. need tests.
+    if (state->GetTemplate() && state->GetTemplate()->m_linkedId)
+        if (WorldStateTemplate const* tmpl = FindTemplate(state->GetTemplate()->m_linkedId, state->GetType(), state->GetCondition()))
+            if (WorldState const* upLink = GetWorldState(tmpl, state->GetInstance()))
+                statesSet.push_back(upLink);
+
+    statesSet.push_back(state);
+}
+
+void WorldStateMgr::SetStateValue(WorldState* state, uint32 value)
+{
+    state->SetValue(value);
+    LogChange(state);
+}
+
+void WorldStateMgr::LogChange(WorldState* state)
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(m_changeLock);
+
+    state->SetVersion(++m_version);
+    m_changeLogs[GetScope(state)].push_back(WorldStateChange(m_version, state, time(NULL)));
+}
+
+void WorldStateMgr::PruneChangeLogs()
+{
+    // called with write lock, no state is changed meantime
+    ACE_Guard<ACE_Thread_Mutex> guard(m_changeLock);
+
+    time_t expireTime = time(NULL) - WORLD_STATE_CHANGE_LOG_TIME;
+
+    for (WorldStateChangeLogMap::iterator log = m_changeLogs.begin(); log != m_changeLogs.end();)
+    {
+        WorldStateChangeLog& changes = log->second;
+
+        while (!changes.empty() && changes.front().time < expireTime)
+        {
+            m_prunedVersion = std::max(m_prunedVersion, changes.front().version);
+            changes.pop_front();
+        }
+
+        // outdated entries and deleted states are never sent, so removing them loses nothing
+        WorldStateChangeLog::iterator last = changes.begin();
+        for (WorldStateChangeLog::iterator itr = changes.begin(); itr != changes.end(); ++itr)
+        {
+            if (itr->version == itr->state->GetVersion() && !itr->state->HasFlag(WORLD_STATE_FLAG_DELETED))
+                *last++ = *itr;
+        }
+        changes.erase(last, changes.end());
+
+        if (changes.empty())
+            m_changeLogs.erase(log++);
+        else
+            ++log;
+    }
+}
+
+WorldStateScope WorldStateMgr::GetScope(WorldState const* state)
+{
+    switch (state->GetType())
+    {
+        case WORLD_STATE_TYPE_WORLD:
+        case WORLD_STATE_TYPE_EVENT:
+        case WORLD_STATE_TYPE_BGWEEKEND:
+            return WorldStateScope(WORLD_STATE_SCOPE_GLOBAL);
+        case WORLD_STATE_TYPE_MAP:
+        case WORLD_STATE_TYPE_BATTLEGROUND:
+            return WorldStateScope(WORLD_STATE_SCOPE_MAP, state->GetCondition(), state->GetInstance());
+        case WORLD_STATE_TYPE_ZONE:
+            return WorldStateScope(WORLD_STATE_SCOPE_ZONE, state->GetCondition(), state->GetInstance());
+        case WORLD_STATE_TYPE_AREA:
+            return WorldStateScope(WORLD_STATE_SCOPE_AREA, state->GetCondition(), state->GetInstance());
+        case WORLD_STATE_TYPE_DESTRUCTIBLE_OBJECT:
+            return WorldStateScope(WORLD_STATE_SCOPE_ZONE_ALL_INSTANCES, state->GetCondition());
+        case WORLD_STATE_TYPE_CUSTOM:
+            if (!state->GetCondition())
+                return WorldStateScope(WORLD_STATE_SCOPE_GLOBAL);
+            break;
+        default:
+            break;
+    }
+
+    // condition is a GO entry or may be any of map, zone and area
+    return WorldStateScope(WORLD_STATE_SCOPE_OTHER);
+}
+
 bool WorldStateMgr::IsFitToCondition(Player* player, WorldState const* state)
 {
     if (!player || !state)
@@ -1068,7 +1215,7 @@ void WorldStateMgr::SetWorldStateValueFor(Player* player, uint32 stateId, uint32
             if (IsFitToCondition(player, &itr->second))
             {
                 if ((&itr->second)->GetValue() != value)
-                    const_cast<WorldState*>(&itr->second)->SetValue(value);
+                    SetStateValue(const_cast<WorldState*>(&itr->second), value);
                 return;
             }
         }
@@ -1090,7 +1237,7 @@ void WorldStateMgr::SetWorldStateValueFor(Map* map, uint32 stateId, uint32 value
             if (IsFitToCondition(map, &itr->second))
             {
                 if ((&itr->second)->GetValue() != value)
-                    const_cast<WorldState*>(&itr->second)->SetValue(value);
+                    SetStateValue(const_cast<WorldState*>(&itr->second), value);
                 return;
             }
         }
@@ -1114,7 +1261,7 @@ void WorldStateMgr::SetWorldStateValueFor(uint32 zoneId, uint32 stateId, uint32
             if (IsFitToCondition(mapId, 0, zoneId, 0, &itr->second))
             {
                 if ((&itr->second)->GetValue() != value)
-                    const_cast<WorldState*>(&itr->second)->SetValue(value);
+                    SetStateValue(const_cast<WorldState*>(&itr->second), value);
                 return;
             }
         }
@@ -1157,7 +1304,7 @@ void WorldStateMgr::SetWorldStateValueFor(WorldObject* object, uint32 stateId, u
             if (IsFitToCondition(object->GetMap()->GetId(), object->GetObjectGuid().GetCounter(), 0, 0, _state))
             {
                 if (_state->GetValue() != value)
-                    const_cast<WorldState*>(_state)->SetValue(value);
+                    SetStateValue(const_cast<WorldState*>(_state), value);
 
                 DEBUG_LOG("WorldStateMgr::SetWorldStateValueFor tru set state %u instance %u, type %u  value %u (%u)  for %s",
                     _state->GetId(), _state->GetInstance(),
@@ -1198,7 +1345,7 @@ WorldState const* WorldStateMgr::CreateWorldState(WorldStateTemplate const* tmpl
     {
         DEBUG_LOG("WorldStateMgr::CreateWorldState tru create  state %u  instance %u type %u (value %u) but state exists (value %u).",
             tmpl->m_stateId, instanceId, tmpl->m_stateType, value, _state->GetValue());
-        const_cast<WorldState*>(_state)->SetValue(value);
+        SetStateValue(const_cast<WorldState*>(_state), value);
         return _state;
     }
 
@@ -1217,6 +1364,8 @@ WorldState const* WorldStateMgr::CreateWorldState(WorldStateTemplate const* tmpl
     if (!tmpl->HasFlag(WORLD_STATE_FLAG_PASSIVE_AT_CREATE))
         _state->AddFlag(WORLD_STATE_FLAG_ACTIVE);
 
+    LogChange(_state);
+
     DEBUG_LOG("WorldStateMgr::CreateWorldState state %u instance %u created, type %u (%u) flags %u (%u) value %u (%u, %u)",
         _state->GetId(), _state->GetInstance(),
         _state->GetType(), tmpl->m_stateType,
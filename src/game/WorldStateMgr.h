@@ -23,6 +23,8 @@
 #include "Common.h"
 #include "World.h"
 
+#include <deque>
+
 class Player;
 
 enum WorldStatesLimits
@@ -148,14 +150,14 @@ struct WorldState
     public:
     // For create new state
     WorldState(WorldStateTemplate const* _state, uint32 _instance) 
-        : m_pState(_state), m_stateId(m_pState->m_stateId), m_instanceId(_instance), m_type(m_pState->m_stateType)
+        : m_pState(_state), m_stateId(m_pState->m_stateId), m_instanceId(_instance), m_type(m_pState->m_stateType), m_version(0)
     {
         Initialize();
     }
 
     // For load
     WorldState(WorldStateTemplate const* _state, uint32 _instance, uint32 _flags, uint32 _value, time_t _renewtime) 
-        : m_pState(_state), m_stateId(m_pState->m_stateId), m_instanceId(_instance), m_type(m_pState->m_stateType), m_flags(_flags), m_value(_value), m_renewTime(_renewtime)
+        : m_pState(_state), m_stateId(m_pState->m_stateId), m_instanceId(_instance), m_type(m_pState->m_stateType), m_flags(_flags), m_value(_value), m_renewTime(_renewtime), m_version(0)
     {
         m_linkedGuid.Clear();
         m_clientGuids.clear();
@@ -164,14 +166,14 @@ struct WorldState
 
     // For load custom state
     WorldState(uint32 _stateid, uint32 _instance, uint32 _flags, uint32 _value, time_t _renewtime) 
-        : m_pState(NULL), m_stateId(_stateid), m_instanceId(_instance), m_type(WORLD_STATE_TYPE_CUSTOM), m_flags(_flags), m_value(_value), m_renewTime(_renewtime)
+        : m_pState(NULL), m_stateId(_stateid), m_instanceId(_instance), m_type(WORLD_STATE_TYPE_CUSTOM), m_flags(_flags), m_value(_value), m_renewTime(_renewtime), m_version(0)
     {
         Initialize();
     }
 
     // For create new custom state
     WorldState(uint32 _stateid, uint32 _instance, uint32 value) 
-        : m_pState(NULL), m_stateId(_stateid), m_instanceId(_instance), m_type(WORLD_STATE_TYPE_CUSTOM), m_value(value)
+        : m_pState(NULL), m_stateId(_stateid), m_instanceId(_instance), m_type(WORLD_STATE_TYPE_CUSTOM), m_value(value), m_version(0)
     {
         Initialize();
     }
@@ -259,6 +261,10 @@ struct WorldState
     time_t const& GetRenewTime() const { return m_renewTime; }
     uint32 const& GetPhaseMask() const { return m_phasemask; }
 
+    // version of the last logged change, set by WorldStateMgr
+    uint32        GetVersion()   const { return m_version; }
+    void          SetVersion(uint32 version) { m_version = version; }
+
     uint32 const& GetValue()     const { return m_value; }
     void          SetValue(uint32 value)
     {
@@ -286,17 +292,63 @@ struct WorldState
     ObjectGuid                         m_linkedGuid;    // Guid of GO/creature/etc, which linked to WorldState (CapturePoint mostly)
     GuidSet                            m_clientGuids;   // List of player Guids, wich already received this WorldState update
     uint32                             m_phasemask;     // Phase mask for this state
+    uint32                             m_version;       // version of last change in the change log (0 - not logged)
 };
 
 typedef std::multimap<uint32 /* state id */, WorldState>   WorldStateMap;
 typedef std::pair<WorldStateMap::const_iterator,WorldStateMap::const_iterator> WorldStateBounds;
 typedef std::vector<WorldState const*> WorldStateSet;
 
+// Part of the world a state is seen in, changes are logged per scope
+enum WorldStateScopeType
+{
+    WORLD_STATE_SCOPE_GLOBAL,                   // world, event and BG weekend states, custom states without condition
+    WORLD_STATE_SCOPE_MAP,                      // map and battleground states of one instance
+    WORLD_STATE_SCOPE_ZONE,                     // zone states of one instance
+    WORLD_STATE_SCOPE_ZONE_ALL_INSTANCES,       // destructible object states
+    WORLD_STATE_SCOPE_AREA,                     // area states of one instance
+    WORLD_STATE_SCOPE_OTHER,                    // capture point and conditional custom states, checked for every player
+};
+
+struct WorldStateScope
+{
+    WorldStateScope(WorldStateScopeType _type, uint32 _condition = 0, uint32 _instance = 0)
+        : type(_type), condition(_condition), instance(_instance) {}
+
+    bool operator<(WorldStateScope const& scope) const
+    {
+        if (type != scope.type)
+            return type < scope.type;
+        if (condition != scope.condition)
+            return condition < scope.condition;
+        return instance < scope.instance;
+    }
+
+    WorldStateScopeType type;
+    uint32 condition;                           // map, zone or area id
+    uint32 instance;
+};
+
+struct WorldStateChange
+{
+    WorldStateChange(uint32 _version, WorldState const* _state, time_t _time)
+        : version(_version), state(_state), time(_time) {}
+
+    uint32 version;
+    WorldState const* state;                    // entry is outdated if the state has a newer version
+    time_t time;
+};
+
+typedef std::deque<WorldStateChange> WorldStateChangeLog;               // ordered by version
+typedef std::map<WorldStateScope, WorldStateChangeLog> WorldStateChangeLogMap;
+
+#define WORLD_STATE_CHANGE_LOG_TIME     60      // seconds changes are kept, older versions get the full state list
+
 // class MANGOS_DLL_DECL WorldStateMgr : public MaNGOS::Singleton<WorldStateMgr, MaNGOS::ClassLevelLockable<WorldStateMgr, ACE_Thread_Mutex> >
 class MANGOS_DLL_DECL WorldStateMgr
 {
     public:
-        WorldStateMgr() {}
+        WorldStateMgr() : m_version(1), m_prunedVersion(0) {}    // version 0 means nothing sent yet
 
     public:
         void Initialize();
@@ -354,7 +406,8 @@ class MANGOS_DLL_DECL WorldStateMgr
         WorldStateSet GetWorldStatesFor(Player* player, WorldStateFlags flag) { return GetWorldStatesFor(player, (1 << flag)); };
         WorldStateSet GetWorldStatesFor(Player* player, uint32 flags = UINT32_MAX);
 
-        WorldStateSet GetUpdatedWorldStatesFor(Player* player, time_t lastUpdateTime = 0);
+        // states changed after version (0 - all states) the player can see, version is set to the current one
+        WorldStateSet GetUpdatedWorldStatesFor(Player* player, uint32& version);
 
         WorldStateSet GetInstanceStates(Map* map, uint32 flags = 0, bool full = false);
         WorldStateSet GetInstanceStates(uint32 mapId, uint32 instanceId, uint32 flags = 0, bool full = false);
@@ -382,9 +435,21 @@ class MANGOS_DLL_DECL WorldStateMgr
         typedef   ACE_Write_Guard<LockType>    WriteGuard;
         LockType& GetLock() { return i_lock; }
 
+        // change log operations
+        void SetStateValue(WorldState* state, uint32 value);
+        void LogChange(WorldState* state);
+        void PruneChangeLogs();
+        static WorldStateScope GetScope(WorldState const* state);
+        void AddUpdatedState(WorldStateSet& statesSet, WorldState const* state);
+
         WorldStateTemplateMap   m_worldStateTemplates;    // templates storage
         WorldStateMap           m_worldState;             // data storage
         LockType                i_lock;
+
+        ACE_Thread_Mutex        m_changeLock;             // guards all below, taken after i_lock
+        uint32                  m_version;                // version of the last change
+        uint32                  m_prunedVersion;          // last version removed from the logs
+        WorldStateChangeLogMap  m_changeLogs;
 };
 
 #define sWorldStateMgr MaNGOS::Singleton<WorldStateMgr>::Instance()
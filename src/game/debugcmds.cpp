@@ -31,6 +31,7 @@
 #include "ObjectMgr.h"
 #include "ObjectGuid.h"
 #include "SpellMgr.h"
+#include "MapManager.h"
 
 bool ChatHandler::HandleDebugSendSpellFailCommand(char* args)
 {
@@ -344,6 +345,71 @@ bool ChatHandler::HandleDebugGetLootRecipientCommand(char* /*args*/)
     return true;
 }
 
+bool ChatHandler::HandleDebugLockStatsCommand(char* args)
+{
+    if (*args)
+    {
+        bool value;
+        if (ExtractLiteralArg(&args, "reset"))
+        {
+            ObjectLockStats::Reset();
+            SendSysMessage("Lock statistics reset.");
+            return true;
+        }
+        else if (ExtractOnOff(&args, value))
+        {
+            ObjectLockStats::SetEnabled(value);
+            PSendSysMessage("Lock statistics collection %s.", value ? "enabled" : "disabled");
+            return true;
+        }
+
+        return false;
+    }
+
+    PSendSysMessage("Lock statistics (collection %s), times in microseconds:", ObjectLockStats::IsEnabled() ? "enabled" : "disabled");
+    for (int i = 0; i < MAP_LOCK_TYPE_MAX; ++i)
+    {
+        ObjectLockStats::ClassStats const& stats = ObjectLockStats::GetStats(MapLockType(i));
+
+        long acquired = stats.acquired.value();
+        long contended = stats.contended.value();
+        long waitTime = stats.waitTime.value();
+
+        PSendSysMessage("%-8s acquired %ld, contended %ld (%.2f%%), wait total %ld avg %ld max %ld, hold total %ld",
+            ObjectLockStats::GetClassName(MapLockType(i)), acquired, contended,
+            acquired ? float(contended) * 100.0f / acquired : 0.0f,
+            waitTime, contended ? waitTime / contended : 0, stats.maxWaitTime.value(),
+            stats.holdTime.value());
+    }
+
+    return true;
+}
+
+bool ChatHandler::HandleDebugMapUpdatesCommand(char* /*args*/)
+{
+    uint32 sleepTime = sWorld.getConfig(CONFIG_UINT32_CREATURE_IDLE_SLEEP_TIME);
+    if (sleepTime)
+        PSendSysMessage("Object updates per map (idle creature sleep time %u ms):", sleepTime);
+    else
+        PSendSysMessage("Object updates per map (idle creature sleep disabled):");
+
+    MapManager::MapMapType const& maps = sMapMgr.Maps();
+    for (MapManager::MapMapType::const_iterator itr = maps.begin(); itr != maps.end(); ++itr)
+    {
+        Map const* map = itr->second;
+
+        uint64 updated = map->GetTotalUpdatedObjects();
+        uint64 skipped = map->GetTotalSkippedIdleCreatures();
+
+        PSendSysMessage("%u (%s) instance %u: last tick updated %u skipped %u, total updated " UI64FMTD " skipped " UI64FMTD " (%.2f%%)",
+            map->GetId(), map->GetMapName(), map->GetInstanceId(),
+            map->GetLastUpdatedObjects(), map->GetLastSkippedIdleCreatures(), updated, skipped,
+            updated + skipped ? float(skipped) * 100.0f / (updated + skipped) : 0.0f);
+    }
+
+    return true;
+}
+
 bool ChatHandler::HandleDebugSendQuestInvalidMsgCommand(char* args)
 {
     uint32 msg = atol(args);
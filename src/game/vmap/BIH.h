@@ -131,6 +131,14 @@ class BIH
             delete[] dat.indices;
         }
         uint32 primCount() { return objects.size(); }
+        size_t memoryUsage() const { return (tree.size() + objects.size()) * sizeof(uint32); }
+        // frees the arrays, leaves an empty tree
+        void release()
+        {
+            BIHVector().swap(tree);
+            BIHVector().swap(objects);
+            init_empty();
+        }
 
         template<typename RayCallback>
         void intersectRay(const Ray& r, RayCallback& intersectCallback, float& maxDist, bool stopAtFirst = false) const
@@ -20,6 +20,7 @@
 #define _IVMAPMANAGER_H
 
 #include<string>
+#include <vector>
 #include <Platform/Define.h>
 
 //===========================================================
@@ -47,16 +48,32 @@ namespace VMAP
         private:
             bool iEnableLineOfSightCalc;
             bool iEnableHeightCalc;
+            bool iEnableLazyModelLoading;
 
         public:
-            IVMapManager() : iEnableLineOfSightCalc(true), iEnableHeightCalc(true) {}
+            IVMapManager() : iEnableLineOfSightCalc(true), iEnableHeightCalc(true), iEnableLazyModelLoading(false) {}
 
             virtual ~IVMapManager(void) {}
 
             virtual VMAPLoadResult loadMap(const char* pBasePath, unsigned int pMapId, int x, int y) = 0;
 
+            /**
+            Load the models of a tile ahead of loadMap(), can be called from any thread.
+            Names of the models with a reference taken are added to models, the references
+            must be given back by releaseModelInstances() after the tile is loaded.
+            */
+            virtual void preloadMap(const char* pBasePath, unsigned int pMapId, int x, int y, std::vector<std::string>& models) = 0;
+            virtual void releaseModelInstances(std::vector<std::string> const& models) = 0;
+
             virtual bool existsMap(const char* pBasePath, unsigned int pMapId, int x, int y) = 0;
 
+            /**
+            Unload the geometry of model groups not queried since the last call, least recently
+            used first, until the geometry in memory is below budgetBytes (0 for no limit).
+            Must not be called while other threads query models.
+            */
+            virtual void unloadUnusedModelGroups(size_t budgetBytes) = 0;
+
             virtual void unloadMap(unsigned int pMapId, int x, int y) = 0;
             virtual void unloadMap(unsigned int pMapId) = 0;
 
@@ -82,10 +99,16 @@ namespace VMAP
             It is enabled by default. If it is enabled in mid game the maps have to loaded manualy
             */
             void setEnableHeightCalc(bool pVal) { iEnableHeightCalc = pVal; }
+            /**
+            Enable/disable loading the geometry of model groups at their first query
+            It is disabled by default. Models loaded before a change keep all their groups or load them lazily
+            */
+            void setEnableLazyModelLoading(bool pVal) { iEnableLazyModelLoading = pVal; }
 
             bool isLineOfSightCalcEnabled() const { return(iEnableLineOfSightCalc); }
             bool isHeightCalcEnabled() const { return(iEnableHeightCalc); }
             bool isMapLoadingEnabled() const { return(iEnableLineOfSightCalc || iEnableHeightCalc); }
+            bool isLazyModelLoadingEnabled() const { return(iEnableLazyModelLoading); }
 
             virtual std::string getDirFileName(unsigned int pMapId, int x, int y) const = 0;
             /**
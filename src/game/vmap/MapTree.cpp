@@ -267,12 +267,51 @@ namespace VMAP
 
     //=========================================================
 
+    bool StaticMapTree::GetTileModelNames(const std::string& vmapPath, uint32 mapID, uint32 tileX, uint32 tileY, std::vector<std::string>& names)
+    {
+        std::string basePath = vmapPath;
+        if (basePath.length() > 0 && (basePath[basePath.length() - 1] != '/' && basePath[basePath.length() - 1] != '\\'))
+            basePath.append("/");
+
+        // not tiled maps and tiles without models have no tile file
+        std::string tilefile = basePath + getTileFileName(mapID, tileX, tileY);
+        FILE* tf = openFileBuffered(tilefile.c_str());
+        if (!tf)
+            return true;
+
+        bool result = true;
+        char chunk[8];
+        if (!readChunk(tf, chunk, VMAP_MAGIC, 8))
+            result = false;
+        uint32 numSpawns;
+        if (result && fread(&numSpawns, sizeof(uint32), 1, tf) != 1)
+            result = false;
+        for (uint32 i = 0; i < numSpawns && result; ++i)
+        {
+            ModelSpawn spawn;
+            result = ModelSpawn::readFromFile(tf, spawn);
+
+            // skip the tree index of the spawn
+            uint32 referencedVal;
+            if (result && fread(&referencedVal, sizeof(uint32), 1, tf) != 1)
+                result = false;
+
+            if (result)
+                names.push_back(spawn.name);
+        }
+
+        fclose(tf);
+        return result;
+    }
+
+    //=========================================================
+
     bool StaticMapTree::InitMap(const std::string& fname, VMapManager2* vm)
     {
         DEBUG_LOG("Initializing StaticMapTree '%s'", fname.c_str());
         bool success = true;
         std::string fullname = iBasePath + fname;
-        FILE* rf = fopen(fullname.c_str(), "rb");
+        FILE* rf = openFileBuffered(fullname.c_str());
         if (!rf)
             return false;
         else
@@ -354,7 +393,7 @@ namespace VMAP
         bool result = true;
 
         std::string tilefile = iBasePath + getTileFileName(iMapID, tileX, tileY);
-        FILE* tf = fopen(tilefile.c_str(), "rb");
+        FILE* tf = openFileBuffered(tilefile.c_str());
         if (tf)
         {
             char chunk[8];
@@ -26,6 +26,10 @@
 #include <sstream>
 #include <iomanip>
 
+#include <ace/Thread_Mutex.h>
+#include <ace/Guard_T.h>
+#include <ace/Thread_Manager.h>
+
 using G3D::Vector3;
 using G3D::AABox;
 using G3D::inf;
@@ -44,6 +48,28 @@ namespace VMAP
         return memcmp(dest, compare, len) == 0;
     }
 
+    FILE* openFileBuffered(const char* filename)
+    {
+        FILE* rf = fopen(filename, "rb");
+        if (!rf)
+            return NULL;
+
+        if (fseek(rf, 0, SEEK_END) == 0)
+        {
+            long size = ftell(rf);
+            rewind(rf);
+
+            if (size > 16 * 1024 * 1024)
+                size = 16 * 1024 * 1024;
+
+            // stdio allocates the buffer and frees it at fclose
+            if (size > BUFSIZ)
+                setvbuf(rf, NULL, _IOFBF, size_t(size));
+        }
+
+        return rf;
+    }
+
     Vector3 ModelPosition::transform(const Vector3& pIn) const
     {
         Vector3 out = pIn * iScale;
@@ -57,6 +83,7 @@ namespace VMAP
     {
         iCurrentUniqueNameId = 0;
         iFilterMethod = NULL;
+        iThreads = 1;
         iSrcDir = pSrcDirName;
         iDestDir = pDestDirName;
         // mkdir(iDestDir);
@@ -180,17 +207,8 @@ namespace VMAP
         exportGameobjectModels();
 
         // export objects
-        std::cout << "\nConverting Model Files" << std::endl;
-        for (std::set<std::string>::iterator mfile = spawnedModelFiles.begin(); mfile != spawnedModelFiles.end(); ++mfile)
-        {
-            std::cout << "Converting " << *mfile << std::endl;
-            if (!convertRawFile(*mfile))
-            {
-                std::cout << "error converting " << *mfile << std::endl;
-                success = false;
-                break;
-            }
-        }
+        if (success)
+            success = convertModelFiles();
 
         // cleanup:
         for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end(); ++map_iter)
@@ -200,6 +218,72 @@ namespace VMAP
         return success;
     }
 
+    // model conversion queue shared by the worker threads
+    struct ModelConvertJob
+    {
+        ModelConvertJob(TileAssembler* _assembler) : assembler(_assembler), next(0), done(0), success(true) {}
+
+        TileAssembler* assembler;
+        std::vector<std::string> files;
+
+        ACE_Thread_Mutex lock;                              // guards all below
+        size_t next;
+        size_t done;
+        bool success;
+    };
+
+    static ACE_THR_FUNC_RETURN convertModelsWorker(void* arg)
+    {
+        ModelConvertJob* job = (ModelConvertJob*)arg;
+        for (;;)
+        {
+            std::string const* file;
+            {
+                ACE_Guard<ACE_Thread_Mutex> guard(job->lock);
+                if (!job->success || job->next >= job->files.size())
+                    return 0;
+
+                file = &job->files[job->next++];
+            }
+
+            bool converted = job->assembler->convertRawFile(*file);
+
+            ACE_Guard<ACE_Thread_Mutex> guard(job->lock);
+            ++job->done;
+            if (converted)
+                printf("Converted %s (%u/%u)\n", file->c_str(), uint32(job->done), uint32(job->files.size()));
+            else
+            {
+                printf("error converting %s\n", file->c_str());
+                job->success = false;
+            }
+        }
+    }
+
+    bool TileAssembler::convertModelFiles()
+    {
+        std::cout << "\nConverting Model Files" << std::endl;
+
+        ModelConvertJob job(this);
+        job.files.assign(spawnedModelFiles.begin(), spawnedModelFiles.end());
+
+        int threads = iThreads < job.files.size() ? int(iThreads) : int(job.files.size());
+        int group = -1;
+        if (threads > 1)
+        {
+            group = ACE_Thread_Manager::instance()->spawn_n(threads, (ACE_THR_FUNC)&convertModelsWorker, &job);
+            if (group == -1)
+                printf("Failed to start %d worker threads, converting in one thread.\n", threads);
+        }
+
+        if (group != -1)
+            ACE_Thread_Manager::instance()->wait_grp(group);
+        else
+            convertModelsWorker(&job);
+
+        return job.success;
+    }
+
     bool TileAssembler::readMapSpawns()
     {
         std::string fname = iSrcDir + "/dir_bin";
@@ -98,12 +98,17 @@ namespace VMAP
             unsigned int iCurrentUniqueNameId;
             MapData mapData;
             std::set<std::string> spawnedModelFiles;
+            uint32 iThreads;
+
+            bool convertModelFiles();
 
         public:
             TileAssembler(const std::string& pSrcDirName, const std::string& pDestDirName);
             virtual ~TileAssembler();
 
             bool convertWorld2();
+            // model files are independent, they are converted by this many threads
+            void setThreads(uint32 threads) { iThreads = threads ? threads : 1; }
             bool readMapSpawns();
             bool calculateTransformedBound(ModelSpawn& spawn);
 
@@ -31,6 +31,9 @@ namespace VMAP
 
     // defined in TileAssembler.cpp currently...
     bool readChunk(FILE* rf, char* dest, const char* compare, uint32 len);
+    // opens a file for reading with a stdio buffer of the file size (up to 16 MB),
+    // so the many small freads of a model are served by one read from disk
+    FILE* openFileBuffered(const char* filename);
 
     inline bool CheckPosition(float const& x, float const& y, float const& z) 
     {
@@ -41,6 +44,17 @@ namespace VMAP
     };
 }
 
+// the tools link ACE too, MoveMapGen loads models from several threads
+#include <ace/Atomic_Op.h>
+#include <ace/Guard_T.h>
+#include <ace/Thread_Mutex.h>
+namespace VMAP
+{
+    typedef ACE_Thread_Mutex ModelFileLock;
+    typedef ACE_Guard<ACE_Thread_Mutex> ModelFileGuard;
+    typedef ACE_Atomic_Op<ACE_Thread_Mutex, long> ModelCounter;
+}
+
 #ifndef NO_CORE_FUNCS
 #include "Errors.h"
 #include "Log.h"
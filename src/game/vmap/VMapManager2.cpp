@@ -20,6 +20,7 @@
 #include <iomanip>
 #include <string>
 #include <sstream>
+#include <algorithm>
 #include "VMapManager2.h"
 #include "MapTree.h"
 #include "ModelInstance.h"
@@ -260,26 +261,43 @@ namespace VMAP
 
     WorldModel* VMapManager2::acquireModelInstance(const std::string& basepath, const std::string& filename)
     {
-        ModelFileMap::iterator model = iLoadedModelFiles.find(filename);
-        if (model == iLoadedModelFiles.end())
         {
-            WorldModel* worldmodel = new WorldModel();
-            if (!worldmodel->readFile(basepath + filename + ".vmo"))
+            ModelFileGuard guard(iLoadedModelFilesLock);
+
+            ModelFileMap::iterator model = iLoadedModelFiles.find(filename);
+            if (model != iLoadedModelFiles.end())
             {
-                ERROR_LOG("VMapManager2: could not load '%s%s.vmo'!", basepath.c_str(), filename.c_str());
-                delete worldmodel;
-                return NULL;
+                model->second.incRefCount();
+                return model->second.getModel();
             }
-            DEBUG_LOG("VMapManager2: loading file '%s%s'.", basepath.c_str(), filename.c_str());
-            model = iLoadedModelFiles.insert(std::pair<std::string, ManagedModel>(filename, ManagedModel())).first;
-            model->second.setModel(worldmodel);
         }
-        model->second.incRefCount();
-        return model->second.getModel();
+
+        // read unlocked, other threads may load other models meanwhile
+        WorldModel* worldmodel = new WorldModel();
+        if (!worldmodel->readFile(basepath + filename + ".vmo", isLazyModelLoadingEnabled()))
+        {
+            ERROR_LOG("VMapManager2: could not load '%s%s.vmo'!", basepath.c_str(), filename.c_str());
+            delete worldmodel;
+            return NULL;
+        }
+        DEBUG_LOG("VMapManager2: loading file '%s%s'.", basepath.c_str(), filename.c_str());
+
+        ModelFileGuard guard(iLoadedModelFilesLock);
+
+        std::pair<ModelFileMap::iterator, bool> model = iLoadedModelFiles.insert(std::pair<std::string, ManagedModel>(filename, ManagedModel()));
+        if (model.second)
+            model.first->second.setModel(worldmodel);
+        else
+            delete worldmodel;                              // loaded by another thread meanwhile
+
+        model.first->second.incRefCount();
+        return model.first->second.getModel();
     }
 
     void VMapManager2::releaseModelInstance(const std::string& filename)
     {
+        ModelFileGuard guard(iLoadedModelFilesLock);
+
         ModelFileMap::iterator model = iLoadedModelFiles.find(filename);
         if (model == iLoadedModelFiles.end())
         {
@@ -293,6 +311,76 @@ namespace VMAP
             iLoadedModelFiles.erase(model);
         }
     }
+
+    //=========================================================
+
+    void VMapManager2::preloadMap(const char* pBasePath, unsigned int pMapId, int x, int y, std::vector<std::string>& models)
+    {
+        if (!isMapLoadingEnabled())
+            return;
+
+        std::vector<std::string> names;
+        StaticMapTree::GetTileModelNames(pBasePath, pMapId, x, y, names);
+
+        std::string basePath = pBasePath;
+        if (basePath.length() > 0 && (basePath[basePath.length() - 1] != '/' && basePath[basePath.length() - 1] != '\\'))
+            basePath.append("/");
+
+        for (std::vector<std::string>::const_iterator itr = names.begin(); itr != names.end(); ++itr)
+            if (acquireModelInstance(basePath, *itr))
+                models.push_back(*itr);
+    }
+
+    void VMapManager2::releaseModelInstances(std::vector<std::string> const& models)
+    {
+        for (std::vector<std::string>::const_iterator itr = models.begin(); itr != models.end(); ++itr)
+            releaseModelInstance(*itr);
+    }
+
+    //=========================================================
+
+    struct ModelGroupUse
+    {
+        ModelGroupUse(WorldModel* worldModel, uint32 index, uint32 used) : model(worldModel), group(index), lastUsed(used) {}
+        bool operator<(ModelGroupUse const& other) const { return lastUsed < other.lastUsed; }
+
+        WorldModel* model;
+        uint32 group;
+        uint32 lastUsed;
+    };
+
+    void VMapManager2::unloadUnusedModelGroups(size_t budgetBytes)
+    {
+        uint32 stamp = WorldModel::NextUseStamp();
+
+        long resident = WorldModel::GetResidentBytes();
+        if (!budgetBytes || resident <= long(budgetBytes))
+            return;
+
+        ModelFileGuard guard(iLoadedModelFilesLock);
+
+        // groups used since the last call stay
+        std::vector<ModelGroupUse> unused;
+        for (ModelFileMap::iterator itr = iLoadedModelFiles.begin(); itr != iLoadedModelFiles.end(); ++itr)
+        {
+            WorldModel* model = itr->second.getModel();
+            for (uint32 i = 0; i < model->getGroupCount(); ++i)
+            {
+                GroupModel const& group = model->getGroup(i);
+                if (group.IsGeometryLoaded() && group.GetFileOffset() >= 0 && group.GetLastUsed() != stamp)
+                    unused.push_back(ModelGroupUse(model, i, group.GetLastUsed()));
+            }
+        }
+
+        std::sort(unused.begin(), unused.end());
+
+        uint32 unloaded = 0;
+        for (; unloaded < unused.size() && resident > long(budgetBytes); ++unloaded)
+            resident -= long(unused[unloaded].model->unloadGroup(unused[unloaded].group));
+
+        DEBUG_LOG("VMapManager2: unloaded %u model groups, %ld bytes of geometry left", unloaded, resident);
+    }
+
     //=========================================================
 
     bool VMapManager2::existsMap(const char* pBasePath, unsigned int pMapId, int x, int y)
@@ -20,6 +20,7 @@
 #define _VMAPMANAGER2_H
 
 #include "IVMapManager.h"
+#include "VMapDefinitions.h"
 #include "Utilities/UnorderedMapSet.h"
 #include "Platform/Define.h"
 #include <G3D/Vector3.h>
@@ -66,6 +67,7 @@ namespace VMAP
         protected:
             // Tree to check collision
             ModelFileMap iLoadedModelFiles;
+            ModelFileLock iLoadedModelFilesLock;            // models are preloaded by terrain loading threads
             InstanceTreeMap iInstanceMapTrees;
 
             bool _loadMap(uint32 pMapId, const std::string& basePath, uint32 tileX, uint32 tileY);
@@ -81,6 +83,11 @@ namespace VMAP
 
             VMAPLoadResult loadMap(const char* pBasePath, unsigned int pMapId, int x, int y);
 
+            void preloadMap(const char* pBasePath, unsigned int pMapId, int x, int y, std::vector<std::string>& models);
+            void releaseModelInstances(std::vector<std::string> const& models);
+
+            void unloadUnusedModelGroups(size_t budgetBytes);
+
             void unloadMap(unsigned int pMapId, int x, int y);
             void unloadMap(unsigned int pMapId);
 
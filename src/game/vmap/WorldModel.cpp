@@ -20,6 +20,10 @@
 #include "VMapDefinitions.h"
 #include "MapTree.h"
 
+#ifndef NO_CORE_FUNCS
+#include "Metrics/Metrics.h"
+#endif
+
 using G3D::Vector3;
 using G3D::Ray;
 
@@ -30,6 +34,18 @@ template<> struct BoundsTrait<VMAP::GroupModel>
 
 namespace VMAP
 {
+    static ModelCounter ResidentBytes;
+    static uint32 UseStamp = 1;
+
+    static void AddResidentBytes(long bytes)
+    {
+        ResidentBytes += bytes;
+#ifndef NO_CORE_FUNCS
+        static MetricGauge* resident = sMetrics.GetGauge("mangos_vmap_resident_bytes", "Geometry of world model groups in memory");
+        resident->Add(bytes);
+#endif
+    }
+
     bool IntersectTriangle(const MeshTriangle& tri, std::vector<Vector3>::const_iterator points, const G3D::Ray& ray, float& distance)
     {
         static const float EPS = 1e-5f;
@@ -204,6 +220,11 @@ namespace VMAP
                iTilesX * iTilesY;
     }
 
+    size_t WmoLiquid::GetMemoryUsage() const
+    {
+        return sizeof(WmoLiquid) + (iTilesX + 1) * (iTilesY + 1) * sizeof(float) + iTilesX * iTilesY;
+    }
+
     bool WmoLiquid::writeToFile(FILE* wf)
     {
         bool result = true;
@@ -242,7 +263,8 @@ namespace VMAP
 
     GroupModel::GroupModel(const GroupModel& other):
         iBound(other.iBound), iMogpFlags(other.iMogpFlags), iGroupWMOID(other.iGroupWMOID),
-        vertices(other.vertices), triangles(other.triangles), meshTree(other.meshTree), iLiquid(0)
+        vertices(other.vertices), triangles(other.triangles), meshTree(other.meshTree), iLiquid(0),
+        iFileOffset(other.iFileOffset), iGeometryLoaded(other.iGeometryLoaded.value()), iLastUsed(other.iLastUsed)
     {
         if (other.iLiquid)
             iLiquid = new WmoLiquid(*other.iLiquid);
@@ -302,7 +324,37 @@ namespace VMAP
         return result;
     }
 
-    bool GroupModel::readFromFile(FILE* rf)
+    bool GroupModel::readFromFile(FILE* rf, bool lazy)
+    {
+        bool result = true;
+
+        if (result && fread(&iBound, sizeof(G3D::AABox), 1, rf) != 1) result = false;
+        if (result && fread(&iMogpFlags, sizeof(uint32), 1, rf) != 1) result = false;
+        if (result && fread(&iGroupWMOID, sizeof(uint32), 1, rf) != 1) result = false;
+        if (!result)
+            return false;
+
+        if (!lazy)
+            return readGeometry(rf);
+
+        triangles.clear();
+        vertices.clear();
+        delete iLiquid;
+        iLiquid = 0;
+
+        bool empty = false;
+        iFileOffset = ftell(rf);
+        if (!skipGeometry(rf, empty))
+            return false;
+
+        // nothing to load later
+        if (empty)
+            iFileOffset = -1;
+        iGeometryLoaded = empty ? 1 : 0;
+        return true;
+    }
+
+    bool GroupModel::readGeometry(FILE* rf)
     {
         char chunk[8];
         bool result = true;
@@ -312,10 +364,6 @@ namespace VMAP
         delete iLiquid;
         iLiquid = 0;
 
-        if (result && fread(&iBound, sizeof(G3D::AABox), 1, rf) != 1) result = false;
-        if (result && fread(&iMogpFlags, sizeof(uint32), 1, rf) != 1) result = false;
-        if (result && fread(&iGroupWMOID, sizeof(uint32), 1, rf) != 1) result = false;
-
         // read vertices
         if (result && !readChunk(rf, chunk, "VERT", 4)) result = false;
         if (result && fread(&chunkSize, sizeof(uint32), 1, rf) != 1) result = false;
@@ -344,6 +392,85 @@ namespace VMAP
         return result;
     }
 
+    // moves the file position behind the geometry, like readGeometry() does
+    bool GroupModel::skipGeometry(FILE* rf, bool& empty)
+    {
+        char chunk[8];
+        bool result = true;
+        uint32 chunkSize, count;
+
+        if (result && !readChunk(rf, chunk, "VERT", 4)) result = false;
+        if (result && fread(&chunkSize, sizeof(uint32), 1, rf) != 1) result = false;
+        if (result && fread(&count, sizeof(uint32), 1, rf) != 1) result = false;
+        if (result && !count)
+        {
+            empty = true;
+            return true;
+        }
+        if (result && fseek(rf, count * sizeof(Vector3), SEEK_CUR) != 0) result = false;
+
+        if (result && !readChunk(rf, chunk, "TRIM", 4)) result = false;
+        if (result && fread(&chunkSize, sizeof(uint32), 1, rf) != 1) result = false;
+        if (result && fread(&count, sizeof(uint32), 1, rf) != 1) result = false;
+        if (result && fseek(rf, count * sizeof(MeshTriangle), SEEK_CUR) != 0) result = false;
+
+        // mesh BIH: bounds, node count, nodes, object count, objects
+        if (result && !readChunk(rf, chunk, "MBIH", 4)) result = false;
+        if (result && fseek(rf, 2 * sizeof(Vector3), SEEK_CUR) != 0) result = false;
+        if (result && fread(&count, sizeof(uint32), 1, rf) != 1) result = false;
+        if (result && fseek(rf, count * sizeof(uint32), SEEK_CUR) != 0) result = false;
+        if (result && fread(&count, sizeof(uint32), 1, rf) != 1) result = false;
+        if (result && fseek(rf, count * sizeof(uint32), SEEK_CUR) != 0) result = false;
+
+        // liquid chunk size misses the liquid type, so skip by the tile counts
+        if (result && !readChunk(rf, chunk, "LIQU", 4)) result = false;
+        if (result && fread(&chunkSize, sizeof(uint32), 1, rf) != 1) result = false;
+        if (result && chunkSize > 0)
+        {
+            uint32 tilesX, tilesY;
+            if (result && fread(&tilesX, sizeof(uint32), 1, rf) != 1) result = false;
+            if (result && fread(&tilesY, sizeof(uint32), 1, rf) != 1) result = false;
+            long size = sizeof(Vector3) + sizeof(uint32) + (tilesX + 1) * (tilesY + 1) * sizeof(float) + tilesX * tilesY;
+            if (result && fseek(rf, size, SEEK_CUR) != 0) result = false;
+        }
+        return result;
+    }
+
+    void GroupModel::loadGeometry(const std::string& filename)
+    {
+        FILE* rf = fopen(filename.c_str(), "rb");
+        bool result = rf && fseek(rf, iFileOffset, SEEK_SET) == 0 && readGeometry(rf);
+        if (rf)
+            fclose(rf);
+
+        if (!result)
+        {
+            ERROR_LOG("GroupModel: could not load geometry of group %u from '%s'!", iGroupWMOID, filename.c_str());
+            unloadGeometry();
+            iFileOffset = -1;                               // don't try again at every query
+        }
+
+        iGeometryLoaded = 1;
+    }
+
+    void GroupModel::unloadGeometry()
+    {
+        std::vector<Vector3>().swap(vertices);
+        std::vector<MeshTriangle>().swap(triangles);
+        meshTree.release();
+        delete iLiquid;
+        iLiquid = 0;
+        iGeometryLoaded = 0;
+    }
+
+    size_t GroupModel::GetMemoryUsage() const
+    {
+        size_t size = vertices.capacity() * sizeof(Vector3) + triangles.capacity() * sizeof(MeshTriangle) + meshTree.memoryUsage();
+        if (iLiquid)
+            size += iLiquid->GetMemoryUsage();
+        return size;
+    }
+
     struct GModelRayCallback
     {
         GModelRayCallback(const std::vector<MeshTriangle>& tris, const std::vector<Vector3>& vert):
@@ -398,6 +525,66 @@ namespace VMAP
 
     // ===================== WorldModel ==================================
 
+    WorldModel::~WorldModel()
+    {
+        if (iResidentBytes)
+            AddResidentBytes(-long(iResidentBytes));
+    }
+
+    const GroupModel& WorldModel::touchGroup(uint32 index) const
+    {
+        GroupModel& group = groupModels[index];
+        group.SetLastUsed(UseStamp);
+        if (!group.IsGeometryLoaded())
+            loadGroup(group);
+        return group;
+    }
+
+    bool WorldModel::loadGroup(GroupModel& group) const
+    {
+        ModelFileGuard guard(iGroupLoadLock);
+
+        // loaded by another thread meanwhile
+        if (group.IsGeometryLoaded())
+            return true;
+
+        group.loadGeometry(iFileName);
+
+        size_t bytes = group.GetMemoryUsage();
+        iResidentBytes += bytes;
+        AddResidentBytes(long(bytes));
+
+#ifndef NO_CORE_FUNCS
+        static MetricCounter* loads = sMetrics.GetCounter("mangos_vmap_group_loads_total", "World model groups loaded at their first query");
+        loads->Inc();
+#endif
+        return group.GetFileOffset() >= 0;
+    }
+
+    size_t WorldModel::unloadGroup(uint32 index)
+    {
+        GroupModel& group = groupModels[index];
+        if (!group.IsGeometryLoaded() || group.GetFileOffset() < 0)
+            return 0;
+
+        size_t bytes = group.GetMemoryUsage();
+        group.unloadGeometry();
+
+        iResidentBytes -= bytes;
+        AddResidentBytes(-long(bytes));
+        return bytes;
+    }
+
+    long WorldModel::GetResidentBytes()
+    {
+        return ResidentBytes.value();
+    }
+
+    uint32 WorldModel::NextUseStamp()
+    {
+        return UseStamp++;
+    }
+
     void WorldModel::setGroupModels(std::vector<GroupModel>& models)
     {
         groupModels.swap(models);
@@ -406,14 +593,23 @@ namespace VMAP
 
     struct WModelRayCallBack
     {
-        WModelRayCallBack(const std::vector<GroupModel>& mod): models(mod.begin()), hit(false) {}
+        WModelRayCallBack(const WorldModel& mod): model(mod), hit(false) {}
         bool operator()(const G3D::Ray& ray, uint32 entry, float& distance, bool pStopAtFirstHit)
         {
-            bool result = models[entry].IntersectRay(ray, distance, pStopAtFirstHit);
+            // don't load groups the ray passes by
+            const GroupModel& group = model.getGroup(entry);
+            if (!group.IsGeometryLoaded())
+            {
+                float time = ray.intersectionTime(group.GetBound());
+                if (time == G3D::finf() || time > distance)
+                    return hit;
+            }
+
+            bool result = model.touchGroup(entry).IntersectRay(ray, distance, pStopAtFirstHit);
             if (result)  hit = true;
             return hit;
         }
-        std::vector<GroupModel>::const_iterator models;
+        const WorldModel& model;
         bool hit;
     };
 
@@ -422,9 +618,9 @@ namespace VMAP
         // small M2 workaround, maybe better make separate class with virtual intersection funcs
         // in any case, there's no need to use a bound tree if we only have one submodel
         if (groupModels.size() == 1)
-            return groupModels[0].IntersectRay(ray, distance, stopAtFirstHit);
+            return touchGroup(0).IntersectRay(ray, distance, stopAtFirstHit);
 
-        WModelRayCallBack isc(groupModels);
+        WModelRayCallBack isc(*this);
         groupTree.intersectRay(ray, isc, distance, stopAtFirstHit);
         return isc.hit;
     }
@@ -432,8 +628,9 @@ namespace VMAP
     class WModelAreaCallback
     {
         public:
-            WModelAreaCallback(const std::vector<GroupModel>& vals, const Vector3& down):
-                prims(vals.begin()), hit(vals.end()), minVol(G3D::inf()), zDist(G3D::inf()), zVec(down) {}
+            WModelAreaCallback(const WorldModel& mod, const std::vector<GroupModel>& vals, const Vector3& down):
+                model(mod), prims(vals.begin()), hit(vals.end()), minVol(G3D::inf()), zDist(G3D::inf()), zVec(down) {}
+            const WorldModel& model;
             std::vector<GroupModel>::const_iterator prims;
             std::vector<GroupModel>::const_iterator hit;
             float minVol;
@@ -441,12 +638,16 @@ namespace VMAP
             Vector3 zVec;
             void operator()(const Vector3& point, uint32 entry)
             {
+                // IsInsideObject() fails outside the bound, don't load the group for it
+                if (!prims[entry].GetBound().contains(point))
+                    return;
+
                 float group_Z;
                 // float pVol = prims[entry].GetBound().volume();
                 // if(pVol < minVol)
                 //{
                 /* if (prims[entry].iBound.contains(point)) */
-                if (prims[entry].IsInsideObject(point, zVec, group_Z))
+                if (model.touchGroup(entry).IsInsideObject(point, zVec, group_Z))
                 {
                     // minVol = pVol;
                     // hit = prims + entry;
@@ -471,7 +672,7 @@ namespace VMAP
     {
         if (groupModels.empty())
             return false;
-        WModelAreaCallback callback(groupModels, down);
+        WModelAreaCallback callback(*this, groupModels, down);
         groupTree.intersectPoint(p, callback);
         if (callback.hit != groupModels.end())
         {
@@ -489,7 +690,7 @@ namespace VMAP
     {
         if (groupModels.empty())
             return false;
-        WModelAreaCallback callback(groupModels, down);
+        WModelAreaCallback callback(*this, groupModels, down);
         groupTree.intersectPoint(p, callback);
         if (callback.hit != groupModels.end())
         {
@@ -533,9 +734,10 @@ namespace VMAP
         return result;
     }
 
-    bool WorldModel::readFile(const std::string& filename)
+    bool WorldModel::readFile(const std::string& filename, bool lazy)
     {
-        FILE* rf = fopen(filename.c_str(), "rb");
+        // geometry is skipped when read lazily, a buffer of the file size would read it anyway
+        FILE* rf = lazy ? fopen(filename.c_str(), "rb") : openFileBuffered(filename.c_str());
         if (!rf)
             return false;
 
@@ -558,7 +760,7 @@ namespace VMAP
             if (result) groupModels.resize(count);
             // if (result && fread(&groupModels[0], sizeof(GroupModel), count, rf) != count) result = false;
             for (uint32 i = 0; i < count && result; ++i)
-                result = groupModels[i].readFromFile(rf);
+                result = groupModels[i].readFromFile(rf, lazy);
 
             // read group BIH
             if (result && !readChunk(rf, chunk, "GBIH", 4)) result = false;
@@ -566,6 +768,17 @@ namespace VMAP
         }
 
         fclose(rf);
+
+        if (result)
+        {
+            if (lazy)
+                iFileName = filename;
+
+            for (uint32 i = 0; i < groupModels.size(); ++i)
+                if (groupModels[i].IsGeometryLoaded())
+                    iResidentBytes += groupModels[i].GetMemoryUsage();
+            AddResidentBytes(long(iResidentBytes));
+        }
         return result;
     }
 }
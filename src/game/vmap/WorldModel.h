@@ -24,6 +24,7 @@
 #include <G3D/AABox.h>
 #include <G3D/Ray.h>
 #include "BIH.h"
+#include "VMapDefinitions.h"
 
 #include "Platform/Define.h"
 
@@ -56,6 +57,7 @@ namespace VMAP
             float* GetHeightStorage() { return iHeight; }
             uint8* GetFlagsStorage() { return iFlags; }
             uint32 GetFileSize();
+            size_t GetMemoryUsage() const;
             bool writeToFile(FILE* wf);
             static bool readFromFile(FILE* rf, WmoLiquid*& liquid);
         private:
@@ -76,10 +78,10 @@ namespace VMAP
     class GroupModel
     {
         public:
-            GroupModel(): iLiquid(0) {}
+            GroupModel(): iLiquid(0), iFileOffset(-1), iGeometryLoaded(1), iLastUsed(0) {}
             GroupModel(const GroupModel& other);
             GroupModel(uint32 mogpFlags, uint32 groupWMOID, const AABox& bound):
-                iBound(bound), iMogpFlags(mogpFlags), iGroupWMOID(groupWMOID), iLiquid(0) {}
+                iBound(bound), iMogpFlags(mogpFlags), iGroupWMOID(groupWMOID), iLiquid(0), iFileOffset(-1), iGeometryLoaded(1), iLastUsed(0) {}
             ~GroupModel() { delete iLiquid; }
 
             //! pass mesh data to object and create BIH. Passed vectors get get swapped with old geometry!
@@ -90,11 +92,23 @@ namespace VMAP
             bool GetLiquidLevel(const Vector3& pos, float& liqHeight) const;
             uint32 GetLiquidType() const;
             bool writeToFile(FILE* wf);
-            bool readFromFile(FILE* rf);
+            //! lazy: only the header is read, the geometry is skipped and read later by readGeometry()
+            bool readFromFile(FILE* rf, bool lazy = false);
+            //! geometry of a group read lazily, the group stays empty if that fails
+            void loadGeometry(const std::string& filename);
+            void unloadGeometry();
             const G3D::AABox& GetBound() const { return iBound; }
             uint32 GetMogpFlags() const { return iMogpFlags; }
             uint32 GetWmoID() const { return iGroupWMOID; }
+            long GetFileOffset() const { return iFileOffset; }
+            bool IsGeometryLoaded() const { return iGeometryLoaded.value() != 0; }
+            uint32 GetLastUsed() const { return iLastUsed; }
+            void SetLastUsed(uint32 stamp) { iLastUsed = stamp; }
+            size_t GetMemoryUsage() const;
         protected:
+            bool readGeometry(FILE* rf);
+            bool skipGeometry(FILE* rf, bool& empty);
+
             G3D::AABox iBound;
             uint32 iMogpFlags;// 0x8 outdor; 0x2000 indoor
             uint32 iGroupWMOID;
@@ -102,17 +116,24 @@ namespace VMAP
             std::vector<MeshTriangle> triangles;
             BIH meshTree;
             WmoLiquid* iLiquid;
+            long iFileOffset;               //!< of the geometry in the model file, -1 if it is always resident
+            ModelCounter iGeometryLoaded;   //!< set after the geometry is written, read without iGroupLoadLock by queries
+            uint32 iLastUsed;               //!< use stamp of the last query, see WorldModel::NextUseStamp()
 
 #ifdef MMAP_GENERATOR
         public:
             void getMeshData(std::vector<Vector3>& vertices, std::vector<MeshTriangle>& triangles, WmoLiquid*& liquid);
 #endif
     };
-    /*! Holds a model (converted M2 or WMO) in its original coordinate space */
+    /*! Holds a model (converted M2 or WMO) in its original coordinate space.
+        A model read lazily loads the geometry of a group at the first query reaching
+        the group bound, unloadGroup() frees it again. Groups must only be unloaded
+        while no queries run. */
     class WorldModel
     {
         public:
-            WorldModel(): RootWMOID(0) {}
+            WorldModel(): RootWMOID(0), iResidentBytes(0) {}
+            ~WorldModel();
 
             //! pass group models to WorldModel and create BIH. Passed vector is swapped with old geometry!
             void setGroupModels(std::vector<GroupModel>& models);
@@ -121,11 +142,28 @@ namespace VMAP
             bool IntersectPoint(const G3D::Vector3& p, const G3D::Vector3& down, float& dist, AreaInfo& info) const;
             bool GetLocationInfo(const G3D::Vector3& p, const G3D::Vector3& down, float& dist, LocationInfo& info) const;
             bool writeFile(const std::string& filename);
-            bool readFile(const std::string& filename);
+            bool readFile(const std::string& filename, bool lazy = false);
+
+            uint32 getGroupCount() const { return groupModels.size(); }
+            const GroupModel& getGroup(uint32 index) const { return groupModels[index]; }
+            //! group geometry is loaded if needed, and the group marked as used
+            const GroupModel& touchGroup(uint32 index) const;
+            //! returns the bytes freed
+            size_t unloadGroup(uint32 index);
+
+            //! geometry of all groups in memory
+            static long GetResidentBytes();
+            //! starts a new period for the last use of groups, returns the stamp of the ended one
+            static uint32 NextUseStamp();
         protected:
+            bool loadGroup(GroupModel& group) const;
+
             uint32 RootWMOID;
-            std::vector<GroupModel> groupModels;
+            mutable std::vector<GroupModel> groupModels;        // geometry of groups is loaded by const queries
             BIH groupTree;
+            std::string iFileName;                              // of a model read lazily
+            mutable ModelFileLock iGroupLoadLock;
+            mutable size_t iResidentBytes;
 
 #ifdef MMAP_GENERATOR
         public:
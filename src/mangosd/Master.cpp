@@ -44,6 +44,7 @@
 #include "MaNGOSsoap.h"
 #include "MassMailMgr.h"
 #include "DBCStores.h"
+#include "Metrics/MetricsServer.h"
 
 #include <ace/OS_NS_signal.h>
 #include <ace/TP_Reactor.h>
@@ -302,6 +303,16 @@ int Master::Run()
         soap_thread = new ACE_Based::Thread(runnable);
     }
 
+    ///- Start metrics exporter thread
+    ACE_Based::Thread* metrics_thread = NULL;
+    MetricsServer* metrics_server = NULL;
+
+    if (sWorld.getConfig(CONFIG_BOOL_METRICS_ENABLE))
+    {
+        metrics_server = new MetricsServer(sConfig.GetStringDefault("Metrics.IP", "127.0.0.1"), sConfig.GetIntDefault("Metrics.Port", 9110));
+        metrics_thread = new ACE_Based::Thread(metrics_server);
+    }
+
     ///- Start up freeze catcher thread
     ACE_Based::Thread* freeze_thread = NULL;
     if(uint32 freeze_delay = sConfig.GetIntDefault("MaxCoreStuckTime", 0))
@@ -341,6 +352,14 @@ int Master::Run()
         delete soap_thread;
     }
 
+    ///- Stop metrics thread
+    if (metrics_thread)
+    {
+        metrics_server->Stop();
+        metrics_thread->wait();
+        delete metrics_thread;
+    }
+
     ///- Set server offline in realmlist
     LoginDatabase.DirectPExecute("UPDATE realmlist SET realmflags = realmflags | %u WHERE id = '%u'", REALM_FLAG_OFFLINE, sWorld.getConfig(CONFIG_UINT32_REALMID));
 
@@ -454,6 +473,7 @@ bool Master::_StartDB()
 
     dbstring = sConfig.GetStringDefault("CharacterDatabaseInfo", "");
     nConnections = sConfig.GetIntDefault("CharacterDatabaseConnections", 1);
+    int nLoginConnections = sConfig.GetIntDefault("CharacterDatabaseLoginConnections", 2);
     if(dbstring.empty())
     {
         sLog.outError("Character Database not specified in configuration file");
@@ -462,10 +482,10 @@ bool Master::_StartDB()
         WorldDatabase.HaltDelayThread();
         return false;
     }
-    sLog.outString("Character Database total connections: %i", nConnections + 1);
+    sLog.outString("Character Database total connections: %i", nConnections + 1 + nLoginConnections);
 
     ///- Initialise the Character database
-    if(!CharacterDatabase.Initialize(dbstring.c_str(), nConnections))
+    if(!CharacterDatabase.Initialize(dbstring.c_str(), nConnections, nLoginConnections))
     {
         sLog.outError("Cannot connect to Character database %s",dbstring.c_str());
 
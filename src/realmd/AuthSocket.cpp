@@ -28,6 +28,7 @@
 #include "RealmList.h"
 #include "AuthSocket.h"
 #include "AuthCodes.h"
+#include "AuthWorkerPool.h"
 #include "PatchHandler.h"
 
 #include <openssl/md5.h>
@@ -190,6 +191,7 @@ AuthSocket::AuthSocket()
 
     _build = 0;
     patch_ = ACE_INVALID_HANDLE;
+    _pendingJob = NULL;
 }
 
 /// Close patch file descriptor before leaving
@@ -197,6 +199,9 @@ AuthSocket::~AuthSocket()
 {
     if(patch_ != ACE_INVALID_HANDLE)
         ACE_OS::close(patch_);
+
+    if (_pendingJob)
+        _pendingJob->Detach();
 }
 
 /// Accept the connection and set the s random value for SRP6
@@ -205,12 +210,26 @@ void AuthSocket::OnAccept()
     BASIC_LOG("Accepting connection from '%s'", get_remote_address().c_str());
 }
 
+/// Result of a job still running is not needed anymore
+void AuthSocket::OnClose()
+{
+    if (_pendingJob)
+    {
+        _pendingJob->Detach();
+        _pendingJob = NULL;
+    }
+}
+
 /// Read the packet from the client
 void AuthSocket::OnRead()
 {
     uint8 _cmd;
     while (1)
     {
+        // next command is processed after result of previous one is sent
+        if (_pendingJob)
+            return;
+
         if(!recv_soft((char *)&_cmd, 1))
             return;
 
@@ -246,10 +265,23 @@ void AuthSocket::OnRead()
     }
 }
 
+void AuthSocket::StartJob(AuthJob* job)
+{
+    _pendingJob = job;
+    sAuthWorkerPool.Enqueue(job);
+}
+
+bool AuthSocket::CompleteJob(AuthJob* job)
+{
+    MANGOS_ASSERT(job == _pendingJob);
+    _pendingJob = NULL;
+    return job->Complete(*this);
+}
+
 /// Make the SRP6 calculation from hash in dB
-void AuthSocket::_SetVSFields(const std::string& rI)
+static void CalculateVSFields(const std::string& rI, const std::string& safelogin, BigNumber& N, BigNumber& g, BigNumber& s, BigNumber& v)
 {
-    s.SetRand(s_BYTE_SIZE * 8);
+    s.SetRand(AuthSocket::s_BYTE_SIZE * 8);
 
     BigNumber I;
     I.SetHexStr(rI.c_str());
@@ -273,7 +305,7 @@ void AuthSocket::_SetVSFields(const std::string& rI)
     const char *v_hex, *s_hex;
     v_hex = v.AsHexStr();
     s_hex = s.AsHexStr();
-    LoginDatabase.PExecute("UPDATE account SET v = '%s', s = '%s' WHERE username = '%s'", v_hex, s_hex, _safelogin.c_str() );
+    LoginDatabase.PExecute("UPDATE account SET v = '%s', s = '%s' WHERE username = '%s'", v_hex, s_hex, safelogin.c_str() );
     OPENSSL_free((void*)v_hex);
     OPENSSL_free((void*)s_hex);
 }
@@ -320,242 +352,228 @@ void AuthSocket::SendProof(Sha1Hash sha)
     }
 }
 
-/// Logon Challenge command handler
-bool AuthSocket::_HandleLogonChallenge()
+/// Account checks and SRP6 challenge of CMD_AUTH_LOGON_CHALLENGE
+class LogonChallengeJob : public AuthJob
 {
-    DEBUG_LOG("Entering _HandleLogonChallenge");
-    if (recv_len() < sizeof(sAuthLogonChallenge_C))
-        return false;
-
-    ///- Read the first 4 bytes (header) to get the length of the remaining of the packet
-    std::vector<uint8> buf;
-    buf.resize(4);
-
-    recv((char *)&buf[0], 4);
-
-    EndianConvert(*((uint16*)(buf[0])));
-    uint16 remaining = ((sAuthLogonChallenge_C *)&buf[0])->size;
-    DEBUG_LOG("[AuthChallenge] got header, body is %#04x bytes", remaining);
-
-    if ((remaining < sizeof(sAuthLogonChallenge_C) - buf.size()) || (recv_len() < remaining))
-        return false;
+    public:
+        LogonChallengeJob(AuthSocket* socket, uint8 const* country) : AuthJob(socket),
+            m_login(socket->_login), m_safelogin(socket->_safelogin), m_address(socket->get_remote_address()),
+            m_N(socket->N), m_g(socket->g), m_result(WOW_FAIL_UNKNOWN0), m_securityLevel(SEC_PLAYER)
+        {
+            m_safeAddress = m_address;
+            LoginDatabase.escape_string(m_safeAddress);
 
-    //No big fear of memory outage (size is int16, i.e. < 65536)
-    buf.resize(remaining + buf.size() + 1);
-    buf[buf.size() - 1] = 0;
-    sAuthLogonChallenge_C *ch = (sAuthLogonChallenge_C*)&buf[0];
+            m_localizationName.resize(4);
+            for (int i = 0; i < 4; ++i)
+                m_localizationName[i] = country[4-i-1];
+        }
 
-    ///- Read the remaining of the packet
-    recv((char *)&buf[4], remaining);
-    DEBUG_LOG("[AuthChallenge] got full packet, %#04x bytes", ch->size);
-    DEBUG_LOG("[AuthChallenge] name(%d): '%s'", ch->I_len, ch->I);
+        void Execute();
+        bool Complete(AuthSocket& socket);
 
-    // BigEndian code, nop in little endian case
-    // size already converted
-    EndianConvert(*((uint32*)(&ch->gamename[0])));
-    EndianConvert(ch->build);
-    EndianConvert(*((uint32*)(&ch->platform[0])));
-    EndianConvert(*((uint32*)(&ch->os[0])));
-    EndianConvert(*((uint32*)(&ch->country[0])));
-    EndianConvert(ch->timezone_bias);
-    EndianConvert(ch->ip);
+    private:
+        void CheckAccount();
 
-    ByteBuffer pkt;
+        std::string m_login;
+        std::string m_safelogin;
+        std::string m_address;
+        std::string m_safeAddress;
+        std::string m_localizationName;
+        BigNumber m_N, m_g;
 
-    _login = (const char*)ch->I;
-    _build = ch->build;
-    _os = (const char*)ch->os;
+        AuthResult m_result;
+        AccountTypes m_securityLevel;
+        BigNumber m_s, m_v, m_b, m_B;
+};
 
-    if(_os.size() > 4)
-        return false;
+void LogonChallengeJob::Execute()
+{
+    CheckAccount();
 
-    ///- Normalize account name
-    //utf8ToUpperOnlyLatin(_login); -- client already send account in expected form
+    if (m_result != WOW_SUCCESS)
+        return;
 
-    //Escape the user login to avoid further SQL injection
-    //Memory will be freed on AuthSocket object destruction
-    _safelogin = _login;
-    LoginDatabase.escape_string(_safelogin);
+    m_b.SetRand(19 * 8);
+    BigNumber gmod = m_g.ModExp(m_b, m_N);
+    m_B = ((m_v * 3) + gmod) % m_N;
 
-    // Starting CMD_AUTH_LOGON_CHALLENGE
-    AuthResult result = WOW_FAIL_UNKNOWN0;
+    MANGOS_ASSERT(gmod.GetNumBytes() <= 32);
+}
 
+void LogonChallengeJob::CheckAccount()
+{
     ///- Verify that this IP is not in the ip_banned table
     // No SQL injection possible (paste the IP address as passed by the socket)
-    std::string address = get_remote_address();
-    LoginDatabase.escape_string(address);
     QueryResult* qresult = LoginDatabase.PQuery("SELECT unbandate FROM ip_banned WHERE "
     //    permanent                    still banned
-        "(unbandate = bandate OR unbandate > UNIX_TIMESTAMP()) AND ip = '%s'", address.c_str());
+        "(unbandate = bandate OR unbandate > UNIX_TIMESTAMP()) AND ip = '%s'", m_safeAddress.c_str());
 
     if (qresult)
     {
-        result = WOW_FAIL_BANNED;
-        BASIC_LOG("[AuthChallenge] Banned ip %s tries to login!", get_remote_address().c_str());
+        m_result = WOW_FAIL_BANNED;
+        BASIC_LOG("[AuthChallenge] Banned ip %s tries to login!", m_address.c_str());
         delete qresult;
+        return;
     }
-    else
-    {
-        ///- Get the account details from the account table
-        // No SQL injection (escaped user name)
 
-        //qresult = LoginDatabase.PQuery("SELECT sha_pass_hash,id,locked,last_ip,gmlevel,v,s FROM account WHERE username = '%s'",_safelogin.c_str());
-        qresult = LoginDatabase.PQuery("SELECT a.sha_pass_hash,a.id,a.locked,a.last_ip,aa.gmlevel,a.v,a.s FROM account a LEFT JOIN account_access aa ON (a.id = aa.id) WHERE username = '%s'", _safelogin.c_str());
+    ///- Get the account details from the account table
+    // No SQL injection (escaped user name)
+    qresult = LoginDatabase.PQuery("SELECT a.sha_pass_hash,a.id,a.locked,a.last_ip,aa.gmlevel,a.v,a.s FROM account a LEFT JOIN account_access aa ON (a.id = aa.id) WHERE username = '%s'", m_safelogin.c_str());
 
-        if (qresult)
+    if (qresult)
+    {
+        ///- If the IP is 'locked', check that the player comes indeed from the correct IP address
+        bool locked = false;
+        if ((*qresult)[2].GetUInt8() == 1)                // if ip is locked
         {
-            ///- If the IP is 'locked', check that the player comes indeed from the correct IP address
-            bool locked = false;
-            if ((*qresult)[2].GetUInt8() == 1)                // if ip is locked
+            DEBUG_LOG("[AuthChallenge] Account '%s' is locked to IP - '%s'", m_login.c_str(), (*qresult)[3].GetString());
+            DEBUG_LOG("[AuthChallenge] Player address is '%s'", m_address.c_str());
+            if ( strcmp((*qresult)[3].GetString(), m_address.c_str()) )
             {
-                DEBUG_LOG("[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), (*qresult)[3].GetString());
-                DEBUG_LOG("[AuthChallenge] Player address is '%s'", get_remote_address().c_str());
-                if ( strcmp((*qresult)[3].GetString(),get_remote_address().c_str()) )
-                {
-                    DEBUG_LOG("[AuthChallenge] Account IP differs");
-                    result = WOW_FAIL_SUSPENDED;
-                    locked = true;
-                }
-                else
-                {
-                    DEBUG_LOG("[AuthChallenge] Account IP matches");
-                }
+                DEBUG_LOG("[AuthChallenge] Account IP differs");
+                m_result = WOW_FAIL_SUSPENDED;
+                locked = true;
             }
             else
             {
-                DEBUG_LOG("[AuthChallenge] Account '%s' is not locked to ip", _login.c_str());
+                DEBUG_LOG("[AuthChallenge] Account IP matches");
             }
+        }
+        else
+        {
+            DEBUG_LOG("[AuthChallenge] Account '%s' is not locked to ip", m_login.c_str());
+        }
 
-            if (!locked)
+        if (!locked)
+        {
+            uint32 accId = (*qresult)[1].GetUInt32();
+            ///- If the account is banned, reject the logon attempt
+            QueryResult* banresult = LoginDatabase.PQuery("SELECT bandate,unbandate FROM account_banned WHERE "
+                "id = %u AND active = 1 AND (unbandate > UNIX_TIMESTAMP() OR unbandate = bandate)", accId);
+            if (banresult)
             {
-                uint32 accId = (*qresult)[1].GetUInt32();
-                ///- If the account is banned, reject the logon attempt
-                QueryResult* banresult = LoginDatabase.PQuery("SELECT bandate,unbandate FROM account_banned WHERE "
-                    "id = %u AND active = 1 AND (unbandate > UNIX_TIMESTAMP() OR unbandate = bandate)", accId);
-                if (banresult)
+                if ((*banresult)[0].GetUInt64() == (*banresult)[1].GetUInt64())
                 {
-                    if ((*banresult)[0].GetUInt64() == (*banresult)[1].GetUInt64())
-                    {
-                        result = WOW_FAIL_BANNED;
-                        BASIC_LOG("[AuthChallenge] Banned account %s (Id: %u) tries to login!", _login.c_str(), accId);
-                    }
-                    else
-                    {
-                        result = WOW_FAIL_SUSPENDED;
-                        BASIC_LOG("[AuthChallenge] Temporarily banned account %s (Id: %u) tries to login!",_login.c_str(), accId);
-                    }
-
-                    delete banresult;
+                    m_result = WOW_FAIL_BANNED;
+                    BASIC_LOG("[AuthChallenge] Banned account %s (Id: %u) tries to login!", m_login.c_str(), accId);
                 }
                 else
                 {
-                    ///- Get the password from the account table, upper it, and make the SRP6 calculation
-                    std::string rI = (*qresult)[0].GetCppString();
+                    m_result = WOW_FAIL_SUSPENDED;
+                    BASIC_LOG("[AuthChallenge] Temporarily banned account %s (Id: %u) tries to login!", m_login.c_str(), accId);
+                }
 
-                    ///- Don't calculate (v, s) if there are already some in the database
-                    std::string databaseV = (*qresult)[5].GetCppString();
-                    std::string databaseS = (*qresult)[6].GetCppString();
+                delete banresult;
+            }
+            else
+            {
+                ///- Get the password from the account table, upper it, and make the SRP6 calculation
+                std::string rI = (*qresult)[0].GetCppString();
 
-                    DEBUG_LOG("database authentication values: v='%s' s='%s'", databaseV.c_str(), databaseS.c_str());
+                ///- Don't calculate (v, s) if there are already some in the database
+                std::string databaseV = (*qresult)[5].GetCppString();
+                std::string databaseS = (*qresult)[6].GetCppString();
 
-                    // multiply with 2, bytes are stored as hexstring
-                    if (databaseV.size() != s_BYTE_SIZE*2 || databaseS.size() != s_BYTE_SIZE*2)
-                        _SetVSFields(rI);
-                    else
-                    {
-                        s.SetHexStr(databaseS.c_str());
-                        v.SetHexStr(databaseV.c_str());
-                    }
+                DEBUG_LOG("database authentication values: v='%s' s='%s'", databaseV.c_str(), databaseS.c_str());
 
-                    result = WOW_SUCCESS;
+                // multiply with 2, bytes are stored as hexstring
+                if (databaseV.size() != AuthSocket::s_BYTE_SIZE*2 || databaseS.size() != AuthSocket::s_BYTE_SIZE*2)
+                    CalculateVSFields(rI, m_safelogin, m_N, m_g, m_s, m_v);
+                else
+                {
+                    m_s.SetHexStr(databaseS.c_str());
+                    m_v.SetHexStr(databaseV.c_str());
+                }
 
-                    uint8 secLevel = (*qresult)[4].GetUInt8();
-                    _accountSecurityLevel = secLevel <= SEC_ADMINISTRATOR ? AccountTypes(secLevel) : SEC_ADMINISTRATOR;
+                m_result = WOW_SUCCESS;
 
-                    _localizationName.resize(4);
-                    for (int i = 0; i < 4; ++i)
-                        _localizationName[i] = ch->country[4-i-1];
+                uint8 secLevel = (*qresult)[4].GetUInt8();
+                m_securityLevel = secLevel <= SEC_ADMINISTRATOR ? AccountTypes(secLevel) : SEC_ADMINISTRATOR;
 
-                    BASIC_LOG("[AuthChallenge] account %s (Id: %u) is using '%c%c%c%c' locale (%u)", _login.c_str (), accId, ch->country[3], ch->country[2], ch->country[1], ch->country[0], GetLocaleByName(_localizationName));
-                }
+                BASIC_LOG("[AuthChallenge] account %s (Id: %u) is using '%s' locale (%u)", m_login.c_str (), accId, m_localizationName.c_str(), GetLocaleByName(m_localizationName));
             }
-            delete qresult;
         }
-        else if (sConfig.GetBoolDefault("AutoRegistration", false))
+        delete qresult;
+    }
+    else if (sConfig.GetBoolDefault("AutoRegistration", false))
+    {
+        if (m_safelogin.find_first_of("\t\v\b\f\a\n\r\\\"\'\? <>[](){}_=+-|/!@#$%^&*~`.,\0") == m_safelogin.npos && m_safelogin.length() > 3)
         {
-            if (_safelogin.find_first_of("\t\v\b\f\a\n\r\\\"\'\? <>[](){}_=+-|/!@#$%^&*~`.,\0") == _safelogin.npos && _safelogin.length() > 3)
-            {
-                QueryResult* checkIPresult = LoginDatabase.PQuery("SELECT COUNT(last_ip) FROM account WHERE last_ip = '%s'",get_remote_address().c_str());
-
-                int32 regCount = checkIPresult ? (*checkIPresult)[0].GetUInt32() : 0;
-
-                if (regCount >= sConfig.GetIntDefault("AutoRegistration.Amount", 1))
-                {
-                    BASIC_LOG("[AuthChallenge] Impossible auto-register account %s, number of auto-registered accouts is %u, but allowed only %u",
-                         _safelogin.c_str(),regCount, sConfig.GetIntDefault("AutoRegistration.Amount", 1));
-//                    result = WOW_FAIL_DB_BUSY;
-                    result = WOW_FAIL_DISCONNECTED;
-                }
-                else
-                {
-                    std::transform(_safelogin.begin(), _safelogin.end(), _safelogin.begin(), std::towupper); 
+            QueryResult* checkIPresult = LoginDatabase.PQuery("SELECT COUNT(last_ip) FROM account WHERE last_ip = '%s'", m_safeAddress.c_str());
 
-                    Sha1Hash sha;
-                    sha.Initialize();
-                    sha.UpdateData(_safelogin);
-                    sha.UpdateData(":");
-                    sha.UpdateData(_safelogin);
-                    sha.Finalize();
+            int32 regCount = checkIPresult ? (*checkIPresult)[0].GetUInt32() : 0;
 
-                    std::string encoded;
-                    hexEncodeByteArray(sha.GetDigest(), sha.GetLength(), encoded);
+            if (regCount >= sConfig.GetIntDefault("AutoRegistration.Amount", 1))
+            {
+                BASIC_LOG("[AuthChallenge] Impossible auto-register account %s, number of auto-registered accouts is %u, but allowed only %u",
+                     m_safelogin.c_str(),regCount, sConfig.GetIntDefault("AutoRegistration.Amount", 1));
+//                m_result = WOW_FAIL_DB_BUSY;
+                m_result = WOW_FAIL_DISCONNECTED;
+            }
+            else
+            {
+                std::transform(m_safelogin.begin(), m_safelogin.end(), m_safelogin.begin(), std::towupper);
 
-                    LoginDatabase.PExecute("INSERT INTO account(username,sha_pass_hash,joindate) VALUES('%s','%s',NOW())", _safelogin.c_str(), encoded.c_str());
+                Sha1Hash sha;
+                sha.Initialize();
+                sha.UpdateData(m_safelogin);
+                sha.UpdateData(":");
+                sha.UpdateData(m_safelogin);
+                sha.Finalize();
 
-                    _SetVSFields(encoded);
+                std::string encoded;
+                hexEncodeByteArray(sha.GetDigest(), sha.GetLength(), encoded);
 
-                    BASIC_LOG("[AuthChallenge] account %s auto-registered (count %u)!",_safelogin.c_str(), ++regCount);
+                LoginDatabase.PExecute("INSERT INTO account(username,sha_pass_hash,joindate) VALUES('%s','%s',NOW())", m_safelogin.c_str(), encoded.c_str());
 
-                    result = WOW_SUCCESS;
-                    _accountSecurityLevel = SEC_PLAYER;
+                CalculateVSFields(encoded, m_safelogin, m_N, m_g, m_s, m_v);
 
-                    _localizationName.resize(4);
-                    for (int i = 0; i < 4; ++i)
-                        _localizationName[i] = ch->country[4-i-1];
-                }
+                BASIC_LOG("[AuthChallenge] account %s auto-registered (count %u)!", m_safelogin.c_str(), ++regCount);
 
-                if (checkIPresult)
-                    delete checkIPresult;
+                m_result = WOW_SUCCESS;
+                m_securityLevel = SEC_PLAYER;
             }
+
+            if (checkIPresult)
+                delete checkIPresult;
         }
-        else
-            result = WOW_FAIL_UNKNOWN_ACCOUNT;
     }
+    else
+        m_result = WOW_FAIL_UNKNOWN_ACCOUNT;
+}
+
+bool LogonChallengeJob::Complete(AuthSocket& socket)
+{
+    ByteBuffer pkt;
 
     pkt << uint8(CMD_AUTH_LOGON_CHALLENGE);
     pkt << uint8(0x00);
-    pkt << uint8(result);
+    pkt << uint8(m_result);
 
-    switch (result)
+    switch (m_result)
     {
         case WOW_SUCCESS:
         {
-            b.SetRand(19 * 8);
-            BigNumber gmod = g.ModExp(b, N);
-            B = ((v * 3) + gmod) % N;
+            socket.s = m_s;
+            socket.v = m_v;
+            socket.b = m_b;
+            socket.B = m_B;
+            socket._accountSecurityLevel = m_securityLevel;
+            socket._localizationName = m_localizationName;
 
-            MANGOS_ASSERT(gmod.GetNumBytes() <= 32);
+            // auto registration uses upper cased name
+            socket._safelogin = m_safelogin;
 
             BigNumber unk3;
             unk3.SetRand(16 * 8);
 
             // B may be calculated < 32B so we force minimal length to 32B
-            pkt.append(B.AsByteArray(32), 32);      // 32 bytes
+            pkt.append(socket.B.AsByteArray(32), 32);      // 32 bytes
             pkt << uint8(1);
-            pkt.append(g.AsByteArray(), 1);
+            pkt.append(socket.g.AsByteArray(), 1);
             pkt << uint8(32);
-            pkt.append(N.AsByteArray(32), 32);
-            pkt.append(s.AsByteArray(), s.GetNumBytes());// 32 bytes
+            pkt.append(socket.N.AsByteArray(32), 32);
+            pkt.append(socket.s.AsByteArray(), socket.s.GetNumBytes());// 32 bytes
             pkt.append(unk3.AsByteArray(16), 16);
             uint8 securityFlags = 0;
             pkt << uint8(securityFlags);            // security flags (0x0...0x04)
@@ -608,101 +626,115 @@ bool AuthSocket::_HandleLogonChallenge()
         case WOW_FAIL_DISCONNECTED:
             break;
         default:
-            BASIC_LOG("[AuthChallenge] unknown CMD_AUTH_LOGON_CHALLENGE execution result %u!", result);
+            BASIC_LOG("[AuthChallenge] unknown CMD_AUTH_LOGON_CHALLENGE execution result %u!", m_result);
             break;
     }
 
-    send((char const*)pkt.contents(), pkt.size());
+    socket.send((char const*)pkt.contents(), pkt.size());
     return true;
 }
 
-/// Logon Proof command handler
-bool AuthSocket::_HandleLogonProof()
+/// Logon Challenge command handler
+bool AuthSocket::_HandleLogonChallenge()
 {
-    DEBUG_LOG("Entering _HandleLogonProof");
-    ///- Read the packet
-    sAuthLogonProof_C lp;
-    if (!recv((char *)&lp, sizeof(sAuthLogonProof_C)))
+    DEBUG_LOG("Entering _HandleLogonChallenge");
+    if (recv_len() < sizeof(sAuthLogonChallenge_C))
         return false;
 
-    ///- Check if the client has one of the expected version numbers
-    bool valid_version = FindBuildInfo(_build) != NULL;
+    ///- Read the first 4 bytes (header) to get the length of the remaining of the packet
+    std::vector<uint8> buf;
+    buf.resize(4);
 
-    /// <ul><li> If the client has no valid version
-    if (!valid_version)
-    {
-        if (this->patch_ != ACE_INVALID_HANDLE)
-            return false;
+    recv((char *)&buf[0], 4);
 
-        ///- Check if we have the apropriate patch on the disk
-        // file looks like: 65535enGB.mpq
-        char tmp[64];
+    EndianConvert(*((uint16*)(buf[0])));
+    uint16 remaining = ((sAuthLogonChallenge_C *)&buf[0])->size;
+    DEBUG_LOG("[AuthChallenge] got header, body is %#04x bytes", remaining);
 
-        snprintf(tmp, 24, "./patches/%d%s.mpq", _build, _localizationName.c_str());
+    if ((remaining < sizeof(sAuthLogonChallenge_C) - buf.size()) || (recv_len() < remaining))
+        return false;
 
-        char filename[PATH_MAX];
-        if (ACE_OS::realpath(tmp, filename) != NULL)
-        {
-            patch_ = ACE_OS::open(filename, GENERIC_READ | FILE_FLAG_SEQUENTIAL_SCAN);
-        }
+    //No big fear of memory outage (size is int16, i.e. < 65536)
+    buf.resize(remaining + buf.size() + 1);
+    buf[buf.size() - 1] = 0;
+    sAuthLogonChallenge_C *ch = (sAuthLogonChallenge_C*)&buf[0];
 
-        if (patch_ == ACE_INVALID_HANDLE)
-        {
-            // no patch found
-            ByteBuffer pkt;
-            pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
-            pkt << (uint8) 0x00;
-            pkt << (uint8) WOW_FAIL_VERSION_INVALID;
-            DEBUG_LOG("[AuthChallenge] %u is not a valid client version!", _build);
-            DEBUG_LOG("[AuthChallenge] Patch %s not found", tmp);
-            send((char const*)pkt.contents(), pkt.size());
-            return true;
-        }
+    ///- Read the remaining of the packet
+    recv((char *)&buf[4], remaining);
+    DEBUG_LOG("[AuthChallenge] got full packet, %#04x bytes", ch->size);
+    DEBUG_LOG("[AuthChallenge] name(%d): '%s'", ch->I_len, ch->I);
 
-        XFER_INIT xferh;
+    // BigEndian code, nop in little endian case
+    // size already converted
+    EndianConvert(*((uint32*)(&ch->gamename[0])));
+    EndianConvert(ch->build);
+    EndianConvert(*((uint32*)(&ch->platform[0])));
+    EndianConvert(*((uint32*)(&ch->os[0])));
+    EndianConvert(*((uint32*)(&ch->country[0])));
+    EndianConvert(ch->timezone_bias);
+    EndianConvert(ch->ip);
 
-        ACE_OFF_T file_size = ACE_OS::filesize(this->patch_);
+    _login = (const char*)ch->I;
+    _build = ch->build;
+    _os = (const char*)ch->os;
 
-        if (file_size == -1)
-        {
-            close_connection();
-            return false;
-        }
+    if(_os.size() > 4)
+        return false;
 
-        if (!PatchCache::instance()->GetHash(tmp, (uint8*)&xferh.md5))
-        {
-            // calculate patch md5, happens if patch was added while realmd was running
-            PatchCache::instance()->LoadPatchMD5(tmp);
-            PatchCache::instance()->GetHash(tmp, (uint8*)&xferh.md5);
-        }
+    ///- Normalize account name
+    //utf8ToUpperOnlyLatin(_login); -- client already send account in expected form
 
-        uint8 data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_VERSION_UPDATE};
-        send((const char*)data, sizeof(data));
+    //Escape the user login to avoid further SQL injection
+    //Memory will be freed on AuthSocket object destruction
+    _safelogin = _login;
+    LoginDatabase.escape_string(_safelogin);
 
-        memcpy(&xferh, "0\x05Patch", 7);
-        xferh.cmd = CMD_XFER_INITIATE;
-        xferh.file_size = file_size;
+    ///- Database checks and SRP6 math are done by auth worker threads, answer is sent at job completion
+    StartJob(new LogonChallengeJob(this, ch->country));
+    return true;
+}
 
-        send((const char*)&xferh, sizeof(xferh));
-        return true;
-    }
-    /// </ul>
+/// SRP6 verification of CMD_AUTH_LOGON_PROOF
+class LogonProofJob : public AuthJob
+{
+    public:
+        LogonProofJob(AuthSocket* socket, BigNumber const& A, uint8 const* M1) : AuthJob(socket),
+            m_login(socket->_login), m_safelogin(socket->_safelogin), m_address(socket->get_remote_address()),
+            m_os(socket->_os), m_locale(GetLocaleByName(socket->_localizationName)),
+            m_N(socket->N), m_g(socket->g), m_s(socket->s), m_v(socket->v), m_b(socket->b), m_B(socket->B), m_A(A),
+            m_authed(false)
+        {
+            memcpy(m_M1, M1, sizeof(m_M1));
+            LoginDatabase.escape_string(m_address);
+        }
 
-    ///- Continue the SRP6 calculation based on data received from the client
-    BigNumber A;
+        void Execute();
+        bool Complete(AuthSocket& socket);
 
-    A.SetBinary(lp.A, 32);
+    private:
+        void FailedLogin();
 
-    // SRP safeguard: abort if A==0
-    if (A.isZero())
-        return false;
+        std::string m_login;
+        std::string m_safelogin;
+        std::string m_address;
+        std::string m_os;
+        uint32 m_locale;
+        BigNumber m_N, m_g, m_s, m_v, m_b, m_B, m_A;
+        uint8 m_M1[20];
+
+        bool m_authed;
+        BigNumber m_K;
+        Sha1Hash m_proof;
+};
 
+void LogonProofJob::Execute()
+{
     Sha1Hash sha;
-    sha.UpdateBigNumbers(&A, &B, NULL);
+    sha.UpdateBigNumbers(&m_A, &m_B, NULL);
     sha.Finalize();
     BigNumber u;
     u.SetBinary(sha.GetDigest(), 20);
-    BigNumber S = (A * (v.ModExp(u, N))).ModExp(b, N);
+    BigNumber S = (m_A * (m_v.ModExp(u, m_N))).ModExp(m_b, m_N);
 
     uint8 t[32];
     uint8 t1[16];
@@ -730,16 +762,16 @@ bool AuthSocket::_HandleLogonProof()
     {
         vK[i * 2 + 1] = sha.GetDigest()[i];
     }
-    K.SetBinary(vK, 40);
+    m_K.SetBinary(vK, 40);
 
     uint8 hash[20];
 
     sha.Initialize();
-    sha.UpdateBigNumbers(&N, NULL);
+    sha.UpdateBigNumbers(&m_N, NULL);
     sha.Finalize();
     memcpy(hash, sha.GetDigest(), 20);
     sha.Initialize();
-    sha.UpdateBigNumbers(&g, NULL);
+    sha.UpdateBigNumbers(&m_g, NULL);
     sha.Finalize();
     for (int i = 0; i < 20; ++i)
     {
@@ -749,7 +781,7 @@ bool AuthSocket::_HandleLogonProof()
     t3.SetBinary(hash, 20);
 
     sha.Initialize();
-    sha.UpdateData(_login);
+    sha.UpdateData(m_login);
     sha.Finalize();
     uint8 t4[SHA_DIGEST_LENGTH];
     memcpy(t4, sha.GetDigest(), SHA_DIGEST_LENGTH);
@@ -757,88 +789,235 @@ bool AuthSocket::_HandleLogonProof()
     sha.Initialize();
     sha.UpdateBigNumbers(&t3, NULL);
     sha.UpdateData(t4, SHA_DIGEST_LENGTH);
-    sha.UpdateBigNumbers(&s, &A, &B, &K, NULL);
+    sha.UpdateBigNumbers(&m_s, &m_A, &m_B, &m_K, NULL);
     sha.Finalize();
     BigNumber M;
     M.SetBinary(sha.GetDigest(), 20);
 
-    ///- Check if SRP6 results match (password is correct), else send an error
-    if (!memcmp(M.AsByteArray(), lp.M1, 20))
+    ///- Check if SRP6 results match (password is correct)
+    if (memcmp(M.AsByteArray(), m_M1, 20))
     {
-        BASIC_LOG("User '%s' successfully authenticated", _login.c_str());
+        FailedLogin();
+        return;
+    }
 
-        ///- Update the sessionkey, last_ip, last login time and reset number of failed logins in the account table for this account
-        // No SQL injection (escaped user name) and IP address as received by socket
-        const char* K_hex = K.AsHexStr();
-        LoginDatabase.PExecute("UPDATE account SET sessionkey = '%s', last_ip = '%s', last_login = NOW(), locale = '%u', os = '%s', failed_logins = 0 WHERE username = '%s'", K_hex, get_remote_address().c_str(), GetLocaleByName(_localizationName), _os.c_str(), _safelogin.c_str() );
-        OPENSSL_free((void*)K_hex);
+    BASIC_LOG("User '%s' successfully authenticated", m_login.c_str());
 
-        ///- Finish SRP6 and send the final result to the client
-        sha.Initialize();
-        sha.UpdateBigNumbers(&A, &M, &K, NULL);
-        sha.Finalize();
+    ///- Update the sessionkey, last_ip, last login time and reset number of failed logins in the account table for this account
+    // No SQL injection (escaped user name) and IP address as received by socket
+    const char* K_hex = m_K.AsHexStr();
+    LoginDatabase.PExecute("UPDATE account SET sessionkey = '%s', last_ip = '%s', last_login = NOW(), locale = '%u', os = '%s', failed_logins = 0 WHERE username = '%s'", K_hex, m_address.c_str(), m_locale, m_os.c_str(), m_safelogin.c_str() );
+    OPENSSL_free((void*)K_hex);
 
-        SendProof(sha);
+    ///- Finish SRP6, the final result is sent to the client at completion
+    m_proof.Initialize();
+    m_proof.UpdateBigNumbers(&m_A, &M, &m_K, NULL);
+    m_proof.Finalize();
+
+    m_authed = true;
+}
+
+void LogonProofJob::FailedLogin()
+{
+    BASIC_LOG("[AuthChallenge] account %s tried to login with wrong password!", m_login.c_str ());
+
+    uint32 MaxWrongPassCount = sConfig.GetIntDefault("WrongPass.MaxCount", 0);
+    if (MaxWrongPassCount == 0)
+        return;
+
+    //Increment number of failed logins by one and if it reaches the limit temporarily ban that account or IP
+    LoginDatabase.PExecute("UPDATE account SET failed_logins = failed_logins + 1 WHERE username = '%s'", m_safelogin.c_str());
+
+    if (QueryResult *loginfail = LoginDatabase.PQuery("SELECT id, failed_logins FROM account WHERE username = '%s'", m_safelogin.c_str()))
+    {
+        Field* fields = loginfail->Fetch();
+        uint32 failed_logins = fields[1].GetUInt32();
+
+        if ( failed_logins >= MaxWrongPassCount )
+        {
+            uint32 WrongPassBanTime = sConfig.GetIntDefault("WrongPass.BanTime", 600);
+            bool WrongPassBanType = sConfig.GetBoolDefault("WrongPass.BanType", false);
+
+            if (WrongPassBanType)
+            {
+                uint32 acc_id = fields[0].GetUInt32();
+                LoginDatabase.PExecute("INSERT INTO account_banned VALUES ('%u',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban',1)",
+                    acc_id, WrongPassBanTime);
+                BASIC_LOG("[AuthChallenge] account %s got banned for '%u' seconds because it failed to authenticate '%u' times",
+                    m_login.c_str(), WrongPassBanTime, failed_logins);
+            }
+            else
+            {
+                LoginDatabase.PExecute("INSERT INTO ip_banned VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban')",
+                    m_address.c_str(), WrongPassBanTime);
+                BASIC_LOG("[AuthChallenge] IP %s got banned for '%u' seconds because account %s failed to authenticate '%u' times",
+                    m_address.c_str(), WrongPassBanTime, m_login.c_str(), failed_logins);
+            }
+        }
+        delete loginfail;
+    }
+}
+
+bool LogonProofJob::Complete(AuthSocket& socket)
+{
+    if (m_authed)
+    {
+        socket.K = m_K;
+        socket.SendProof(m_proof);
 
         ///- Set _authed to true!
-        _authed = true;
+        socket._authed = true;
+    }
+    else if (socket._build > 6005)                          // > 1.12.2
+    {
+        char data[4] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT, 3, 0};
+        socket.send(data, sizeof(data));
     }
     else
     {
-        if (_build > 6005)                                  // > 1.12.2
+        // 1.x not react incorrectly at 4-byte message use 3 as real error
+        char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT};
+        socket.send(data, sizeof(data));
+    }
+
+    return true;
+}
+
+/// Logon Proof command handler
+bool AuthSocket::_HandleLogonProof()
+{
+    DEBUG_LOG("Entering _HandleLogonProof");
+    ///- Read the packet
+    sAuthLogonProof_C lp;
+    if (!recv((char *)&lp, sizeof(sAuthLogonProof_C)))
+        return false;
+
+    ///- Check if the client has one of the expected version numbers
+    bool valid_version = FindBuildInfo(_build) != NULL;
+
+    /// <ul><li> If the client has no valid version
+    if (!valid_version)
+    {
+        if (this->patch_ != ACE_INVALID_HANDLE)
+            return false;
+
+        ///- Check if we have the apropriate patch on the disk
+        // file looks like: 65535enGB.mpq
+        char tmp[64];
+
+        snprintf(tmp, 24, "./patches/%d%s.mpq", _build, _localizationName.c_str());
+
+        char filename[PATH_MAX];
+        if (ACE_OS::realpath(tmp, filename) != NULL)
         {
-            char data[4] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT, 3, 0};
-            send(data, sizeof(data));
+            patch_ = ACE_OS::open(filename, GENERIC_READ | FILE_FLAG_SEQUENTIAL_SCAN);
         }
-        else
+
+        if (patch_ == ACE_INVALID_HANDLE)
+        {
+            // no patch found
+            ByteBuffer pkt;
+            pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
+            pkt << (uint8) 0x00;
+            pkt << (uint8) WOW_FAIL_VERSION_INVALID;
+            DEBUG_LOG("[AuthChallenge] %u is not a valid client version!", _build);
+            DEBUG_LOG("[AuthChallenge] Patch %s not found", tmp);
+            send((char const*)pkt.contents(), pkt.size());
+            return true;
+        }
+
+        XFER_INIT xferh;
+
+        ACE_OFF_T file_size = ACE_OS::filesize(this->patch_);
+
+        if (file_size == -1)
         {
-            // 1.x not react incorrectly at 4-byte message use 3 as real error
-            char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT};
-            send(data, sizeof(data));
+            close_connection();
+            return false;
         }
-        BASIC_LOG("[AuthChallenge] account %s tried to login with wrong password!",_login.c_str ());
 
-        uint32 MaxWrongPassCount = sConfig.GetIntDefault("WrongPass.MaxCount", 0);
-        if (MaxWrongPassCount > 0)
+        if (!PatchCache::instance()->GetHash(tmp, (uint8*)&xferh.md5))
         {
-            //Increment number of failed logins by one and if it reaches the limit temporarily ban that account or IP
-            LoginDatabase.PExecute("UPDATE account SET failed_logins = failed_logins + 1 WHERE username = '%s'",_safelogin.c_str());
+            // calculate patch md5, happens if patch was added while realmd was running
+            PatchCache::instance()->LoadPatchMD5(tmp);
+            PatchCache::instance()->GetHash(tmp, (uint8*)&xferh.md5);
+        }
 
-            if (QueryResult *loginfail = LoginDatabase.PQuery("SELECT id, failed_logins FROM account WHERE username = '%s'", _safelogin.c_str()))
-            {
-                Field* fields = loginfail->Fetch();
-                uint32 failed_logins = fields[1].GetUInt32();
+        uint8 data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_VERSION_UPDATE};
+        send((const char*)data, sizeof(data));
 
-                if ( failed_logins >= MaxWrongPassCount )
-                {
-                    uint32 WrongPassBanTime = sConfig.GetIntDefault("WrongPass.BanTime", 600);
-                    bool WrongPassBanType = sConfig.GetBoolDefault("WrongPass.BanType", false);
-
-                    if (WrongPassBanType)
-                    {
-                        uint32 acc_id = fields[0].GetUInt32();
-                        LoginDatabase.PExecute("INSERT INTO account_banned VALUES ('%u',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban',1)",
-                            acc_id, WrongPassBanTime);
-                        BASIC_LOG("[AuthChallenge] account %s got banned for '%u' seconds because it failed to authenticate '%u' times",
-                            _login.c_str(), WrongPassBanTime, failed_logins);
-                    }
-                    else
-                    {
-                        std::string current_ip = get_remote_address();
-                        LoginDatabase.escape_string(current_ip);
-                        LoginDatabase.PExecute("INSERT INTO ip_banned VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban')",
-                            current_ip.c_str(), WrongPassBanTime);
-                        BASIC_LOG("[AuthChallenge] IP %s got banned for '%u' seconds because account %s failed to authenticate '%u' times",
-                            current_ip.c_str(), WrongPassBanTime, _login.c_str(), failed_logins);
-                    }
-                }
-                delete loginfail;
-            }
-        }
+        memcpy(&xferh, "0\x05Patch", 7);
+        xferh.cmd = CMD_XFER_INITIATE;
+        xferh.file_size = file_size;
+
+        send((const char*)&xferh, sizeof(xferh));
+        return true;
     }
+    /// </ul>
+
+    ///- Continue the SRP6 calculation based on data received from the client
+    BigNumber A;
+
+    A.SetBinary(lp.A, 32);
+
+    // SRP safeguard: abort if A==0
+    if (A.isZero())
+        return false;
+
+    ///- SRP6 math and account update are done by auth worker threads, result is sent at job completion
+    StartJob(new LogonProofJob(this, A, lp.M1));
     return true;
 }
 
+/// Session key lookup of CMD_AUTH_RECONNECT_CHALLENGE
+class ReconnectChallengeJob : public AuthJob
+{
+    public:
+        explicit ReconnectChallengeJob(AuthSocket* socket) : AuthJob(socket),
+            m_login(socket->_login), m_safelogin(socket->_safelogin), m_found(false) {}
+
+        void Execute()
+        {
+            QueryResult *result = LoginDatabase.PQuery ("SELECT sessionkey FROM account WHERE username = '%s'", m_safelogin.c_str ());
+            if (!result)
+                return;
+
+            Field* fields = result->Fetch ();
+            m_K.SetHexStr (fields[0].GetString ());
+            m_found = true;
+            delete result;
+        }
+
+        bool Complete(AuthSocket& socket)
+        {
+            // Stop if the account is not found
+            if (!m_found)
+            {
+                sLog.outError("[ERROR] user %s tried to login and we cannot find his session key in the database.", m_login.c_str());
+                socket.close_connection();
+                return false;
+            }
+
+            socket.K = m_K;
+
+            ///- Sending response
+            ByteBuffer pkt;
+            pkt << (uint8)  CMD_AUTH_RECONNECT_CHALLENGE;
+            pkt << (uint8)  0x00;
+            socket._reconnectProof.SetRand(16 * 8);
+            pkt.append(socket._reconnectProof.AsByteArray(16),16);  // 16 bytes random
+            pkt << (uint64) 0x00 << (uint64) 0x00;          // 16 bytes zeros
+            socket.send((char const*)pkt.contents(), pkt.size());
+            return true;
+        }
+
+    private:
+        std::string m_login;
+        std::string m_safelogin;
+        bool m_found;
+        BigNumber m_K;
+};
+
 /// Reconnect Challenge command handler
 bool AuthSocket::_HandleReconnectChallenge()
 {
@@ -881,28 +1060,7 @@ bool AuthSocket::_HandleReconnectChallenge()
     if (_os.size() > 4)
         return false;
 
-    QueryResult *result = LoginDatabase.PQuery ("SELECT sessionkey FROM account WHERE username = '%s'", _safelogin.c_str ());
-
-    // Stop if the account is not found
-    if (!result)
-    {
-        sLog.outError("[ERROR] user %s tried to login and we cannot find his session key in the database.", _login.c_str());
-        close_connection();
-        return false;
-    }
-
-    Field* fields = result->Fetch ();
-    K.SetHexStr (fields[0].GetString ());
-    delete result;
-
-    ///- Sending response
-    ByteBuffer pkt;
-    pkt << (uint8)  CMD_AUTH_RECONNECT_CHALLENGE;
-    pkt << (uint8)  0x00;
-    _reconnectProof.SetRand(16 * 8);
-    pkt.append(_reconnectProof.AsByteArray(16),16);         // 16 bytes random
-    pkt << (uint64) 0x00 << (uint64) 0x00;                  // 16 bytes zeros
-    send((char const*)pkt.contents(), pkt.size());
+    StartJob(new ReconnectChallengeJob(this));
     return true;
 }
 
@@ -949,6 +1107,73 @@ bool AuthSocket::_HandleReconnectProof()
     }
 }
 
+/// Character counts of the account for CMD_REALM_LIST
+class RealmListJob : public AuthJob
+{
+    public:
+        explicit RealmListJob(AuthSocket* socket) : AuthJob(socket),
+            m_login(socket->_login), m_safelogin(socket->_safelogin), m_found(false) {}
+
+        void Execute()
+        {
+            ///- Get the user id (else close the connection)
+            // No SQL injection (escaped user name)
+            QueryResult *result = LoginDatabase.PQuery("SELECT id FROM account WHERE username = '%s'", m_safelogin.c_str());
+            if (!result)
+                return;
+
+            uint32 id = (*result)[0].GetUInt32();
+            delete result;
+
+            m_found = true;
+
+            ///- Character amounts of all realms at once, realms without row have no characters
+            result = LoginDatabase.PQuery("SELECT realmid, numchars FROM realmcharacters WHERE acctid = '%u'", id);
+            if (!result)
+                return;
+
+            do
+            {
+                Field* fields = result->Fetch();
+                m_counts[fields[0].GetUInt32()] = fields[1].GetUInt8();
+            }
+            while (result->NextRow());
+
+            delete result;
+        }
+
+        bool Complete(AuthSocket& socket)
+        {
+            if (!m_found)
+            {
+                sLog.outError("[ERROR] user %s tried to login and we cannot find him in the database.", m_login.c_str());
+                socket.close_connection();
+                return false;
+            }
+
+            ///- Update realm list if need
+            sRealmList.UpdateIfNeed();
+
+            ///- Circle through realms in the RealmList and construct the return packet (including # of user characters in each realm)
+            ByteBuffer pkt;
+            socket.LoadRealmlist(pkt, m_counts);
+
+            ByteBuffer hdr;
+            hdr << (uint8) CMD_REALM_LIST;
+            hdr << (uint16)pkt.size();
+            hdr.append(pkt);
+
+            socket.send((char const*)hdr.contents(), hdr.size());
+            return true;
+        }
+
+    private:
+        std::string m_login;
+        std::string m_safelogin;
+        bool m_found;
+        AuthSocket::RealmCharacterCounts m_counts;
+};
+
 /// %Realm List command handler
 bool AuthSocket::_HandleRealmList()
 {
@@ -958,66 +1183,48 @@ bool AuthSocket::_HandleRealmList()
 
     recv_skip(5);
 
-    ///- Get the user id (else close the connection)
-    // No SQL injection (escaped user name)
-
-    QueryResult *result = LoginDatabase.PQuery("SELECT id,sha_pass_hash FROM account WHERE username = '%s'",_safelogin.c_str());
-    if (!result)
-    {
-        sLog.outError("[ERROR] user %s tried to login and we cannot find him in the database.",_login.c_str());
-        close_connection();
-        return false;
-    }
-
-    uint32 id = (*result)[0].GetUInt32();
-    std::string rI = (*result)[1].GetCppString();
-    delete result;
-
-    ///- Update realm list if need
-    sRealmList.UpdateIfNeed();
+    StartJob(new RealmListJob(this));
+    return true;
+}
 
-    ///- Circle through realms in the RealmList and construct the return packet (including # of user characters in each realm)
-    ByteBuffer pkt;
-    LoadRealmlist(pkt, id);
+/**
+ * Realm list packet of one client build and account security level, split at the
+ * character amount of every realm, the only per account part of the packet.
+ * Rebuilt when the realm list is reloaded from the database.
+ */
+struct RealmListTemplate
+{
+    RealmListTemplate() : generation(0) {}
 
-    ByteBuffer hdr;
-    hdr << (uint8) CMD_REALM_LIST;
-    hdr << (uint16)pkt.size();
-    hdr.append(pkt);
+    uint32 generation;
+    std::vector<uint32> realmIds;
+    std::vector<ByteBuffer> parts;                          // realmIds.size() + 1 parts around the character amounts
+};
 
-    send((char const*)hdr.contents(), hdr.size());
+typedef std::map<uint32, RealmListTemplate> RealmListTemplateMap;
 
-    return true;
-}
+static RealmListTemplateMap s_realmListTemplates;           // by (build << 8 | security level), used in reactor thread only
 
-void AuthSocket::LoadRealmlist(ByteBuffer &pkt, uint32 acctid)
+static void BuildRealmListTemplate(RealmListTemplate& tmpl, uint16 build, AccountTypes securityLevel)
 {
-    switch(_build)
+    tmpl.generation = sRealmList.GetGeneration();
+    tmpl.realmIds.clear();
+    tmpl.parts.clear();
+    tmpl.parts.push_back(ByteBuffer());
+
+    switch(build)
     {
         case 5875:                                          // 1.12.1
         case 6005:                                          // 1.12.2
         {
-            pkt << uint32(0);                               // unused value
-            pkt << uint8(sRealmList.size());
+            tmpl.parts.back() << uint32(0);                 // unused value
+            tmpl.parts.back() << uint8(sRealmList.size());
 
             for (RealmList::RealmMap::const_iterator  i = sRealmList.begin(); i != sRealmList.end(); ++i)
             {
-                uint8 AmountOfCharacters;
+                bool ok_build = std::find(i->second.realmbuilds.begin(), i->second.realmbuilds.end(), build) != i->second.realmbuilds.end();
 
-                // No SQL injection. id of realm is controlled by the database.
-                QueryResult *result = LoginDatabase.PQuery( "SELECT numchars FROM realmcharacters WHERE realmid = '%d' AND acctid='%u'", i->second.m_ID, acctid);
-                if ( result )
-                {
-                    Field *fields = result->Fetch();
-                    AmountOfCharacters = fields[0].GetUInt8();
-                    delete result;
-                }
-                else
-                    AmountOfCharacters = 0;
-
-                bool ok_build = std::find(i->second.realmbuilds.begin(), i->second.realmbuilds.end(), _build) != i->second.realmbuilds.end();
-
-                RealmBuildInfo const* buildInfo = ok_build ? FindBuildInfo(_build) : NULL;
+                RealmBuildInfo const* buildInfo = ok_build ? FindBuildInfo(build) : NULL;
                 if (!buildInfo)
                     buildInfo = &i->second.realmBuildInfo;
 
@@ -1033,20 +1240,25 @@ void AuthSocket::LoadRealmlist(ByteBuffer &pkt, uint32 acctid)
                 }
 
                 // Show offline state for unsupported client builds and locked realms (1.x clients not support locked state show)
-                if (!ok_build || (i->second.allowedSecurityLevel > _accountSecurityLevel))
+                if (!ok_build || (i->second.allowedSecurityLevel > securityLevel))
                     realmflags = RealmFlags(realmflags | REALM_FLAG_OFFLINE);
 
+                ByteBuffer& pkt = tmpl.parts.back();
                 pkt << uint32(i->second.icon);              // realm type
                 pkt << uint8(realmflags);                   // realmflags
                 pkt << name;                                // name
                 pkt << i->second.address;                   // address
                 pkt << float(i->second.populationLevel);
-                pkt << uint8(AmountOfCharacters);
-                pkt << uint8(i->second.timezone);           // realm category
-                pkt << uint8(0x00);                         // unk, may be realm number/id?
+
+                // amount of characters
+                tmpl.realmIds.push_back(i->second.m_ID);
+                tmpl.parts.push_back(ByteBuffer());
+
+                tmpl.parts.back() << uint8(i->second.timezone);// realm category
+                tmpl.parts.back() << uint8(0x00);           // unk, may be realm number/id?
             }
 
-            pkt << uint16(0x0002);                          // unused value (why 2?)
+            tmpl.parts.back() << uint16(0x0002);            // unused value (why 2?)
             break;
         }
 
@@ -1062,31 +1274,18 @@ void AuthSocket::LoadRealmlist(ByteBuffer &pkt, uint32 acctid)
         case 16057:                                         // 5.0.5b
         default:                                            // and later
         {
-            pkt << uint32(0);                               // unused value
-            pkt << uint16(sRealmList.size());
+            tmpl.parts.back() << uint32(0);                 // unused value
+            tmpl.parts.back() << uint16(sRealmList.size());
 
             for (RealmList::RealmMap::const_iterator  i = sRealmList.begin(); i != sRealmList.end(); ++i)
             {
-                uint8 AmountOfCharacters;
-
-                // No SQL injection. id of realm is controlled by the database.
-                QueryResult *result = LoginDatabase.PQuery( "SELECT numchars FROM realmcharacters WHERE realmid = '%d' AND acctid='%u'", i->second.m_ID, acctid);
-                if ( result )
-                {
-                    Field *fields = result->Fetch();
-                    AmountOfCharacters = fields[0].GetUInt8();
-                    delete result;
-                }
-                else
-                    AmountOfCharacters = 0;
-
-                bool ok_build = std::find(i->second.realmbuilds.begin(), i->second.realmbuilds.end(), _build) != i->second.realmbuilds.end();
+                bool ok_build = std::find(i->second.realmbuilds.begin(), i->second.realmbuilds.end(), build) != i->second.realmbuilds.end();
 
-                RealmBuildInfo const* buildInfo = ok_build ? FindBuildInfo(_build) : NULL;
+                RealmBuildInfo const* buildInfo = ok_build ? FindBuildInfo(build) : NULL;
                 if (!buildInfo)
                     buildInfo = &i->second.realmBuildInfo;
 
-                uint8 lock = (i->second.allowedSecurityLevel > _accountSecurityLevel) ? 1 : 0;
+                uint8 lock = (i->second.allowedSecurityLevel > securityLevel) ? 1 : 0;
 
                 RealmFlags realmFlags = i->second.realmflags;
 
@@ -1097,31 +1296,53 @@ void AuthSocket::LoadRealmlist(ByteBuffer &pkt, uint32 acctid)
                 if (!buildInfo)
                     realmFlags = RealmFlags(realmFlags & ~REALM_FLAG_SPECIFYBUILD);
 
+                ByteBuffer& pkt = tmpl.parts.back();
                 pkt << uint8(i->second.icon);               // realm type (this is second column in Cfg_Configs.dbc)
                 pkt << uint8(lock);                         // flags, if 0x01, then realm locked
                 pkt << uint8(realmFlags);                   // see enum RealmFlags
                 pkt << i->first;                            // name
                 pkt << i->second.address;                   // address
                 pkt << float(i->second.populationLevel);
-                pkt << uint8(AmountOfCharacters);
-                pkt << uint8(i->second.timezone);           // realm category (Cfg_Categories.dbc)
-                pkt << uint8(0x2C);                         // unk, may be realm number/id?
+
+                // amount of characters
+                tmpl.realmIds.push_back(i->second.m_ID);
+                tmpl.parts.push_back(ByteBuffer());
+
+                ByteBuffer& tail = tmpl.parts.back();
+                tail << uint8(i->second.timezone);          // realm category (Cfg_Categories.dbc)
+                tail << uint8(0x2C);                        // unk, may be realm number/id?
 
                 if (realmFlags & REALM_FLAG_SPECIFYBUILD)
                 {
-                    pkt << uint8(buildInfo->major_version);
-                    pkt << uint8(buildInfo->minor_version);
-                    pkt << uint8(buildInfo->bugfix_version);
-                    pkt << uint16(_build);
+                    tail << uint8(buildInfo->major_version);
+                    tail << uint8(buildInfo->minor_version);
+                    tail << uint8(buildInfo->bugfix_version);
+                    tail << uint16(build);
                 }
             }
 
-            pkt << uint16(0x0010);                          // unused value (why 10?)
+            tmpl.parts.back() << uint16(0x0010);            // unused value (why 10?)
             break;
         }
     }
 }
 
+void AuthSocket::LoadRealmlist(ByteBuffer &pkt, RealmCharacterCounts const& counts)
+{
+    RealmListTemplate& tmpl = s_realmListTemplates[(uint32(_build) << 8) | uint8(_accountSecurityLevel)];
+    if (tmpl.generation != sRealmList.GetGeneration())
+        BuildRealmListTemplate(tmpl, _build, _accountSecurityLevel);
+
+    pkt.append(tmpl.parts[0]);
+
+    for (size_t i = 0; i < tmpl.realmIds.size(); ++i)
+    {
+        RealmCharacterCounts::const_iterator itr = counts.find(tmpl.realmIds[i]);
+        pkt << uint8(itr != counts.end() ? itr->second : 0);
+        pkt.append(tmpl.parts[i + 1]);
+    }
+}
+
 /// Resume patch transfer
 bool AuthSocket::_HandleXferResume()
 {
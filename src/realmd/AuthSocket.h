@@ -30,19 +30,33 @@
 
 #include "BufferedSocket.h"
 
+class AuthJob;
+
 /// Handle login commands
 class AuthSocket: public BufferedSocket
 {
+    friend class LogonChallengeJob;
+    friend class LogonProofJob;
+    friend class ReconnectChallengeJob;
+    friend class RealmListJob;
+
     public:
         const static int s_BYTE_SIZE = 32;
 
+        /// Character amount of the account per realm id
+        typedef std::map<uint32, uint8> RealmCharacterCounts;
+
         AuthSocket();
         ~AuthSocket();
 
         void OnAccept();
         void OnRead();
+        void OnClose();
         void SendProof(Sha1Hash sha);
-        void LoadRealmlist(ByteBuffer &pkt, uint32 acctid);
+        void LoadRealmlist(ByteBuffer &pkt, RealmCharacterCounts const& counts);
+
+        /// Called by AuthWorkerPool in reactor thread when the job started by the socket is done
+        bool CompleteJob(AuthJob* job);
 
         bool _HandleLogonChallenge();
         bool _HandleLogonProof();
@@ -55,9 +69,8 @@ class AuthSocket: public BufferedSocket
         bool _HandleXferCancel();
         bool _HandleXferAccept();
 
-        void _SetVSFields(const std::string& rI);
-
     private:
+        void StartJob(AuthJob* job);
 
         BigNumber N, s, g, v;
         BigNumber b, B;
@@ -78,6 +91,8 @@ class AuthSocket: public BufferedSocket
 
         ACE_HANDLE patch_;
 
+        AuthJob* _pendingJob;                               // next commands wait for its result
+
         void InitPatch();
 };
 #endif
@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** \file
+    \ingroup realmd
+*/
+
+#include "AuthWorkerPool.h"
+#include "AuthSocket.h"
+#include "Database/DatabaseEnv.h"
+#include "Log.h"
+
+#include <ace/Guard_T.h>
+#include <ace/Reactor.h>
+#include <ace/Thread.h>
+#include <ace/Thread_Manager.h>
+
+#include <openssl/crypto.h>
+
+extern DatabaseType LoginDatabase;
+
+typedef ACE_Guard<ACE_Thread_Mutex> AuthWorkerGuard;
+
+// OpenSSL before 1.1.0 needs locking callbacks for use of its random generator from many threads
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+static ACE_Thread_Mutex* OpenSSLLocks = NULL;
+
+static void OpenSSLLockingCallback(int mode, int type, char const* /*file*/, int /*line*/)
+{
+    if (mode & CRYPTO_LOCK)
+        OpenSSLLocks[type].acquire();
+    else
+        OpenSSLLocks[type].release();
+}
+
+static unsigned long OpenSSLThreadId()
+{
+    return (unsigned long)ACE_Thread::self();
+}
+
+static void InitOpenSSLLocking()
+{
+    if (OpenSSLLocks)
+        return;
+
+    OpenSSLLocks = new ACE_Thread_Mutex[CRYPTO_num_locks()];
+    CRYPTO_set_id_callback(&OpenSSLThreadId);
+    CRYPTO_set_locking_callback(&OpenSSLLockingCallback);
+}
+
+static void CleanupOpenSSLLocking()
+{
+    if (!OpenSSLLocks)
+        return;
+
+    CRYPTO_set_locking_callback(NULL);
+    CRYPTO_set_id_callback(NULL);
+    delete[] OpenSSLLocks;
+    OpenSSLLocks = NULL;
+}
+#else
+static void InitOpenSSLLocking() {}
+static void CleanupOpenSSLLocking() {}
+#endif
+
+AuthWorkerPool::AuthWorkerPool() : m_threads(0), m_group(-1), m_cond(m_lock), m_notified(false), m_stopping(false)
+{
+}
+
+AuthWorkerPool::~AuthWorkerPool()
+{
+    Stop();
+}
+
+AuthWorkerPool& AuthWorkerPool::Instance()
+{
+    static AuthWorkerPool pool;
+    return pool;
+}
+
+bool AuthWorkerPool::Start(uint32 threads)
+{
+    reactor(ACE_Reactor::instance());
+
+    if (!threads)
+        return true;
+
+    InitOpenSSLLocking();
+
+    m_stopping = false;
+    m_group = ACE_Thread_Manager::instance()->spawn_n(threads, (ACE_THR_FUNC)&WorkerThread, this);
+    if (m_group == -1)
+    {
+        sLog.outError("AuthWorkerPool: can't start %u worker threads", threads);
+        CleanupOpenSSLLocking();
+        return false;
+    }
+
+    m_threads = threads;
+
+    // finished jobs wait here if the reactor can't be notified
+    if (reactor()->schedule_timer(this, NULL, ACE_Time_Value(1), ACE_Time_Value(1)) == -1)
+        sLog.outError("AuthWorkerPool: can't schedule the timer for finished jobs");
+
+    return true;
+}
+
+void AuthWorkerPool::Stop()
+{
+    if (!m_threads)
+        return;
+
+    {
+        AuthWorkerGuard guard(m_lock);
+        m_stopping = true;
+        m_cond.broadcast();
+    }
+
+    reactor()->cancel_timer(this);
+    ACE_Thread_Manager::instance()->wait_grp(m_group);
+    m_threads = 0;
+    m_group = -1;
+
+    // sockets are closed with the reactor, results are not needed anymore
+    while (!m_jobs.empty())
+    {
+        delete m_jobs.front();
+        m_jobs.pop_front();
+    }
+
+    while (!m_finished.empty())
+    {
+        delete m_finished.front();
+        m_finished.pop_front();
+    }
+
+    CleanupOpenSSLLocking();
+}
+
+void AuthWorkerPool::Enqueue(AuthJob* job)
+{
+    if (!m_threads)
+    {
+        job->Execute();
+        Complete(job);
+        return;
+    }
+
+    AuthWorkerGuard guard(m_lock);
+    m_jobs.push_back(job);
+    m_cond.signal();
+}
+
+ACE_THR_FUNC_RETURN AuthWorkerPool::WorkerThread(void* arg)
+{
+    // jobs use connections of the sync query pool, thread must be known by DB client library
+    LoginDatabase.ThreadStart();
+
+    ((AuthWorkerPool*)arg)->RunWorker();
+
+    LoginDatabase.ThreadEnd();
+    return 0;
+}
+
+void AuthWorkerPool::RunWorker()
+{
+    for (;;)
+    {
+        AuthJob* job;
+        {
+            AuthWorkerGuard guard(m_lock);
+
+            while (m_jobs.empty() && !m_stopping)
+                m_cond.wait();
+
+            if (m_stopping)
+                return;
+
+            job = m_jobs.front();
+            m_jobs.pop_front();
+        }
+
+        job->Execute();
+
+        bool notify;
+        {
+            AuthWorkerGuard guard(m_lock);
+            m_finished.push_back(job);
+
+            // one notification drains all finished jobs
+            notify = !m_notified;
+            m_notified = true;
+        }
+
+        if (notify && reactor()->notify(this) == -1)
+        {
+            sLog.outError("AuthWorkerPool: can't notify reactor about finished jobs, completing them at the next timer");
+
+            // else no job would ever notify again
+            AuthWorkerGuard guard(m_lock);
+            m_notified = false;
+        }
+    }
+}
+
+int AuthWorkerPool::handle_exception(ACE_HANDLE)
+{
+    std::deque<AuthJob*> finished;
+    {
+        AuthWorkerGuard guard(m_lock);
+        finished.swap(m_finished);
+        m_notified = false;
+    }
+
+    for (std::deque<AuthJob*>::const_iterator itr = finished.begin(); itr != finished.end(); ++itr)
+    {
+        AuthSocket* socket = (*itr)->GetSocket();
+
+        // continue with commands received while the job was executed
+        if (Complete(*itr))
+            socket->OnRead();
+    }
+
+    return 0;
+}
+
+int AuthWorkerPool::handle_timeout(ACE_Time_Value const& /*current_time*/, void const* /*act*/)
+{
+    {
+        AuthWorkerGuard guard(m_lock);
+        if (m_finished.empty())
+            return 0;
+    }
+
+    return handle_exception(ACE_INVALID_HANDLE);
+}
+
+bool AuthWorkerPool::Complete(AuthJob* job)
+{
+    bool open = false;
+    if (AuthSocket* socket = job->GetSocket())
+        open = socket->CompleteJob(job);
+
+    delete job;
+    return open;
+}
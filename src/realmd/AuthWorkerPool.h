@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/// \addtogroup realmd
+/// @{
+/// \file
+
+#ifndef _AUTHWORKERPOOL_H
+#define _AUTHWORKERPOOL_H
+
+#include "Common.h"
+
+#include <ace/Event_Handler.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include <deque>
+
+class AuthSocket;
+
+/**
+ * Blocking part of an auth command (database lookups, SRP6 math).
+ *
+ * Execute() runs in a worker thread and may use only data copied into the job,
+ * Complete() runs in the reactor thread with the socket that started the job and
+ * returns false if it closed the connection. If the socket is closed meanwhile
+ * the job is detached and Complete() is not called.
+ */
+class AuthJob
+{
+    public:
+        explicit AuthJob(AuthSocket* socket) : m_socket(socket) {}
+        virtual ~AuthJob() {}
+
+        virtual void Execute() = 0;
+        virtual bool Complete(AuthSocket& socket) = 0;
+
+        AuthSocket* GetSocket() const { return m_socket; }
+        void Detach() { m_socket = NULL; }
+
+    private:
+        AuthSocket* m_socket;
+};
+
+/**
+ * Threads executing auth jobs out of the reactor thread.
+ *
+ * Finished jobs are collected and handed back to the reactor thread by
+ * a reactor notification. Without threads jobs are executed at once.
+ */
+class AuthWorkerPool : public ACE_Event_Handler
+{
+    public:
+        AuthWorkerPool();
+        ~AuthWorkerPool();
+
+        static AuthWorkerPool& Instance();
+
+        bool Start(uint32 threads);
+        void Stop();
+
+        // takes ownership of the job
+        void Enqueue(AuthJob* job);
+
+        // reactor notification, completes finished jobs
+        int handle_exception(ACE_HANDLE);
+
+        // completes jobs whose notification failed
+        int handle_timeout(ACE_Time_Value const& current_time, void const* act);
+
+    private:
+        static ACE_THR_FUNC_RETURN WorkerThread(void* arg);
+        void RunWorker();
+
+        // returns true if the socket can continue with next commands
+        static bool Complete(AuthJob* job);
+
+        uint32 m_threads;
+        int m_group;
+
+        ACE_Thread_Mutex m_lock;                            // guards all below
+        ACE_Condition_Thread_Mutex m_cond;
+        std::deque<AuthJob*> m_jobs;
+        std::deque<AuthJob*> m_finished;
+        bool m_notified;                                    // reactor notification is on the way
+        bool m_stopping;
+};
+
+#define sAuthWorkerPool AuthWorkerPool::Instance()
+
+#endif
+/// @}
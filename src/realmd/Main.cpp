@@ -27,6 +27,7 @@
 #include "Config/Config.h"
 #include "Log.h"
 #include "AuthSocket.h"
+#include "AuthWorkerPool.h"
 #include "SystemConfig.h"
 #include "revision.h"
 #include "revision_nr.h"
@@ -240,6 +241,13 @@ extern int main(int argc, char **argv)
         return 1;
     }
 
+    ///- Start threads for database lookups and SRP6 math of logon commands
+    if (!sAuthWorkerPool.Start(sConfig.GetIntDefault("AuthWorkerThreads", 2)))
+    {
+        Log::WaitBeforeContinueIfNeed();
+        return 1;
+    }
+
     ///- Get the list of realms for the server
     sRealmList.Initialize(sConfig.GetIntDefault("RealmsStateUpdateDelay", 20));
     if (sRealmList.size() == 0)
@@ -348,6 +356,9 @@ extern int main(int argc, char **argv)
 #endif
     }
 
+    ///- Wait for the auth worker threads to exit
+    sAuthWorkerPool.Stop();
+
     ///- Wait for the delay thread to exit
     LoginDatabase.HaltDelayThread();
 
@@ -388,9 +399,11 @@ bool StartDB()
         return false;
     }
 
-    sLog.outString("Login Database total connections: %i", 1 + 1);
+    int nConnections = sConfig.GetIntDefault("LoginDatabaseConnections", 1);
+
+    sLog.outString("Login Database total connections: %i", nConnections + 1);
 
-    if(!LoginDatabase.Initialize(dbstring.c_str()))
+    if(!LoginDatabase.Initialize(dbstring.c_str(), nConnections))
     {
         sLog.outError("Cannot connect to database");
         return false;
@@ -63,7 +63,7 @@ RealmBuildInfo const* FindBuildInfo(uint16 _build)
     return NULL;
 }
 
-RealmList::RealmList( ) : m_UpdateInterval(0), m_NextUpdateTime(time(NULL))
+RealmList::RealmList( ) : m_UpdateInterval(0), m_NextUpdateTime(time(NULL)), m_generation(0)
 {
 }
 
@@ -141,6 +141,8 @@ void RealmList::UpdateRealms(bool init)
 {
     DETAIL_LOG("Updating Realm List...");
 
+    ++m_generation;
+
     ////                                               0   1     2        3     4     5           6         7                     8           9
     QueryResult *result = LoginDatabase.Query( "SELECT id, name, address, port, icon, realmflags, timezone, allowedSecurityLevel, population, realmbuilds FROM realmlist WHERE (realmflags & 1) = 0 ORDER BY name" );
 
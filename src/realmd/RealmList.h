@@ -70,6 +70,9 @@ class RealmList
         RealmMap::const_iterator begin() const { return m_realms.begin(); }
         RealmMap::const_iterator end() const { return m_realms.end(); }
         uint32 size() const { return m_realms.size(); }
+
+        // changed at every reload of the realm list, lets users detect stale copies of it
+        uint32 GetGeneration() const { return m_generation; }
     private:
         void UpdateRealms(bool init);
         void UpdateRealm( uint32 ID, const std::string& name, const std::string& address, uint32 port, uint8 icon, RealmFlags realmflags, uint8 timezone, AccountTypes allowedSecurityLevel, float popu, const std::string& builds);
@@ -77,6 +80,7 @@ class RealmList
         RealmMap m_realms;                                  ///< Internal map of realms
         uint32   m_UpdateInterval;
         time_t   m_NextUpdateTime;
+        uint32   m_generation;
 };
 
 #define sRealmList RealmList::Instance()
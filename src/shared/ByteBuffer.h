@@ -21,6 +21,7 @@
 
 #include "Common.h"
 #include "Utilities/ByteConverter.h"
+#include "MemoryPool.h"
 #include "ace/Stack_Trace.h"
 
 class ByteBufferException
@@ -442,7 +443,7 @@ class ByteBuffer
 
     protected:
         size_t _rpos, _wpos;
-        std::vector<uint8> _storage;
+        MemoryPoolBuffer _storage;                          // packets are created and destroyed at high rate
 };
 
 template <typename T>
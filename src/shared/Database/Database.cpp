@@ -80,6 +80,15 @@ SqlPreparedStatement * SqlConnection::GetStmt( int nIndex )
     return pStmt;
 }
 
+void SqlConnection::QueryBatch(std::vector<const char*> const& sql, std::vector<QueryResult*>& results)
+{
+    results.assign(sql.size(), (QueryResult*)NULL);
+
+    for (size_t i = 0; i < sql.size(); ++i)
+        if (sql[i])
+            results[i] = Query(sql[i]);
+}
+
 bool SqlConnection::ExecuteStmt(int nIndex, const SqlStmtParameters& id )
 {
     if(nIndex == -1)
@@ -93,13 +102,26 @@ bool SqlConnection::ExecuteStmt(int nIndex, const SqlStmtParameters& id )
     return pStmt->execute();
 }
 
+QueryResult* SqlConnection::QueryStmt(int nIndex, const SqlStmtParameters& id, bool stream)
+{
+    if(nIndex == -1)
+        return NULL;
+
+    //get prepared statement object
+    SqlPreparedStatement * pStmt = GetStmt(nIndex);
+    //bind parameters
+    pStmt->bind(id);
+    //execute query
+    return pStmt->query(stream);
+}
+
 //////////////////////////////////////////////////////////////////////////
 Database::~Database()
 {
     StopServer();
 }
 
-bool Database::Initialize(const char * infoString, int nConns /*= 1*/)
+bool Database::Initialize(const char * infoString, int nConns /*= 1*/, int nHolderConns /*= 0*/)
 {
     // Enable logging of SQL commands (usually only GM commands)
     // (See method: PExecuteLog)
@@ -141,6 +163,20 @@ bool Database::Initialize(const char * infoString, int nConns /*= 1*/)
     if(!m_pAsyncConn->Initialize(infoString))
         return false;
 
+    //holder connections send all queries of a holder at once
+    for (int i = 0; i < nHolderConns && i < MAX_CONNECTION_POOL_SIZE; ++i)
+    {
+        SqlConnection * pConn = CreateConnection();
+        pConn->AllowBatchQueries();
+        if(!pConn->Initialize(infoString))
+        {
+            delete pConn;
+            return false;
+        }
+
+        m_pHolderConnections.push_back(pConn);
+    }
+
     m_pResultQueue = new SqlResultQueue;
 
     InitDelayThread();
@@ -168,6 +204,11 @@ void Database::StopServer()
 
     m_pQueryConnections.clear();
 
+    for (size_t i = 0; i < m_pHolderConnections.size(); ++i)
+        delete m_pHolderConnections[i];
+
+    m_pHolderConnections.clear();
+
 }
 
 SqlDelayThread * Database::CreateDelayThread()
@@ -183,12 +224,30 @@ void Database::InitDelayThread()
     //New delay thread for delay execute
     m_threadBody = CreateDelayThread();              // will deleted at m_delayThread delete
     m_delayThread = new ACE_Based::Thread(m_threadBody);
+
+    for (size_t i = 0; i < m_pHolderConnections.size(); ++i)
+    {
+        SqlDelayThread * pBody = new SqlDelayThread(this, m_pHolderConnections[i]);
+        m_holderThreadBodies.push_back(pBody);
+        m_holderThreads.push_back(new ACE_Based::Thread(pBody));
+    }
 }
 
 void Database::HaltDelayThread()
 {
     if (!m_threadBody || !m_delayThread) return;
 
+    //holders may wait for writes of the delay thread, so stop them first
+    for (size_t i = 0; i < m_holderThreads.size(); ++i)
+    {
+        m_holderThreadBodies[i]->Stop();
+        m_holderThreads[i]->wait();
+        delete m_holderThreads[i];
+    }
+
+    m_holderThreads.clear();
+    m_holderThreadBodies.clear();
+
     m_threadBody->Stop();                                   //Stop event
     m_delayThread->wait();                                  //Wait for flush to DB
     delete m_delayThread;                                   //This also deletes m_threadBody
@@ -248,6 +307,30 @@ void Database::Ping()
         SqlConnection::Lock guard(m_pQueryConnections[i]);
         delete guard->Query(sql);
     }
+
+    for (size_t i = 0; i < m_pHolderConnections.size(); ++i)
+    {
+        SqlConnection::Lock guard(m_pHolderConnections[i]);
+        delete guard->Query(sql);
+    }
+}
+
+SqlDelayThread * Database::getHolderThread() const
+{
+    SqlDelayThread * pThread = m_threadBody;
+    long nQueueSize = 0;
+
+    for (size_t i = 0; i < m_holderThreadBodies.size(); ++i)
+    {
+        long nSize = m_holderThreadBodies[i]->GetQueueSize();
+        if(i == 0 || nSize < nQueueSize)
+        {
+            pThread = m_holderThreadBodies[i];
+            nQueueSize = nSize;
+        }
+    }
+
+    return pThread;
 }
 
 bool Database::PExecuteLog(const char * format,...)
@@ -577,6 +660,15 @@ bool Database::DirectExecuteStmt( const SqlStatementID& id, SqlStmtParameters *
     return _guard->ExecuteStmt(id.ID(), *params);
 }
 
+QueryResult* Database::QueryStmt( const SqlStatementID& id, SqlStmtParameters * params, bool stream )
+{
+    MANGOS_ASSERT(params);
+    std::auto_ptr<SqlStmtParameters> p(params);
+    //queries use the sync connection pool like Query()
+    SqlConnection::Lock _guard(getQueryConnection());
+    return _guard->QueryStmt(id.ID(), *params, stream);
+}
+
 SqlStatement Database::CreateStatement(SqlStatementID& index, const char * fmt )
 {
     int nId = -1;
@@ -52,6 +52,12 @@ class MANGOS_DLL_SPEC SqlConnection
         //public methods for making requests
         virtual bool Execute(const char *sql) = 0;
 
+        //runs all queries and sets results[i] for sql[i] (NULL sql entries are skipped),
+        //in one round trip to the server if batch queries are allowed and supported
+        virtual void QueryBatch(std::vector<const char*> const& sql, std::vector<QueryResult*>& results);
+        //must be called before Initialize()
+        void AllowBatchQueries() { m_bBatchQueries = true; }
+
         //escape string generation
         virtual unsigned long escape_string(char *to, const char *from, unsigned long length) { strncpy(to,from,length); return length; }
 
@@ -63,6 +69,7 @@ class MANGOS_DLL_SPEC SqlConnection
 
         //methods to work with prepared statements
         bool ExecuteStmt(int nIndex, const SqlStmtParameters& id);
+        QueryResult* QueryStmt(int nIndex, const SqlStmtParameters& id, bool stream);
 
         //SqlConnection object lock
         class Lock
@@ -81,13 +88,14 @@ class MANGOS_DLL_SPEC SqlConnection
         Database& DB() { return m_db; }
 
     protected:
-        SqlConnection(Database& db) : m_db(db) {}
+        SqlConnection(Database& db) : m_db(db), m_bBatchQueries(false) {}
 
         virtual SqlPreparedStatement * CreateStatement(const std::string& fmt);
         //allocate prepared statement and return statement ID
         SqlPreparedStatement * GetStmt(int nIndex);
 
         Database& m_db;
+        bool m_bBatchQueries;
 
         //free prepared statements objects
         void FreePreparedStatements();
@@ -105,10 +113,11 @@ class MANGOS_DLL_SPEC Database
     public:
         virtual ~Database();
 
-        virtual bool Initialize(const char *infoString, int nConns = 1);
-        //start worker thread for async DB request execution
+        //nHolderConns connections with an own thread each run query holders concurrently
+        virtual bool Initialize(const char *infoString, int nConns = 1, int nHolderConns = 0);
+        //start worker threads for async DB request execution
         virtual void InitDelayThread();
-        //stop worker thread
+        //stop worker threads
         virtual void HaltDelayThread();
 
         /// Synchronous DB queries
@@ -213,6 +222,9 @@ class MANGOS_DLL_SPEC Database
         bool CheckRequiredField(char const* table_name, char const* required_name);
         uint32 GetPingIntervall() { return m_pingIntervallms; }
 
+        // statements waiting in the async queue
+        long GetAsyncQueueSize() const { return m_threadBody ? m_threadBody->GetQueueSize() : 0; }
+
         //function to ping database connections
         void Ping();
 
@@ -266,12 +278,15 @@ class MANGOS_DLL_SPEC Database
         SqlConnection * getQueryConnection();
         //for now return one single connection for async requests
         SqlConnection * getAsyncConnection() const { return m_pAsyncConn; }
+        //thread with the shortest queue for query holders, the delay thread if there are no holder threads
+        SqlDelayThread * getHolderThread() const;
 
         friend class SqlStatement;
         //PREPARED STATEMENT API
         //query function for prepared statements
         bool ExecuteStmt(const SqlStatementID& id, SqlStmtParameters * params);
         bool DirectExecuteStmt(const SqlStatementID& id, SqlStmtParameters * params);
+        QueryResult* QueryStmt(const SqlStatementID& id, SqlStmtParameters * params, bool stream);
 
         //connection helper counters
         int m_nQueryConnPoolSize;                               //current size of query connection pool
@@ -288,6 +303,11 @@ class MANGOS_DLL_SPEC Database
         SqlDelayThread *    m_threadBody;                    ///< Pointer to delay sql executer (owned by m_delayThread)
         ACE_Based::Thread * m_delayThread;                   ///< Pointer to executer thread
 
+        ///< Query holder connections and their threads, holders are read only and may run in parallel
+        SqlConnectionContainer m_pHolderConnections;
+        std::vector<SqlDelayThread*> m_holderThreadBodies;   ///< owned by m_holderThreads
+        std::vector<ACE_Based::Thread*> m_holderThreads;
+
         bool m_bAllowAsyncTransactions;                      ///< flag which specifies if async transactions are enabled
 
         //PREPARED STATEMENT REGISTRY
@@ -127,8 +127,9 @@ bool MySQLConnection::Initialize(const char *infoString)
     }
 #endif
 
+    // batch connections send several queries in one request, the flag is kept at reconnect
     mMysql = mysql_real_connect(mysqlInit, host.c_str(), user.c_str(),
-        password.c_str(), database.c_str(), port, unix_socket, 0);
+        password.c_str(), database.c_str(), port, unix_socket, m_bBatchQueries ? CLIENT_MULTI_STATEMENTS : 0);
 
     if (!mMysql)
     {
@@ -254,6 +255,71 @@ QueryNamedResult* MySQLConnection::QueryNamed(const char *sql)
     return new QueryNamedResult(queryResult,names);
 }
 
+void MySQLConnection::QueryBatch(std::vector<const char*> const& sql, std::vector<QueryResult*>& results)
+{
+    if (!m_bBatchQueries)
+    {
+        SqlConnection::QueryBatch(sql, results);
+        return;
+    }
+
+    results.assign(sql.size(), (QueryResult*)NULL);
+
+    if (!mMysql)
+        return;
+
+    std::string batch;
+    for (size_t i = 0; i < sql.size(); ++i)
+    {
+        if (!sql[i])
+            continue;
+
+        if (!batch.empty())
+            batch += ';';
+        batch += sql[i];
+    }
+
+    if (batch.empty())
+        return;
+
+    uint32 _s = WorldTimer::getMSTime();
+
+    // results come in order of the queries, an error ends the batch
+    int status = mysql_real_query(mMysql, batch.c_str(), batch.length());
+    for (size_t i = 0; i < sql.size(); ++i)
+    {
+        if (!sql[i])
+            continue;
+
+        if (status)
+        {
+            sLog.outErrorDb("SQL: %s", sql[i]);
+            sLog.outErrorDb("query ERROR: %s", mysql_error(mMysql));
+            break;
+        }
+
+        if (MYSQL_RES *result = mysql_store_result(mMysql))
+        {
+            uint64 rowCount = mysql_num_rows(result);
+            if (rowCount)
+            {
+                QueryResultMysql *queryResult = new QueryResultMysql(result, mysql_fetch_fields(result), rowCount, mysql_num_fields(result));
+                queryResult->NextRow();
+                results[i] = queryResult;
+            }
+            else
+                mysql_free_result(result);
+        }
+
+        // -1 after the last result
+        status = mysql_next_result(mMysql);
+        if (status < 0)
+            break;
+    }
+
+    DEBUG_FILTER_LOG(LOG_FILTER_SQL_TEXT, "[%u ms] SQL batch: %s", WorldTimer::getMSTimeDiff(_s,WorldTimer::getMSTime()), batch.c_str());
+}
+
 bool MySQLConnection::Execute(const char* sql)
 {
     if (!mMysql)
@@ -482,6 +548,40 @@ bool MySqlPreparedStatement::execute()
     return true;
 }
 
+QueryResult* MySqlPreparedStatement::query(bool stream)
+{
+    if(!isPrepared())
+        return NULL;
+
+    if(!isQuery())
+    {
+        sLog.outError("SQL: '%s' is not a query", m_szFmt.c_str());
+        return NULL;
+    }
+
+    uint32 _s = WorldTimer::getMSTime();
+
+    if(mysql_stmt_execute(m_stmt))
+    {
+        sLog.outError("SQL: cannot execute '%s'", m_szFmt.c_str());
+        sLog.outError("SQL ERROR: %s", mysql_stmt_error(m_stmt));
+        return NULL;
+    }
+
+    //stored results read all rows here
+    QueryResultMysqlStmt *queryResult = new QueryResultMysqlStmt(m_stmt, m_pResultMetadata, stream ? &m_pConn : NULL);
+
+    DEBUG_FILTER_LOG(LOG_FILTER_SQL_TEXT, "[%u ms] SQL: %s", WorldTimer::getMSTimeDiff(_s,WorldTimer::getMSTime()), m_szFmt.c_str());
+
+    if(!queryResult->NextRow())
+    {
+        delete queryResult;
+        return NULL;
+    }
+
+    return queryResult;
+}
+
 enum_field_types MySqlPreparedStatement::ToMySQLType( const SqlStmtFieldData &data, my_bool &bUnsigned )
 {
     bUnsigned = 0;
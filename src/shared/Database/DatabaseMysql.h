@@ -50,6 +50,9 @@ public:
     //execute DML statement
     virtual bool execute();
 
+    //execute query, result set is read by the binary protocol
+    virtual QueryResult* query(bool stream);
+
 protected:
     //bind parameters
     void addParam(int nIndex, const SqlStmtFieldData& data);
@@ -80,6 +83,9 @@ class MANGOS_DLL_SPEC MySQLConnection : public SqlConnection
         QueryNamedResult* QueryNamed(const char *sql);
         bool Execute(const char *sql);
 
+        //one multi-statement request if batch queries are allowed
+        void QueryBatch(std::vector<const char*> const& sql, std::vector<QueryResult*>& results);
+
         unsigned long escape_string(char *to, const char *from, unsigned long length);
 
         bool BeginTransaction();
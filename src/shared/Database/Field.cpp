@@ -18,3 +18,18 @@
 
 //#include "DatabaseEnv.h"
 
+
+#include "Field.h"
+
+const char* Field::FormatNumber() const
+{
+    switch (mStorage)
+    {
+        case STORAGE_INTEGER:   snprintf(mText, sizeof(mText), SI64FMTD, mNumber.integer);     break;
+        case STORAGE_UNSIGNED:  snprintf(mText, sizeof(mText), UI64FMTD, mNumber.uinteger);    break;
+        case STORAGE_REAL:      snprintf(mText, sizeof(mText), "%g", mNumber.real);             break;
+        default:                return mValue;
+    }
+
+    return mText;
+}
@@ -34,28 +34,42 @@ class Field
             DB_TYPE_BOOL    = 0x04
         };
 
-        Field() : mValue(NULL), mType(DB_TYPE_UNKNOWN) {}
-        Field(const char* value, enum DataTypes type) : mValue(value), mType(type) {}
+        Field() : mValue(NULL), mType(DB_TYPE_UNKNOWN), mStorage(STORAGE_TEXT) {}
+        Field(const char* value, enum DataTypes type) : mValue(value), mType(type), mStorage(STORAGE_TEXT) {}
 
         ~Field() {}
 
         enum DataTypes GetType() const { return mType; }
-        bool IsNULL() const { return mValue == NULL; }
+        bool IsNULL() const { return mStorage == STORAGE_TEXT && mValue == NULL; }
 
-        const char *GetString() const { return mValue; }
+        const char *GetString() const { return mStorage == STORAGE_TEXT ? mValue : FormatNumber(); }
         std::string GetCppString() const
         {
-            return mValue ? mValue : "";                    // std::string s = 0 have undefine result in C++
+            const char* value = GetString();
+            return value ? value : "";                      // std::string s = 0 have undefine result in C++
         }
-        float GetFloat() const { return mValue ? static_cast<float>(atof(mValue)) : 0.0f; }
-        bool GetBool() const { return mValue ? atoi(mValue) > 0 : false; }
-        int32 GetInt32() const { return mValue ? static_cast<int32>(atol(mValue)) : int32(0); }
-        uint8 GetUInt8() const { return mValue ? static_cast<uint8>(atol(mValue)) : uint8(0); }
-        uint16 GetUInt16() const { return mValue ? static_cast<uint16>(atol(mValue)) : uint16(0); }
-        int16 GetInt16() const { return mValue ? static_cast<int16>(atol(mValue)) : int16(0); }
-        uint32 GetUInt32() const { return mValue ? static_cast<uint32>(atol(mValue)) : uint32(0); }
+        float GetFloat() const
+        {
+            if (mStorage != STORAGE_TEXT)
+                return mStorage == STORAGE_REAL ? static_cast<float>(mNumber.real) : static_cast<float>(GetNumber());
+            return mValue ? static_cast<float>(atof(mValue)) : 0.0f;
+        }
+        bool GetBool() const
+        {
+            if (mStorage != STORAGE_TEXT)
+                return mStorage == STORAGE_UNSIGNED ? mNumber.uinteger > 0 : GetNumber() > 0;
+            return mValue ? atoi(mValue) > 0 : false;
+        }
+        int32 GetInt32() const { return mStorage != STORAGE_TEXT ? static_cast<int32>(GetNumber()) : mValue ? static_cast<int32>(atol(mValue)) : int32(0); }
+        uint8 GetUInt8() const { return mStorage != STORAGE_TEXT ? static_cast<uint8>(GetNumber()) : mValue ? static_cast<uint8>(atol(mValue)) : uint8(0); }
+        uint16 GetUInt16() const { return mStorage != STORAGE_TEXT ? static_cast<uint16>(GetNumber()) : mValue ? static_cast<uint16>(atol(mValue)) : uint16(0); }
+        int16 GetInt16() const { return mStorage != STORAGE_TEXT ? static_cast<int16>(GetNumber()) : mValue ? static_cast<int16>(atol(mValue)) : int16(0); }
+        uint32 GetUInt32() const { return mStorage != STORAGE_TEXT ? static_cast<uint32>(GetNumber()) : mValue ? static_cast<uint32>(atol(mValue)) : uint32(0); }
         uint64 GetUInt64() const
         {
+            if (mStorage != STORAGE_TEXT)
+                return static_cast<uint64>(GetNumber());
+
             uint64 value = 0;
             if(!mValue || sscanf(mValue,UI64FMTD,&value) == -1)
                 return 0;
@@ -66,13 +80,43 @@ class Field
         void SetType(enum DataTypes type) { mType = type; }
         //no need for memory allocations to store resultset field strings
         //all we need is to cache pointers returned by different DBMS APIs
-        void SetValue(const char* value) { mValue = value; };
+        void SetValue(const char* value) { mValue = value; mStorage = STORAGE_TEXT; };
+
+        //typed values of binary (prepared statement) result sets, read without parsing
+        void SetInteger(int64 value) { mNumber.integer = value; mStorage = STORAGE_INTEGER; }
+        void SetUnsigned(uint64 value) { mNumber.uinteger = value; mStorage = STORAGE_UNSIGNED; }
+        void SetReal(double value) { mNumber.real = value; mStorage = STORAGE_REAL; }
 
     private:
         Field(Field const&);
         Field& operator=(Field const&);
 
+        enum StorageTypes
+        {
+            STORAGE_TEXT,                                   // mValue, NULL for NULL values
+            STORAGE_INTEGER,
+            STORAGE_UNSIGNED,
+            STORAGE_REAL
+        };
+
+        int64 GetNumber() const
+        {
+            // unsigned values above int64 range keep their bits, casts to narrower types are the same
+            return mStorage == STORAGE_REAL ? static_cast<int64>(mNumber.real) : mNumber.integer;
+        }
+
+        // text of a typed value for GetString(), valid until the next row
+        const char* FormatNumber() const;
+
         const char* mValue;
         enum DataTypes mType;
+        enum StorageTypes mStorage;
+        union
+        {
+            int64 integer;
+            uint64 uinteger;
+            double real;
+        } mNumber;
+        mutable char mText[32];
 };
 #endif
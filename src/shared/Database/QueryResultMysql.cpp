@@ -72,7 +72,7 @@ void QueryResultMysql::EndQuery()
     }
 }
 
-enum Field::DataTypes QueryResultMysql::ConvertNativeType(enum_field_types mysqlType) const
+enum Field::DataTypes QueryResultMysql::ConvertNativeType(enum_field_types mysqlType)
 {
     switch (mysqlType)
     {
@@ -102,4 +102,281 @@ enum Field::DataTypes QueryResultMysql::ConvertNativeType(enum_field_types mysql
             return Field::DB_TYPE_UNKNOWN;
     }
 }
+
+//////////////////////////////////////////////////////////////////////////
+// text columns start with a small fetch buffer that grows to the longest value read
+#define STMT_TEXT_BUFFER_SIZE 256
+
+QueryResultMysqlStmt::QueryResultMysqlStmt(MYSQL_STMT *stmt, MYSQL_RES *metadata, SqlConnection *streamConn) :
+    QueryResult(0, mysql_num_fields(metadata)), mStmt(stmt), mBinds(NULL), mNextRow(0), mStreamLock(NULL)
+{
+    // the statement and its connection can't be used by others until all rows are read
+    if (streamConn)
+        mStreamLock = new SqlConnection::Lock(streamConn);
+
+    mCurrentRow = new Field[mFieldCount];
+    mColumns.resize(mFieldCount);
+    mBinds = new MYSQL_BIND[mFieldCount];
+    memset(mBinds, 0, sizeof(MYSQL_BIND) * mFieldCount);
+
+    MYSQL_FIELD *fields = mysql_fetch_fields(metadata);
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        mCurrentRow[i].SetType(QueryResultMysql::ConvertNativeType(fields[i].type));
+        BindColumn(i, fields[i]);
+    }
+
+    if (mysql_stmt_bind_result(mStmt, mBinds))
+    {
+        sLog.outError("SQL ERROR: mysql_stmt_bind_result() failed");
+        sLog.outError("SQL ERROR: %s", mysql_stmt_error(mStmt));
+        EndQuery();
+        return;
+    }
+
+    if (mStreamLock)
+        return;
+
+    while (Fetch())
+    {
+        StoreRow();
+        ++mRowCount;
+    }
+
+    mysql_stmt_free_result(mStmt);
+    mStmt = NULL;
+}
+
+QueryResultMysqlStmt::~QueryResultMysqlStmt()
+{
+    EndQuery();
+    delete [] mBinds;
+}
+
+void QueryResultMysqlStmt::BindColumn(uint32 index, MYSQL_FIELD const& field)
+{
+    Column& column = mColumns[index];
+    MYSQL_BIND& bind = mBinds[index];
+
+    switch (field.type)
+    {
+        case MYSQL_TYPE_TINY:
+        case MYSQL_TYPE_SHORT:
+        case MYSQL_TYPE_INT24:
+        case MYSQL_TYPE_LONG:
+        case MYSQL_TYPE_LONGLONG:
+            column.kind = COLUMN_INTEGER;
+            column.isUnsigned = (field.flags & UNSIGNED_FLAG) != 0;
+            bind.buffer_type = MYSQL_TYPE_LONGLONG;
+            bind.buffer = &column.integer;
+            bind.is_unsigned = column.isUnsigned;
+            break;
+        case MYSQL_TYPE_FLOAT:
+        case MYSQL_TYPE_DOUBLE:
+        case MYSQL_TYPE_DECIMAL:
+        case MYSQL_TYPE_NEWDECIMAL:
+            column.kind = COLUMN_REAL;
+            bind.buffer_type = MYSQL_TYPE_DOUBLE;
+            bind.buffer = &column.real;
+            break;
+        default:
+            // strings, blobs, enums and dates, converted to text by the client library
+            column.kind = COLUMN_TEXT;
+            column.text.resize((field.length < STMT_TEXT_BUFFER_SIZE ? field.length : STMT_TEXT_BUFFER_SIZE) + 1);
+            bind.buffer_type = MYSQL_TYPE_STRING;
+            bind.buffer = &column.text[0];
+            bind.buffer_length = column.text.size() - 1;    // keep place for terminating zero
+            break;
+    }
+
+    bind.length = &column.length;
+    bind.is_null = &column.isNull;
+}
+
+bool QueryResultMysqlStmt::Fetch()
+{
+    if (!mStmt)
+        return false;
+
+    switch (mysql_stmt_fetch(mStmt))
+    {
+        case 0:
+            break;
+        case MYSQL_DATA_TRUNCATED:
+            FetchTruncated();
+            break;
+        case MYSQL_NO_DATA:
+            return false;
+        default:
+            sLog.outError("SQL ERROR: mysql_stmt_fetch() failed");
+            sLog.outError("SQL ERROR: %s", mysql_stmt_error(mStmt));
+            return false;
+    }
+
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        Column& column = mColumns[i];
+        if (column.kind == COLUMN_TEXT && !column.isNull)
+            column.text[column.length] = '\0';
+    }
+
+    return true;
+}
+
+void QueryResultMysqlStmt::FetchTruncated()
+{
+    bool rebind = false;
+
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        Column& column = mColumns[i];
+        MYSQL_BIND& bind = mBinds[i];
+
+        // numeric truncation (decimal to double) needs nothing
+        if (column.kind != COLUMN_TEXT || column.isNull || column.length <= bind.buffer_length)
+            continue;
+
+        column.text.resize(column.length + 1);
+        bind.buffer = &column.text[0];
+        bind.buffer_length = column.length;
+
+        if (mysql_stmt_fetch_column(mStmt, &bind, i, 0))
+        {
+            sLog.outError("SQL ERROR: mysql_stmt_fetch_column() failed");
+            sLog.outError("SQL ERROR: %s", mysql_stmt_error(mStmt));
+            column.length = 0;
+        }
+
+        rebind = true;
+    }
+
+    // bigger buffers are used for the next rows too
+    if (rebind && mysql_stmt_bind_result(mStmt, mBinds))
+    {
+        sLog.outError("SQL ERROR: mysql_stmt_bind_result() failed");
+        sLog.outError("SQL ERROR: %s", mysql_stmt_error(mStmt));
+    }
+}
+
+void QueryResultMysqlStmt::StoreRow()
+{
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        Column& column = mColumns[i];
+        column.nulls.push_back(column.isNull);
+
+        switch (column.kind)
+        {
+            case COLUMN_INTEGER:
+                column.integers.push_back(column.integer);
+                break;
+            case COLUMN_REAL:
+                column.reals.push_back(column.real);
+                break;
+            case COLUMN_TEXT:
+                column.offsets.push_back(uint32(mStrings.size()));
+                if (!column.isNull)
+                    mStrings.insert(mStrings.end(), column.text.begin(), column.text.begin() + column.length + 1);
+                break;
+        }
+    }
+}
+
+void QueryResultMysqlStmt::SetFetchedRow()
+{
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        Column const& column = mColumns[i];
+        Field& field = mCurrentRow[i];
+
+        if (column.isNull)
+            field.SetValue(NULL);
+        else if (column.kind == COLUMN_INTEGER)
+        {
+            if (column.isUnsigned)
+                field.SetUnsigned(uint64(column.integer));
+            else
+                field.SetInteger(column.integer);
+        }
+        else if (column.kind == COLUMN_REAL)
+            field.SetReal(column.real);
+        else
+            field.SetValue(&column.text[0]);
+    }
+}
+
+void QueryResultMysqlStmt::SetStoredRow(uint64 row)
+{
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        Column const& column = mColumns[i];
+        Field& field = mCurrentRow[i];
+
+        if (column.nulls[row])
+            field.SetValue(NULL);
+        else if (column.kind == COLUMN_INTEGER)
+        {
+            if (column.isUnsigned)
+                field.SetUnsigned(uint64(column.integers[row]));
+            else
+                field.SetInteger(column.integers[row]);
+        }
+        else if (column.kind == COLUMN_REAL)
+            field.SetReal(column.reals[row]);
+        else
+            field.SetValue(&mStrings[column.offsets[row]]);
+    }
+}
+
+bool QueryResultMysqlStmt::NextRow()
+{
+    if (!mCurrentRow)
+        return false;
+
+    if (mStreamLock)
+    {
+        if (!Fetch())
+        {
+            EndQuery();
+            return false;
+        }
+
+        SetFetchedRow();
+        return true;
+    }
+
+    if (mNextRow >= mRowCount)
+    {
+        EndQuery();
+        return false;
+    }
+
+    SetStoredRow(mNextRow++);
+    return true;
+}
+
+void QueryResultMysqlStmt::EndQuery()
+{
+    if (mCurrentRow)
+    {
+        delete [] mCurrentRow;
+        mCurrentRow = 0;
+    }
+
+    // unread rows of a streamed result are discarded
+    if (mStmt)
+    {
+        mysql_stmt_free_result(mStmt);
+        mStmt = NULL;
+    }
+
+    std::vector<Column>().swap(mColumns);
+    std::vector<char>().swap(mStrings);
+
+    if (mStreamLock)
+    {
+        delete mStreamLock;
+        mStreamLock = NULL;
+    }
+}
 #endif
@@ -22,6 +22,7 @@
 #define QUERYRESULTMYSQL_H
 
 #include "Common.h"
+#include "Database/Database.h"
 
 #ifdef WIN32
 #include <winsock2.h>
@@ -39,11 +40,77 @@ class QueryResultMysql : public QueryResult
 
         bool NextRow();
 
+        static enum Field::DataTypes ConvertNativeType(enum_field_types mysqlType);
+
     private:
-        enum Field::DataTypes ConvertNativeType(enum_field_types mysqlType) const;
         void EndQuery();
 
         MYSQL_RES *mResult;
 };
+
+/**
+ * Binary protocol result set of a prepared statement.
+ *
+ * Numeric columns are fetched as int64/double and handed to Field as typed values,
+ * so the getters do no string parsing. A stored result reads all rows at construction
+ * into column-major buffers (one typed array per column, strings in a shared pool)
+ * and leaves the statement free for the next execution. A streamed result fetches
+ * each row in NextRow() from the server, has no row count (GetRowCount() is 0) and
+ * keeps the connection locked until all rows are read or the result is deleted.
+ */
+class QueryResultMysqlStmt : public QueryResult
+{
+    public:
+        // streamConn is the connection of the statement for streamed results, NULL for stored ones
+        QueryResultMysqlStmt(MYSQL_STMT *stmt, MYSQL_RES *metadata, SqlConnection *streamConn);
+
+        ~QueryResultMysqlStmt();
+
+        bool NextRow();
+
+    private:
+        enum ColumnKind
+        {
+            COLUMN_INTEGER,
+            COLUMN_REAL,
+            COLUMN_TEXT
+        };
+
+        struct Column
+        {
+            Column() : kind(COLUMN_TEXT), isUnsigned(false), integer(0), real(0.0), length(0), isNull(0) {}
+
+            ColumnKind kind;
+            bool isUnsigned;
+
+            // fetch buffers bound to the statement
+            int64 integer;
+            double real;
+            std::vector<char> text;
+            unsigned long length;
+            my_bool isNull;
+
+            // stored rows, only the array of the column kind is used
+            std::vector<int64> integers;
+            std::vector<double> reals;
+            std::vector<uint32> offsets;                    // in mStrings
+            std::vector<uint8> nulls;
+        };
+
+        void BindColumn(uint32 index, MYSQL_FIELD const& field);
+        bool Fetch();
+        void FetchTruncated();
+        void StoreRow();
+        void SetFetchedRow();
+        void SetStoredRow(uint64 row);
+        void EndQuery();
+
+        MYSQL_STMT *mStmt;                                  // while rows are fetched
+        MYSQL_BIND *mBinds;
+        std::vector<Column> mColumns;
+        std::vector<char> mStrings;
+        uint64 mNextRow;
+        SqlConnection::Lock *mStreamLock;
+};
 #endif
 #endif
@@ -20,7 +20,8 @@
 #include "Database/SqlOperations.h"
 #include "DatabaseEnv.h"
 
-SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn) : m_dbEngine(db), m_dbConnection(conn), m_running(true)
+SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn) : m_dbEngine(db), m_dbConnection(conn), m_running(true),
+    m_queued(uint64(0)), m_processed(uint64(0))
 {
 }
 
@@ -73,5 +74,7 @@ void SqlDelayThread::ProcessRequests()
     {
         s->Execute(m_dbConnection);
         delete s;
+        --m_queueSize;
+        ++m_processed;
     }
 }
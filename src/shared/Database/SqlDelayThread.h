@@ -37,6 +37,9 @@ class SqlDelayThread : public ACE_Based::Runnable
         Database* m_dbEngine;                               ///< Pointer to used Database engine
         SqlConnection * m_dbConnection;                     ///< Pointer to DB connection
         volatile bool m_running;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_queueSize;  ///< Statements not executed yet
+        ACE_Atomic_Op<ACE_Thread_Mutex, uint64> m_queued;   ///< Statements queued since start
+        ACE_Atomic_Op<ACE_Thread_Mutex, uint64> m_processed;///< Statements executed since start
 
         //process all enqueued requests
         void ProcessRequests();
@@ -46,7 +49,13 @@ class SqlDelayThread : public ACE_Based::Runnable
         ~SqlDelayThread();
 
         ///< Put sql statement to delay queue
-        bool Delay(SqlOperation* sql) { m_sqlQueue.add(sql); return true; }
+        bool Delay(SqlOperation* sql) { ++m_queueSize; ++m_queued; m_sqlQueue.add(sql); return true; }
+
+        long GetQueueSize() const { return m_queueSize.value(); }
+
+        // all statements queued before GetQueuedCount() was read are executed when GetProcessedCount() reaches it
+        uint64 GetQueuedCount() const { return m_queued.value(); }
+        uint64 GetProcessedCount() const { return m_processed.value(); }
 
         virtual void Stop();                                ///< Stop event
         virtual void run();                                 ///< Main Thread loop
@@ -107,14 +107,18 @@ void SqlResultQueue::Update()
     }
 }
 
-bool SqlQueryHolder::Execute(MaNGOS::IQueryCallback * callback, SqlDelayThread *thread, SqlResultQueue *queue)
+bool SqlQueryHolder::Execute(MaNGOS::IQueryCallback * callback, SqlDelayThread *thread, SqlResultQueue *queue, SqlDelayThread *writer)
 {
     if(!callback || !thread || !queue)
         return false;
 
+    /// the delay thread itself executes its writes in order
+    if(writer == thread)
+        writer = NULL;
+
     /// delay the execution of the queries, sync them with the delay thread
     /// which will in turn resync on execution (via the queue) and call back
-    SqlQueryHolderEx *holderEx = new SqlQueryHolderEx(this, callback, queue);
+    SqlQueryHolderEx *holderEx = new SqlQueryHolderEx(this, callback, queue, writer, writer ? writer->GetQueuedCount() : 0);
     thread->Delay(holderEx);
     return true;
 }
@@ -212,15 +216,27 @@ bool SqlQueryHolderEx::Execute(SqlConnection *conn)
     if(!m_holder || !m_callback || !m_queue)
         return false;
 
+    /// wait for the saves queued before the holder in the delay thread
+    if(m_writer)
+    {
+        while(m_writer->GetProcessedCount() < m_writerQueued)
+            ACE_Based::Thread::Sleep(1);
+    }
+
     LOCK_DB_CONN(conn);
     /// we can do this, we are friends
     std::vector<SqlQueryHolder::SqlResultPair> &queries = m_holder->m_queries;
+
+    std::vector<const char*> sql(queries.size());
     for(size_t i = 0; i < queries.size(); i++)
-    {
-        /// execute all queries in the holder and pass the results
-        char const *sql = queries[i].first;
-        if(sql) m_holder->SetResult(i, conn->Query(sql));
-    }
+        sql[i] = queries[i].first;
+
+    /// execute all queries in the holder and pass the results
+    std::vector<QueryResult*> results;
+    conn->QueryBatch(sql, results);
+
+    for(size_t i = 0; i < queries.size(); i++)
+        if(sql[i]) m_holder->SetResult(i, results[i]);
 
     /// sync with the caller thread
     m_queue->add(m_callback);
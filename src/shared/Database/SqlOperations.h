@@ -20,6 +20,7 @@
 #define __SQLOPERATIONS_H
 
 #include "Common.h"
+#include "MemoryPool.h"
 
 #include "ace/Thread_Mutex.h"
 #include "LockedQueue.h"
@@ -33,7 +34,7 @@ class SqlConnection;
 class SqlDelayThread;
 class SqlStmtParameters;
 
-class SqlOperation
+class SqlOperation : public MemoryPoolObject
 {
     public:
         virtual void OnRemove() { delete this; }
@@ -48,8 +49,8 @@ class SqlPlainRequest : public SqlOperation
     private:
         const char *m_sql;
     public:
-        SqlPlainRequest(const char *sql) : m_sql(mangos_strdup(sql)){}
-        ~SqlPlainRequest() { char* tofree = const_cast<char*>(m_sql); delete [] tofree; }
+        SqlPlainRequest(const char *sql) : m_sql(MemoryPool::CopyString(sql)){}
+        ~SqlPlainRequest() { MemoryPool::FreeString(m_sql); }
         bool Execute(SqlConnection *conn);
 };
 
@@ -103,8 +104,8 @@ class SqlQuery : public SqlOperation
         SqlResultQueue * m_queue;
     public:
         SqlQuery(const char *sql, MaNGOS::IQueryCallback * callback, SqlResultQueue * queue)
-            : m_sql(mangos_strdup(sql)), m_callback(callback), m_queue(queue) {}
-        ~SqlQuery() { char* tofree = const_cast<char*>(m_sql); delete [] tofree; }
+            : m_sql(MemoryPool::CopyString(sql)), m_callback(callback), m_queue(queue) {}
+        ~SqlQuery() { MemoryPool::FreeString(m_sql); }
         bool Execute(SqlConnection *conn);
 };
 
@@ -122,7 +123,9 @@ class SqlQueryHolder
         void SetSize(size_t size);
         QueryResult* GetResult(size_t index);
         void SetResult(size_t index, QueryResult *result);
-        bool Execute(MaNGOS::IQueryCallback * callback, SqlDelayThread *thread, SqlResultQueue *queue);
+        // writer is the delay thread of the database: if the holder runs in another thread
+        // it waits for the writes queued before, so it reads what was saved before
+        bool Execute(MaNGOS::IQueryCallback * callback, SqlDelayThread *thread, SqlResultQueue *queue, SqlDelayThread *writer = NULL);
 };
 
 class SqlQueryHolderEx : public SqlOperation
@@ -131,9 +134,11 @@ class SqlQueryHolderEx : public SqlOperation
         SqlQueryHolder * m_holder;
         MaNGOS::IQueryCallback * m_callback;
         SqlResultQueue * m_queue;
+        SqlDelayThread * m_writer;
+        uint64 m_writerQueued;
     public:
-        SqlQueryHolderEx(SqlQueryHolder *holder, MaNGOS::IQueryCallback * callback, SqlResultQueue * queue)
-            : m_holder(holder), m_callback(callback), m_queue(queue) {}
+        SqlQueryHolderEx(SqlQueryHolder *holder, MaNGOS::IQueryCallback * callback, SqlResultQueue * queue, SqlDelayThread * writer, uint64 writerQueued)
+            : m_holder(holder), m_callback(callback), m_queue(queue), m_writer(writer), m_writerQueued(writerQueued) {}
         bool Execute(SqlConnection *conn);
 };
 #endif                                                      //__SQLOPERATIONS_H
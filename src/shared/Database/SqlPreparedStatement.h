@@ -207,6 +207,13 @@ class MANGOS_DLL_SPEC SqlStatement
         bool Execute();
         bool DirectExecute();
 
+        //synchronous query, result set is read in binary form so Field getters don't parse strings
+        QueryResult* Query();
+        //same, but rows are fetched from the server while iterating instead of at once,
+        //for big loaders: GetRowCount() is 0 and the DB connection stays locked until
+        //all rows are read or the result is deleted, so the thread must not run other queries meanwhile
+        QueryResult* StreamQuery();
+
         //templates to simplify 1-4 parameter bindings
         template<typename ParamType1>
         bool PExecute(ParamType1 param1)
@@ -242,6 +249,40 @@ class MANGOS_DLL_SPEC SqlStatement
             return Execute();
         }
 
+        template<typename ParamType1>
+        QueryResult* PQuery(ParamType1 param1)
+        {
+            arg(param1);
+            return Query();
+        }
+
+        template<typename ParamType1, typename ParamType2>
+        QueryResult* PQuery(ParamType1 param1, ParamType2 param2)
+        {
+            arg(param1);
+            arg(param2);
+            return Query();
+        }
+
+        template<typename ParamType1, typename ParamType2, typename ParamType3>
+        QueryResult* PQuery(ParamType1 param1, ParamType2 param2, ParamType3 param3)
+        {
+            arg(param1);
+            arg(param2);
+            arg(param3);
+            return Query();
+        }
+
+        template<typename ParamType1, typename ParamType2, typename ParamType3, typename ParamType4>
+        QueryResult* PQuery(ParamType1 param1, ParamType2 param2, ParamType3 param3, ParamType4 param4)
+        {
+            arg(param1);
+            arg(param2);
+            arg(param3);
+            arg(param4);
+            return Query();
+        }
+
         //bind parameters with specified type
         void addBool(bool var) { arg(var); }
         void addUInt8(uint8 var) { arg(var); }
@@ -265,6 +306,8 @@ class MANGOS_DLL_SPEC SqlStatement
 
     private:
 
+        QueryResult* DoQuery(bool stream);
+
         SqlStmtParameters * get()
         {
             if(!m_pParams)
@@ -314,6 +357,8 @@ class MANGOS_DLL_SPEC SqlPreparedStatement
 
         //execute statement w/o result set
         virtual bool execute() = 0;
+        //execute query, returns NULL for empty result sets
+        virtual QueryResult* query(bool stream) = 0;
 
     protected:
         SqlPreparedStatement(const std::string& fmt, SqlConnection& conn):
@@ -341,6 +386,8 @@ class MANGOS_DLL_SPEC SqlPlainPreparedStatement : public SqlPreparedStatement
         virtual void bind(const SqlStmtParameters& holder);
 
         virtual bool execute();
+        //plain SQL text result set, always stored
+        virtual QueryResult* query(bool stream);
 
     protected:
         void DataToString(const SqlStmtFieldData& data, std::ostringstream& fmt);
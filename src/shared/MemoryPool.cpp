@@ -0,0 +1,391 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MemoryPool.h"
+
+#include <ace/Atomic_Op.h>
+#include <ace/Guard_T.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/TSS_T.h>
+
+#define MEMORY_POOL_MIN_SIZE    16
+#define MEMORY_POOL_STATS_FLUSH 1024                        // operations of a thread counted locally between statistics updates
+
+typedef ACE_Guard<ACE_Thread_Mutex> PoolGuard;
+
+struct PoolBlock
+{
+    PoolBlock* next;
+};
+
+static inline uint32 GetSizeClass(size_t size)
+{
+    uint32 sizeClass = 0;
+    for (size_t blockSize = MEMORY_POOL_MIN_SIZE; blockSize < size; blockSize <<= 1)
+        ++sizeClass;
+    return sizeClass;
+}
+
+static inline size_t GetBlockSize(uint32 sizeClass)
+{
+    return size_t(MEMORY_POOL_MIN_SIZE) << sizeClass;
+}
+
+// count of blocks moved between a thread cache and the central list at once,
+// a thread cache keeps at most two batches per class
+static inline uint32 GetBatchSize(uint32 sizeClass)
+{
+    size_t batch = 8192 / GetBlockSize(sizeClass);
+    if (batch < 4)
+        return 4;
+    if (batch > 64)
+        return 64;
+    return uint32(batch);
+}
+
+struct PoolThreadCache
+{
+    PoolThreadCache();
+    ~PoolThreadCache();
+
+    PoolBlock* heads[MEMORY_POOL_CLASSES];
+    uint32 counts[MEMORY_POOL_CLASSES];
+    long allocations[MEMORY_POOL_CLASSES];                  // not yet added to the central statistics
+    long deallocations[MEMORY_POOL_CLASSES];
+};
+
+struct PoolCentralList
+{
+    PoolCentralList() : head(NULL), count(0), allocations(0), deallocations(0), slabs(0) {}
+
+    ACE_Thread_Mutex lock;                                  // guards all below
+    PoolBlock* head;
+    uint32 count;
+    long allocations;
+    long deallocations;
+    long slabs;
+};
+
+struct PoolState
+{
+    PoolCentralList central[MEMORY_POOL_CLASSES];
+    ACE_TSS<PoolThreadCache> caches;
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> oversize;
+};
+
+// created at first use and never destroyed: blocks may be freed by static destructors
+// of other modules and by threads still running at exit
+static PoolState& GetState()
+{
+    static PoolState* state = new PoolState;
+    return *state;
+}
+
+static inline PoolThreadCache& GetThreadCache()
+{
+    return *GetState().caches;
+}
+
+// moves the statistics of the thread to the central list, lock must be held
+static void FlushStatistics(PoolThreadCache& cache, PoolCentralList& central, uint32 sizeClass)
+{
+    central.allocations += cache.allocations[sizeClass];
+    central.deallocations += cache.deallocations[sizeClass];
+    cache.allocations[sizeClass] = 0;
+    cache.deallocations[sizeClass] = 0;
+}
+
+static void CountOperation(PoolThreadCache& cache, uint32 sizeClass)
+{
+    // a cache that neither runs empty nor overflows would not report otherwise
+    if (cache.allocations[sizeClass] + cache.deallocations[sizeClass] < MEMORY_POOL_STATS_FLUSH)
+        return;
+
+    PoolCentralList& central = GetState().central[sizeClass];
+    PoolGuard guard(central.lock);
+    FlushStatistics(cache, central, sizeClass);
+}
+
+static void Refill(PoolThreadCache& cache, uint32 sizeClass)
+{
+    PoolCentralList& central = GetState().central[sizeClass];
+    uint32 batch = GetBatchSize(sizeClass);
+
+    PoolGuard guard(central.lock);
+    FlushStatistics(cache, central, sizeClass);
+
+    if (!central.head)
+    {
+        size_t blockSize = GetBlockSize(sizeClass);
+        char* slab = static_cast<char*>(::operator new(MEMORY_POOL_SLAB_SIZE));
+        ++central.slabs;
+
+        for (size_t offset = 0; offset + blockSize <= MEMORY_POOL_SLAB_SIZE; offset += blockSize)
+        {
+            PoolBlock* block = reinterpret_cast<PoolBlock*>(slab + offset);
+            block->next = central.head;
+            central.head = block;
+            ++central.count;
+        }
+    }
+
+    for (uint32 i = 0; i < batch && central.head; ++i)
+    {
+        PoolBlock* block = central.head;
+        central.head = block->next;
+        --central.count;
+
+        block->next = cache.heads[sizeClass];
+        cache.heads[sizeClass] = block;
+        ++cache.counts[sizeClass];
+    }
+}
+
+static void Release(PoolThreadCache& cache, uint32 sizeClass, uint32 count)
+{
+    // unlink the blocks before taking the lock
+    PoolBlock* first = cache.heads[sizeClass];
+    PoolBlock* last = first;
+    uint32 released = 1;
+    for (; released < count && last->next; ++released)
+        last = last->next;
+
+    cache.heads[sizeClass] = last->next;
+    cache.counts[sizeClass] -= released;
+
+    PoolCentralList& central = GetState().central[sizeClass];
+
+    PoolGuard guard(central.lock);
+    FlushStatistics(cache, central, sizeClass);
+
+    last->next = central.head;
+    central.head = first;
+    central.count += released;
+}
+
+PoolThreadCache::PoolThreadCache()
+{
+    for (uint32 i = 0; i < MEMORY_POOL_CLASSES; ++i)
+    {
+        heads[i] = NULL;
+        counts[i] = 0;
+        allocations[i] = 0;
+        deallocations[i] = 0;
+    }
+}
+
+PoolThreadCache::~PoolThreadCache()
+{
+    // thread exits, its blocks can be used by others
+    for (uint32 i = 0; i < MEMORY_POOL_CLASSES; ++i)
+    {
+        if (counts[i])
+            Release(*this, i, counts[i]);
+        else
+        {
+            PoolCentralList& central = GetState().central[i];
+            PoolGuard guard(central.lock);
+            FlushStatistics(*this, central, i);
+        }
+    }
+}
+
+void* MemoryPool::Allocate(size_t size)
+{
+    if (size > MEMORY_POOL_MAX_SIZE)
+    {
+        ++GetState().oversize;
+        return ::operator new(size);
+    }
+
+    uint32 sizeClass = GetSizeClass(size);
+    PoolThreadCache& cache = GetThreadCache();
+
+    if (!cache.heads[sizeClass])
+        Refill(cache, sizeClass);
+
+    PoolBlock* block = cache.heads[sizeClass];
+    cache.heads[sizeClass] = block->next;
+    --cache.counts[sizeClass];
+    ++cache.allocations[sizeClass];
+    CountOperation(cache, sizeClass);
+
+    return block;
+}
+
+void MemoryPool::Deallocate(void* ptr, size_t size)
+{
+    if (!ptr)
+        return;
+
+    if (size > MEMORY_POOL_MAX_SIZE)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    uint32 sizeClass = GetSizeClass(size);
+    PoolThreadCache& cache = GetThreadCache();
+
+    PoolBlock* block = static_cast<PoolBlock*>(ptr);
+    block->next = cache.heads[sizeClass];
+    cache.heads[sizeClass] = block;
+    ++cache.counts[sizeClass];
+    ++cache.deallocations[sizeClass];
+
+    uint32 batch = GetBatchSize(sizeClass);
+    if (cache.counts[sizeClass] > 2 * batch)
+        Release(cache, sizeClass, batch);
+    else
+        CountOperation(cache, sizeClass);
+}
+
+char* MemoryPool::CopyString(char const* str)
+{
+    size_t size = strlen(str) + 1;
+    char* copy = static_cast<char*>(Allocate(size));
+    memcpy(copy, str, size);
+    return copy;
+}
+
+void MemoryPool::FreeString(char const* str)
+{
+    if (str)
+        Deallocate(const_cast<char*>(str), strlen(str) + 1);
+}
+
+void MemoryPool::GetStatistics(ClassStatistics (&stats)[MEMORY_POOL_CLASSES])
+{
+    for (uint32 i = 0; i < MEMORY_POOL_CLASSES; ++i)
+    {
+        PoolCentralList& central = GetState().central[i];
+        PoolGuard guard(central.lock);
+
+        stats[i].blockSize = GetBlockSize(i);
+        stats[i].allocations = central.allocations;
+        stats[i].deallocations = central.deallocations;
+        stats[i].slabs = central.slabs;
+        stats[i].centralBlocks = central.count;
+    }
+}
+
+long MemoryPool::GetOversizeAllocations()
+{
+    return GetState().oversize.value();
+}
+
+// ===================== ObjectPool ==================================
+
+#define OBJECT_POOL_MIN_SLAB_BLOCKS 8
+
+struct ObjectPool::State
+{
+    State(char const* poolName, size_t size) : name(poolName), objectSize(size), head(NULL), allocations(0), deallocations(0), slabs(0)
+    {
+        // keep blocks aligned like operator new does
+        blockSize = (objectSize + MEMORY_POOL_MIN_SIZE - 1) & ~size_t(MEMORY_POOL_MIN_SIZE - 1);
+        slabSize = blockSize * OBJECT_POOL_MIN_SLAB_BLOCKS;
+        if (slabSize < MEMORY_POOL_SLAB_SIZE)
+            slabSize = MEMORY_POOL_SLAB_SIZE / blockSize * blockSize;
+    }
+
+    char const* name;
+    size_t objectSize;
+    size_t blockSize;
+    size_t slabSize;
+
+    ACE_Thread_Mutex lock;                                  // guards all below
+    PoolBlock* head;
+    long allocations;
+    long deallocations;
+    long slabs;
+};
+
+// pools are linked at static initialization, before any thread is started
+static ObjectPool* ObjectPools = NULL;
+
+ObjectPool::ObjectPool(char const* name, size_t objectSize) : m_state(new State(name, objectSize)), m_next(ObjectPools)
+{
+    ObjectPools = this;
+}
+
+void* ObjectPool::Allocate(size_t size)
+{
+    if (size != m_state->objectSize)
+        return ::operator new(size);
+
+    PoolGuard guard(m_state->lock);
+
+    if (!m_state->head)
+    {
+        char* slab = static_cast<char*>(::operator new(m_state->slabSize));
+        ++m_state->slabs;
+
+        for (size_t offset = 0; offset + m_state->blockSize <= m_state->slabSize; offset += m_state->blockSize)
+        {
+            PoolBlock* block = reinterpret_cast<PoolBlock*>(slab + offset);
+            block->next = m_state->head;
+            m_state->head = block;
+        }
+    }
+
+    PoolBlock* block = m_state->head;
+    m_state->head = block->next;
+    ++m_state->allocations;
+    return block;
+}
+
+void ObjectPool::Deallocate(void* ptr, size_t size)
+{
+    if (!ptr)
+        return;
+
+    if (size != m_state->objectSize)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    PoolBlock* block = static_cast<PoolBlock*>(ptr);
+
+    PoolGuard guard(m_state->lock);
+    block->next = m_state->head;
+    m_state->head = block;
+    ++m_state->deallocations;
+}
+
+void ObjectPool::GetStatistics(Statistics& stats) const
+{
+    PoolGuard guard(m_state->lock);
+
+    stats.name = m_state->name;
+    stats.blockSize = m_state->blockSize;
+    stats.allocations = m_state->allocations;
+    stats.deallocations = m_state->deallocations;
+    stats.slabs = m_state->slabs;
+    stats.slabSize = m_state->slabSize;
+}
+
+void ObjectPool::GetAllStatistics(std::vector<Statistics>& stats)
+{
+    for (ObjectPool* pool = ObjectPools; pool; pool = pool->m_next)
+    {
+        stats.push_back(Statistics());
+        pool->GetStatistics(stats.back());
+    }
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_MEMORYPOOL_H
+#define MANGOS_MEMORYPOOL_H
+
+#include "Common.h"
+#include "Platform/Define.h"
+
+#include <vector>
+
+#define MEMORY_POOL_CLASSES     9                           // 16 bytes up to 4096 bytes, power of two steps
+#define MEMORY_POOL_MAX_SIZE    4096
+#define MEMORY_POOL_SLAB_SIZE   (64 * 1024)
+
+/**
+ * Size class pool for small short living blocks (packet buffers, SQL operations).
+ *
+ * Every thread keeps a cache of free blocks per size class, so allocation and
+ * deallocation in the common case take no lock. Blocks freed by another thread
+ * than the allocating one simply go to the cache of the freeing thread; caches
+ * exchange blocks in batches with a locked central list. Blocks are carved from
+ * 64 KB slabs which are kept for reuse until exit, so reserved memory is bounded
+ * by peak usage. Bigger requests go to the global operator new.
+ *
+ * The caller must pass the size used at allocation to Deallocate().
+ */
+class MANGOS_DLL_SPEC MemoryPool
+{
+    public:
+        struct ClassStatistics
+        {
+            size_t blockSize;
+            long allocations;                               // done in total, counted in batches per thread
+            long deallocations;
+            long slabs;                                     // 64 KB slabs reserved for the class
+            long centralBlocks;                             // free blocks in the central list
+        };
+
+        static void* Allocate(size_t size);
+        static void Deallocate(void* ptr, size_t size);
+
+        // pooled copy of a string, must be freed by FreeString
+        static char* CopyString(char const* str);
+        static void FreeString(char const* str);
+
+        static void GetStatistics(ClassStatistics (&stats)[MEMORY_POOL_CLASSES]);
+        static long GetOversizeAllocations();
+};
+
+/// Base for classes allocated by new from the pool
+class MemoryPoolObject
+{
+    public:
+        static void* operator new(size_t size) { return MemoryPool::Allocate(size); }
+        static void operator delete(void* ptr, size_t size) { MemoryPool::Deallocate(ptr, size); }
+};
+
+/**
+ * Pool for the objects of one class, for classes too big for the size classes
+ * (creatures, game objects) that are deleted and created again in numbers when
+ * grids unload and load. Blocks are carved from slabs of at least 64 KB which are
+ * kept until exit, freed blocks are reused by the next object of the class.
+ *
+ * Objects are created and deleted rarely compared to packets, so a single lock
+ * guards the free list. Requests of another size than the pool's, as by derived
+ * classes, go to the global operator new.
+ */
+class MANGOS_DLL_SPEC ObjectPool
+{
+    public:
+        struct Statistics
+        {
+            char const* name;
+            size_t blockSize;
+            long allocations;                               // done in total
+            long deallocations;
+            long slabs;
+            size_t slabSize;
+        };
+
+        ObjectPool(char const* name, size_t objectSize);
+
+        void* Allocate(size_t size);
+        void Deallocate(void* ptr, size_t size);
+
+        void GetStatistics(Statistics& stats) const;
+
+        // all pools of the process, pools are created at static initialization
+        static void GetAllStatistics(std::vector<Statistics>& stats);
+
+    private:
+        struct State;
+
+        // never freed, objects may be deleted by static destructors of other modules
+        State* m_state;
+        ObjectPool* m_next;
+};
+
+/**
+ * Growable byte array in pool memory, has the subset of std::vector<uint8> interface
+ * used by ByteBuffer. Bytes are copied and cleared by memcpy/memset, std::vector
+ * with a custom allocator would construct them one by one.
+ */
+class MemoryPoolBuffer
+{
+    public:
+        MemoryPoolBuffer() : m_data(NULL), m_size(0), m_capacity(0) {}
+        MemoryPoolBuffer(MemoryPoolBuffer const& buf) : m_data(NULL), m_size(0), m_capacity(0) { assign(buf); }
+        ~MemoryPoolBuffer() { MemoryPool::Deallocate(m_data, m_capacity); }
+
+        MemoryPoolBuffer& operator=(MemoryPoolBuffer const& buf)
+        {
+            if (this != &buf)
+                assign(buf);
+            return *this;
+        }
+
+        size_t size() const { return m_size; }
+        size_t capacity() const { return m_capacity; }
+        bool empty() const { return m_size == 0; }
+
+        uint8& operator[](size_t pos) { return m_data[pos]; }
+        uint8 const& operator[](size_t pos) const { return m_data[pos]; }
+
+        void clear() { m_size = 0; }
+
+        void reserve(size_t capacity)
+        {
+            if (capacity <= m_capacity)
+                return;
+
+            uint8* data = static_cast<uint8*>(MemoryPool::Allocate(capacity));
+            if (m_size)
+                memcpy(data, m_data, m_size);
+
+            MemoryPool::Deallocate(m_data, m_capacity);
+            m_data = data;
+            m_capacity = capacity;
+        }
+
+        // new bytes are zeroed
+        void resize(size_t size)
+        {
+            if (size > m_capacity)
+                reserve(size > 2 * m_capacity ? size : 2 * m_capacity);
+
+            if (size > m_size)
+                memset(m_data + m_size, 0, size - m_size);
+
+            m_size = size;
+        }
+
+    private:
+        void assign(MemoryPoolBuffer const& buf)
+        {
+            m_size = 0;
+            reserve(buf.m_size);
+            if (buf.m_size)
+                memcpy(m_data, buf.m_data, buf.m_size);
+            m_size = buf.m_size;
+        }
+
+        uint8* m_data;
+        size_t m_size;
+        size_t m_capacity;
+};
+
+#endif
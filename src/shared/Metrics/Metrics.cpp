@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Metrics/Metrics.h"
+#include "Log.h"
+
+#include <ace/Guard_T.h>
+#include <ace/TSS_T.h>
+
+typedef ACE_Guard<ACE_Thread_Mutex> MetricsGuard;
+
+struct MetricThreadShard
+{
+    MetricThreadShard() : index(uint32(++s_next) % METRIC_SHARDS) {}
+
+    uint32 index;
+    static MetricValue s_next;
+};
+
+MetricValue MetricThreadShard::s_next;
+
+typedef ACE_TSS<MetricThreadShard> MetricThreadShardTSS;
+static MetricThreadShardTSS s_threadShard;
+
+uint32 GetMetricShard()
+{
+    return s_threadShard->index;
+}
+
+long const MetricUpdateTimeBounds[METRIC_UPDATE_TIME_BOUNDS] = { 1, 2, 5, 10, 25, 50, 100, 250, 500, 1000 };
+
+std::string MetricLabel(char const* name, uint32 value)
+{
+    std::ostringstream label;
+    label << name << "=\"" << value << "\"";
+    return label.str();
+}
+
+static void FormatSample(std::ostringstream& out, std::string const& name, char const* suffix, std::string const& labels, long value)
+{
+    out << name << suffix;
+    if (!labels.empty())
+        out << '{' << labels << '}';
+    out << ' ' << value << '\n';
+}
+
+long MetricCounter::GetValue() const
+{
+    long value = 0;
+    for (int i = 0; i < METRIC_SHARDS; ++i)
+        value += m_shards[i].value.value();
+    return value;
+}
+
+void MetricCounter::Format(std::string const& name, std::string const& labels, std::ostringstream& out) const
+{
+    FormatSample(out, name, "", labels, GetValue());
+}
+
+void MetricGauge::Format(std::string const& name, std::string const& labels, std::ostringstream& out) const
+{
+    FormatSample(out, name, "", labels, GetValue());
+}
+
+MetricHistogram::MetricHistogram(long const* bounds, uint32 count) : m_bounds(bounds, bounds + count)
+{
+    for (int i = 0; i < METRIC_SHARDS; ++i)
+        m_shards[i].resize(count + 2);
+}
+
+void MetricHistogram::Observe(long value)
+{
+    std::vector<MetricValue>& shard = m_shards[GetMetricShard()];
+
+    uint32 bucket = 0;
+    while (bucket < m_bounds.size() && value > m_bounds[bucket])
+        ++bucket;
+
+    ++shard[bucket];
+    shard[m_bounds.size() + 1] += value;
+}
+
+void MetricHistogram::Format(std::string const& name, std::string const& labels, std::ostringstream& out) const
+{
+    std::vector<long> buckets(m_bounds.size() + 2, 0);
+    for (int i = 0; i < METRIC_SHARDS; ++i)
+        for (uint32 j = 0; j < buckets.size(); ++j)
+            buckets[j] += m_shards[i][j].value();
+
+    // buckets are cumulative in the exposition format
+    std::string separator = labels.empty() ? "" : ",";
+    long count = 0;
+    for (uint32 i = 0; i <= m_bounds.size(); ++i)
+    {
+        count += buckets[i];
+
+        out << name << "_bucket{" << labels << separator << "le=\"";
+        if (i < m_bounds.size())
+            out << m_bounds[i];
+        else
+            out << "+Inf";
+        out << "\"} " << count << '\n';
+    }
+
+    FormatSample(out, name, "_sum", labels, buckets[m_bounds.size() + 1]);
+    FormatSample(out, name, "_count", labels, count);
+}
+
+MetricsRegistry& MetricsRegistry::Instance()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+    for (std::map<std::string, Family>::iterator itr = m_families.begin(); itr != m_families.end(); ++itr)
+        for (std::map<std::string, Metric*>::iterator metric = itr->second.metrics.begin(); metric != itr->second.metrics.end(); ++metric)
+            delete metric->second;
+}
+
+Metric* MetricsRegistry::Find(char const* name, char const* help, char const* type, std::string const& labels, bool& typeMismatch)
+{
+    typeMismatch = false;
+
+    std::map<std::string, Family>::iterator itr = m_families.find(name);
+    if (itr == m_families.end())
+    {
+        Family& family = m_families[name];
+        family.help = help;
+        family.type = type;
+        return NULL;
+    }
+
+    if (strcmp(itr->second.type, type) != 0)
+    {
+        sLog.outError("MetricsRegistry: metric %s is registered as %s, requested as %s", name, itr->second.type, type);
+        typeMismatch = true;
+        return NULL;
+    }
+
+    std::map<std::string, Metric*>::const_iterator metric = itr->second.metrics.find(labels);
+    return metric != itr->second.metrics.end() ? metric->second : NULL;
+}
+
+template<class T>
+T* MetricsRegistry::Register(char const* name, std::string const& labels, T* metric, bool typeMismatch)
+{
+    // metric of wrong type works but is not exported
+    if (!typeMismatch)
+        m_families[name].metrics[labels] = metric;
+
+    return metric;
+}
+
+MetricCounter* MetricsRegistry::GetCounter(char const* name, char const* help, std::string const& labels /*= ""*/)
+{
+    MetricsGuard guard(m_lock);
+
+    bool typeMismatch;
+    if (Metric* metric = Find(name, help, "counter", labels, typeMismatch))
+        return static_cast<MetricCounter*>(metric);
+
+    return Register(name, labels, new MetricCounter, typeMismatch);
+}
+
+MetricGauge* MetricsRegistry::GetGauge(char const* name, char const* help, std::string const& labels /*= ""*/)
+{
+    MetricsGuard guard(m_lock);
+
+    bool typeMismatch;
+    if (Metric* metric = Find(name, help, "gauge", labels, typeMismatch))
+        return static_cast<MetricGauge*>(metric);
+
+    return Register(name, labels, new MetricGauge, typeMismatch);
+}
+
+MetricHistogram* MetricsRegistry::GetHistogram(char const* name, char const* help, long const* bounds, uint32 count, std::string const& labels /*= ""*/)
+{
+    MetricsGuard guard(m_lock);
+
+    bool typeMismatch;
+    if (Metric* metric = Find(name, help, "histogram", labels, typeMismatch))
+        return static_cast<MetricHistogram*>(metric);
+
+    return Register(name, labels, new MetricHistogram(bounds, count), typeMismatch);
+}
+
+std::string MetricsRegistry::Format()
+{
+    std::ostringstream out;
+
+    MetricsGuard guard(m_lock);
+
+    for (std::map<std::string, Family>::const_iterator itr = m_families.begin(); itr != m_families.end(); ++itr)
+    {
+        Family const& family = itr->second;
+
+        out << "# HELP " << itr->first << ' ' << family.help << '\n';
+        out << "# TYPE " << itr->first << ' ' << family.type << '\n';
+
+        for (std::map<std::string, Metric*>::const_iterator metric = family.metrics.begin(); metric != family.metrics.end(); ++metric)
+            metric->second->Format(itr->first, metric->first, out);
+    }
+
+    return out.str();
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_METRICS_H
+#define MANGOS_METRICS_H
+
+#include "Common.h"
+#include "Platform/Define.h"
+
+#include <ace/Atomic_Op.h>
+#include <ace/Thread_Mutex.h>
+
+#include <map>
+#include <sstream>
+
+#define METRIC_SHARDS           16
+#define METRIC_CACHE_LINE_SIZE  64
+
+typedef ACE_Atomic_Op<ACE_Thread_Mutex, long> MetricValue;
+
+/**
+ * Shard of the calling thread. Threads get shards round robin at first use,
+ * so updates of different threads don't fight for one cache line.
+ */
+uint32 GetMetricShard();
+
+class Metric
+{
+    public:
+        virtual ~Metric() {}
+
+        // append samples in Prometheus text format
+        virtual void Format(std::string const& name, std::string const& labels, std::ostringstream& out) const = 0;
+};
+
+/// Monotonic counter, sharded per thread and summed when scraped
+class MetricCounter : public Metric
+{
+    public:
+        void Inc(long value = 1) { m_shards[GetMetricShard()].value += value; }
+        long GetValue() const;
+
+        void Format(std::string const& name, std::string const& labels, std::ostringstream& out) const;
+
+    private:
+        struct Shard
+        {
+            MetricValue value;
+            char pad[METRIC_CACHE_LINE_SIZE - sizeof(MetricValue) % METRIC_CACHE_LINE_SIZE];
+        };
+
+        Shard m_shards[METRIC_SHARDS];
+};
+
+/// Current value of something, usually set by its owner
+class MetricGauge : public Metric
+{
+    public:
+        void Set(long value) { m_value = value; }
+        void Add(long value) { m_value += value; }
+        long GetValue() const { return m_value.value(); }
+
+        void Format(std::string const& name, std::string const& labels, std::ostringstream& out) const;
+
+    private:
+        MetricValue m_value;
+};
+
+/// Distribution of observed values over fixed bucket upper bounds, sharded per thread
+class MetricHistogram : public Metric
+{
+    public:
+        MetricHistogram(long const* bounds, uint32 count);
+
+        void Observe(long value);
+
+        void Format(std::string const& name, std::string const& labels, std::ostringstream& out) const;
+
+    private:
+        std::vector<long> m_bounds;
+        // per shard: a counter for every bound, one for +Inf and the sum of values
+        std::vector<MetricValue> m_shards[METRIC_SHARDS];
+};
+
+/**
+ * Registry of all metrics of the process, exported by MetricsServer.
+ *
+ * Metrics are created at first request and live until exit, so callers keep
+ * the returned pointer and update it without any lookup. Metrics of one name
+ * with different labels (like map="0") form a family.
+ */
+class MANGOS_DLL_SPEC MetricsRegistry
+{
+    public:
+        static MetricsRegistry& Instance();
+
+        MetricCounter* GetCounter(char const* name, char const* help, std::string const& labels = "");
+        MetricGauge* GetGauge(char const* name, char const* help, std::string const& labels = "");
+        MetricHistogram* GetHistogram(char const* name, char const* help, long const* bounds, uint32 count, std::string const& labels = "");
+
+        // all metrics in Prometheus text exposition format
+        std::string Format();
+
+    private:
+        MetricsRegistry() {}
+        ~MetricsRegistry();
+
+        struct Family
+        {
+            std::string help;
+            char const* type;
+            std::map<std::string, Metric*> metrics;         // by labels
+        };
+
+        // called with m_lock held, creates the family at first use
+        Metric* Find(char const* name, char const* help, char const* type, std::string const& labels, bool& typeMismatch);
+        template<class T>
+        T* Register(char const* name, std::string const& labels, T* metric, bool typeMismatch);
+
+        ACE_Thread_Mutex m_lock;
+        std::map<std::string, Family> m_families;
+};
+
+// label string for GetCounter/GetGauge/GetHistogram, like map="0"
+std::string MetricLabel(char const* name, uint32 value);
+
+// histogram bounds for update durations, in milliseconds
+#define METRIC_UPDATE_TIME_BOUNDS 10
+extern long const MetricUpdateTimeBounds[METRIC_UPDATE_TIME_BOUNDS];
+
+#define sMetrics MetricsRegistry::Instance()
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Metrics/MetricsServer.h"
+#include "Metrics/Metrics.h"
+#include "Log.h"
+
+#include <ace/INET_Addr.h>
+
+#define METRICS_MAX_REQUEST_SIZE    4096
+
+int MetricsSocket::handle_input(ACE_HANDLE)
+{
+    char buf[1024];
+    ssize_t readBytes = peer().recv(buf, sizeof(buf));
+    if (readBytes <= 0)
+        return -1;
+
+    m_request.append(buf, readBytes);
+
+    // wait for the end of the headers, the request has no body
+    if (m_request.find("\r\n\r\n") == std::string::npos && m_request.find("\n\n") == std::string::npos)
+        return m_request.size() < METRICS_MAX_REQUEST_SIZE ? 0 : -1;
+
+    if (m_request.compare(0, 13, "GET /metrics ") == 0 || m_request.compare(0, 6, "GET / ") == 0)
+        SendResponse("200 OK", sMetrics.Format());
+    else
+        SendResponse("404 Not Found", "Metrics are at /metrics\n");
+
+    return -1;
+}
+
+void MetricsSocket::SendResponse(char const* status, std::string const& body)
+{
+    std::ostringstream response;
+    response << "HTTP/1.0 " << status << "\r\n"
+             << "Content-Type: text/plain; version=0.0.4\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+
+    std::string data = response.str();
+    peer().send_n(data.c_str(), data.size());
+}
+
+MetricsServer::MetricsServer(std::string const& address, uint16 port) : m_address(address), m_port(port), m_stopped(false)
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+    m_acceptor.close();
+}
+
+void MetricsServer::run()
+{
+    ACE_INET_Addr listenAddr(m_port, m_address.c_str());
+
+    if (m_acceptor.open(listenAddr, &m_reactor, ACE_NONBLOCK) == -1)
+    {
+        sLog.outError("MetricsServer: can't bind to %s:%u", m_address.c_str(), m_port);
+        return;
+    }
+
+    sLog.outString("Metrics are exported at http://%s:%u/metrics", m_address.c_str(), m_port);
+
+    while (!m_stopped)
+    {
+        ACE_Time_Value interval(0, 100000);
+        if (m_reactor.run_reactor_event_loop(interval) == -1)
+            break;
+    }
+
+    m_acceptor.close();
+}
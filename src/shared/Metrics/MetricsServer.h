@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2005-2012 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_METRICSSERVER_H
+#define MANGOS_METRICSSERVER_H
+
+#include "Common.h"
+#include "Threading.h"
+
+#include <ace/Acceptor.h>
+#include <ace/Reactor.h>
+#include <ace/SOCK_Acceptor.h>
+#include <ace/Svc_Handler.h>
+
+/// One HTTP request for the metrics, answered and closed at once
+class MetricsSocket : public ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH>
+{
+    public:
+        int handle_input(ACE_HANDLE = ACE_INVALID_HANDLE);
+
+    private:
+        void SendResponse(char const* status, std::string const& body);
+
+        std::string m_request;
+};
+
+/**
+ * Minimal HTTP listener exporting sMetrics in Prometheus text format
+ * at /metrics. Runs its own reactor in the thread it is started in.
+ */
+class MetricsServer : public ACE_Based::Runnable
+{
+    public:
+        MetricsServer(std::string const& address, uint16 port);
+        ~MetricsServer();
+
+        void run();
+        void Stop() { m_stopped = true; }
+
+    private:
+        typedef ACE_Acceptor<MetricsSocket, ACE_SOCK_ACCEPTOR> Acceptor;
+
+        std::string m_address;
+        uint16 m_port;
+        ACE_Reactor m_reactor;
+        Acceptor m_acceptor;
+        volatile bool m_stopped;
+};
+
+#endif
@@ -23,6 +23,7 @@
 #include "mersennetwister/MersenneTwister.h"
 #include <ace/TSS_T.h>
 #include <ace/INET_Addr.h>
+#include <ace/OS_NS_unistd.h>
 
 typedef ACE_TSS<MTRand> MTRandTSS;
 static MTRandTSS mtRand;
@@ -272,6 +273,24 @@ uint32 CreatePIDFile(const std::string& filename)
     return (uint32)pid;
 }
 
+size_t GetProcessResidentBytes()
+{
+#if PLATFORM == PLATFORM_UNIX
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (!statm)
+        return 0;
+
+    unsigned long size = 0, resident = 0;
+    int read = fscanf(statm, "%lu %lu", &size, &resident);
+    fclose(statm);
+
+    return read == 2 ? size_t(resident) * ACE_OS::getpagesize() : 0;
+#else
+    // not implemented yet
+    return 0;
+#endif
+}
+
 size_t utf8length(std::string& utf8str)
 {
     try
@@ -349,6 +349,8 @@ void vutf8printf(FILE *out, const char *str, va_list* ap);
 
 bool IsIPAddress(char const* ipaddress);
 uint32 CreatePIDFile(const std::string& filename);
+// physical memory used by the process, 0 where not known
+size_t GetProcessResidentBytes();
 
 void hexEncodeByteArray(uint8* bytes, uint32 arrayLen, std::string& result);
 
@@ -24,7 +24,7 @@
 
 // Note: m_opcode and size stored in platfom dependent format
 // ignore endianess until send, and converted at receive
-class WorldPacket : public ByteBuffer
+class WorldPacket : public ByteBuffer, public MemoryPoolObject
 {
     public:
                                                             // just container for later use